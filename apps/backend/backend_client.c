@@ -70,7 +70,21 @@
 #include "clixon_backend_commit.h"
 #include "backend_handle.h"
 #include "backend_get.h"
+#include "backend_startup.h"
+#include "backend_yang.h"
+#include "backend_template.h"
 #include "backend_client.h"
+#include "backend_sched.h"
+
+/* Forward */
+static int from_client_input_timeout(int s, void *arg);
+
+/* Number of cancelled rpcs, see clixon_cancel_start and stats rpc */
+static struct {
+    uint64_t rc_deadline;   /* Deadline exceeded */
+    uint64_t rc_disconnect; /* Client closed session */
+    uint64_t rc_memory;     /* Memory budget exceeded */
+} _rpc_cancel_stats = {0,};
 
 /*! Find client by session-id 
  *
@@ -354,6 +368,10 @@ backend_client_rm(clixon_handle        h,
     ce_prev = &c0; /* this points to stack and is not real backpointer */
     for (c = *ce_prev; c; c = c->ce_next){
         if (c == ce){
+            if (timerisset(&ce->ce_input_time))
+                clixon_event_unreg_timeout(from_client_input_timeout, ce);
+            /* Drop requests waiting to be scheduled */
+            backend_sched_session_free(ce);
             if (ce->ce_s){
                 clixon_event_unreg_fd(ce->ce_s, from_client);
                 close(ce->ce_s);
@@ -361,6 +379,8 @@ backend_client_rm(clixon_handle        h,
                 if (release_all_dbs(h, ce->ce_id) < 0)
                     return -1;
             }
+            if (private_candidate_discard(h, ce) < 0)
+                return -1;
             break;
         }
         ce_prev = &c->ce_next;
@@ -565,6 +585,8 @@ from_client_edit_config(clixon_handle h,
             goto done;
         goto ok;
     }
+    if ((target = private_candidate_db(h, ce, target, 1)) == NULL)
+        goto done;
     if ((cbx = cbuf_new()) == NULL){
         clixon_err(OE_XML, errno, "cbuf_new");
         goto done;
@@ -701,14 +723,25 @@ from_client_edit_config(clixon_handle h,
                 break;
             }
         }
-        if ((ret = candidate_commit(h, NULL, "candidate", myid, 0, cbret)) < 0){ /* Assume validation fail, nofatal */
+        if (ce->ce_candidate)
+            ret = private_candidate_commit(h, NULL, ce, cbret);
+        else
+            ret = candidate_commit(h, NULL, "candidate", myid, 0, cbret);
+        if (ret < 0){ /* Assume validation fail, nofatal */
             if (netconf_operation_failed(cbret, "application", clixon_err_reason())< 0)
                 goto done;
-            xmldb_copy(h, "running", "candidate");
+            if (ce->ce_candidate)
+                private_candidate_discard(h, ce);
+            else
+                xmldb_copy(h, "running", "candidate");
             goto ok;
         }
         if (ret == 0){ /* discard */
-            if (xmldb_copy(h, "running", "candidate") < 0){
+            if (ce->ce_candidate){
+                if (private_candidate_discard(h, ce) < 0)
+                    goto done;
+            }
+            else if (xmldb_copy(h, "running", "candidate") < 0){
                 if (netconf_operation_failed(cbret, "application", clixon_err_reason())< 0)
                     goto done;
                 goto ok;
@@ -719,7 +752,7 @@ from_client_edit_config(clixon_handle h,
     /* Clixon extension: copy */
     if ((attr = xml_find_value(xn, "copystartup")) != NULL &&
         strcmp(attr,"true") == 0){
-        if (xmldb_copy(h, "running", "startup") < 0){
+        if (startup_flush_request(h, 1) < 0){
             if (netconf_operation_failed(cbret, "application", clixon_err_reason())< 0)
                 goto done;
             goto ok;
@@ -748,6 +781,96 @@ from_client_edit_config(clixon_handle h,
     return retval;
 } /* from_client_edit_config */
 
+/*! Edit data in an NMDA datastore, RFC 8526 edit-data
+ *
+ * Translated to edit-config of the conventional datastore, only running and candidate 
+ * are writable.
+ * @param[in]  h       Clixon handle 
+ * @param[in]  xn      Request: <rpc><xn></rpc> 
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register() 
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see from_client_edit_config
+ */
+static int
+from_client_edit_data(clixon_handle h,
+                      cxobj        *xn,
+                      cbuf         *cbret,
+                      void         *arg,
+                      void         *regarg)
+{
+    int    retval = -1;
+    cxobj *x;
+    cxobj *xc0;
+    cxobj *xc;
+    cxobj *xt = NULL;
+    cxobj *xe;
+    char  *id = NULL;
+    char  *db = NULL;
+    char  *op;
+    cvec  *nsc = NULL;
+    int    ret;
+
+    if ((x = xml_find_type(xn, NULL, "datastore", CX_ELMNT)) == NULL){
+        if (netconf_missing_element(cbret, "protocol", "datastore", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((ret = nmda_identity(x, NMDA_DATASTORES_NAMESPACE, &id)) < 0)
+        goto done;
+    if (ret == 1){
+        if (strcmp(id, "running") == 0)
+            db = "running";
+        else if (strcmp(id, "candidate") == 0)
+            db = "candidate";
+    }
+    if (db == NULL){
+        if (netconf_invalid_value(cbret, "protocol", "Datastore not writable") < 0)
+            goto done;
+        goto ok;
+    }
+    if ((xc0 = xml_find_type(xn, NULL, NETCONF_INPUT_CONFIG, CX_ELMNT)) == NULL){
+        if (netconf_missing_element(cbret, "protocol", NETCONF_INPUT_CONFIG, NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((op = xml_find_body(xn, "default-operation")) == NULL)
+        op = "merge";
+    if (clixon_xml_parse_va(YB_NONE, NULL, &xt, NULL,
+                            "<edit-config xmlns=\"%s\"><target><%s/></target>"
+                            "<default-operation>%s</default-operation><%s/></edit-config>",
+                            NETCONF_BASE_NAMESPACE, db, op, NETCONF_INPUT_CONFIG) < 0)
+        goto done;
+    if ((xe = xml_find_type(xt, NULL, "edit-config", CX_ELMNT)) == NULL ||
+        (xc = xml_find_type(xe, NULL, NETCONF_INPUT_CONFIG, CX_ELMNT)) == NULL){
+        clixon_err(OE_XML, EINVAL, "edit-config not found");
+        goto done;
+    }
+    /* Move config content to edit-config, keeping namespaces declared in ancestors */
+    if (xml_nsctx_node(xc0, &nsc) < 0)
+        goto done;
+    while ((x = xml_child_i_type(xc0, 0, CX_ELMNT)) != NULL){
+        if (xml_addsub(xc, x) < 0)
+            goto done;
+        if (xmlns_set_all(x, nsc) < 0)
+            goto done;
+    }
+    retval = from_client_edit_config(h, xe, cbret, arg, regarg);
+    goto done;
+ ok:
+    retval = 0;
+ done:
+    if (id)
+        free(id);
+    if (nsc)
+        cvec_free(nsc);
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
 /*! Create or replace an entire config with another complete config db
  *
  * @param[in]  h       Clixon handle
@@ -793,6 +916,10 @@ from_client_copy_config(clixon_handle h,
             goto done;
         goto ok;
     }
+    if ((source = private_candidate_db(h, ce, source, 0)) == NULL)
+        goto done;
+    if ((target = private_candidate_db(h, ce, target, 1)) == NULL)
+        goto done;
     /* Check if target locked by other client */
     iddb = xmldb_islocked(h, target);
     if (iddb && myid != iddb){
@@ -861,6 +988,8 @@ from_client_delete_config(clixon_handle h,
             goto done;
         goto ok;
     }
+    if ((target = private_candidate_db(h, ce, target, 1)) == NULL)
+        goto done;
     if ((cbx = cbuf_new()) == NULL){
         clixon_err(OE_XML, errno, "cbuf_new");
         goto done;
@@ -935,6 +1064,8 @@ from_client_lock(clixon_handle h,
             goto done;
         goto ok;
     }
+    if ((db = private_candidate_db(h, ce, db, 1)) == NULL)
+        goto done;
     if ((cbx = cbuf_new()) == NULL){
         clixon_err(OE_XML, errno, "cbuf_new");
         goto done;
@@ -991,6 +1122,8 @@ from_client_unlock(clixon_handle h,
             goto done;
         goto ok;
     }
+    if ((db = private_candidate_db(h, ce, db, 1)) == NULL)
+        goto done;
     if ((cbx = cbuf_new()) == NULL){
         clixon_err(OE_XML, errno, "cbuf_new");
         goto done;
@@ -1054,6 +1187,8 @@ from_client_close_session(clixon_handle h,
 
     if (release_all_dbs(h, id) < 0)
         return -1;
+    if (private_candidate_discard(h, ce) < 0)
+        return -1;
     stream_ss_delete_all(h, ce_event_cb, (void*)ce);
     cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
     return 0;
@@ -1438,6 +1573,15 @@ from_client_stats(clixon_handle h,
 	if (clixon_stats_datastore_get(h, "startup", cbret) < 0)
 	    goto done;
     cprintf(cbret, "</datastores>");
+    if (startup_flush_stats(h, cbret) < 0)
+        goto done;
+    cprintf(cbret, "<rpc-cancel xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cbret, "<deadline>%" PRIu64 "</deadline>", _rpc_cancel_stats.rc_deadline);
+    cprintf(cbret, "<disconnect>%" PRIu64 "</disconnect>", _rpc_cancel_stats.rc_disconnect);
+    cprintf(cbret, "<memory>%" PRIu64 "</memory>", _rpc_cancel_stats.rc_memory);
+    cprintf(cbret, "</rpc-cancel>");
+    if (backend_sched_stats(h, cbret) < 0)
+        goto done;
     /* per module-set, first configuration, then main dbspec, then mountpoints */
     cprintf(cbret, "<module-sets xmlns=\"%s\">", CLIXON_LIB_NS);
     cprintf(cbret, "<module-set><name>clixon-config</name>");
@@ -1476,6 +1620,8 @@ from_client_stats(clixon_handle h,
             goto done;
     }
     cprintf(cbret, "</module-sets>");
+    if (clixon_event_stats(cbret, CLIXON_LIB_NS, "backend") < 0)
+        goto done;
     cprintf(cbret, "</rpc-reply>");
     retval = 0;
  done:
@@ -1484,6 +1630,50 @@ from_client_stats(clixon_handle h,
     return retval;
 }
 
+/*! Dump xpath statistics per expression and call site, and optionally reset them
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see CLICON_XPATH_PROFILE
+ */
+static int
+from_client_xpath_profile(clixon_handle h,
+                          cxobj        *xe,
+                          cbuf         *cbret,
+                          void         *arg,
+                          void         *regarg)
+{
+    int      retval = -1;
+    int      ret;
+    char    *str;
+    uint32_t max = 0;
+    int      reset = 0;
+
+    if ((str = xml_find_body(xe, "max")) != NULL){
+        if ((ret = netconf_parse_uint32("max", str, NULL, 0, cbret, &max)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
+    if ((str = xml_find_body(xe, "reset")) != NULL)
+        reset = strcmp(str, "true") == 0;
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    if (xpath_profile_dump(cbret, CLIXON_LIB_NS, max) < 0)
+        goto done;
+    cprintf(cbret, "</rpc-reply>");
+    if (reset && xpath_profile_reset() < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Request restart of specific plugins
  *
  * @param[in]  h       Clixon handle
@@ -1614,6 +1804,117 @@ from_client_hello(clixon_handle       h,
     return retval;
 }
 
+/*! Get per-user limit of rpc from option with entries on the form "<user>|* <value>"
+ *
+ * @param[in]  h         Clixon handle
+ * @param[in]  option    Option name, eg CLICON_BACKEND_RPC_DEADLINE
+ * @param[in]  username  User of rpc
+ * @param[out] val       Value of first entry matching user, or 0 if none
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+rpc_user_limit(clixon_handle h,
+               char         *option,
+               char         *username,
+               uint64_t     *val)
+{
+    int     retval = -1;
+    cxobj  *x = NULL;
+    char   *str;
+    char   *p;
+    char   *reason = NULL;
+    int     ret;
+
+    *val = 0;
+    while ((x = xml_child_each(clicon_conf_xml(h), x, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(x), option) != 0)
+            continue;
+        if ((str = xml_body(x)) == NULL ||
+            (p = strchr(str, ' ')) == NULL)
+            continue;
+        if (!(p - str == 1 && str[0] == '*') &&
+            (username == NULL ||
+             strlen(username) != p - str ||
+             strncmp(username, str, p - str) != 0))
+            continue;
+        if ((ret = parse_uint64(p+1, val, &reason)) < 0){
+            clixon_err(OE_CFG, errno, "parse_uint64");
+            goto done;
+        }
+        if (ret == 0){
+            clixon_log(h, LOG_WARNING, "%s \"%s\": %s", option, str, reason);
+            free(reason);
+            reason = NULL;
+            continue;
+        }
+        break;
+    }
+    retval = 0;
+ done:
+    if (reason)
+        free(reason);
+    return retval;
+}
+
+/*! Get deadline of incoming rpc
+ *
+ * The deadline is given by the clixon-lib "deadline" attribute of the rpc, or else by the
+ * first CLICON_BACKEND_RPC_DEADLINE entry matching the user.
+ * @param[in]  h         Clixon handle
+ * @param[in]  xrpc      Incoming rpc
+ * @param[in]  username  User of rpc
+ * @param[out] cbret     Error message (if retval = 0)
+ * @param[out] ms        Deadline in milliseconds, or 0 for none
+ * @retval     1         OK
+ * @retval     0         Invalid deadline attribute (cbret set)
+ * @retval    -1         Error
+ */
+static int
+rpc_deadline_get(clixon_handle h,
+                 cxobj        *xrpc,
+                 char         *username,
+                 cbuf         *cbret,
+                 uint32_t     *ms)
+{
+    int      retval = -1;
+    cxobj   *xa;
+    char    *ns = NULL;
+    char    *reason = NULL;
+    uint64_t val;
+    int      ret;
+
+    *ms = 0;
+    if ((xa = xml_find_type(xrpc, NULL, "deadline", CX_ATTR)) != NULL){
+        if (xml2ns(xa, xml_prefix(xa), &ns) < 0)
+            goto done;
+        if (ns != NULL && strcmp(ns, CLIXON_LIB_NS) == 0){
+            if ((ret = parse_uint32(xml_value(xa), ms, &reason)) < 0){
+                clixon_err(OE_XML, errno, "parse_uint32");
+                goto done;
+            }
+            if (ret == 0){
+                if (netconf_bad_attribute(cbret, "protocol", "deadline", reason) < 0)
+                    goto done;
+                goto fail;
+            }
+            goto ok;
+        }
+    }
+    if (rpc_user_limit(h, "CLICON_BACKEND_RPC_DEADLINE", username, &val) < 0)
+        goto done;
+    *ms = val > UINT32_MAX ? UINT32_MAX : val;
+ ok:
+    retval = 1;
+ done:
+    if (reason)
+        free(reason);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! An internal clixon NETCONF message has arrived from a local client. Receive and dispatch.
  *
  * @param[in]   h    Clixon handle
@@ -1623,7 +1924,7 @@ from_client_hello(clixon_handle       h,
  * @retval     -1    Error Terminates backend and is never called). Instead errors are
  *                   propagated back to client.
  */
-static int
+int
 from_client_msg(clixon_handle        h,
                 struct client_entry *ce,
                 char                *msg)
@@ -1648,6 +1949,8 @@ from_client_msg(clixon_handle        h,
     char                *namespace = NULL;
     int                  nr = 0;
     cbuf                *cbce = NULL;
+    uint32_t             deadline;
+    uint64_t             budget;
 
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "");
     yspec = clicon_dbspec_yang(h);
@@ -1773,6 +2076,16 @@ from_client_msg(clixon_handle        h,
     username = xml_find_value(x, "username");
     /* May be used by callbacks, etc */
     clicon_username_set(h, username);
+    if ((ret = rpc_deadline_get(h, x, username, cbret, &deadline)) < 0)
+        goto done;
+    if (ret == 1 &&
+        rpc_user_limit(h, "CLICON_BACKEND_RPC_MEMORY", username, &budget) < 0)
+        goto done;
+    if (ret == 0){
+        ce->ce_out_rpc_errors++;
+        netconf_monitoring_counter_inc(h, "out-rpc-errors");
+        goto reply;
+    }
     while ((xe = xml_child_each(x, xe, CX_ELMNT)) != NULL) {
         rpc = xml_name(xe);
         if ((ye = xml_spec(xe)) == NULL){
@@ -1822,7 +2135,38 @@ from_client_msg(clixon_handle        h,
             }
         }
         clixon_err_reset();
-        if ((ret = rpc_callback_call(h, xe, ce, &nr, cbret)) < 0){
+        /* Abort rpc if deadline passes, client closes session, or memory budget is exceeded */
+        clixon_cancel_start(deadline, ce->ce_s);
+        clixon_cancel_budget(budget);
+        ret = rpc_callback_call(h, xe, ce, &nr, cbret);
+        clixon_cancel_stop();
+        if (ret < 0 && clixon_cancel_reason()){
+            /* Partial reply is discarded */
+            cbuf_reset(cbret);
+            switch (clixon_cancel_reason()){
+            case ETIMEDOUT:
+                _rpc_cancel_stats.rc_deadline++;
+                if (netconf_operation_failed(cbret, "application", "Deadline exceeded") < 0)
+                    goto done;
+                break;
+            case E2BIG:
+                _rpc_cancel_stats.rc_memory++;
+                if (netconf_too_big(cbret, "application", "Memory budget exceeded") < 0)
+                    goto done;
+                break;
+            default:
+                _rpc_cancel_stats.rc_disconnect++;
+                if (netconf_operation_failed(cbret, "application", "Client closed session") < 0)
+                    goto done;
+                break;
+            }
+            clixon_log(h, LOG_NOTICE, "%s %s cancelled: %s (%zu bytes allocated)",
+                       __FUNCTION__, rpc, strerror(clixon_cancel_reason()), clixon_cancel_used());
+            ce->ce_out_rpc_errors++;
+            netconf_monitoring_counter_inc(h, "out-rpc-errors");
+            goto reply;
+        }
+        if (ret < 0){
             if (netconf_operation_failed(cbret, "application", clixon_err_reason())< 0)
                 goto done;
             clixon_log(h, LOG_NOTICE, "%s Error in rpc_callback_call:%s", __FUNCTION__, xml_name(xe));
@@ -1854,6 +2198,9 @@ from_client_msg(clixon_handle        h,
         if (netconf_operation_failed(cbret, "application",
                                      clixon_err_category()?clixon_err_reason():"unknown")< 0)
             goto done;
+    /* Publish replica if request wrote running, before reply so that the client sees it */
+    if (xmldb_replica_sync(h) < 0)
+        clixon_log(h, LOG_WARNING, "%s: replica: %s", __FUNCTION__, clixon_err_reason());
     // XXX    clixon_debug(CLIXON_DBG_MSG, "Reply:%s", cbuf_get(cbret));
     /* XXX problem here is that cbret has not been parsed so may contain 
        parse errors */
@@ -1901,8 +2248,74 @@ from_client_msg(clixon_handle        h,
     return retval;// -1 here terminates backend
 }
 
+/*! Timeout of partial incoming message: close the client session
+ *
+ * @param[in]   s    Not used (timeout)
+ * @param[in]   arg  Client entry
+ * @retval      0    OK
+ * @retval     -1    Error
+ * @see CLICON_BACKEND_MSG_TIMEOUT
+ */
+static int
+from_client_input_timeout(int   s,
+                          void *arg)
+{
+    struct client_entry *ce = (struct client_entry *)arg;
+    clixon_handle        h = ce->ce_handle;
+
+    clixon_log(h, LOG_WARNING, "Session %u: incomplete message after %d ms, closing",
+               ce->ce_id, clicon_option_int(h, "CLICON_BACKEND_MSG_TIMEOUT"));
+    timerclear(&ce->ce_input_time);
+    backend_client_rm(h, ce);
+    netconf_monitoring_counter_inc(h, "dropped-sessions");
+    return 0;
+}
+
+/*! Start or stop age timer of partial incoming message of a client
+ *
+ * @param[in]   h    Clixon handle
+ * @param[in]   ce   Client entry
+ * @param[in]   on   Start timer if not started, otherwise stop it
+ * @retval      0    OK
+ * @retval     -1    Error
+ */
+static int
+from_client_input_timer(clixon_handle        h,
+                        struct client_entry *ce,
+                        int                  on)
+{
+    int            retval = -1;
+    int            timeout;
+    struct timeval t;
+
+    if (on){
+        if (timerisset(&ce->ce_input_time) ||
+            (timeout = clicon_option_int(h, "CLICON_BACKEND_MSG_TIMEOUT")) <= 0)
+            goto ok;
+        gettimeofday(&ce->ce_input_time, NULL);
+        t.tv_sec = timeout/1000;
+        t.tv_usec = (timeout%1000)*1000;
+        timeradd(&ce->ce_input_time, &t, &t);
+        if (clixon_event_reg_timeout(t, from_client_input_timeout, ce, "partial message") < 0)
+            goto done;
+    }
+    else if (timerisset(&ce->ce_input_time)){
+        clixon_event_unreg_timeout(from_client_input_timeout, ce);
+        timerclear(&ce->ce_input_time);
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! An internal clicon message has arrived from a client. Receive and dispatch.
  *
+ * Reads what is available on the socket without blocking, and appends it to the input buffer
+ * of the client. Only complete messages are dispatched, other sessions are served while a
+ * message is incomplete.
+ * The client is closed if an incomplete message exceeds CLICON_BACKEND_MSG_MAX bytes or is
+ * older than CLICON_BACKEND_MSG_TIMEOUT ms.
  * @param[in]   s    Socket where message arrived. read from this.
  * @param[in]   arg  Client entry (from).
  * @retval      0    OK
@@ -1916,33 +2329,117 @@ from_client(int   s,
     int                  retval = -1;
     struct client_entry *ce = (struct client_entry *)arg;
     clixon_handle        h = ce->ce_handle;
+    uint32_t             id = ce->ce_id;
     int                  eof = 0;
-    cbuf                *cbce = NULL;
-    cbuf                *cb = NULL;
+    int                  eom = 0;
+    unsigned char        buf[BUFSIZ];
+    unsigned char       *p;
+    size_t               plen;
+    ssize_t              len;
+    int                  max;
+    int                  ret;
 
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "");
     if (s != ce->ce_s){
         clixon_err(OE_NETCONF, EINVAL, "Internal error: s != ce->ce_s");
         goto done;
     }
-    if (ce_client_descr(ce, &cbce) < 0)
-        goto done;
-    if (clixon_msg_rcv11(s, NULL, 0, &cb, &eof) < 0)
+    if (ce->ce_input == NULL &&
+        (ce->ce_input = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
         goto done;
-    if (eof){
-        backend_client_rm(h, ce);
-        netconf_monitoring_counter_inc(h, "dropped-sessions");
     }
-    else if (from_client_msg(h, ce, cbuf_get(cb)) < 0)
-        goto done;
+    /* Socket is readable: a single read does not block */
+    if ((len = netconf_input_read2(s, buf, sizeof(buf), &eof)) < 0)
+        goto done;
+    if (eof)
+        goto closed;
+    max = clicon_option_int(h, "CLICON_BACKEND_MSG_MAX");
+    p = buf;
+    plen = len;
+    while (plen > 0){
+        if (netconf_input_msg2(&p, &plen,
+                               ce->ce_input,
+                               NETCONF_SSH_CHUNKED,
+                               &ce->ce_frame_state,
+                               &ce->ce_frame_size,
+                               &eom) < 0)
+            /* Errors from input are only framing errors, non-fatal, close session */
+            goto closed;
+        if (eom == 0)
+            break;
+        if (from_client_input_timer(h, ce, 0) < 0)
+            goto done;
+        clixon_debug(CLIXON_DBG_MSG, "Recv: %s", cbuf_get(ce->ce_input));
+        if ((ret = backend_sched_request(h, ce, cbuf_get(ce->ce_input))) < 0)
+            goto done;
+        if (ret == 0 &&
+            from_client_msg(h, ce, cbuf_get(ce->ce_input)) < 0)
+            goto done;
+        /* Client may be removed by the rpc, eg on notification error */
+        if (ce_find_byid(backend_client_list(h), id) != ce)
+            goto ok;
+        cbuf_reset(ce->ce_input);
+    }
+    if (cbuf_len(ce->ce_input) > 0 || ce->ce_frame_state != 0){
+        if (max > 0 && cbuf_len(ce->ce_input) > max){
+            clixon_log(h, LOG_WARNING, "Session %u: message larger than %d bytes, closing",
+                       ce->ce_id, max);
+            goto closed;
+        }
+        if (!ce->ce_input_paused &&
+            from_client_input_timer(h, ce, 1) < 0)
+            goto done;
+    }
+ ok:
     retval = 0;
-  done:
+ done:
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "retval:%d", retval);
-    if (cb)
-        cbuf_free(cb);
-    if (cbce)
-        cbuf_free(cbce);
     return retval; /* -1 here terminates backend */
+ closed:
+    backend_client_rm(h, ce);
+    netconf_monitoring_counter_inc(h, "dropped-sessions");
+    goto ok;
+}
+
+/*! Stop or resume reading incoming messages from a client
+ *
+ * Used by the request scheduler to stop reading from a client while it has requests waiting,
+ * so that the client is held back by the socket instead of its requests being queued
+ * without limit. The timer of a partial message is stopped while the client is not read.
+ * @param[in]   h     Clixon handle
+ * @param[in]   ce    Client entry
+ * @param[in]   pause Stop reading if set, otherwise resume
+ * @retval      0     OK
+ * @retval     -1     Error
+ */
+int
+from_client_pause(clixon_handle        h,
+                  struct client_entry *ce,
+                  int                  pause)
+{
+    int retval = -1;
+
+    if (ce->ce_input_paused == pause || ce->ce_s == 0)
+        goto ok;
+    if (pause){
+        clixon_event_unreg_fd(ce->ce_s, from_client);
+        if (from_client_input_timer(h, ce, 0) < 0)
+            goto done;
+    }
+    else {
+        if (clixon_event_reg_fd(ce->ce_s, from_client, (void*)ce, "local netconf client socket") < 0)
+            goto done;
+        if (ce->ce_input &&
+            (cbuf_len(ce->ce_input) > 0 || ce->ce_frame_state != 0) &&
+            from_client_input_timer(h, ce, 1) < 0)
+            goto done;
+    }
+    ce->ce_input_paused = pause;
+ ok:
+    retval = 0;
+ done:
+    return retval;
 }
 
 /*! Init backend rpc: Set up standard netconf rpc callbacks
@@ -2011,6 +2508,15 @@ backend_rpc_init(clixon_handle h)
     if (rpc_callback_register(h, from_client_get_schema, NULL,
                       NETCONF_MONITORING_NAMESPACE, "get-schema") < 0)
         goto done;
+    /* RFC 8526 */
+    if (clicon_option_bool(h, "CLICON_NETCONF_NMDA")){
+        if (rpc_callback_register(h, from_client_get_data, NULL,
+                                  NETCONF_NMDA_NAMESPACE, "get-data") < 0)
+            goto done;
+        if (rpc_callback_register(h, from_client_edit_data, NULL,
+                                  NETCONF_NMDA_NAMESPACE, "edit-data") < 0)
+            goto done;
+    }
     /* Clixon RPC */
     if (rpc_callback_register(h, from_client_debug, NULL,
                               CLIXON_LIB_NS, "debug") < 0)
@@ -2021,12 +2527,21 @@ backend_rpc_init(clixon_handle h)
     if (rpc_callback_register(h, from_client_stats, NULL,
                               CLIXON_LIB_NS, "stats") < 0)
         goto done;
+    if (rpc_callback_register(h, from_client_xpath_profile, NULL,
+                              CLIXON_LIB_NS, "xpath-profile") < 0)
+        goto done;
     if (rpc_callback_register(h, from_client_restart_plugin, NULL,
                               CLIXON_LIB_NS, "restart-plugin") < 0)
         goto done;
     if (rpc_callback_register(h, from_client_process_control, NULL,
                               CLIXON_LIB_NS, "process-control") < 0)
         goto done;
+    if (rpc_callback_register(h, from_client_yang_load, NULL,
+                              CLIXON_LIB_NS, "yang-load") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_template_apply, NULL,
+                              CLIXON_LIB_NS, "template-apply") < 0)
+        goto done;
     retval =0;
  done:
     return retval;
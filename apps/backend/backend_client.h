@@ -42,7 +42,9 @@
  */
 int backend_monitoring_state_get(clixon_handle h, yang_stmt *yspec, char *xpath, cvec *nsc, cxobj **xret, cxobj **xerr);
 int backend_client_rm(clixon_handle h, struct client_entry *ce);
+int from_client_msg(clixon_handle h, struct client_entry *ce, char *msg);
 int from_client(int fd, void *arg);
+int from_client_pause(clixon_handle h, struct client_entry *ce, int pause);
 int backend_rpc_init(clixon_handle h);
 
 #endif  /* _BACKEND_CLIENT_H_ */
@@ -44,6 +44,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <errno.h>
 #include <signal.h>
 #include <fcntl.h>
@@ -81,6 +82,7 @@
  *    string regexp checked.
  * See also db_lv_set() where defaults are also filled in. The case here for defaults
  * are if code comes via XML/NETCONF.
+ * Validation is made in parallel worker processes if CLICON_VALIDATE_WORKERS > 1
  * @param[in]   h       Clixon handle
  * @param[in]   yspec   Yang spec
  * @param[in]   td      Transaction data
@@ -95,43 +97,377 @@ generic_validate(clixon_handle       h,
                  transaction_data_t *td,
                  cxobj             **xret)
 {
-    int        retval = -1;
-    cxobj     *x2;
-    int        i;
-    int        ret;
-    cbuf      *cb = NULL;
+    int           retval = -1;
+    int           i;
+    validate_job *vj = NULL;
 
+    if ((vj = validate_job_new(h)) == NULL)
+        goto done;
     /* All entries */
-    if ((ret = xml_yang_validate_all_top(h, td->td_target, xret)) < 0)
+    if (validate_job_all_top(vj, td->td_target) < 0)
         goto done;
-    if (ret == 0)
-        goto fail;
     /* changed entries */
     for (i=0; i<td->td_clen; i++){
-        x2 = td->td_tcvec[i]; /* target changed */
         /* Should this be recursive? */
-        if ((ret = xml_yang_validate_add(h, x2, xret)) < 0)
+        if (validate_job_add(vj, td->td_tcvec[i]) < 0) /* target changed */
             goto done;
-        if (ret == 0)
-            goto fail;
     }
     /* added entries */
     for (i=0; i<td->td_alen; i++){
-        x2 = td->td_avec[i];
-        if ((ret = xml_yang_validate_add(h, x2, xret)) < 0)
+        if (validate_job_add(vj, td->td_avec[i]) < 0)
             goto done;
-        if (ret == 0)
-            goto fail;
     }
-    // ok:
-    retval = 1;
+    retval = validate_job_run(vj, xret);
+ done:
+    if (vj)
+        validate_job_free(vj);
+    return retval;
+}
+
+/* File in CLICON_XMLDB_DIR where digests of last validated config and YANG are saved
+ * See CLICON_STARTUP_DIGEST
+ */
+#define STARTUP_DIGEST_FILE "validated.digest"
+
+/* Cached digest of YANG spec, computed once per spec
+ * Specs replaced by yang-load are retired, not freed, so the pointer identifies the spec
+ * See digest_yang_cached
+ */
+static yang_stmt *_digest_yspec = NULL;
+static uint8_t    _digest_yang[SHA256_DIGEST_LEN];
+
+/*! Add a tag byte followed by a length-prefixed string to a SHA-256 digest
+ *
+ * The tag identifies what the field is, the length prefix makes the encoding of a
+ * sequence of fields unambiguous regardless of their content
+ * @param[in]  ctx  SHA-256 state
+ * @param[in]  tag  Field tag
+ * @param[in]  str  String, NULL is encoded as empty
+ */
+static void
+digest_str(clixon_sha256_ctx *ctx,
+           uint8_t            tag,
+           const char        *str)
+{
+    clixon_sha256_update(ctx, &tag, 1);
+    clixon_sha256_field(ctx, str, str ? strlen(str) : 0);
+}
+
+/*! Add SHA-256 digest of a file to a SHA-256 digest
+ *
+ * @param[in]  ctx       SHA-256 state
+ * @param[in]  filename  File to read
+ * @retval     1         OK
+ * @retval     0         File not found or not readable
+ */
+static int
+digest_file(clixon_sha256_ctx *ctx,
+            const char        *filename)
+{
+    clixon_sha256_ctx fctx;
+    uint8_t           fdigest[SHA256_DIGEST_LEN];
+    uint8_t           tag = 'C';
+    FILE             *f;
+    char              buf[BUFSIZ];
+    size_t            len;
+
+    if ((f = fopen(filename, "r")) == NULL)
+        return 0;
+    clixon_sha256_init(&fctx);
+    while ((len = fread(buf, 1, sizeof(buf), f)) > 0)
+        clixon_sha256_update(&fctx, buf, len);
+    fclose(f);
+    clixon_sha256_final(&fctx, fdigest);
+    clixon_sha256_update(ctx, &tag, 1);
+    clixon_sha256_field(ctx, fdigest, sizeof(fdigest));
+    return 1;
+}
+
+/*! Compute digest of the YANG modules of a spec
+ *
+ * Includes the contents of the files of all (sub)modules, and enabled features
+ * @param[in]  yspec   Yang spec
+ * @param[out] digest  Digest
+ */
+static void
+digest_yang(yang_stmt *yspec,
+            uint8_t    digest[SHA256_DIGEST_LEN])
+{
+    clixon_sha256_ctx ctx;
+    yang_stmt        *ym = NULL;
+    yang_stmt        *yf;
+    yang_stmt        *yrev;
+    const char       *filename;
+    cg_var           *cv;
+
+    clixon_sha256_init(&ctx);
+    while ((ym = yn_each(yspec, ym)) != NULL) {
+        if (yang_keyword_get(ym) != Y_MODULE && yang_keyword_get(ym) != Y_SUBMODULE)
+            continue;
+        digest_str(&ctx, 'M', yang_argument_get(ym));
+        if ((filename = yang_filename_get(ym)) == NULL ||
+            digest_file(&ctx, filename) == 0){
+            if ((yrev = yang_find(ym, Y_REVISION, NULL)) != NULL)
+                digest_str(&ctx, 'R', yang_argument_get(yrev));
+        }
+        yf = NULL;
+        while ((yf = yn_each(ym, yf)) != NULL) {
+            if (yang_keyword_get(yf) != Y_FEATURE)
+                continue;
+            if ((cv = yang_cv_get(yf)) != NULL && cv_bool_get(cv))
+                digest_str(&ctx, 'F', yang_argument_get(yf));
+        }
+    }
+    clixon_sha256_final(&ctx, digest);
+}
+
+/*! Get digest of the YANG modules of a spec, computed once per spec
+ *
+ * Reading and hashing all YANG files is only made after YANG load, not on every commit
+ * @param[in]  yspec   Yang spec
+ * @retval     digest  Digest, static buffer
+ */
+static const uint8_t *
+digest_yang_cached(yang_stmt *yspec)
+{
+    if (yspec != _digest_yspec){
+        digest_yang(yspec, _digest_yang);
+        _digest_yspec = yspec;
+    }
+    return _digest_yang;
+}
+
+/*! Check if XML node is left out of config digest
+ *
+ * Default values and empty non-presence containers are not saved in datastores, and
+ * may or may not be present in a tree depending on whether it is read from file
+ * @param[in]  x    XML node
+ * @retval     1    Skip
+ * @retval     0    Include in digest
+ */
+static int
+digest_xml_skip(cxobj *x)
+{
+    yang_stmt *y;
+    cxobj     *xc = NULL;
+
+    if (xml_flag(x, XML_FLAG_DEFAULT))
+        return 1;
+    if ((y = xml_spec(x)) == NULL ||
+        yang_keyword_get(y) != Y_CONTAINER ||
+        yang_find(y, Y_PRESENCE, NULL) != NULL)
+        return 0;
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL)
+        if (!digest_xml_skip(xc))
+            return 0;
+    return 1;
+}
+
+/*! Add sorted and YANG-bound XML tree to a SHA-256 digest
+ *
+ * Namespaces, names and bodies of elements are included, in tree order. Each element is
+ * enclosed in start and end tags and its fields are length-prefixed.
+ * @param[in]  ctx  SHA-256 state
+ * @param[in]  xt   XML tree
+ */
+static void
+digest_xml(clixon_sha256_ctx *ctx,
+           cxobj             *xt)
+{
+    cxobj     *x = NULL;
+    yang_stmt *y;
+    char      *body;
+    uint8_t    tag;
+
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+        if (digest_xml_skip(x))
+            continue;
+        y = xml_spec(x);
+        digest_str(ctx, '<', y ? yang_find_mynamespace(y) : NULL);
+        digest_str(ctx, 'N', xml_name(x));
+        if ((body = xml_body(x)) != NULL)
+            digest_str(ctx, 'B', body);
+        digest_xml(ctx, x);
+        tag = '>';
+        clixon_sha256_update(ctx, &tag, 1);
+    }
+}
+
+/*! Get digests of a config tree and the current YANG as a hex string
+ *
+ * @param[in]  h   Clixon handle
+ * @param[in]  xt  Config tree, sorted and bound to YANG
+ * @param[out] cb  Config and YANG digests separated by space
+ */
+static void
+startup_digest_str(clixon_handle h,
+                   cxobj        *xt,
+                   cbuf         *cb)
+{
+    clixon_sha256_ctx ctx;
+    uint8_t           dbdigest[SHA256_DIGEST_LEN];
+
+    clixon_sha256_init(&ctx);
+    digest_xml(&ctx, xt);
+    clixon_sha256_final(&ctx, dbdigest);
+    clixon_sha256_hex(dbdigest, cb);
+    cprintf(cb, " ");
+    clixon_sha256_hex(digest_yang_cached(clicon_dbspec_yang(h)), cb);
+}
+
+/*! Get name of startup digest file
+ *
+ * @param[in]  h         Clixon handle
+ * @param[in]  suffix    Suffix appended to file name, or NULL
+ * @param[out] filename  Malloced file name, free after use
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+startup_digest_filename(clixon_handle h,
+                        const char   *suffix,
+                        char        **filename)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+    char *dir;
+
+    if ((dir = clicon_xmldb_dir(h)) == NULL){
+        clixon_err(OE_XML, errno, "dbdir not set");
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s/%s%s", dir, STARTUP_DIGEST_FILE, suffix ? suffix : "");
+    if ((*filename = strdup(cbuf_get(cb))) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    retval = 0;
  done:
     if (cb)
         cbuf_free(cb);
     return retval;
- fail:
+}
+
+/*! Save digest of a validated config tree written to a datastore and the current YANG
+ *
+ * Called after successful commit. If the datastore file is later used as startup, and
+ * neither config nor YANG has changed, startup validation can be skipped.
+ * The digest is computed from the tree in memory, the datastore file is not re-read.
+ * The digest file is written to a temporary file and renamed, so that a crash never
+ * leaves a partially written digest.
+ * @param[in]  h       Clixon handle
+ * @param[in]  db      Datastore the tree is written to
+ * @param[in]  xt      Validated config tree, sorted and bound to YANG
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see startup_digest_trusted
+ */
+static int
+startup_digest_save(clixon_handle h,
+                    const char   *db,
+                    cxobj        *xt)
+{
+    int       retval = -1;
+    char     *filename = NULL;
+    char     *tmpname = NULL;
+    cbuf     *cb = NULL;
+    FILE     *f = NULL;
+
+    if (!clicon_option_bool(h, "CLICON_STARTUP_DIGEST"))
+        goto ok;
+    if (startup_digest_filename(h, NULL, &filename) < 0)
+        goto done;
+    /* Only trust file if it is in sync with tree */
+    if (xt == NULL || xmldb_volatile_get(h, db) == 1){
+        unlink(filename);
+        goto ok;
+    }
+    if (startup_digest_filename(h, ".tmp", &tmpname) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    startup_digest_str(h, xt, cb);
+    if ((f = fopen(tmpname, "w")) == NULL){
+        clixon_err(OE_UNIX, errno, "fopen %s", tmpname);
+        goto done;
+    }
+    fprintf(f, "%s\n", cbuf_get(cb));
+    if (fclose(f) != 0){
+        f = NULL;
+        clixon_err(OE_UNIX, errno, "fclose %s", tmpname);
+        unlink(tmpname);
+        goto done;
+    }
+    f = NULL;
+    if (rename(tmpname, filename) < 0){
+        clixon_err(OE_UNIX, errno, "rename %s", tmpname);
+        unlink(tmpname);
+        goto done;
+    }
+ ok:
     retval = 0;
-    goto done;
+ done:
+    if (f)
+        fclose(f);
+    if (cb)
+        cbuf_free(cb);
+    if (tmpname)
+        free(tmpname);
+    if (filename)
+        free(filename);
+    return retval;
+}
+
+/*! Check if a startup config is unchanged since it was last validated
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  xt      Startup config tree, sorted and bound to YANG
+ * @retval     1       Trusted, config and YANG digests match saved digest
+ * @retval     0       Not trusted, validate
+ * @see startup_digest_save
+ */
+static int
+startup_digest_trusted(clixon_handle h,
+                       cxobj        *xt)
+{
+    int       retval = 0;
+    char     *filename = NULL;
+    cbuf     *cb = NULL;
+    char      saved[2*(2*SHA256_DIGEST_LEN+1)];
+    FILE     *f = NULL;
+
+    if (!clicon_option_bool(h, "CLICON_STARTUP_DIGEST"))
+        goto done;
+    if (startup_digest_filename(h, NULL, &filename) < 0)
+        goto done;
+    if ((f = fopen(filename, "r")) == NULL)
+        goto done;
+    if (fgets(saved, sizeof(saved), f) == NULL)
+        goto done;
+    saved[strcspn(saved, "\n")] = '\0';
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    startup_digest_str(h, xt, cb);
+    if (strcmp(cbuf_get(cb), saved) != 0)
+        goto done;
+    clixon_debug(CLIXON_DBG_BACKEND, "startup digest matches, skip validation");
+    retval = 1;
+ done:
+    if (f)
+        fclose(f);
+    if (cb)
+        cbuf_free(cb);
+    if (filename)
+        free(filename);
+    return retval;
 }
 
 /*! Common startup validation
@@ -141,6 +477,7 @@ generic_validate(clixon_handle       h,
  * and call application callback validations.
  * @param[in]  h       Clixon handle
  * @param[in]  db      The startup database. The wanted backend state
+ * @param[in]  digest  Skip generic validation if startup is unchanged since last validated
  * @param[in]  td      Transaction data
  * @param[out] cbret   CLIgen buffer w error stmt if retval = 0
  * @retval     1       Validation OK       
@@ -160,6 +497,7 @@ generic_validate(clixon_handle       h,
 static int
 startup_common(clixon_handle       h,
                char               *db,
+               int                 digest,
                transaction_data_t *td,
                cbuf               *cbret)
 {
@@ -171,6 +509,7 @@ startup_common(clixon_handle       h,
     cxobj              *x;
     cxobj              *xret = NULL;
     cxobj              *xerr = NULL;
+    int                 trusted;
 
     /* If CLICON_XMLDB_MODSTATE is enabled, then get the db XML with 
      * potentially non-matching module-state in msdiff
@@ -289,6 +628,7 @@ startup_common(clixon_handle       h,
     /* Apply default values (removed in clear function) */
     if (xml_default_recurse(xt, 0, 0) < 0)
         goto done;
+    trusted = digest && startup_digest_trusted(h, xt);
 
     /* Handcraft transition with with only add tree */
     td->td_target = xt;
@@ -307,13 +647,15 @@ startup_common(clixon_handle       h,
 
     /* 5. Make generic validation on all new or changed data.
        Note this is only call that uses 3-values */
-    clixon_debug(CLIXON_DBG_BACKEND, "Validating startup %s", db);
-    if ((ret = generic_validate(h, yspec, td, &xret)) < 0)
-        goto done;
-    if (ret == 0){
-        if (clixon_xml2cbuf(cbret, xret, 0, 0, NULL, -1, 0) < 0)
+    if (!trusted){
+        clixon_debug(CLIXON_DBG_BACKEND, "Validating startup %s", db);
+        if ((ret = generic_validate(h, yspec, td, &xret)) < 0)
             goto done;
-        goto fail; /* STARTUP_INVALID */
+        if (ret == 0){
+            if (clixon_xml2cbuf(cbret, xret, 0, 0, NULL, -1, 0) < 0)
+                goto done;
+            goto fail; /* STARTUP_INVALID */
+        }
     }
     /* 6. Call plugin transaction validate callbacks */
     if (plugin_transaction_validate_all(h, td) < 0)
@@ -362,7 +704,7 @@ startup_validate(clixon_handle  h,
     /* Handcraft a transition with only target and add trees */
     if ((td = transaction_new()) == NULL)
         goto done;
-    if ((ret = startup_common(h, db, td, cbret)) < 0){
+    if ((ret = startup_common(h, db, 0, td, cbret)) < 0){
         plugin_transaction_abort_all(h, td);
         goto done;
     }
@@ -412,7 +754,7 @@ startup_commit(clixon_handle  h,
     /* Handcraft a transition with only target and add trees */
     if ((td = transaction_new()) == NULL)
         goto done;
-    if ((ret = startup_common(h, db, td, cbret)) < 0)
+    if ((ret = startup_common(h, db, 1, td, cbret)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -447,6 +789,10 @@ startup_commit(clixon_handle  h,
         goto done;
     if (ret == 0)
         goto fail;
+    if (startup_digest_save(h, "running", td->td_target) < 0)
+        goto done;
+    if (xmldb_replica_sync(h) < 0)
+        goto done;
     /* 10. Call plugin transaction end callbacks */
     plugin_transaction_end_all(h, td);
     retval = 1;
@@ -671,6 +1017,7 @@ candidate_commit(clixon_handle h,
     int                 ret;
     cxobj              *xret = NULL;
     yang_stmt          *yspec;
+    int                 hold = 0;
 
     /* 1. Start transaction */
     if ((td = transaction_new()) == NULL)
@@ -708,6 +1055,9 @@ candidate_commit(clixon_handle h,
             goto done;
         goto fail;
     }
+    /* Commit phase is not cancelled, see clixon_cancel_check */
+    clixon_cancel_hold(1);
+    hold++;
     /* 7. Call plugin transaction commit callbacks */
     if (plugin_transaction_commit_all(h, td) < 0)
         goto done;
@@ -719,6 +1069,11 @@ candidate_commit(clixon_handle h,
     if (xmldb_copy(h, db, "running") < 0)
         goto done;
     xmldb_modified_set(h, db, 0); /* reset dirty bit */
+    /* Publish replica once per commit */
+    if (xmldb_replica_sync(h) < 0)
+        goto done;
+    if (startup_digest_save(h, "running", xmldb_cache_get(h, "running")) < 0)
+        goto done;
     /* Here pointers to old (source) tree are obsolete */
     if (td->td_dvec){
         td->td_dlen = 0;
@@ -740,6 +1095,8 @@ candidate_commit(clixon_handle h,
             plugin_transaction_abort_all(h, td);
         transaction_free(td);
     }
+    if (hold)
+        clixon_cancel_hold(0);
     if (xret)
         xml_free(xret);
     return retval;
@@ -789,6 +1146,7 @@ from_client_commit(clixon_handle h,
     cbuf                *cbx = NULL; /* Assist cbuf */
     int                  ret;
     yang_stmt           *yspec;
+    int                  private;
 
     if ((yspec = clicon_dbspec_yang(h)) == NULL) {
         clixon_err(OE_YANG, ENOENT, "No yang spec");
@@ -800,8 +1158,9 @@ from_client_commit(clixon_handle h,
         if (ret == 0)
             goto ok;
     }
+    private = clicon_option_bool(h, "CLICON_XMLDB_PRIVATE_CANDIDATE");
     /* Check if target locked by other client */
-    iddb = xmldb_islocked(h, "candidate");
+    iddb = private ? 0 : xmldb_islocked(h, "candidate");
     if (iddb && myid != iddb){
         if ((cbx = cbuf_new()) == NULL){
             clixon_err(OE_XML, errno, "cbuf_new");
@@ -821,7 +1180,11 @@ from_client_commit(clixon_handle h,
             goto done;
         goto ok;
     }
-    if ((ret = candidate_commit(h, xe, "candidate", myid, 0, cbret)) < 0){ /* Assume validation fail, nofatal */
+    if (private)
+        ret = private_candidate_commit(h, xe, ce, cbret);
+    else
+        ret = candidate_commit(h, xe, "candidate", myid, 0, cbret);
+    if (ret < 0){ /* Assume validation fail, nofatal */
         clixon_debug(CLIXON_DBG_BACKEND, "Commit candidate failed");
         if (ret < 0)
             if (netconf_operation_failed(cbret, "application", clixon_err_reason())< 0)
@@ -866,6 +1229,12 @@ from_client_discard_changes(clixon_handle h,
     uint32_t             iddb;
     cbuf                *cbx = NULL; /* Assist cbuf */
 
+    if (clicon_option_bool(h, "CLICON_XMLDB_PRIVATE_CANDIDATE")){
+        if (private_candidate_discard(h, ce) < 0)
+            goto done;
+        cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
+        goto ok;
+    }
     /* Check if target locked by other client */
     iddb = xmldb_islocked(h, "candidate");
     if (iddb && myid != iddb){
@@ -914,9 +1283,10 @@ from_client_validate(clixon_handle h,
                      void         *arg,
                      void         *regarg)
 {
-    int   retval = -1;
-    int   ret;
-    char *db;
+    int                  retval = -1;
+    struct client_entry *ce = (struct client_entry *)arg;
+    int                  ret;
+    char                *db;
 
     clixon_debug(CLIXON_DBG_BACKEND, "");
     if ((db = netconf_db_find(xe, "source")) == NULL){
@@ -924,6 +1294,8 @@ from_client_validate(clixon_handle h,
             goto done;
         goto ok;
     }
+    if ((db = private_candidate_db(h, ce, db, 0)) == NULL)
+        goto done;
     if ((ret = candidate_validate(h, db, cbret)) < 0)
         goto done;
     if (ret == 1)
@@ -1045,6 +1045,8 @@ from_client_get_config(clixon_handle h,
         clixon_err(OE_XML, 0, "db not found");
         goto done;
     }
+    if ((db = private_candidate_db(h, ce, db, 0)) == NULL)
+        goto done;
     retval = get_common(h, ce, xe, CONTENT_CONFIG, db, cbret);
  done:
     return retval;
@@ -1078,3 +1080,481 @@ from_client_get(clixon_handle h,
         content = netconf_content_str2int(attr);
     return get_common(h, ce, xe, content, "running", cbret);
 }
+
+/* NMDA origin annotations, RFC 8342 Sec 5.3.4
+ * Only intended and default are set by clixon, other origins are never matched
+ */
+#define NMDA_ORIGIN_INTENDED 0x01
+#define NMDA_ORIGIN_DEFAULT  0x02
+#define NMDA_ORIGIN_ALL      (NMDA_ORIGIN_INTENDED|NMDA_ORIGIN_DEFAULT)
+
+static const map_str2int nmda_origin_map[] = {
+    {"origin",    NMDA_ORIGIN_ALL}, /* Base identity: all origins are derived from it */
+    {"intended",  NMDA_ORIGIN_INTENDED},
+    {"default",   NMDA_ORIGIN_DEFAULT},
+    {"dynamic",   0},
+    {"system",    0},
+    {"learned",   0},
+    {"unknown",   0},
+    {NULL,        -1}
+};
+
+/*! Get identity of an identityref body and check its namespace
+ *
+ * @param[in]  x    XML node with identityref body, eg <datastore>ds:running</datastore>
+ * @param[in]  ns   Expected namespace of identity
+ * @param[out] id   Identity without prefix, malloced, free after use
+ * @retval     1    OK, id set
+ * @retval     0    Namespace of prefix does not match ns
+ * @retval    -1    Error
+ */
+int
+nmda_identity(cxobj *x,
+              char  *ns,
+              char **id)
+{
+    int   retval = -1;
+    char *prefix = NULL;
+    char *ns1 = NULL;
+
+    if (nodeid_split(xml_body(x), &prefix, id) < 0)
+        goto done;
+    if (xml2ns(x, prefix, &ns1) < 0)
+        goto done;
+    if (ns1 == NULL || strcmp(ns1, ns) != 0){
+        if (*id){
+            free(*id);
+            *id = NULL;
+        }
+        retval = 0;
+        goto done;
+    }
+    retval = 1;
+ done:
+    if (prefix)
+        free(prefix);
+    return retval;
+}
+
+/*! Translate a subtree filter to an xpath union
+ *
+ * Selection and containment nodes are translated to location paths, and content match
+ * nodes to predicates of their parent. A node with content match nodes only is returned
+ * with all its siblings, a simplification of RFC 6241 Sec 6.2.5
+ * Content match values are quoted with ' or " depending on value. XPath 1.0 has no escape
+ * mechanism, so a value with both is rejected.
+ * @param[in]     xn    Subtree filter node
+ * @param[in]     path  Path of xn
+ * @param[in,out] nsc   Namespace context, prefixes are added for namespaces in filter
+ * @param[out]    cb    Xpath union
+ * @param[out]    cbret Error message if invalid
+ * @retval        1     OK
+ * @retval        0     Invalid filter, error in cbret
+ * @retval       -1     Error
+ */
+static int
+nmda_subtree2xpath(cxobj *xn,
+                   char  *path,
+                   cvec  *nsc,
+                   cbuf  *cb,
+                   cbuf  *cbret)
+{
+    int    retval = -1;
+    cxobj *x = NULL;
+    cxobj *xc;
+    cbuf  *cbp = NULL;
+    char  *ns;
+    char  *prefix;
+    char  *body;
+    char   quote;
+    char   pbuf[16];
+    int    containment;
+    int    ret;
+
+    while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL){
+        if (xml_child_nr_type(x, CX_ELMNT) == 0 && xml_body(x) != NULL)
+            continue; /* content match node, predicate of parent */
+        if ((cbp = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        ns = NULL;
+        if (xml2ns(x, xml_prefix(x), &ns) < 0)
+            goto done;
+        prefix = NULL;
+        if (ns != NULL && xml_nsctx_get_prefix(nsc, ns, &prefix) == 0){
+            snprintf(pbuf, sizeof(pbuf), "n%d", cvec_len(nsc));
+            if (xml_nsctx_add(nsc, pbuf, ns) < 0)
+                goto done;
+            prefix = pbuf;
+        }
+        cprintf(cbp, "%s/%s%s%s", path, prefix?prefix:"", prefix?":":"", xml_name(x));
+        containment = 0;
+        xc = NULL;
+        while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL){
+            if (xml_child_nr_type(xc, CX_ELMNT) == 0 && (body = xml_body(xc)) != NULL){
+                quote = strchr(body, '\'') ? '"' : '\'';
+                if (quote == '"' && strchr(body, '"') != NULL){
+                    if (netconf_invalid_value(cbret, "application",
+                                              "Content match value with both ' and \" not supported") < 0)
+                        goto done;
+                    goto fail;
+                }
+                cprintf(cbp, "[%s%s%s=%c%s%c]", prefix?prefix:"", prefix?":":"",
+                        xml_name(xc), quote, body, quote);
+            }
+            else
+                containment++;
+        }
+        if (containment){
+            if ((ret = nmda_subtree2xpath(x, cbuf_get(cbp), nsc, cb, cbret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+        }
+        else
+            cprintf(cb, "%s%s", cbuf_len(cb)?" | ":"", cbuf_get(cbp));
+        cbuf_free(cbp);
+        cbp = NULL;
+    }
+    retval = 1;
+ done:
+    if (cbp)
+        cbuf_free(cbp);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Apply config-filter and origin-filter on the operational datastore and annotate origin
+ *
+ * A node is kept if it matches the filters or if it has a kept descendant. List keys are 
+ * kept with their list. State nodes are not affected by origin filters and have no origin.
+ * This is a post-filter: the origin of a node (default or intended) is only known once
+ * config is read, so matching nodes are pruned after the whole tree is built.
+ * @param[in]  xn         XML node, children are filtered
+ * @param[in]  porigin    Origin of xn, 0 if state or top
+ * @param[in]  pcfg       Config property of xn
+ * @param[in]  mask       Origins selected by origin-filter
+ * @param[in]  cfilter    Value of config-filter, or -1 if not present
+ * @param[in]  withorigin Add origin annotations
+ * @param[out] kept       Number of kept non-key children
+ * @retval     0          OK
+ * @retval    -1          Error
+ */
+static int
+nmda_origin_filter(cxobj *xn,
+                   int    porigin,
+                   int    pcfg,
+                   int    mask,
+                   int    cfilter,
+                   int    withorigin,
+                   int   *kept)
+{
+    int        retval = -1;
+    cxobj     *x;
+    yang_stmt *yp;
+    yang_stmt *ys;
+    int        i;
+    int        cfg;
+    int        origin;
+    int        match;
+    int        subkept;
+    char      *id;
+    char       idbuf[32];
+
+    *kept = 0;
+    yp = xml_spec(xn);
+    for (i=xml_child_nr(xn)-1; i>=0; i--){
+        x = xml_child_i(xn, i);
+        if (xml_type(x) != CX_ELMNT)
+            continue;
+        ys = xml_spec(x);
+        if (yp && yang_keyword_get(yp) == Y_LIST &&
+            yang_key_match(yp, xml_name(x), NULL) == 1)
+            continue; /* Keys follow their list */
+        cfg = ys ? yang_config_ancestor(ys) : pcfg;
+        if (cfg){
+            origin = xml_flag(x, XML_FLAG_DEFAULT) ? NMDA_ORIGIN_DEFAULT : NMDA_ORIGIN_INTENDED;
+            match = (origin & mask) && cfilter != 0;
+        }
+        else {
+            origin = 0;
+            match = cfilter != 1;
+        }
+        if (nmda_origin_filter(x, origin, cfg, mask, cfilter, withorigin, &subkept) < 0)
+            goto done;
+        if (!match && subkept == 0){
+            if (xml_purge(x) < 0)
+                goto done;
+            continue;
+        }
+        (*kept)++;
+        if (withorigin && origin && origin != porigin){
+            id = (char*)clicon_int2str(nmda_origin_map, origin);
+            snprintf(idbuf, sizeof(idbuf), "%s:%s", NMDA_ORIGIN_PREFIX, id);
+            if (xml_add_attr(x, "origin", idbuf, NMDA_ORIGIN_PREFIX, NULL) == NULL)
+                goto done;
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Retrieve data from an NMDA datastore, RFC 8526 get-data
+ *
+ * The conventional datastores are read as get-config, and intended is the same as running.
+ * The operational datastore is running merged with state data as get.
+ * Filters are pushed down while the tree is built where possible: state callbacks are not
+ * called if config-filter is true, and config is not read if config-filter is false or if
+ * origin filters exclude all configuration. Other origin filtering is made on the built
+ * tree, see nmda_origin_filter.
+ * @param[in]  h       Clixon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see from_client_get
+ */
+int
+from_client_get_data(clixon_handle h,
+                     cxobj        *xe,
+                     cbuf         *cbret,
+                     void         *arg,
+                     void         *regarg)
+{
+    int                  retval = -1;
+    struct client_entry *ce = (struct client_entry *)arg;
+    yang_stmt           *yspec;
+    cxobj               *x;
+    char                *id = NULL;
+    char                *db = NULL;
+    int                  operational = 0;
+    char                *xpath0 = NULL;
+    char                *xpath = NULL;
+    cvec                *nsc0 = NULL;
+    cvec                *nsc = NULL;
+    cbuf                *cbxpath = NULL;
+    cbuf                *cbreason = NULL;
+    cbuf                *cbmsg = NULL;
+    char                *str;
+    int                  cfilter = -1; /* config-filter: -1 not present, 0 false, 1 true */
+    int                  mask = NMDA_ORIGIN_ALL;
+    int                  selected = 0;
+    int                  negated = 0;
+    int                  filtered = 0;
+    int                  origin;
+    int                  withorigin = 0;
+    int32_t              depth = -1;
+    uint16_t             maxdepth;
+    withdefaults_type    wdef = WITHDEFAULTS_EXPLICIT;
+    char                *reason = NULL;
+    cxobj               *xret = NULL;
+    cxobj              **xvec = NULL;
+    size_t               xlen;
+    int                  kept;
+    int                  ret;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clixon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    /* Datastore identity */
+    if ((x = xml_find_type(xe, NULL, "datastore", CX_ELMNT)) == NULL){
+        if (netconf_missing_element(cbret, "protocol", "datastore", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((ret = nmda_identity(x, NMDA_DATASTORES_NAMESPACE, &id)) < 0)
+        goto done;
+    if (ret == 1){
+        if (strcmp(id, "running") == 0 || strcmp(id, "intended") == 0)
+            db = "running";
+        else if (strcmp(id, "candidate") == 0)
+            db = "candidate";
+        else if (strcmp(id, "startup") == 0 &&
+                 if_feature(yspec, "ietf-netconf", "startup"))
+            db = "startup";
+        else if (strcmp(id, "operational") == 0){
+            db = "running";
+            operational++;
+        }
+    }
+    if (db == NULL){
+        if (netconf_invalid_value(cbret, "protocol", "Datastore not supported") < 0)
+            goto done;
+        goto ok;
+    }
+    if ((db = private_candidate_db(h, ce, db, 0)) == NULL)
+        goto done;
+    /* Filter spec */
+    if ((x = xml_find_type(xe, NULL, "xpath-filter", CX_ELMNT)) != NULL){
+        if ((xpath0 = xml_body(x)) == NULL)
+            xpath0 = "/";
+        else if (xml_nsctx_node(x, &nsc0) < 0)
+            goto done;
+    }
+    else if ((x = xml_find_type(xe, NULL, "subtree-filter", CX_ELMNT)) != NULL){
+        if ((cbxpath = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        if ((nsc0 = xml_nsctx_init(NULL, NULL)) == NULL)
+            goto done;
+        if ((ret = nmda_subtree2xpath(x, "", nsc0, cbxpath, cbret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+        if (cbuf_len(cbxpath) == 0){ /* Empty filter selects nothing */
+            cprintf(cbret, "<rpc-reply xmlns=\"%s\"><data xmlns=\"%s\"/></rpc-reply>",
+                    NETCONF_BASE_NAMESPACE, NETCONF_NMDA_NAMESPACE);
+            goto ok;
+        }
+        xpath0 = cbuf_get(cbxpath);
+    }
+    if (xpath0 != NULL){
+        if ((ret = xpath2canonical(xpath0, nsc0, yspec, &xpath, &nsc, &cbreason)) < 0)
+            goto done;
+        if (ret == 0){
+            if (netconf_invalid_value(cbret, "application", cbuf_get(cbreason)) < 0)
+                goto done;
+            goto ok;
+        }
+    }
+    if ((str = xml_find_body(xe, "config-filter")) != NULL)
+        cfilter = strcmp(str, "true") == 0;
+    /* Origin filters, only operational */
+    x = NULL;
+    while ((x = xml_child_each(xe, x, CX_ELMNT)) != NULL){
+        if (strcmp(xml_name(x), "origin-filter") != 0 &&
+            strcmp(xml_name(x), "negated-origin-filter") != 0)
+            continue;
+        if (!operational){
+            if (netconf_invalid_value(cbret, "protocol", "Origin filter only valid for operational datastore") < 0)
+                goto done;
+            goto ok;
+        }
+        if (id){
+            free(id);
+            id = NULL;
+        }
+        if ((ret = nmda_identity(x, NMDA_ORIGIN_NAMESPACE, &id)) < 0)
+            goto done;
+        if (ret == 0 || (origin = clicon_str2int(nmda_origin_map, id)) < 0){
+            if (netconf_invalid_value(cbret, "protocol", "Unknown origin") < 0)
+                goto done;
+            goto ok;
+        }
+        if (strcmp(xml_name(x), "negated-origin-filter") == 0)
+            negated |= origin;
+        else {
+            selected |= origin;
+            filtered++;
+        }
+    }
+    if (filtered)
+        mask = selected;
+    mask &= ~negated;
+    if (xml_find_type(xe, NULL, "with-origin", CX_ELMNT) != NULL){
+        if (!operational){
+            if (netconf_invalid_value(cbret, "protocol", "with-origin only valid for operational datastore") < 0)
+                goto done;
+            goto ok;
+        }
+        withorigin++;
+    }
+    if ((str = xml_find_body(xe, "max-depth")) != NULL &&
+        strcmp(str, "unbounded") != 0){
+        if ((ret = parse_uint16(str, &maxdepth, &reason)) < 0){
+            clixon_err(OE_XML, errno, "parse_uint16");
+            goto done;
+        }
+        if (ret == 0 || maxdepth == 0){
+            if (netconf_invalid_value(cbret, "protocol", "Invalid max-depth") < 0)
+                goto done;
+            goto ok;
+        }
+        depth = maxdepth;
+    }
+    if ((str = xml_find_body(xe, "with-defaults")) != NULL)
+        wdef = withdefaults_str2int(str);
+    /* Read config, unless excluded by filters */
+    if (cfilter != 0 && (mask & NMDA_ORIGIN_ALL)){
+        if (xmldb_get0(h, db, YB_MODULE, nsc, xpath?xpath:"/", 1, WITHDEFAULTS_REPORT_ALL, &xret, NULL, NULL) < 0) {
+            if ((cbmsg = cbuf_new()) == NULL){
+                clixon_err(OE_UNIX, errno, "cbuf_new");
+                goto done;
+            }
+            cprintf(cbmsg, "Get %s datastore: %s", db, clixon_err_reason());
+            if (netconf_operation_failed(cbret, "application", cbuf_get(cbmsg)) < 0)
+                goto done;
+            goto ok;
+        }
+    }
+    else if ((xret = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    /* Read state, only operational and unless excluded by config-filter */
+    if (operational && cfilter != 1){
+        if ((ret = get_statedata(h, xpath?xpath:"/", nsc, &xret)) < 0)
+            goto done;
+        if (ret == 0){ /* Error from callback (error in xret) */
+            if (clixon_xml2cbuf(cbret, xret, 0, 0, NULL, -1, 0) < 0)
+                goto done;
+            goto ok;
+        }
+        if (xml_global_defaults(h, xret, nsc, xpath, yspec, 1) < 0)
+            goto done;
+        if (xml_default_recurse(xret, 1, 0) < 0)
+            goto done;
+    }
+    if (xpath_vec(xret, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
+        goto done;
+    if (filter_xpath_again(h, yspec, xret, xvec, xlen, xpath, nsc) < 0)
+        goto done;
+    if (xvec){
+        free(xvec);
+        xvec = NULL;
+    }
+    if (operational){
+        if (nmda_origin_filter(xret, 0, 1, mask, cfilter, withorigin, &kept) < 0)
+            goto done;
+        if (withorigin &&
+            xml_add_attr(xret, NMDA_ORIGIN_PREFIX, NMDA_ORIGIN_NAMESPACE, "xmlns", NULL) == NULL)
+            goto done;
+    }
+    if (xml_add_attr(xret, "xmlns", NETCONF_NMDA_NAMESPACE, NULL, NULL) == NULL)
+        goto done;
+    /* Nodes may have been removed by origin filter, find them again for NACM */
+    if (xpath_vec(xret, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
+        goto done;
+    if (get_nacm_and_reply(h, xret, xvec, xlen, xpath, nsc, clicon_username_get(h), depth, wdef, cbret) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (id)
+        free(id);
+    if (xvec)
+        free(xvec);
+    if (xret)
+        xml_free(xret);
+    if (xpath)
+        free(xpath);
+    if (nsc0)
+        xml_nsctx_free(nsc0);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (cbxpath)
+        cbuf_free(cbxpath);
+    if (cbreason)
+        cbuf_free(cbreason);
+    if (cbmsg)
+        cbuf_free(cbmsg);
+    if (reason)
+        free(reason);
+    return retval;
+}
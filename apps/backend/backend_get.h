@@ -40,8 +40,10 @@
 /*
  * Prototypes
  */
+int nmda_identity(cxobj *x, char *ns, char **id);
 int from_client_get_config(clixon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg);
 int from_client_get(clixon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg);
+int from_client_get_data(clixon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg);
 int from_client_get_pageable_list(clixon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg); /* XXX */
 
 #endif  /* _BACKEND_GET_H_ */
@@ -77,6 +77,9 @@
 #include "backend_handle.h"
 #include "backend_startup.h"
 #include "backend_plugin_restconf.h"
+#include "backend_yang.h"
+#include "backend_template.h"
+#include "backend_sched.h"
 
 /* Command line options to be passed to getopt(3) */
 #define BACKEND_OPTS "hVD:f:E:l:C:d:p:b:Fza:u:P:1qs:c:U:g:y:o:"
@@ -103,6 +106,10 @@ backend_terminate(clixon_handle h)
     clixon_debug(CLIXON_DBG_BACKEND, "");
     if ((ss = clicon_socket_get(h)) != -1)
         close(ss);
+    /* Copy coalesced edits to startup before exit */
+    if (startup_flush(h) < 0)
+        clixon_log(h, LOG_WARNING, "%s: copy running to startup failed: %s",
+                   __FUNCTION__, clixon_err_reason());
     /* Disconnect datastore */
     xmldb_disconnect(h);
     /* Clear module state caches */
@@ -116,6 +123,9 @@ backend_terminate(clixon_handle h)
     if ((yspec = clicon_dbspec_yang(h)) != NULL){
         ys_free(yspec);
     }
+    backend_yang_exit(h);
+    backend_template_exit(h);
+    backend_sched_exit(h);
     if ((yspec = clicon_config_yang(h)) != NULL)
         ys_free(yspec);
     if ((yspec = clicon_nacm_ext_yang(h)) != NULL)
@@ -135,6 +145,7 @@ backend_terminate(clixon_handle h)
     clixon_process_delete_all(h); 
 
     xpath_optimize_exit();
+    xpath_profile_exit();
     clixon_pagination_free(h);
     
     if (pidfile)
@@ -743,6 +754,9 @@ main(int    argc,
 
     if ((sz = clicon_option_int(h, "CLICON_LOG_STRING_LIMIT")) != 0)
         clixon_log_string_limit_set(sz);
+    xpath_profile_set(clicon_option_bool(h, "CLICON_XPATH_PROFILE"),
+                      clicon_option_int(h, "CLICON_XPATH_SLOW_THRESHOLD"));
+    clixon_event_watchdog_set(clicon_option_int(h, "CLICON_EVENT_WATCHDOG"));
     
 #ifndef HAVE_LIBXML2
     if (clicon_yang_regexp(h) ==  REGEXP_LIBXML2){
@@ -1028,6 +1042,9 @@ main(int    argc,
         goto done;
     if (xmldb_modified_set(h, "candidate", 0) <0)
         goto done;
+    /* Publish replica of running as written by startup */
+    if (xmldb_replica_sync(h) < 0)
+        goto done;
     
     /* Set startup status */
     if (clicon_startup_status_set(h, status) < 0)
@@ -1118,6 +1135,9 @@ main(int    argc,
     /* Just before event-loop, after socket bind/listen */
     if (netconf_monitoring_statistics_init(h) < 0)
         goto done;
+    /* Request scheduling classes, see CLICON_BACKEND_SCHED_CLASS */
+    if (backend_sched_init(h) < 0)
+        goto done;
     clixon_log(h, LOG_NOTICE, "%s: %u Started", __PROGRAM__, getpid());
     if (clixon_event_loop(h) < 0)
         goto done;
@@ -351,6 +351,8 @@ clixon_plugin_statedata_all(clixon_handle   h,
 
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "");
     while ((cp = clixon_plugin_each(h, cp)) != NULL) {
+        if (clixon_cancel_check(1) < 0)
+            goto done;
         if ((ret = clixon_plugin_statedata_one(cp, h, nsc, xpath, &x)) < 0)
             goto done;
         if (ret == 0){
@@ -0,0 +1,511 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+  Private candidate datastores
+  Each session edits its own copy of candidate, created from running on first edit.
+  On commit, the edits of the session are merged with what other sessions have committed
+  to running since the private candidate was created (a three-way merge using the
+  running of that time as base).
+  See CLICON_XMLDB_PRIVATE_CANDIDATE
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <syslog.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/param.h>
+#include <sys/types.h>
+#include <netinet/in.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include <clixon/clixon.h>
+
+#include "clixon_backend_transaction.h"
+#include "clixon_backend_client.h"
+#include "clixon_backend_commit.h"
+
+/*! Create private candidate of a session from running
+ *
+ * The running configuration at this point is saved as base for three-way merge on commit
+ * @param[in]  h    Clixon handle
+ * @param[in]  ce   Client entry
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+private_candidate_create(clixon_handle        h,
+                         struct client_entry *ce)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "candidate-%u", ce->ce_id);
+    if (xmldb_get0(h, "running", YB_MODULE, NULL, "/", 1, WITHDEFAULTS_EXPLICIT,
+                   &ce->ce_candidate_base, NULL, NULL) < 0)
+        goto done;
+    if (xmldb_copy(h, "running", cbuf_get(cb)) < 0)
+        goto done;
+    xmldb_modified_set(h, cbuf_get(cb), 0);
+    if ((ce->ce_candidate = strdup(cbuf_get(cb))) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    clixon_debug(CLIXON_DBG_BACKEND, "%s created", ce->ce_candidate);
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Translate a datastore name to the private candidate of a session
+ *
+ * If private candidates are not enabled, or db is not "candidate", db is returned as is.
+ * Otherwise the private candidate is returned. If it does not exist (the session has not made
+ * any edits) it is created if write is set, otherwise running is returned which is what the
+ * private candidate would contain.
+ * @param[in]  h      Clixon handle
+ * @param[in]  ce     Client entry
+ * @param[in]  db     Datastore name as given by client, eg "candidate"
+ * @param[in]  write  Set if datastore is to be modified
+ * @retval     db     Datastore name, do not free
+ * @retval     NULL   Error
+ */
+char *
+private_candidate_db(clixon_handle        h,
+                     struct client_entry *ce,
+                     char                *db,
+                     int                  write)
+{
+    if (db == NULL ||
+        strcmp(db, "candidate") != 0 ||
+        !clicon_option_bool(h, "CLICON_XMLDB_PRIVATE_CANDIDATE"))
+        return db;
+    if (ce->ce_candidate == NULL){
+        if (!write)
+            return "running";
+        if (private_candidate_create(h, ce) < 0)
+            return NULL;
+    }
+    return ce->ce_candidate;
+}
+
+/*! Remove private candidate of a session, if any
+ *
+ * Called on discard-changes, after commit and when session closes
+ * @param[in]  h    Clixon handle
+ * @param[in]  ce   Client entry
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+private_candidate_discard(clixon_handle        h,
+                          struct client_entry *ce)
+{
+    int   retval = -1;
+    char *filename = NULL;
+
+    if (ce->ce_candidate != NULL){
+        clixon_debug(CLIXON_DBG_BACKEND, "%s removed", ce->ce_candidate);
+        if (xmldb_clear(h, ce->ce_candidate) < 0)
+            goto done;
+        if (xmldb_db2file(h, ce->ce_candidate, &filename) < 0)
+            goto done;
+        if (unlink(filename) < 0 && errno != ENOENT){
+            clixon_err(OE_UNIX, errno, "unlink %s", filename);
+            goto done;
+        }
+        clicon_hash_del(clicon_db_elmnt(h), ce->ce_candidate);
+        free(ce->ce_candidate);
+        ce->ce_candidate = NULL;
+    }
+    if (ce->ce_candidate_base){
+        xml_free(ce->ce_candidate_base);
+        ce->ce_candidate_base = NULL;
+    }
+    retval = 0;
+ done:
+    if (filename)
+        free(filename);
+    return retval;
+}
+
+/*! Qsort string compare function
+ */
+static int
+private_path_cmp(const void *a,
+                 const void *b)
+{
+    return strcmp(*(char **)a, *(char **)b);
+}
+
+/*! Add xpath of nodes to a vector of paths
+ *
+ * @param[in]     xvec   Vector of XML nodes
+ * @param[in]     xlen   Length of xvec
+ * @param[in]     nsc    Namespace context of the paths
+ * @param[in,out] pvec   Vector of malloced paths
+ * @param[in,out] plen   Length of pvec
+ * @retval        0      OK
+ * @retval       -1      Error
+ */
+static int
+private_path_add(cxobj  **xvec,
+                 int      xlen,
+                 cvec    *nsc,
+                 char  ***pvec,
+                 size_t  *plen)
+{
+    int    retval = -1;
+    char **vec;
+    int    i;
+
+    if (xlen == 0)
+        return 0;
+    if ((vec = realloc(*pvec, (*plen + xlen)*sizeof(char*))) == NULL){
+        clixon_err(OE_UNIX, errno, "realloc");
+        goto done;
+    }
+    *pvec = vec;
+    for (i=0; i<xlen; i++){
+        if (xml2xpath(xvec[i], nsc, 0, 1, &vec[*plen]) < 0)
+            goto done;
+        (*plen)++;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Check if path is equal to, a descendant of, or an ancestor of any path in a sorted vector
+ *
+ * Ancestors are found by cutting path at each "/" (outside key literals) and looking up
+ * the prefix. Descendants are found as the entries that follow path itself in sorted order.
+ * @param[in]  pvec   Sorted vector of paths
+ * @param[in]  plen   Length of pvec
+ * @param[in]  path   Path to check
+ * @retval     1      Conflict
+ * @retval     0      No conflict
+ */
+static int
+private_path_conflict(char  **pvec,
+                      size_t  plen,
+                      char   *path)
+{
+    size_t lo = 0;
+    size_t hi = plen;
+    size_t mid;
+    size_t len;
+    char  *p;
+    char   q = 0;
+    char   c;
+
+    if (plen == 0)
+        return 0;
+    /* Lower bound of path: equal and descendants follow */
+    while (lo < hi){
+        mid = (lo + hi)/2;
+        if (strcmp(pvec[mid], path) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    len = strlen(path);
+    for (; lo < plen && strncmp(pvec[lo], path, len) == 0; lo++){
+        c = pvec[lo][len];
+        if (c == '\0' || c == '/')
+            return 1;
+    }
+    /* Ancestors */
+    for (p = path+1; *p != '\0'; p++){
+        if (q){
+            if (*p == q)
+                q = 0;
+            continue;
+        }
+        if (*p == '\'' || *p == '"')
+            q = *p;
+        else if (*p == '/'){
+            *p = '\0';
+            c = bsearch(&path, pvec, plen, sizeof(char*), private_path_cmp) != NULL;
+            *p = '/';
+            if (c)
+                return 1;
+        }
+    }
+    return 0;
+}
+
+/*! Mark nodes and their ancestors for xml_copy_marked
+ */
+static void
+private_mark(cxobj **xvec,
+             int     xlen)
+{
+    int i;
+
+    for (i=0; i<xlen; i++){
+        xml_flag_set(xvec[i], XML_FLAG_MARK);
+        xml_apply_ancestor(xvec[i], (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
+    }
+}
+
+/*! Rebase private candidate of a session on current running
+ *
+ * Three-way merge: local changes are base->private, remote changes are base->running.
+ * If a local change and a remote change touches the same node, or one is an ancestor of the
+ * other, there is a conflict and the rebase fails.
+ * Otherwise the local changes are applied to a copy of running which replaces the private
+ * candidate.
+ * @param[in]  h      Clixon handle
+ * @param[in]  ce     Client entry
+ * @param[out] cbret  Error message, if retval is 0
+ * @retval     1      OK, private candidate rebased (or no remote changes)
+ * @retval     0      Conflict, cbret set
+ * @retval    -1      Error
+ */
+static int
+private_candidate_rebase(clixon_handle        h,
+                         struct client_entry *ce,
+                         cbuf                *cbret)
+{
+    int        retval = -1;
+    yang_stmt *yspec;
+    cvec      *nsc = NULL;
+    cxobj     *xb;         /* base */
+    cxobj     *xl = NULL;  /* local: private candidate */
+    cxobj     *xr = NULL;  /* remote: running */
+    cxobj     *xa = NULL;  /* local adds and changes */
+    cxobj     *x;
+    cxobj    **ldvec = NULL;
+    int        ldlen;
+    cxobj    **lavec = NULL;
+    int        lalen;
+    cxobj    **lsvec = NULL;
+    cxobj    **ltvec = NULL;
+    int        lclen;
+    cxobj    **rdvec = NULL;
+    int        rdlen;
+    cxobj    **ravec = NULL;
+    int        ralen;
+    cxobj    **rsvec = NULL;
+    cxobj    **rtvec = NULL;
+    int        rclen;
+    char     **rpaths = NULL;
+    size_t     rplen = 0;
+    char     **lpaths = NULL;
+    size_t     lplen = 0;
+    char      *reason = NULL;
+    cbuf      *cb = NULL;
+    int        ret;
+    size_t     i;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clixon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    xb = ce->ce_candidate_base;
+    if (xmldb_get0(h, "running", YB_MODULE, NULL, "/", 1, WITHDEFAULTS_EXPLICIT, &xr, NULL, NULL) < 0)
+        goto done;
+    if (xml_diff(xb, xr, &rdvec, &rdlen, &ravec, &ralen, &rsvec, &rtvec, &rclen) < 0)
+        goto done;
+    if (rdlen + ralen + rclen == 0)
+        goto ok; /* Running unchanged since private candidate was created */
+    if (xmldb_get0(h, ce->ce_candidate, YB_MODULE, NULL, "/", 1, WITHDEFAULTS_EXPLICIT, &xl, NULL, NULL) < 0)
+        goto done;
+    if (xml_diff(xb, xl, &ldvec, &ldlen, &lavec, &lalen, &lsvec, &ltvec, &lclen) < 0)
+        goto done;
+    if (xml_nsctx_yangspec(yspec, &nsc) < 0)
+        goto done;
+    /* Remote paths: deleted and changed in base, added in running */
+    if (private_path_add(rdvec, rdlen, nsc, &rpaths, &rplen) < 0)
+        goto done;
+    if (private_path_add(ravec, ralen, nsc, &rpaths, &rplen) < 0)
+        goto done;
+    if (private_path_add(rsvec, rclen, nsc, &rpaths, &rplen) < 0)
+        goto done;
+    qsort(rpaths, rplen, sizeof(char*), private_path_cmp);
+    /* Local paths: deleted and changed in base, added in private candidate */
+    if (private_path_add(ldvec, ldlen, nsc, &lpaths, &lplen) < 0)
+        goto done;
+    if (private_path_add(lavec, lalen, nsc, &lpaths, &lplen) < 0)
+        goto done;
+    if (private_path_add(lsvec, lclen, nsc, &lpaths, &lplen) < 0)
+        goto done;
+    for (i=0; i<lplen; i++){
+        if (private_path_conflict(rpaths, rplen, lpaths[i])){
+            if ((cb = cbuf_new()) == NULL){
+                clixon_err(OE_UNIX, errno, "cbuf_new");
+                goto done;
+            }
+            cprintf(cb, "Commit conflict: %s has been changed in running by another session", lpaths[i]);
+            if (netconf_in_use(cbret, "application", cbuf_get(cb)) < 0)
+                goto done;
+            goto fail;
+        }
+    }
+    /* No conflicts: apply local deletes to running */
+    for (i=0; i<ldlen; i++){
+        if ((x = xpath_first(xr, nsc, "%s", lpaths[i])) != NULL)
+            xml_purge(x);
+    }
+    /* Apply local adds and changes to running */
+    private_mark(lavec, lalen);
+    private_mark(ltvec, lclen);
+    if ((xa = xml_new(xml_name(xl), NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (xml_copy_marked(xl, xa) < 0)
+        goto done;
+    if ((ret = xml_merge(xr, xa, yspec, &reason)) < 0)
+        goto done;
+    if (ret == 0){
+        if (netconf_operation_failed(cbret, "application", reason) < 0)
+            goto done;
+        goto fail;
+    }
+    /* Replace private candidate with merged tree and move base forward */
+    if ((ret = xmldb_put(h, ce->ce_candidate, OP_REPLACE, xr, clicon_username_get(h), cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (ce->ce_candidate_base)
+        xml_free(ce->ce_candidate_base);
+    ce->ce_candidate_base = NULL;
+    if (xmldb_get0(h, "running", YB_MODULE, NULL, "/", 1, WITHDEFAULTS_EXPLICIT,
+                   &ce->ce_candidate_base, NULL, NULL) < 0)
+        goto done;
+ ok:
+    retval = 1;
+ done:
+    if (rpaths){
+        for (i=0; i<rplen; i++)
+            free(rpaths[i]);
+        free(rpaths);
+    }
+    if (lpaths){
+        for (i=0; i<lplen; i++)
+            free(lpaths[i]);
+        free(lpaths);
+    }
+    if (ldvec)
+        free(ldvec);
+    if (lavec)
+        free(lavec);
+    if (lsvec)
+        free(lsvec);
+    if (ltvec)
+        free(ltvec);
+    if (rdvec)
+        free(rdvec);
+    if (ravec)
+        free(ravec);
+    if (rsvec)
+        free(rsvec);
+    if (rtvec)
+        free(rtvec);
+    if (reason)
+        free(reason);
+    if (cb)
+        cbuf_free(cb);
+    if (nsc)
+        cvec_free(nsc);
+    if (xa)
+        xml_free(xa);
+    if (xl)
+        xml_free(xl);
+    if (xr)
+        xml_free(xr);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Commit private candidate of a session
+ *
+ * First rebase the private candidate on running, then make a regular commit of it, and
+ * finally remove it.
+ * @param[in]  h      Clixon handle
+ * @param[in]  xe     Request: <rpc><xn></rpc>  (or NULL)
+ * @param[in]  ce     Client entry
+ * @param[out] cbret  Return xml tree, eg <rpc-reply>..., <rpc-error.. (if retval = 0)
+ * @retval     1      OK
+ * @retval     0      Conflict or validation failed (with cbret set)
+ * @retval    -1      Error
+ * @see candidate_commit
+ */
+int
+private_candidate_commit(clixon_handle        h,
+                         cxobj               *xe,
+                         struct client_entry *ce,
+                         cbuf                *cbret)
+{
+    int retval = -1;
+    int ret;
+
+    if (ce->ce_candidate == NULL) /* No edits made */
+        goto ok;
+    if ((ret = private_candidate_rebase(h, ce, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if ((ret = candidate_commit(h, xe, ce->ce_candidate, ce->ce_id, 0, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (private_candidate_discard(h, ce) < 0)
+        goto done;
+ ok:
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
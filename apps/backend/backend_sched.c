@@ -0,0 +1,727 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * Request scheduling across backend sessions
+ *
+ * Complete incoming messages are queued per session, and dispatched one at a time
+ * by weighted fair selection between scheduling classes (stride scheduling), and
+ * round-robin between the sessions of a class.
+ * Sessions are assigned to classes by user, NACM group or transport, see
+ * CLICON_BACKEND_SCHED_CLASS.
+ * The dispatcher is driven by a pipe registered in the event loop, which is readable
+ * as long as requests are queued. Since client sockets are read in the same loop,
+ * a request of a high-weight class waits at most for the request being run and the
+ * requests of classes with earlier virtual time.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <ctype.h>
+#include <syslog.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include <clixon/clixon.h>
+
+#include "clixon_backend_client.h"
+#include "backend_handle.h"
+#include "backend_client.h"
+#include "backend_sched.h"
+
+#define NACM_NS "urn:ietf:params:xml:ns:yang:ietf-netconf-acm"
+
+/* Virtual time increment of a dispatched request of a class with weight 1 */
+#define SCHED_STRIDE (1<<20)
+
+/* Name of implicit class of sessions not matching any configured class */
+#define SCHED_DEFAULT "default"
+
+/*! Scheduling class
+ */
+struct sched_class {
+    char     *sc_name;     /* Class name */
+    uint32_t  sc_weight;   /* Relative share of dispatched requests */
+    cvec     *sc_match;    /* Match criteria: user, group or transport, or empty for all */
+    uint64_t  sc_pass;     /* Virtual time of next request of class */
+    uint64_t  sc_requests; /* Number of dispatched requests */
+    uint32_t  sc_queued;   /* Number of requests waiting */
+    uint64_t  sc_wait;     /* Total queue-wait of dispatched requests in us */
+    uint64_t  sc_wait_max; /* Max queue-wait of dispatched requests in us */
+};
+
+/*! Request waiting in session queue
+ */
+struct sched_req {
+    qelem_t        sr_q;     /* Queue header */
+    char          *sr_msg;   /* Complete incoming message */
+    struct timeval sr_time;  /* Time of arrival */
+};
+
+/*! Scheduling state of a session
+ */
+struct sched_session {
+    struct sched_req *ss_queue;     /* Requests waiting, in arrival order */
+    int               ss_class;     /* Index of class in class vector */
+    char             *ss_user;      /* User that class was selected for */
+    int               ss_transport; /* Transport was known when class was selected */
+    uint64_t          ss_served;    /* Sequence number of last dispatch (round-robin) */
+};
+
+/*! Scheduler state
+ */
+struct sched {
+    struct sched_class *s_classv;   /* Vector of classes, implicit default class last */
+    int                 s_classlen; /* Length of class vector */
+    int                 s_pipe[2];  /* Readable when requests are queued */
+    int                 s_armed;    /* A byte is written to pipe */
+    uint32_t            s_queued;   /* Number of requests waiting in all sessions */
+    uint64_t            s_vtime;    /* Virtual time of last dispatched request */
+    uint64_t            s_seq;      /* Dispatch sequence number */
+};
+
+static struct sched _sched = {NULL, 0, {-1, -1}, 0, 0, 0, 0};
+
+/*! Add scheduling class from option value
+ *
+ * @param[in]  str   Class definition: "<name> <weight> [user:<u>|group:<g>|transport:<t>]*"
+ * @retval     0     OK
+ * @retval    -1    Error
+ */
+static int
+sched_class_add(char *str)
+{
+    int                 retval = -1;
+    struct sched_class *sc;
+    char              **vec = NULL;
+    int                 nvec;
+    char               *p;
+    char               *reason = NULL;
+    int                 ret;
+    int                 i;
+    int                 j;
+
+    if ((vec = clicon_strsep(str, " \t", &nvec)) == NULL)
+        goto done;
+    /* clicon_strsep gives empty strings for repeated delimiters */
+    for (i=0, j=0; i<nvec; i++)
+        if (strlen(vec[i]))
+            vec[j++] = vec[i];
+    nvec = j;
+    i = 0;
+    if (nvec < 2){
+        clixon_err(OE_CFG, EINVAL, "CLICON_BACKEND_SCHED_CLASS \"%s\": expected name and weight", str);
+        goto done;
+    }
+    if ((_sched.s_classv = realloc(_sched.s_classv, (_sched.s_classlen+1)*sizeof(*sc))) == NULL){
+        clixon_err(OE_UNIX, errno, "realloc");
+        goto done;
+    }
+    sc = &_sched.s_classv[_sched.s_classlen++];
+    memset(sc, 0, sizeof(*sc));
+    if ((sc->sc_match = cvec_new(0)) == NULL){
+        clixon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if ((sc->sc_name = strdup(vec[i++])) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if ((ret = parse_uint32(vec[i++], &sc->sc_weight, &reason)) < 0){
+        clixon_err(OE_UNIX, errno, "parse_uint32");
+        goto done;
+    }
+    if (ret == 0 || sc->sc_weight == 0){
+        clixon_err(OE_CFG, EINVAL, "CLICON_BACKEND_SCHED_CLASS \"%s\": invalid weight", str);
+        goto done;
+    }
+    for (; i<nvec; i++){
+        if ((p = strchr(vec[i], ':')) == NULL){
+            clixon_err(OE_CFG, EINVAL, "CLICON_BACKEND_SCHED_CLASS \"%s\": expected user:, group: or transport: in %s",
+                       str, vec[i]);
+            goto done;
+        }
+        *p++ = '\0';
+        if (strcmp(vec[i], "user") != 0 &&
+            strcmp(vec[i], "group") != 0 &&
+            strcmp(vec[i], "transport") != 0){
+            clixon_err(OE_CFG, EINVAL, "CLICON_BACKEND_SCHED_CLASS \"%s\": unknown criteria %s", str, vec[i]);
+            goto done;
+        }
+        if (cvec_add_string(sc->sc_match, vec[i], p) < 0){
+            clixon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+    }
+    retval = 0;
+ done:
+    if (reason)
+        free(reason);
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Check if user is member of NACM group
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  group  NACM group name
+ * @param[in]  user   User name
+ * @retval     1      Yes
+ * @retval     0      No, or no NACM configured
+ * @retval    -1      Error
+ */
+static int
+sched_group_member(clixon_handle h,
+                   char         *group,
+                   char         *user)
+{
+    int    retval = -1;
+    char  *mode;
+    cxobj *xt = NULL;
+    cxobj *x = NULL;
+    cvec  *nsc = NULL;
+
+    if ((mode = clicon_option_str(h, "CLICON_NACM_MODE")) == NULL)
+        goto fail;
+    if (strcmp(mode, "external") == 0)
+        x = clicon_nacm_ext(h);
+    else if (strcmp(mode, "internal") == 0){
+        if (xmldb_get0(h, "running", YB_MODULE, NULL, "nacm", 1, 0, &xt, NULL, NULL) < 0)
+            goto done;
+        x = xt;
+    }
+    if (x == NULL)
+        goto fail;
+    if ((nsc = xml_nsctx_init("nacm", NACM_NS)) == NULL)
+        goto done;
+    if (xpath_first(x, nsc, "nacm:nacm/nacm:groups/nacm:group[nacm:name='%s'][nacm:user-name='%s']",
+                    group, user) == NULL)
+        goto fail;
+    retval = 1;
+ done:
+    if (nsc)
+        cvec_free(nsc);
+    if (xt)
+        xml_free(xt);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Select scheduling class of session
+ *
+ * The first class whose criteria all match is selected. A class without criteria matches
+ * all sessions.
+ * @param[in]  h     Clixon handle
+ * @param[in]  ce    Client entry
+ * @param[in]  user  User of request
+ * @retval     i     Index of class
+ * @retval    -1     Error
+ */
+static int
+sched_class_select(clixon_handle        h,
+                   struct client_entry *ce,
+                   char                *user)
+{
+    struct sched_class *sc;
+    cg_var             *cv;
+    char               *name;
+    char               *val;
+    char               *transport;
+    int                 i;
+    int                 ret;
+
+    /* Transport of sessions without hello transport attribute is netconf, see RFC 6022
+     * Identity prefix, eg cl:, is stripped */
+    if ((transport = ce->ce_transport) == NULL)
+        transport = "netconf";
+    else if (strchr(transport, ':') != NULL)
+        transport = strchr(transport, ':') + 1;
+    for (i=0; i<_sched.s_classlen; i++){
+        sc = &_sched.s_classv[i];
+        cv = NULL;
+        while ((cv = cvec_each(sc->sc_match, cv)) != NULL){
+            name = cv_name_get(cv);
+            val = cv_string_get(cv);
+            if (strcmp(name, "transport") == 0){
+                if (strcmp(val, transport) != 0)
+                    break;
+            }
+            else if (user == NULL)
+                break;
+            else if (strcmp(name, "user") == 0){
+                if (strcmp(val, user) != 0)
+                    break;
+            }
+            else if (strcmp(name, "group") == 0){
+                if ((ret = sched_group_member(h, val, user)) < 0)
+                    return -1;
+                if (ret == 0)
+                    break;
+            }
+        }
+        if (cv == NULL)
+            return i;
+    }
+    return _sched.s_classlen - 1; /* Not reached: default class has no criteria */
+}
+
+/*! Get user attribute of incoming rpc without parsing it
+ *
+ * The attribute is matched on local name as in from_client_msg, ie both username="x"
+ * and prefixed, eg cl:username="x" as sent by the frontends, are accepted.
+ * @param[in]  msg   Incoming message
+ * @param[out] user  Malloced user name, or NULL
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+sched_msg_user(char  *msg,
+               char **user)
+{
+    char  *end;
+    char  *p;
+    char  *q;
+    char   quote;
+    size_t len;
+
+    *user = NULL;
+    /* Only look in first start tag, after any XML declaration */
+    p = msg;
+    while ((p = strchr(p, '<')) != NULL && p[1] == '?')
+        p++;
+    if (p == NULL || (end = strchr(p, '>')) == NULL)
+        return 0;
+    while ((p = strstr(p, "username=")) != NULL && p < end){
+        q = p - 1;
+        if (*q == ':'){ /* Skip prefix */
+            while (q > msg && (isalnum(q[-1]) || strchr("_-.", q[-1]) != NULL))
+                q--;
+            if (q < p - 1)
+                q--;
+        }
+        p += strlen("username=");
+        if (!isspace(*q) || (*p != '"' && *p != '\''))
+            continue;
+        quote = *p++;
+        for (len=0; p+len < end && p[len] != quote; len++);
+        if ((*user = strndup(p, len)) == NULL){
+            clixon_err(OE_UNIX, errno, "strndup");
+            return -1;
+        }
+        break;
+    }
+    return 0;
+}
+
+/*! Get scheduling state of session, select class if user or transport is new
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  ce    Client entry
+ * @param[in]  msg   Incoming message
+ * @retval     ss    Scheduling state
+ * @retval     NULL  Error
+ */
+static struct sched_session *
+sched_session_get(clixon_handle        h,
+                  struct client_entry *ce,
+                  char                *msg)
+{
+    struct sched_session *ss;
+    struct sched_req     *sr;
+    char                 *user = NULL;
+    int                   i;
+
+    if ((ss = ce->ce_sched) == NULL){
+        if ((ss = malloc(sizeof(*ss))) == NULL){
+            clixon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memset(ss, 0, sizeof(*ss));
+        ss->ss_class = -1;
+        ce->ce_sched = ss;
+    }
+    if (sched_msg_user(msg, &user) < 0)
+        goto err;
+    if (user == NULL && ce->ce_username &&
+        (user = strdup(ce->ce_username)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto err;
+    }
+    if (ss->ss_class != -1 &&
+        ss->ss_transport == (ce->ce_transport != NULL) &&
+        clicon_strcmp(ss->ss_user, user) == 0)
+        goto done;
+    if ((i = sched_class_select(h, ce, user)) < 0)
+        goto err;
+    if (i != ss->ss_class){
+        /* Move queued requests to new class */
+        for (sr = ss->ss_queue; sr; ){
+            if (ss->ss_class != -1)
+                _sched.s_classv[ss->ss_class].sc_queued--;
+            _sched.s_classv[i].sc_queued++;
+            if ((sr = NEXTQ(struct sched_req *, sr)) == ss->ss_queue)
+                break;
+        }
+        clixon_debug(CLIXON_DBG_BACKEND, "session %u class %s", ce->ce_id, _sched.s_classv[i].sc_name);
+        ss->ss_class = i;
+    }
+    if (ss->ss_user)
+        free(ss->ss_user);
+    ss->ss_user = user;
+    user = NULL;
+    ss->ss_transport = (ce->ce_transport != NULL);
+ done:
+    if (user)
+        free(user);
+    return ss;
+ err:
+    ss = NULL;
+    goto done;
+}
+
+/*! Select next request to dispatch
+ *
+ * The class with requests waiting and the least virtual time is selected, and within the
+ * class the session least recently served.
+ * @param[in]  h     Clixon handle
+ * @retval     ce    Client entry with request to dispatch
+ * @retval     NULL  No request waiting
+ */
+static struct client_entry *
+sched_select(clixon_handle h)
+{
+    struct sched_class  *sc;
+    struct client_entry *ce;
+    struct client_entry *cebest = NULL;
+    int                  best = -1;
+    int                  i;
+
+    for (i=0; i<_sched.s_classlen; i++){
+        sc = &_sched.s_classv[i];
+        if (sc->sc_queued == 0)
+            continue;
+        if (best == -1 || sc->sc_pass < _sched.s_classv[best].sc_pass)
+            best = i;
+    }
+    if (best == -1)
+        return NULL;
+    for (ce = backend_client_list(h); ce; ce = ce->ce_next){
+        if (ce->ce_sched == NULL ||
+            ce->ce_sched->ss_class != best ||
+            ce->ce_sched->ss_queue == NULL)
+            continue;
+        if (cebest == NULL || ce->ce_sched->ss_served < cebest->ce_sched->ss_served)
+            cebest = ce;
+    }
+    return cebest;
+}
+
+/*! Dispatch one request, callback of scheduler pipe in event loop
+ *
+ * @param[in]  fd   Read end of scheduler pipe
+ * @param[in]  arg  Clixon handle
+ * @retval     0    OK
+ * @retval    -1    Error, terminates backend
+ */
+static int
+sched_dispatch(int   fd,
+               void *arg)
+{
+    int                   retval = -1;
+    clixon_handle         h = (clixon_handle)arg;
+    struct client_entry  *ce;
+    struct sched_session *ss;
+    struct sched_class   *sc;
+    struct sched_req     *sr = NULL;
+    struct timeval        now;
+    struct timeval        t;
+    uint64_t              wait;
+    char                  byte;
+
+    if ((ce = sched_select(h)) != NULL){
+        ss = ce->ce_sched;
+        sc = &_sched.s_classv[ss->ss_class];
+        sr = ss->ss_queue;
+        DELQ(sr, ss->ss_queue, struct sched_req *);
+        sc->sc_queued--;
+        _sched.s_queued--;
+        /* A class that has been idle does not get credit for it */
+        if (sc->sc_pass < _sched.s_vtime)
+            sc->sc_pass = _sched.s_vtime;
+        _sched.s_vtime = sc->sc_pass;
+        sc->sc_pass += SCHED_STRIDE / sc->sc_weight;
+        ss->ss_served = ++_sched.s_seq;
+        gettimeofday(&now, NULL);
+        timersub(&now, &sr->sr_time, &t);
+        wait = (uint64_t)t.tv_sec*1000000 + t.tv_usec;
+        sc->sc_requests++;
+        sc->sc_wait += wait;
+        if (wait > sc->sc_wait_max)
+            sc->sc_wait_max = wait;
+        /* Resume reading client before request, which may remove the client */
+        if (ss->ss_queue == NULL &&
+            from_client_pause(h, ce, 0) < 0)
+            goto done;
+        if (from_client_msg(h, ce, sr->sr_msg) < 0)
+            goto done;
+    }
+    if (_sched.s_queued == 0 && _sched.s_armed){
+        if (read(fd, &byte, 1) < 0){
+            clixon_err(OE_UNIX, errno, "read");
+            goto done;
+        }
+        _sched.s_armed = 0;
+    }
+    retval = 0;
+ done:
+    if (sr){
+        if (sr->sr_msg)
+            free(sr->sr_msg);
+        free(sr);
+    }
+    return retval;
+}
+
+/*! Initialize request scheduler from CLICON_BACKEND_SCHED_CLASS options
+ *
+ * If no classes are configured, requests are dispatched directly in arrival order.
+ * @param[in]  h    Clixon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+backend_sched_init(clixon_handle h)
+{
+    int    retval = -1;
+    cxobj *x = NULL;
+    char  *str;
+    int    i;
+
+    while ((x = xml_child_each(clicon_conf_xml(h), x, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(x), "CLICON_BACKEND_SCHED_CLASS") != 0)
+            continue;
+        if ((str = xml_body(x)) == NULL)
+            continue;
+        if (sched_class_add(str) < 0)
+            goto done;
+    }
+    if (_sched.s_classlen == 0)
+        goto ok;
+    /* Add default class unless there is a configured class matching all sessions */
+    for (i=0; i<_sched.s_classlen; i++)
+        if (cvec_len(_sched.s_classv[i].sc_match) == 0)
+            break;
+    if (i == _sched.s_classlen &&
+        sched_class_add(SCHED_DEFAULT " 1") < 0)
+        goto done;
+    if (pipe(_sched.s_pipe) < 0){
+        clixon_err(OE_UNIX, errno, "pipe");
+        goto done;
+    }
+    if (clixon_event_reg_fd(_sched.s_pipe[0], sched_dispatch, h, "request scheduler") < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Queue complete incoming request of session for scheduling
+ *
+ * @param[in]  h    Clixon handle
+ * @param[in]  ce   Client entry
+ * The client is not read while it has requests waiting, see from_client_pause
+ * @param[in]  msg  Incoming message, copied
+ * @retval     1    Request is queued
+ * @retval     0    No scheduling, dispatch request directly
+ * @retval    -1    Error
+ */
+int
+backend_sched_request(clixon_handle        h,
+                      struct client_entry *ce,
+                      char                *msg)
+{
+    int                   retval = -1;
+    struct sched_session *ss;
+    struct sched_req     *sr = NULL;
+    char                  byte = 0;
+
+    if (_sched.s_classlen == 0){
+        retval = 0;
+        goto done;
+    }
+    if ((ss = sched_session_get(h, ce, msg)) == NULL)
+        goto done;
+    if ((sr = malloc(sizeof(*sr))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(sr, 0, sizeof(*sr));
+    if ((sr->sr_msg = strdup(msg)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        free(sr);
+        goto done;
+    }
+    gettimeofday(&sr->sr_time, NULL);
+    if (ss->ss_queue == NULL &&
+        from_client_pause(h, ce, 1) < 0){
+        free(sr->sr_msg);
+        free(sr);
+        goto done;
+    }
+    ADDQ(sr, ss->ss_queue);
+    _sched.s_classv[ss->ss_class].sc_queued++;
+    _sched.s_queued++;
+    if (!_sched.s_armed){
+        if (write(_sched.s_pipe[1], &byte, 1) < 0){
+            clixon_err(OE_UNIX, errno, "write");
+            goto done;
+        }
+        _sched.s_armed = 1;
+    }
+    retval = 1;
+ done:
+    return retval;
+}
+
+/*! Free scheduling state of session, including waiting requests
+ *
+ * @param[in]  ce   Client entry
+ * @retval     0    OK
+ */
+int
+backend_sched_session_free(struct client_entry *ce)
+{
+    struct sched_session *ss;
+    struct sched_req     *sr;
+
+    if ((ss = ce->ce_sched) == NULL)
+        return 0;
+    while ((sr = ss->ss_queue) != NULL){
+        DELQ(sr, ss->ss_queue, struct sched_req *);
+        if (ss->ss_class != -1)
+            _sched.s_classv[ss->ss_class].sc_queued--;
+        _sched.s_queued--;
+        if (sr->sr_msg)
+            free(sr->sr_msg);
+        free(sr);
+    }
+    if (ss->ss_user)
+        free(ss->ss_user);
+    free(ss);
+    ce->ce_sched = NULL;
+    return 0;
+}
+
+/*! Get scheduler statistics
+ *
+ * @param[in]  h      Clixon handle
+ * @param[out] cbret  Statistics as XML, see clixon-lib.yang stats rpc
+ * @retval     0      OK
+ */
+int
+backend_sched_stats(clixon_handle h,
+                    cbuf         *cbret)
+{
+    struct sched_class *sc;
+    int                 i;
+
+    if (_sched.s_classlen == 0)
+        return 0;
+    cprintf(cbret, "<scheduler xmlns=\"%s\">", CLIXON_LIB_NS);
+    for (i=0; i<_sched.s_classlen; i++){
+        sc = &_sched.s_classv[i];
+        cprintf(cbret, "<class>");
+        cprintf(cbret, "<name>%s</name>", sc->sc_name);
+        cprintf(cbret, "<weight>%u</weight>", sc->sc_weight);
+        cprintf(cbret, "<requests>%" PRIu64 "</requests>", sc->sc_requests);
+        cprintf(cbret, "<queued>%u</queued>", sc->sc_queued);
+        cprintf(cbret, "<wait-total>%" PRIu64 "</wait-total>", sc->sc_wait);
+        cprintf(cbret, "<wait-max>%" PRIu64 "</wait-max>", sc->sc_wait_max);
+        cprintf(cbret, "</class>");
+    }
+    cprintf(cbret, "</scheduler>");
+    return 0;
+}
+
+/*! Free scheduler state
+ *
+ * @param[in]  h    Clixon handle
+ * @retval     0    OK
+ */
+int
+backend_sched_exit(clixon_handle h)
+{
+    struct client_entry *ce;
+    struct sched_class  *sc;
+    int                  i;
+
+    for (ce = backend_client_list(h); ce; ce = ce->ce_next)
+        backend_sched_session_free(ce);
+    for (i=0; i<_sched.s_classlen; i++){
+        sc = &_sched.s_classv[i];
+        if (sc->sc_name)
+            free(sc->sc_name);
+        if (sc->sc_match)
+            cvec_free(sc->sc_match);
+    }
+    if (_sched.s_classv)
+        free(_sched.s_classv);
+    _sched.s_classv = NULL;
+    _sched.s_classlen = 0;
+    for (i=0; i<2; i++)
+        if (_sched.s_pipe[i] != -1){
+            close(_sched.s_pipe[i]);
+            _sched.s_pipe[i] = -1;
+        }
+    return 0;
+}
@@ -41,6 +41,8 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <stdarg.h>
@@ -381,3 +383,133 @@ startup_module_state(clixon_handle h,
     retval = 0;
     goto done;
 }
+
+/*! State of coalesced copy of running to startup
+ *
+ * @see CLICON_STARTUP_FLUSH_DELAY
+ */
+struct startup_flush {
+    uint32_t sf_pending;   /* Edits since last copy to startup */
+    int      sf_scheduled; /* Flush timeout is registered */
+    uint64_t sf_edits;     /* Total number of edits requesting copy to startup */
+    uint64_t sf_flushes;   /* Total number of copies to startup */
+    uint64_t sf_max;       /* Max number of edits in one copy */
+};
+
+static struct startup_flush _startup_flush = {0,};
+
+/*! Copy running to startup if edits are pending
+ *
+ * @param[in]  h    Clixon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+startup_flush(clixon_handle h)
+{
+    int                   retval = -1;
+    struct startup_flush *sf = &_startup_flush;
+
+    if (sf->sf_scheduled){
+        clixon_event_unreg_timeout(startup_flush_timeout, h);
+        sf->sf_scheduled = 0;
+    }
+    if (sf->sf_pending == 0)
+        goto ok;
+    if (xmldb_copy(h, "running", "startup") < 0)
+        goto done;
+    clixon_debug(CLIXON_DBG_BACKEND, "%u edits", sf->sf_pending);
+    sf->sf_flushes++;
+    if (sf->sf_pending > sf->sf_max)
+        sf->sf_max = sf->sf_pending;
+    sf->sf_pending = 0;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Timeout callback of coalesced copy of running to startup
+ *
+ * On error, the error is logged and the copy is retried after a new delay
+ * @param[in]  fd   Not used
+ * @param[in]  arg  Clixon handle
+ * @retval     0    OK
+ */
+int
+startup_flush_timeout(int   fd,
+                      void *arg)
+{
+    clixon_handle h = (clixon_handle)arg;
+
+    _startup_flush.sf_scheduled = 0;
+    if (startup_flush(h) < 0){
+        clixon_log(h, LOG_WARNING, "%s: copy running to startup failed: %s",
+                   __FUNCTION__, clixon_err_reason());
+        if (startup_flush_request(h, 0) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Request copy of running to startup after a RESTCONF edit
+ *
+ * If CLICON_STARTUP_FLUSH_DELAY is 0, copy directly.
+ * Otherwise, copy at most CLICON_STARTUP_FLUSH_DELAY ms after the first edit not yet
+ * copied, so that all edits in that window are coalesced into one copy.
+ * @param[in]  h     Clixon handle
+ * @param[in]  edit  Count as new edit (0 on retry)
+ * @retval     0     OK
+ * @retval    -1    Error
+ */
+int
+startup_flush_request(clixon_handle h,
+                      int           edit)
+{
+    int                   retval = -1;
+    struct startup_flush *sf = &_startup_flush;
+    int                   delay;
+    struct timeval        t;
+    struct timeval        t1;
+
+    if (edit){
+        sf->sf_edits++;
+        sf->sf_pending++;
+    }
+    if ((delay = clicon_option_int(h, "CLICON_STARTUP_FLUSH_DELAY")) <= 0)
+        return startup_flush(h);
+    if (sf->sf_scheduled)
+        goto ok;
+    gettimeofday(&t, NULL);
+    t1.tv_sec = delay/1000;
+    t1.tv_usec = (delay%1000)*1000;
+    timeradd(&t, &t1, &t);
+    if (clixon_event_reg_timeout(t, startup_flush_timeout, h, "startup flush") < 0)
+        goto done;
+    sf->sf_scheduled = 1;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get statistics of copy of running to startup
+ *
+ * @param[in]  h      Clixon handle
+ * @param[out] cbret  Statistics as XML, see clixon-lib.yang stats rpc
+ * @retval     0      OK
+ */
+int
+startup_flush_stats(clixon_handle h,
+                    cbuf         *cbret)
+{
+    struct startup_flush *sf = &_startup_flush;
+
+    cprintf(cbret, "<startup-flush xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cbret, "<edits>%" PRIu64 "</edits>", sf->sf_edits);
+    cprintf(cbret, "<flushes>%" PRIu64 "</flushes>", sf->sf_flushes);
+    cprintf(cbret, "<pending>%u</pending>", sf->sf_pending);
+    cprintf(cbret, "<max-edits-per-flush>%" PRIu64 "</max-edits-per-flush>", sf->sf_max);
+    cprintf(cbret, "</startup-flush>");
+    return 0;
+}
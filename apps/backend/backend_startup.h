@@ -45,5 +45,9 @@
 int startup_mode_startup(clixon_handle h, char *db, cbuf *cbret);
 int startup_extraxml(clixon_handle h, char *file, cbuf *cbret);
 int startup_module_state(clixon_handle h, yang_stmt *yspec);
+int startup_flush(clixon_handle h);
+int startup_flush_timeout(int fd, void *arg);
+int startup_flush_request(clixon_handle h, int edit);
+int startup_flush_stats(clixon_handle h, cbuf *cbret);
 
 #endif  /* _BACKEND_STARTUP_H_ */
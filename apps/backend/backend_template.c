@@ -0,0 +1,398 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * Compiled configuration templates, see clixon-lib template-apply RPC
+ *
+ * A template is given by name with its content in the RPC, compiled once, and kept by name
+ * for subsequent RPCs. Each instance of the RPC, a set of variables, instantiates the template
+ * into one edit tree which is then merged into the candidate datastore.
+ * A template is re-compiled if the YANG spec has changed by runtime module load.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <syslog.h>
+#include <sys/time.h>
+#include <sys/types.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include <clixon/clixon.h>
+
+#include "clixon_backend_client.h"
+#include "backend_template.h"
+
+/*! Named template
+ */
+struct backend_template {
+    qelem_t          bt_qelem;  /* List header */
+    char            *bt_name;   /* Template name */
+    cxobj           *bt_xml;    /* Unbound template XML as given in RPC */
+    yang_stmt       *bt_yspec;  /* YANG spec template is compiled with */
+    clixon_template *bt_tmpl;   /* Compiled template */
+};
+
+/* List of named templates */
+static struct backend_template *_templates = NULL;
+
+/*! Find named template
+ *
+ * @param[in]  name  Template name
+ * @retval     bt    Template
+ * @retval     NULL  Not found
+ */
+static struct backend_template *
+backend_template_find(char *name)
+{
+    struct backend_template *bt;
+
+    if ((bt = _templates) != NULL)
+        do {
+            if (strcmp(bt->bt_name, name) == 0)
+                return bt;
+            bt = NEXTQ(struct backend_template *, bt);
+        } while (bt && bt != _templates);
+    return NULL;
+}
+
+/*! Free named template
+ *
+ * @param[in]  bt  Template
+ */
+static void
+backend_template_free(struct backend_template *bt)
+{
+    if (bt->bt_name)
+        free(bt->bt_name);
+    if (bt->bt_xml)
+        xml_free(bt->bt_xml);
+    if (bt->bt_tmpl)
+        xml_template_free(bt->bt_tmpl);
+    free(bt);
+}
+
+/*! Bind template XML to YANG and compile it
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  bt     Template
+ * @param[in]  yspec  YANG spec
+ * @param[out] cbret  Error reply if invalid
+ * @retval     1      OK
+ * @retval     0      Invalid, cbret set
+ * @retval    -1      Error
+ */
+static int
+backend_template_compile(clixon_handle            h,
+                         struct backend_template *bt,
+                         yang_stmt               *yspec,
+                         cbuf                    *cbret)
+{
+    int              retval = -1;
+    cxobj           *xt = NULL;
+    cxobj           *xerr = NULL;
+    clixon_template *tmpl = NULL;
+    int              ret;
+
+    if ((xt = xml_dup(bt->bt_xml)) == NULL)
+        goto done;
+    if ((ret = xml_bind_yang(h, xt, YB_MODULE, yspec, &xerr)) < 0)
+        goto done;
+    if (ret == 0){
+        if (clixon_xml2cbuf(cbret, xerr, 0, 0, NULL, -1, 0) < 0)
+            goto done;
+        goto fail;
+    }
+    if (xml_template_compile(xt, &tmpl) < 0){
+        if (netconf_operation_failed(cbret, "application", clixon_err_reason()) < 0)
+            goto done;
+        goto fail;
+    }
+    if (bt->bt_tmpl)
+        xml_template_free(bt->bt_tmpl);
+    bt->bt_tmpl = tmpl;
+    bt->bt_yspec = yspec;
+    retval = 1;
+ done:
+    if (xt)
+        xml_free(xt);
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Define or redefine a named template from the template element of the RPC
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  name   Template name
+ * @param[in]  xtmpl  Template element in RPC, anydata
+ * @param[in]  yspec  YANG spec
+ * @param[out] cbret  Error reply if invalid
+ * @retval     1      OK
+ * @retval     0      Invalid, cbret set, an existing template is not changed
+ * @retval    -1      Error
+ */
+static int
+backend_template_define(clixon_handle h,
+                        char         *name,
+                        cxobj        *xtmpl,
+                        yang_stmt    *yspec,
+                        cbuf         *cbret)
+{
+    int                      retval = -1;
+    struct backend_template *bt = NULL;
+    struct backend_template *bt0;
+    cvec                    *nsc = NULL;
+    int                      ret;
+
+    if ((bt = malloc(sizeof(*bt))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(bt, 0, sizeof(*bt));
+    if ((bt->bt_name = strdup(name)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if ((bt->bt_xml = xml_dup(xtmpl)) == NULL)
+        goto done;
+    /* Keep namespace declarations of the RPC, and unbind anydata */
+    if (xml_nsctx_node(xtmpl, &nsc) < 0)
+        goto done;
+    if (xmlns_set_all(bt->bt_xml, nsc) < 0)
+        goto done;
+    xml_spec_set(bt->bt_xml, NULL);
+    if ((ret = backend_template_compile(h, bt, yspec, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if ((bt0 = backend_template_find(name)) != NULL){
+        DELQ(bt0, _templates, struct backend_template *);
+        backend_template_free(bt0);
+    }
+    ADDQ(bt, _templates);
+    bt = NULL;
+    retval = 1;
+ done:
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (bt)
+        backend_template_free(bt);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Instantiate a template with each instance's variables and merge into candidate
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see from_client_edit_config  for the corresponding validation of edit trees
+ */
+int
+from_client_template_apply(clixon_handle h,
+                           cxobj        *xe,
+                           cbuf         *cbret,
+                           void         *arg,
+                           void         *regarg)
+{
+    int                      retval = -1;
+    struct client_entry     *ce = (struct client_entry *)arg;
+    yang_stmt               *yspec;
+    struct backend_template *bt;
+    char                    *name;
+    char                    *target;
+    uint32_t                 iddb;
+    cxobj                   *xtmpl;
+    cxobj                   *xi = NULL;
+    cxobj                   *xv;
+    cxobj                   *xval;
+    cxobj                   *xt = NULL;
+    cxobj                   *xret = NULL;
+    cvec                    *cvv = NULL;
+    cg_var                  *cv;
+    char                    *vname;
+    uint32_t                 n = 0;
+    cbuf                    *cbx = NULL;
+    int                      ret;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clixon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if ((name = xml_find_body(xe, "name")) == NULL){
+        if (netconf_missing_element(cbret, "protocol", "name", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((xtmpl = xml_find_type(xe, NULL, "template", CX_ELMNT)) != NULL){
+        if ((ret = backend_template_define(h, name, xtmpl, yspec, cbret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
+    if ((bt = backend_template_find(name)) == NULL){
+        if (netconf_bad_element(cbret, "application", "name", "Template not defined") < 0)
+            goto done;
+        goto ok;
+    }
+    /* YANG spec changed by runtime module load */
+    if (bt->bt_yspec != yspec){
+        if ((ret = backend_template_compile(h, bt, yspec, cbret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
+    if ((target = private_candidate_db(h, ce, "candidate", 1)) == NULL)
+        goto done;
+    /* Check if target locked by other client */
+    iddb = xmldb_islocked(h, target);
+    if (iddb && ce->ce_id != iddb){
+        if ((cbx = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(cbx, "<session-id>%u</session-id>", iddb);
+        if (netconf_lock_denied(cbret, cbuf_get(cbx), "Operation failed, lock is already held") < 0)
+            goto done;
+        goto ok;
+    }
+    if ((xt = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    while ((xi = xml_child_each(xe, xi, CX_ELMNT)) != NULL){
+        if (strcmp(xml_name(xi), "instance") != 0)
+            continue;
+        if ((cvv = cvec_new(0)) == NULL){
+            clixon_err(OE_UNIX, errno, "cvec_new");
+            goto done;
+        }
+        xv = NULL;
+        while ((xv = xml_child_each(xi, xv, CX_ELMNT)) != NULL){
+            if (strcmp(xml_name(xv), "variable") != 0 ||
+                (vname = xml_find_body(xv, "name")) == NULL)
+                continue;
+            xval = NULL;
+            while ((xval = xml_child_each(xv, xval, CX_ELMNT)) != NULL){
+                if (strcmp(xml_name(xval), "value") != 0)
+                    continue;
+                if ((cv = cvec_add(cvv, CGV_STRING)) == NULL){
+                    clixon_err(OE_UNIX, errno, "cvec_add");
+                    goto done;
+                }
+                if (cv_name_set(cv, vname) == NULL ||
+                    cv_string_set(cv, xml_body(xval) ? xml_body(xval) : "") == NULL){
+                    clixon_err(OE_UNIX, errno, "cv_string_set");
+                    goto done;
+                }
+            }
+        }
+        if (xml_template_instantiate(bt->bt_tmpl, cvv, xt) < 0)
+            goto done;
+        cvec_free(cvv);
+        cvv = NULL;
+        n++;
+    }
+    /* Limited validation of edit tree, as edit-config */
+    if ((ret = xml_yang_validate_minmax(xt, 1, &xret)) < 0)
+        goto done;
+    if (ret == 1 && (ret = xml_yang_validate_unique_recurse(xt, &xret)) < 0)
+        goto done;
+    if (ret == 1 && (ret = xml_yang_validate_list_key_only(xt, &xret)) < 0)
+        goto done;
+    if (ret == 0){
+        if (clixon_xml2cbuf(cbret, xret, 0, 0, NULL, -1, 0) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((ret = xmldb_put(h, target, OP_MERGE, xt, clicon_username_get(h), cbret)) < 0){
+        if (netconf_operation_failed(cbret, "protocol", clixon_err_reason())< 0)
+            goto done;
+        goto ok;
+    }
+    if (ret == 0)
+        goto ok;
+    xmldb_modified_set(h, target, 1); /* mark as dirty */
+    clixon_debug(CLIXON_DBG_BACKEND, "template %s: %u instances", name, n);
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><instances xmlns=\"%s\">%u</instances></rpc-reply>",
+            NETCONF_BASE_NAMESPACE, CLIXON_LIB_NS, n);
+ ok:
+    retval = 0;
+ done:
+    if (cbx)
+        cbuf_free(cbx);
+    if (cvv)
+        cvec_free(cvv);
+    if (xt)
+        xml_free(xt);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
+/*! Free named templates
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ */
+int
+backend_template_exit(clixon_handle h)
+{
+    struct backend_template *bt;
+
+    while ((bt = _templates) != NULL){
+        DELQ(bt, _templates, struct backend_template *);
+        backend_template_free(bt);
+    }
+    return 0;
+}
@@ -0,0 +1,596 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * Runtime YANG module load, upgrade and removal
+ *
+ * The new YANG spec is built alongside the running one: all loaded modules are parsed
+ * again from their files, with modules to load or upgrade parsed first and modules to
+ * remove left out. Each cached datastore is then upgraded to the new spec using the
+ * module-state difference, the same way as startup is upgraded (datastore and module
+ * upgrade callbacks, incl XML changelog), bound, sorted and default-populated. Running
+ * is also validated. Only if all datastores succeed is the new spec switched in, and a
+ * RFC 8525 yang-library-update notification is sent on the NETCONF stream.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <syslog.h>
+#include <sys/time.h>
+#include <sys/types.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include <clixon/clixon.h>
+
+#include "backend_yang.h"
+
+/*! YANG specs replaced by runtime module load
+ *
+ * Freed on exit, not when replaced, since XML outside the datastores, such as notifications
+ * in stream replay buffers, may still refer to them.
+ */
+static yang_stmt **_yspec_retired = NULL;
+static int         _yspec_retired_len = 0;
+
+/*! Check if module name is in list of modules to load
+ *
+ * @param[in]  vec   Vector of module entries of yang-load RPC
+ * @param[in]  len   Length of vec
+ * @param[in]  name  Module name
+ * @retval     1     Yes
+ * @retval     0     No
+ */
+static int
+yang_load_listed(cxobj **vec,
+                 size_t  len,
+                 char   *name)
+{
+    char *b;
+    int   i;
+
+    for (i=0; i<len; i++){
+        if ((b = xml_find_body(vec[i], "name")) == NULL)
+            b = xml_body(vec[i]); /* remove leaf-list */
+        if (b && strcmp(b, name) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+/*! Parse new YANG spec from loaded modules, modules to load and modules to remove
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  yspec0  Current YANG spec
+ * @param[in]  mvec    Modules to load or upgrade
+ * @param[in]  mlen    Length of mvec
+ * @param[in]  rvec    Modules to remove
+ * @param[in]  rlen    Length of rvec
+ * @param[in]  yspec1  New YANG spec
+ * @retval     0       OK
+ * @retval    -1       Error, eg parse error
+ * Modules to load are parsed first so that an upgraded revision takes precedence over 
+ * imports of the old. Loaded modules are parsed in reverse order, which places imported
+ * modules before the modules importing them.
+ */
+static int
+yang_load_parse(clixon_handle h,
+                yang_stmt    *yspec0,
+                cxobj       **mvec,
+                size_t        mlen,
+                cxobj       **rvec,
+                size_t        rlen,
+                yang_stmt    *yspec1)
+{
+    int          retval = -1;
+    yang_stmt  **yvec = NULL;
+    int          ylen = 0;
+    yang_stmt   *ym;
+    yang_stmt   *yrev;
+    char        *name;
+    char        *rev;
+    const char  *filename;
+    int          i;
+
+    /* 1. Modules to load or upgrade */
+    for (i=0; i<mlen; i++){
+        name = xml_find_body(mvec[i], "name");
+        rev = xml_find_body(mvec[i], "revision");
+        if (yang_spec_parse_module(h, name, rev, yspec1) < 0)
+            goto done;
+    }
+    /* 2. Loaded modules, except those loaded above or removed */
+    if ((yvec = calloc(yang_len_get(yspec0), sizeof(yang_stmt *))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    ym = NULL;
+    while ((ym = yn_each(yspec0, ym)) != NULL) {
+        if (yang_keyword_get(ym) == Y_MODULE)
+            yvec[ylen++] = ym;
+    }
+    for (i=ylen-1; i>=0; i--){
+        ym = yvec[i];
+        name = yang_argument_get(ym);
+        if (yang_load_listed(mvec, mlen, name) ||
+            yang_load_listed(rvec, rlen, name))
+            continue;
+        if ((filename = yang_filename_get(ym)) != NULL){
+            if (yang_spec_parse_file(h, (char*)filename, yspec1) < 0)
+                goto done;
+        }
+        else{
+            rev = (yrev = yang_find(ym, Y_REVISION, NULL)) ? yang_argument_get(yrev) : NULL;
+            if (yang_spec_parse_module(h, name, rev, yspec1) < 0)
+                goto done;
+        }
+    }
+    retval = 0;
+ done:
+    if (yvec)
+        free(yvec);
+    return retval;
+}
+
+/*! Build brief module-state of a YANG spec as stored in datastores
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  yspec  YANG spec
+ * @param[in]  msid   Content-id
+ * @param[out] xmsp   yang-library XML tree. Free with xml_free
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see startup_module_state  where the module-state cache of the running spec is built
+ */
+static int
+yang_load_modstate(clixon_handle h,
+                   yang_stmt    *yspec,
+                   char         *msid,
+                   cxobj       **xmsp)
+{
+    int    retval = -1;
+    cbuf  *cb = NULL;
+    cxobj *x = NULL;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (yang_modules_state_build(h, yspec, msid, 1, cb) < 0)
+        goto done;
+    if (clixon_xml_parse_string(cbuf_get(cb), YB_MODULE, yspec, &x, NULL) < 0)
+        goto done;
+    if (xml_rootchild(x, 0, &x) < 0)
+        goto done;
+    *xmsp = x;
+    x = NULL;
+    retval = 0;
+ done:
+    if (x)
+        xml_free(x);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Upgrade a cached datastore to a new YANG spec
+ *
+ * A copy of the datastore, without defaults and unbound as when read from file, is
+ * upgraded by callbacks, and then bound, sorted and populated with defaults as in startup.
+ * @param[in]  h        Clixon handle, with new YANG spec set
+ * @param[in]  db       Name of datastore
+ * @param[in]  x0       Cached datastore tree, bound to the old YANG spec
+ * @param[in]  yspec    New YANG spec
+ * @param[in]  msdiff   Module-state difference, or NULL
+ * @param[in]  validate Validate the upgraded tree
+ * @param[out] x1p      Upgraded datastore tree. Free with xml_free
+ * @param[out] cbret    Netconf error message if invalid
+ * @retval     1        OK
+ * @retval     0        Upgrade or validation failed (cbret set)
+ * @retval    -1        Error
+ * @see startup_common
+ */
+static int
+yang_load_migrate(clixon_handle    h,
+                  char            *db,
+                  cxobj           *x0,
+                  yang_stmt       *yspec,
+                  modstate_diff_t *msdiff,
+                  int              validate,
+                  cxobj          **x1p,
+                  cbuf            *cbret)
+{
+    int           retval = -1;
+    cbuf         *cb = NULL;
+    cxobj        *xt = NULL;
+    cxobj        *xerr = NULL;
+    cxobj        *x;
+    validate_job *vj = NULL;
+    int           ret;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_xml2cbuf1(cb, x0, 0, 0, NULL, -1, 0, WITHDEFAULTS_EXPLICIT) < 0)
+        goto done;
+    if (clixon_xml_parse_string(cbuf_get(cb), YB_NONE, yspec, &xt, NULL) < 0)
+        goto done;
+    if (xml_rootchild(xt, 0, &xt) < 0)
+        goto done;
+    xml_flag_set(xt, XML_FLAG_TOP);
+    /* General purpose datastore upgrade */
+    if (clixon_plugin_datastore_upgrade_all(h, db, xt, msdiff) < 0)
+        goto done;
+    /* Module-specific upgrade callbacks */
+    if (msdiff){
+        cbuf_reset(cb);
+        if ((ret = clixon_module_upgrade(h, xt, msdiff, cb)) < 0)
+            goto done;
+        if (ret == 0){
+            if (cbuf_len(cb) == 0)
+                cprintf(cb, "Module-set upgrade of %s failed", db);
+            if (netconf_operation_failed(cbret, "application", cbuf_get(cb)) < 0)
+                goto done;
+            goto fail;
+        }
+    }
+    if ((ret = xml_bind_yang(h, xt, YB_MODULE, yspec, &xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto failx;
+    if ((ret = xml_non_config_data(xt, &xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto failx;
+    if (xml_sort_recurse(xt) < 0)
+        goto done;
+    if (xml_global_defaults(h, xt, NULL, NULL, yspec, 0) < 0)
+        goto done;
+    if (xml_default_recurse(xt, 0, 0) < 0)
+        goto done;
+    if (validate){
+        if ((vj = validate_job_new(h)) == NULL)
+            goto done;
+        if (validate_job_all_top(vj, xt) < 0)
+            goto done;
+        x = NULL;
+        while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL)
+            if (validate_job_add(vj, x) < 0)
+                goto done;
+        if ((ret = validate_job_run(vj, &xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto failx;
+    }
+    *x1p = xt;
+    xt = NULL;
+    retval = 1;
+ done:
+    if (vj)
+        validate_job_free(vj);
+    if (xerr)
+        xml_free(xerr);
+    if (xt)
+        xml_free(xt);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ failx:
+    if (clixon_xml2cbuf(cbret, xerr, 0, 0, NULL, -1, 0) < 0)
+        goto done;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Switch the module-state, namespace context and changelog to a new YANG spec
+ *
+ * @param[in]  h      Clixon handle, with new YANG spec set
+ * @param[in]  yspec  New YANG spec
+ * @param[in]  xms    Brief module-state of yspec, or NULL
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+yang_load_switch(clixon_handle h,
+                 yang_stmt    *yspec,
+                 cxobj        *xms)
+{
+    int    retval = -1;
+    cvec  *nsctx = NULL;
+    cvec  *nsctx0;
+    cxobj *x;
+
+    /* Full module-state is rebuilt on next get */
+    if (clicon_modst_cache_set(h, 0, NULL) < 0)
+        goto done;
+    if (clicon_modst_cache_set(h, 1, xms) < 0)
+        goto done;
+    if (xml_nsctx_yangspec(yspec, &nsctx) < 0)
+        goto done;
+    nsctx0 = clicon_nsctx_global_get(h);
+    if (clicon_nsctx_global_set(h, nsctx) < 0)
+        goto done;
+    nsctx = NULL;
+    if (nsctx0)
+        cvec_free(nsctx0);
+    if (clicon_option_bool(h, "CLICON_XML_CHANGELOG")){
+        if ((x = clicon_xml_changelog_get(h)) != NULL){
+            xml_free(x);
+            clicon_xml_changelog_set(h, NULL);
+        }
+        if (clixon_xml_changelog_init(h) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (nsctx)
+        cvec_free(nsctx);
+    return retval;
+}
+
+/*! Load, upgrade or remove YANG modules in the running backend
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ * Clients are not served while modules are loaded. On any parse, upgrade or validation
+ * error, the old YANG spec and datastores remain.
+ * @note Modules loaded are not persistent across backend restarts, the backend
+ * configuration should be changed accordingly
+ */
+int
+from_client_yang_load(clixon_handle h,
+                      cxobj        *xe,
+                      cbuf         *cbret,
+                      void         *arg,
+                      void         *regarg)
+{
+    int              retval = -1;
+    yang_stmt       *yspec0;
+    yang_stmt       *yspec1 = NULL;
+    yang_stmt      **yvec;
+    cxobj          **mvec = NULL;
+    size_t           mlen;
+    cxobj          **rvec = NULL;
+    size_t           rlen;
+    char           **keys = NULL;
+    size_t           klen = 0;
+    cxobj          **xvec = NULL;
+    cxobj           *xms = NULL;
+    cxobj           *xmodcache;
+    modstate_diff_t *msdiff = NULL;
+    db_elmnt        *de;
+    db_elmnt         de0;
+    cbuf            *cbid = NULL;
+    cbuf            *cb = NULL;
+    char            *msid;
+    char            *name;
+    struct timeval   t0;
+    struct timeval   t1;
+    int              i;
+    int              ret;
+
+    gettimeofday(&t0, NULL);
+    if (clicon_option_bool(h, "CLICON_YANG_SCHEMA_MOUNT")){
+        if (netconf_operation_not_supported(cbret, "application", "Runtime YANG load with schema mount") < 0)
+            goto done;
+        goto ok;
+    }
+    yspec0 = clicon_dbspec_yang(h);
+    if (xpath_vec(xe, NULL, "module", &mvec, &mlen) < 0)
+        goto done;
+    if (xpath_vec(xe, NULL, "remove", &rvec, &rlen) < 0)
+        goto done;
+    for (i=0; i<rlen; i++){
+        if ((name = xml_body(rvec[i])) == NULL ||
+            yang_find(yspec0, Y_MODULE, name) == NULL){
+            if (netconf_bad_element(cbret, "application", "remove", "No such module") < 0)
+                goto done;
+            goto ok;
+        }
+    }
+    /* Build new YANG spec alongside the old */
+    if ((yspec1 = yspec_new()) == NULL)
+        goto done;
+    if (yang_load_parse(h, yspec0, mvec, mlen, rvec, rlen, yspec1) < 0){
+        if (netconf_operation_failed(cbret, "application", clixon_err_reason()) < 0)
+            goto done;
+        clixon_err_reset();
+        goto ok;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    for (i=0; i<rlen; i++){
+        name = xml_body(rvec[i]);
+        if (yang_find(yspec1, Y_MODULE, name) != NULL){
+            cprintf(cb, "Module %s can not be removed, it is imported by another module", name);
+            if (netconf_operation_failed(cbret, "application", cbuf_get(cb)) < 0)
+                goto done;
+            goto ok;
+        }
+    }
+    /* New content-id */
+    if ((cbid = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    msid = clicon_option_str(h, "CLICON_MODULE_SET_ID");
+    cprintf(cbid, "%lu", (msid ? strtoul(msid, NULL, 10) : 0) + 1);
+    /* Module-state difference between old and new spec, as between startup file and system */
+    if (clicon_option_bool(h, "CLICON_XMLDB_MODSTATE")){
+        if (yang_load_modstate(h, yspec1, cbuf_get(cbid), &xms) < 0)
+            goto done;
+        if ((msdiff = modstate_diff_new()) == NULL)
+            goto done;
+        if ((xmodcache = clicon_modst_cache_get(h, 1)) != NULL &&
+            yang_modules_state_diff(yspec1,
+                                    xml_find_type(xmodcache, NULL, "module-set", CX_ELMNT),
+                                    xml_find_type(xms, NULL, "module-set", CX_ELMNT),
+                                    msdiff) < 0)
+            goto done;
+    }
+    /* Upgrade callbacks and validation see the new spec */
+    clicon_dbspec_yang_set(h, yspec1);
+    if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
+        goto done;
+    if ((xvec = calloc(klen, sizeof(cxobj *))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<klen; i++){
+        if ((de = clicon_db_elmnt_get(h, keys[i])) == NULL || de->de_xml == NULL)
+            continue;
+        if ((ret = yang_load_migrate(h, keys[i], de->de_xml, yspec1, msdiff,
+                                     strcmp(keys[i], "running") == 0,
+                                     &xvec[i], cbret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
+    /* Switch atomically: no failures expected from here */
+    for (i=0; i<klen; i++){
+        if (xvec[i] == NULL)
+            continue;
+        de = clicon_db_elmnt_get(h, keys[i]);
+        de0 = *de;
+        xml_free(de0.de_xml);
+        de0.de_xml = xvec[i];
+        xvec[i] = NULL;
+        clicon_db_elmnt_set(h, keys[i], &de0);
+    }
+    if ((yvec = realloc(_yspec_retired, (_yspec_retired_len+1)*sizeof(yang_stmt *))) == NULL){
+        clixon_err(OE_UNIX, errno, "realloc");
+        goto done;
+    }
+    _yspec_retired = yvec;
+    _yspec_retired[_yspec_retired_len++] = yspec0;
+    yspec1 = NULL;
+    if (clicon_option_str_set(h, "CLICON_MODULE_SET_ID", cbuf_get(cbid)) < 0)
+        goto done;
+    if (yang_load_switch(h, clicon_dbspec_yang(h), xms) < 0)
+        goto done;
+    /* Write datastores with new module-state */
+    for (i=0; i<klen; i++){
+        if ((de = clicon_db_elmnt_get(h, keys[i])) == NULL || de->de_xml == NULL ||
+            de->de_volatile)
+            continue;
+        if (xmldb_write_cache2file(h, keys[i]) < 0)
+            goto done;
+    }
+    if (xmldb_replica_publish(h) < 0)
+        goto done;
+    /* Notify frontends, RFC 8525 */
+    if (yang_find(clicon_dbspec_yang(h), Y_MODULE, "ietf-yang-library") != NULL){
+        if (stream_add(h, "NETCONF", "Default NETCONF event stream", 0, NULL) < 0)
+            goto done;
+        if (stream_notify(h, "NETCONF",
+                          "<yang-library-update xmlns=\"urn:ietf:params:xml:ns:yang:ietf-yang-library\">"
+                          "<content-id>%s</content-id></yang-library-update>",
+                          cbuf_get(cbid)) < 0)
+            goto done;
+    }
+    gettimeofday(&t1, NULL);
+    timersub(&t1, &t0, &t1);
+    clixon_log(h, LOG_NOTICE, "YANG modules loaded, content-id %s in %lu.%06lus",
+               cbuf_get(cbid), (unsigned long)t1.tv_sec, (unsigned long)t1.tv_usec);
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><content-id xmlns=\"%s\">%s</content-id></rpc-reply>",
+            NETCONF_BASE_NAMESPACE, CLIXON_LIB_NS, cbuf_get(cbid));
+ ok:
+    retval = 0;
+ done:
+    if (yspec1){ /* Not switched */
+        if (clicon_dbspec_yang(h) == yspec1)
+            clicon_dbspec_yang_set(h, yspec0);
+        ys_free(yspec1);
+    }
+    if (xvec){
+        for (i=0; i<klen; i++)
+            if (xvec[i])
+                xml_free(xvec[i]);
+        free(xvec);
+    }
+    if (keys)
+        free(keys);
+    if (msdiff)
+        modstate_diff_free(msdiff);
+    if (xms)
+        xml_free(xms);
+    if (cbid)
+        cbuf_free(cbid);
+    if (cb)
+        cbuf_free(cb);
+    if (mvec)
+        free(mvec);
+    if (rvec)
+        free(rvec);
+    return retval;
+}
+
+/*! Free YANG specs replaced by runtime module load
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ */
+int
+backend_yang_exit(clixon_handle h)
+{
+    int i;
+
+    for (i=0; i<_yspec_retired_len; i++)
+        ys_free(_yspec_retired[i]);
+    if (_yspec_retired)
+        free(_yspec_retired);
+    _yspec_retired = NULL;
+    _yspec_retired_len = 0;
+    return 0;
+}
@@ -73,11 +73,24 @@ struct client_entry{
     uint32_t              ce_in_bad_rpcs;    /* Not correct <rpc> messages */
     uint32_t              ce_out_rpc_errors; /*  <rpc-error> messages*/
     uint32_t              ce_out_notifications; /* Outgoing notifications */
+    char                 *ce_candidate; /* Name of private candidate datastore, if created
+                                           See CLICON_XMLDB_PRIVATE_CANDIDATE */
+    cxobj                *ce_candidate_base; /* Running when private candidate was created */
+    cbuf                 *ce_input;    /* Incoming message not yet complete, see from_client */
+    int                   ce_frame_state; /* Chunked framing state of ce_input */
+    size_t                ce_frame_size;  /* Chunked framing size of ce_input */
+    struct timeval        ce_input_time;  /* Start of incomplete message, if timer is set */
+    int                   ce_input_paused; /* Socket is not read, see from_client_pause */
+    struct sched_session *ce_sched;   /* Requests waiting to be scheduled, see backend_sched.c */
 };
 typedef struct client_entry client_entry;
 
 /*
  * Prototypes
  */
+/* backend_private.c */
+char *private_candidate_db(clixon_handle h, struct client_entry *ce, char *db, int write);
+int   private_candidate_discard(clixon_handle h, struct client_entry *ce);
+int   private_candidate_commit(clixon_handle h, cxobj *xe, struct client_entry *ce, cbuf *cbret);
 
 #endif /* _CLIXON_BACKEND_CLIENT_H_ */
@@ -202,6 +202,12 @@ backend_client_delete(clixon_handle        h,
                 free(ce->ce_transport);
             if (ce->ce_source_host)
                 free(ce->ce_source_host);
+            if (ce->ce_candidate)
+                free(ce->ce_candidate);
+            if (ce->ce_candidate_base)
+                xml_free(ce->ce_candidate_base);
+            if (ce->ce_input)
+                cbuf_free(ce->ce_input);
             free(ce);
             break;
         }
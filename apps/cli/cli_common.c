@@ -918,6 +918,30 @@ cli_validate(clixon_handle h,
     return retval;
 }
 
+/*! Get configuration of a datastore for compare
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  db     Name of datastore
+ * @param[out] xc     Config tree, free with xml_free
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+compare_db_get(clixon_handle h,
+               char         *db,
+               cxobj       **xc)
+{
+    cxobj *xerr;
+
+    if (clicon_rpc_get_config(h, NULL, db, "/", NULL, NULL, xc) < 0)
+        return -1;
+    if ((xerr = xpath_first(*xc, NULL, "/rpc-error")) != NULL){
+        clixon_err_netconf(h, OE_NETCONF, 0, xerr, "Get configuration");
+        return -1;
+    }
+    return 0;
+}
+
 /*! Compare two datastore by name and formats
  *
  * @param[in]  h      Clixon handle
@@ -926,7 +950,7 @@ cli_validate(clixon_handle h,
  * @param[in]  db2    Name of second datastrore
  * @retval     0      OK
  * @retval    -1      Error
- * @note JSON and CLI are NYI
+ * @note JSON is line diff of JSON output, CLI is NYI and shown as XML
  */
 int
 compare_db_names(clixon_handle    h,
@@ -937,25 +961,14 @@ compare_db_names(clixon_handle    h,
     int              retval = -1;
     cxobj           *xc1 = NULL;
     cxobj           *xc2 = NULL;
-    cxobj           *xerr = NULL;
     cbuf            *cb = NULL;
 
-    if (clicon_rpc_get_config(h, NULL, db1, "/", NULL, NULL, &xc1) < 0)
-        goto done;
-    if ((xerr = xpath_first(xc1, NULL, "/rpc-error")) != NULL){
-        if (clixon_err_netconf(h, OE_NETCONF, 0, xerr, "Get configuration") < 0)
-            goto done;
-        goto done;
-    }
-    if (clicon_rpc_get_config(h, NULL, db2, "/", NULL, NULL, &xc2) < 0)
+    if (compare_db_get(h, db1, &xc1) < 0)
         goto done;
-    if ((xerr = xpath_first(xc2, NULL, "/rpc-error")) != NULL){
-        if (clixon_err_netconf(h, OE_NETCONF, 0, xerr, "Get configuration") < 0)
-            goto done;
+    if (compare_db_get(h, db2, &xc2) < 0)
         goto done;
-    }
     /* Note that XML and TEXT uses a (new) structured in-mem algorithm while 
-     * JSON and CLI uses (old) UNIX file diff.
+     * JSON and CLI uses line diff of output.
      */
     switch (format){
     case FORMAT_XML:
@@ -976,8 +989,8 @@ compare_db_names(clixon_handle    h,
             goto done;
         cligen_output(stdout, "%s", cbuf_get(cb));
         break;
-    case FORMAT_JSON:         /* XXX NYI */
-    case FORMAT_CLI:
+    case FORMAT_JSON:
+    case FORMAT_CLI:          /* XXX NYI */
         if (clixon_compare_xmls(xc1, xc2, format) < 0) /* astext? */
             goto done;
     default:
@@ -1039,6 +1052,69 @@ compare_dbs(clixon_handle h,
     return retval;
 }
 
+/*! Compare two dbs with structural diff or unified line diff of XML
+ *
+ * @param[in]   h     Clixon handle
+ * @param[in]   cvv  
+ * @param[in]   argv  <db1> <db2> <style>
+ *   <style>  "tree":    one line per node only in db1 (-), only in db2 (+) or with changed
+ *                       value (~), see clixon_diff_tree
+ *            "unified": line diff of XML with three lines of context and hunk headers,
+ *                       see clixon_diff_xml
+ * @retval      0     OK
+ * @retval     -1     Error
+ * @code
+ *   # cligen spec
+ *   tree, compare_dbs_diff("running", "candidate", "tree");
+ * @endcode
+ */
+int
+compare_dbs_diff(clixon_handle h,
+                 cvec         *cvv,
+                 cvec         *argv)
+{
+    int    retval = -1;
+    char  *style;
+    cxobj *xc1 = NULL;
+    cxobj *xc2 = NULL;
+    cbuf  *cb = NULL;
+
+    if (cvec_len(argv) != 3){
+        clixon_err(OE_PLUGIN, EINVAL, "Expected arguments: <db1> <db2> <style>");
+        goto done;
+    }
+    style = cv_string_get(cvec_i(argv, 2));
+    if (strcmp(style, "tree") != 0 && strcmp(style, "unified") != 0){
+        clixon_err(OE_PLUGIN, EINVAL, "Diff style %s, expected tree or unified", style);
+        goto done;
+    }
+    if (compare_db_get(h, cv_string_get(cvec_i(argv, 0)), &xc1) < 0)
+        goto done;
+    if (compare_db_get(h, cv_string_get(cvec_i(argv, 1)), &xc2) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (strcmp(style, "tree") == 0){
+        if (clixon_diff_tree(cb, xc1, xc2) < 0)
+            goto done;
+    }
+    else if (clixon_diff_xml(cb, xc1, xc2, FORMAT_XML, 3, CLIXON_DIFF_HUNK) < 0)
+        goto done;
+    if (cbuf_len(cb))
+        cligen_output(stdout, "%s", cbuf_get(cb));
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (xc1)
+        xml_free(xc1);
+    if (xc2)
+        xml_free(xc2);
+    return retval;
+}
+
 /*! Load a configuration file to candidate database
  *
  * Utility function used by cligen spec file
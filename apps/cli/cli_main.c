@@ -71,9 +71,10 @@
 #include "cli_generate.h"
 #include "cli_common.h"
 #include "cli_handle.h"
+#include "cli_server.h"
 
 /* Command line options to be passed to getopt(3) */
-#define CLI_OPTS "+hVD:f:E:l:C:F:1a:u:d:m:qp:GLy:c:U:o:"
+#define CLI_OPTS "+hVD:f:E:l:C:F:1a:u:d:m:qp:GLy:c:U:o:S:x:"
 /*! Check if there is a CLI history file and if so dump the CLI histiry to it
  *
  * Just log if file does not exist or is not readable
@@ -177,6 +178,7 @@ cli_terminate(clixon_handle h)
         clixon_exit_set(1);
     if (clicon_data_get(h, "session-transport", NULL) == 0)
         clicon_rpc_close_session(h);
+    xmldb_replica_free(h);
     if ((yspec = clicon_dbspec_yang(h)) != NULL)
         ys_free(yspec);
     if ((yspec = clicon_config_yang(h)) != NULL)
@@ -188,6 +190,7 @@ cli_terminate(clixon_handle h)
     clicon_data_cvec_del(h, "cli-edit-cvv");;
     clicon_data_cvec_del(h, "cli-edit-filter");;
     xpath_optimize_exit();
+    xpath_profile_exit();
     /* Delete all plugins, and RPC callbacks */
     clixon_plugin_module_exit(h);
     /* Delete CLI syntax et al */
@@ -537,7 +540,9 @@ usage(clixon_handle h,
             "\t-y <file>\tOverride yang spec file (dont include .yang suffix)\n"
             "\t-c <file>\tSpecify cli spec file.\n"
             "\t-U <user>\tOver-ride unix user with a pseudo user for NACM.\n"
-            "\t-o \"<option>=<value>\"\tGive configuration option overriding config file (see clixon-config.yang)\n",
+            "\t-o \"<option>=<value>\"\tGive configuration option overriding config file (see clixon-config.yang)\n"
+            "\t-S <sock>\tRun as command server on UNIX socket, instead of interactive\n"
+            "\t-x <sock>\tRun commands in command server on UNIX socket (only -m and -U options apply)\n",
             argv0,
             plgdir ? plgdir : "none"
         );
@@ -575,6 +580,10 @@ main(int    argc,
     int            config_dump;
     enum format_enum config_dump_format = FORMAT_XML;
     int            print_version = 0;
+    char          *serversock = NULL;
+    char          *clientsock = NULL;
+    char          *clientmode = NULL;
+    char          *clientuser = NULL;
 
     /* Defaults */
     once = 0;
@@ -649,7 +658,29 @@ main(int    argc,
                 clixon_log_file(optarg+1) < 0)
                 goto done;
             break;
+        case 'x': /* Run commands in command server */
+            clientsock = optarg;
+            break;
+        case 'm': /* CLI syntax mode, see also below */
+            clientmode = optarg;
+            break;
+        case 'U': /* Clixon 'pseudo' user, see also below */
+            clientuser = optarg;
+            break;
         }
+    /* Thin client of command server: skip config, yang and clispec */
+    if (clientsock != NULL){
+        if (help)
+            usage(h, argv[0]);
+        clixon_log_init(h, __PROGRAM__, dbg?LOG_DEBUG:LOG_INFO, logdst);
+        clixon_debug_init(h, dbg);
+        if ((restarg = clicon_strjoin(argc-optind, argv+optind, " ")) == NULL)
+            goto done;
+        retval = cli_server_client(h, clientsock, clientmode, clientuser, restarg);
+        free(restarg);
+        cli_handle_exit(h);
+        return retval;
+    }
     /*
      * Logs, error and debug to stderr or syslog, set debug level
      */
@@ -673,6 +704,7 @@ main(int    argc,
         case 'f' : /* config file */
         case 'E' : /* extra config dir */
         case 'l' : /* Log destination */
+        case 'x' : /* Command server client */
             break; /* see above */
         case 'C' : /* Explicitly dump configuration */
             if ((config_dump_format = format_str2int(optarg)) ==  (enum format_enum)-1){
@@ -737,6 +769,9 @@ main(int    argc,
             if (clicon_username_set(h, optarg) < 0)
                 goto done;
             break;
+        case 'S': /* Run as command server */
+            serversock = optarg;
+            break;
         case 'o':{ /* Configuration option */
             char          *val;
             if ((val = index(optarg, '=')) == NULL)
@@ -795,6 +830,8 @@ main(int    argc,
 
     if ((nr = clicon_option_int(h, "CLICON_LOG_STRING_LIMIT")) != 0)
         clixon_log_string_limit_set(nr);
+    xpath_profile_set(clicon_option_bool(h, "CLICON_XPATH_PROFILE"),
+                      clicon_option_int(h, "CLICON_XPATH_SLOW_THRESHOLD"));
 
     /* Setup signal handlers */
     if (cli_signal_init(h) < 0)
@@ -954,8 +991,11 @@ main(int    argc,
             goto done;
     }
 
+    /* Serve commands of thin clients instead of interactive */
+    if (serversock != NULL)
+        retval = cli_server(h, serversock);
     /* Go into event-loop unless -1 command-line */
-    if (!once){
+    else if (!once){
         retval = cli_interactive(h);
     }
     else
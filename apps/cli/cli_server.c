@@ -0,0 +1,513 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * CLI command server
+ *
+ * A long-lived CLI process keeps YANG, clispec, autocli trees, plugins and the backend
+ * session, and runs commands on behalf of one-shot clients on a local UNIX socket.
+ * Start the server with clixon_cli -S <sock>, and run a command with clixon_cli -x <sock>.
+ * The client does not read the config file or YANG.
+ * One request per connection:
+ *   request: <mode>\0<user>\0<commands>\0 where commands are separated by ';'
+ *   reply:   "<status> <outlen> <errlen>\n" followed by stdout and stderr of the commands
+ * Requests are served one at a time, each with its own mode, user, output and exit status.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <syslog.h>
+#include <pwd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/param.h>
+#define __USE_GNU   /* for ucred */
+#define _GNU_SOURCE /* for ucred */
+#include <sys/socket.h>
+#ifdef HAVE_LOCAL_PEERCRED
+#include <sys/ucred.h>
+#endif
+#include <sys/un.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include <clixon/clixon.h>
+
+#include "clixon_cli_api.h"
+#include "cli_plugin.h"
+#include "cli_handle.h"
+#include "cli_server.h"
+
+/* Max size of a request */
+#define CLI_SERVER_REQ_MAX 65536
+
+/* Max time to wait for a complete request in seconds */
+#define CLI_SERVER_REQ_TIMEOUT 5
+
+/*! Write all of a buffer to a socket
+ *
+ * @param[in]  s    Socket
+ * @param[in]  buf  Buffer
+ * @param[in]  len  Length of buffer
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+cli_server_write(int    s,
+                 char  *buf,
+                 size_t len)
+{
+    ssize_t n;
+
+    while (len > 0){
+        if ((n = write(s, buf, len)) < 0){
+            if (errno == EINTR)
+                continue;
+            clixon_err(OE_UNIX, errno, "write");
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/*! Copy contents of a file to a socket
+ *
+ * @param[in]  s    Socket
+ * @param[in]  f    File, read from start
+ * @param[in]  len  Number of bytes
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+cli_server_copy(int    s,
+                FILE  *f,
+                size_t len)
+{
+    char   buf[4096];
+    size_t n;
+
+    rewind(f);
+    while (len > 0){
+        if ((n = fread(buf, 1, len<sizeof(buf)?len:sizeof(buf), f)) == 0){
+            clixon_err(OE_UNIX, errno, "fread");
+            return -1;
+        }
+        if (cli_server_write(s, buf, n) < 0)
+            return -1;
+        len -= n;
+    }
+    return 0;
+}
+
+/*! Run commands of one request with stdout and stderr redirected to files
+ *
+ * Mode, user and edit-mode are restored after the request
+ * @param[in]  h       Clixon handle
+ * @param[in]  mode    CLI syntax mode, or empty for current mode
+ * @param[in]  user    User for NACM
+ * @param[in]  cmds    Commands separated by ';'
+ * @param[in]  fout    File for stdout
+ * @param[in]  ferr    File for stderr
+ * @param[out] status  Exit status, 0 if all commands were successful
+ * @retval     0       OK
+ * @retval    -1       Fatal error
+ * @see rest_commands in cli_main.c for the one-shot equivalent
+ */
+static int
+cli_server_run(clixon_handle h,
+               char         *mode,
+               char         *user,
+               char         *cmds,
+               FILE         *fout,
+               FILE         *ferr,
+               int          *status)
+{
+    int           retval = -1;
+    char         *mode0 = NULL;
+    char         *user0 = NULL;
+    char         *m;
+    char        **vec = NULL;
+    int           nvec;
+    int           i;
+    int           out0 = -1;
+    int           err0 = -1;
+    cligen_result result;
+    int           evalres;
+    pt_head      *ph;
+
+    *status = 1;
+    if ((m = cli_syntax_mode(h)) != NULL &&
+        (mode0 = strdup(m)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if ((m = clicon_username_get(h)) != NULL &&
+        (user0 = strdup(m)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    fflush(stdout);
+    fflush(stderr);
+    if ((out0 = dup(STDOUT_FILENO)) < 0 ||
+        (err0 = dup(STDERR_FILENO)) < 0){
+        clixon_err(OE_UNIX, errno, "dup");
+        goto done;
+    }
+    if (dup2(fileno(fout), STDOUT_FILENO) < 0 ||
+        dup2(fileno(ferr), STDERR_FILENO) < 0){
+        clixon_err(OE_UNIX, errno, "dup2");
+        goto done;
+    }
+    if (clicon_username_set(h, user) < 0)
+        goto done;
+    if (strlen(mode) && cli_set_syntax_mode(h, mode) == 0)
+        fprintf(stderr, "No such cli mode: %s\n", mode);
+    else if ((vec = clicon_strsep(cmds, ";", &nvec)) != NULL){
+        m = cli_syntax_mode(h);
+        for (i=0; i<nvec; i++){
+            evalres = 0;
+            if (clicon_parse(h, vec[i], &m, &result, &evalres) < 0)
+                break;
+            if (result != 1 || evalres < 0)
+                break;
+        }
+        if (i == nvec)
+            *status = 0;
+    }
+    retval = 0;
+ done:
+    fflush(stdout);
+    fflush(stderr);
+    if (out0 != -1){
+        dup2(out0, STDOUT_FILENO);
+        close(out0);
+    }
+    if (err0 != -1){
+        dup2(err0, STDERR_FILENO);
+        close(err0);
+    }
+    /* Restore state of server */
+    cligen_exiting_set(cli_cligen(h), 0);
+    if ((ph = cligen_pt_head_active_get(cli_cligen(h))) != NULL)
+        cligen_ph_workpoint_set(ph, NULL);
+    clicon_data_set(h, "cli-edit-mode", "");
+    clicon_data_cvec_del(h, "cli-edit-cvv");
+    clicon_data_cvec_del(h, "cli-edit-filter");
+    if (mode0){
+        cli_set_syntax_mode(h, mode0);
+        free(mode0);
+    }
+    if (user0){
+        clicon_username_set(h, user0);
+        free(user0);
+    }
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Get name of user of connected peer
+ *
+ * @param[in]  s       Socket
+ * @param[out] uid     Peer user id
+ * @param[out] name    Peer user name, malloced, free after use
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+cli_server_peer(int    s,
+                uid_t *uid,
+                char **name)
+{
+#if defined(HAVE_SO_PEERCRED)
+    socklen_t    clen;
+    struct ucred cr = {0,};
+
+    clen = sizeof(cr);
+    if (getsockopt(s, SOL_SOCKET, SO_PEERCRED, &cr, &clen) < 0){
+        clixon_err(OE_UNIX, errno, "getsockopt");
+        return -1;
+    }
+    *uid = cr.uid;
+#elif defined(HAVE_GETPEEREID)
+    gid_t        gid;
+
+    if (getpeereid(s, uid, &gid) < 0){
+        clixon_err(OE_UNIX, errno, "getpeereid");
+        return -1;
+    }
+#else
+#error "Need getsockopt O_PEERCRED or getpeereid for unix socket peer cred"
+#endif
+    return uid2name(*uid, name);
+}
+
+/*! Accept a client, read request, run commands and send reply
+ *
+ * A pseudo user given by the client is only accepted from root or the user of the server,
+ * otherwise the user of the peer is used.
+ * @param[in]  fd   Server socket
+ * @param[in]  arg  Clixon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+cli_server_accept(int   fd,
+                  void *arg)
+{
+    int            retval = -1;
+    clixon_handle  h = (clixon_handle)arg;
+    int            s = -1;
+    char          *buf = NULL;
+    size_t         len = 0;
+    ssize_t        n;
+    char          *mode;
+    char          *user;
+    char          *cmds;
+    char          *peer = NULL;
+    uid_t          uid = -1;
+    struct timeval tv = {CLI_SERVER_REQ_TIMEOUT, 0};
+    FILE          *fout = NULL;
+    FILE          *ferr = NULL;
+    int            status;
+    size_t         outlen;
+    size_t         errlen;
+    char           hdr[64];
+
+    if ((s = accept(fd, NULL, NULL)) < 0){
+        clixon_err(OE_UNIX, errno, "accept");
+        goto done;
+    }
+    if (setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0){
+        clixon_err(OE_UNIX, errno, "setsockopt");
+        goto done;
+    }
+    if (cli_server_peer(s, &uid, &peer) < 0)
+        goto done;
+    if ((buf = malloc(CLI_SERVER_REQ_MAX+1)) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    /* Read request until client shuts down its write side */
+    while (len < CLI_SERVER_REQ_MAX){
+        if ((n = read(s, buf+len, CLI_SERVER_REQ_MAX-len)) < 0){
+            if (errno == EINTR)
+                continue;
+            clixon_log(h, LOG_WARNING, "%s: read: %s", __FUNCTION__, strerror(errno));
+            goto ok;
+        }
+        if (n == 0)
+            break;
+        len += n;
+    }
+    buf[len] = '\0';
+    /* Split request in mode, user and commands */
+    mode = buf;
+    if ((user = memchr(mode, '\0', len)) == NULL || ++user >= buf+len ||
+        (cmds = memchr(user, '\0', buf+len-user)) == NULL || ++cmds > buf+len){
+        clixon_log(h, LOG_WARNING, "%s: Malformed request", __FUNCTION__);
+        goto ok;
+    }
+    if (strlen(user) == 0 || (uid != 0 && uid != getuid()))
+        user = peer;
+    if ((fout = tmpfile()) == NULL ||
+        (ferr = tmpfile()) == NULL){
+        clixon_err(OE_UNIX, errno, "tmpfile");
+        goto done;
+    }
+    clixon_debug(CLIXON_DBG_CLI, "user:%s mode:%s cmd:%s", user, mode, cmds);
+    if (cli_server_run(h, mode, user, cmds, fout, ferr, &status) < 0)
+        goto done;
+    outlen = ftell(fout);
+    errlen = ftell(ferr);
+    snprintf(hdr, sizeof(hdr), "%d %zu %zu\n", status, outlen, errlen);
+    if (cli_server_write(s, hdr, strlen(hdr)) < 0 ||
+        cli_server_copy(s, fout, outlen) < 0 ||
+        cli_server_copy(s, ferr, errlen) < 0){
+        clixon_log(h, LOG_WARNING, "%s: reply: %s", __FUNCTION__, clixon_err_reason());
+        clixon_err_reset();
+    }
+ ok:
+    retval = 0;
+ done:
+    if (fout)
+        fclose(fout);
+    if (ferr)
+        fclose(ferr);
+    if (s != -1)
+        close(s);
+    if (buf)
+        free(buf);
+    if (peer)
+        free(peer);
+    return retval;
+}
+
+/*! Run CLI as command server on a UNIX socket until terminated
+ *
+ * The socket is only accessible by the user of the server.
+ * @param[in]  h     Clixon handle
+ * @param[in]  sock  UNIX socket path
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+int
+cli_server(clixon_handle h,
+           char         *sock)
+{
+    int                retval = -1;
+    int                s = -1;
+    struct sockaddr_un addr;
+    mode_t             old_mask;
+    struct stat        st;
+
+    if (lstat(sock, &st) == 0 && unlink(sock) < 0){
+        clixon_err(OE_UNIX, errno, "unlink(%s)", sock);
+        goto done;
+    }
+    if ((s = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+        clixon_err(OE_UNIX, errno, "socket");
+        goto done;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, sock, sizeof(addr.sun_path)-1);
+    old_mask = umask(S_IRWXO | S_IRWXG | S_IXUSR);
+    if (bind(s, (struct sockaddr *)&addr, SUN_LEN(&addr)) < 0){
+        clixon_err(OE_UNIX, errno, "bind");
+        umask(old_mask);
+        goto done;
+    }
+    umask(old_mask);
+    if (listen(s, 16) < 0){
+        clixon_err(OE_UNIX, errno, "listen");
+        goto done;
+    }
+    /* No terminal: no paging of output */
+    cligen_line_scrolling_set(cli_cligen(h), 0);
+    if (clixon_event_reg_fd(s, cli_server_accept, h, "cli server socket") < 0)
+        goto done;
+    clixon_log(h, LOG_NOTICE, "%s: %u Serving commands on %s", __PROGRAM__, getpid(), sock);
+    if (clixon_event_loop(h) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (s != -1){
+        clixon_event_unreg_fd(s, cli_server_accept);
+        close(s);
+        unlink(sock);
+    }
+    return retval;
+}
+
+/*! Run commands in a CLI server and print their output
+ *
+ * Thin client that does not load config, YANG or clispec
+ * @param[in]  h     Clixon handle
+ * @param[in]  sock  UNIX socket path of server
+ * @param[in]  mode  CLI syntax mode or NULL
+ * @param[in]  user  Pseudo user or NULL
+ * @param[in]  cmds  Commands separated by ';'
+ * @retval     st    Exit status of commands
+ * @retval    -1     Error
+ */
+int
+cli_server_client(clixon_handle h,
+                  char         *sock,
+                  char         *mode,
+                  char         *user,
+                  char         *cmds)
+{
+    int    retval = -1;
+    int    s = -1;
+    FILE  *f = NULL;
+    int    status;
+    size_t outlen;
+    size_t errlen;
+    char   buf[4096];
+    size_t n;
+
+    if ((s = clicon_connect_unix(h, sock)) < 0)
+        goto done;
+    if (cli_server_write(s, mode?mode:"", strlen(mode?mode:"")+1) < 0 ||
+        cli_server_write(s, user?user:"", strlen(user?user:"")+1) < 0 ||
+        cli_server_write(s, cmds?cmds:"", strlen(cmds?cmds:"")+1) < 0)
+        goto done;
+    if (shutdown(s, SHUT_WR) < 0){
+        clixon_err(OE_UNIX, errno, "shutdown");
+        goto done;
+    }
+    if ((f = fdopen(s, "r")) == NULL){
+        clixon_err(OE_UNIX, errno, "fdopen");
+        goto done;
+    }
+    s = -1;
+    /* Header line is read separately, a scanf newline would also skip leading output whitespace */
+    if (fgets(buf, sizeof(buf), f) == NULL ||
+        strchr(buf, '\n') == NULL ||
+        sscanf(buf, "%d %zu %zu", &status, &outlen, &errlen) != 3){
+        clixon_err(OE_PROTO, 0, "Malformed reply from cli server %s", sock);
+        goto done;
+    }
+    while (outlen > 0 && (n = fread(buf, 1, outlen<sizeof(buf)?outlen:sizeof(buf), f)) > 0){
+        fwrite(buf, 1, n, stdout);
+        outlen -= n;
+    }
+    while (errlen > 0 && (n = fread(buf, 1, errlen<sizeof(buf)?errlen:sizeof(buf), f)) > 0){
+        fwrite(buf, 1, n, stderr);
+        errlen -= n;
+    }
+    fflush(stdout);
+    retval = status;
+ done:
+    if (f)
+        fclose(f);
+    if (s != -1)
+        close(s);
+    return retval;
+}
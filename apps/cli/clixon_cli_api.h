@@ -101,6 +101,7 @@ int cli_commit(clixon_handle h, cvec *vars, cvec *argv);
 int cli_validate(clixon_handle h, cvec *vars, cvec *argv);
 int compare_db_names(clixon_handle h, enum format_enum format, char *db1, char *db2);
 int compare_dbs(clixon_handle h, cvec *vars, cvec *argv);
+int compare_dbs_diff(clixon_handle h, cvec *vars, cvec *argv);
 int load_config_file(clixon_handle h, cvec *vars, cvec *argv);
 int save_config_file(clixon_handle h, cvec *vars, cvec *argv);
 int delete_all(clixon_handle h, cvec *vars, cvec *argv);
@@ -0,0 +1,72 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2024 Olof Hagsand
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * Clixon load generator, shared definitions
+ */
+#ifndef _LOADGEN_H_
+#define _LOADGEN_H_
+
+/*
+ * Types
+ */
+/*! Operations in a load mix */
+enum loadgen_op{
+    LG_GET = 0,     /* get with optional xpath filter, or restconf GET */
+    LG_EDIT,        /* edit-config merge to candidate, or restconf PUT */
+    LG_COMMIT,      /* commit candidate */
+    LG_SUBSCRIBE,   /* create-subscription on a new session */
+    LG_NOPS         /* Must be last */
+};
+
+/*! Transport used to reach the server */
+enum loadgen_proto{
+    LG_INTERNAL,    /* Internal backend socket, see CLICON_SOCK */
+    LG_NETCONF,     /* NETCONF 1.1 chunked framing via a clixon_netconf subprocess */
+    LG_HTTP1,       /* RESTCONF over HTTP/1.1 clear-text */
+    LG_HTTP2,       /* RESTCONF over HTTP/2 clear-text with prior knowledge (h2c) */
+};
+
+/*
+ * Prototypes
+ */
+int loadgen_http_connect(const char *addr, unsigned short port, int *sp);
+int loadgen_http1_request(int s, const char *method, const char *path,
+                          const char *authority, const char *header,
+                          const char *body, cbuf *cbret, int *status);
+int loadgen_http2_init(int s);
+int loadgen_http2_request(int s, uint32_t stream, const char *method, const char *path,
+                          const char *authority, const char *header,
+                          const char *body, cbuf *cbret, int *status);
+
+#endif  /* _LOADGEN_H_ */
@@ -0,0 +1,699 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2024 Olof Hagsand
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * Minimal RESTCONF clients for the load generator: HTTP/1.1 and HTTP/2 clear-text
+ * with prior knowledge (RFC 9113 Sec 3.3).
+ * Only what is needed to issue one request at a time on a connection and read the
+ * complete reply is implemented. HPACK encoding uses literals without indexing and
+ * without Huffman coding, so no header tables are maintained.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <ctype.h>
+#include <errno.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include <clixon/clixon.h>
+
+#include "loadgen.h"
+
+/* HTTP/2 frame types and flags, RFC 9113 Sec 6 */
+#define H2_DATA             0x0
+#define H2_HEADERS          0x1
+#define H2_RST_STREAM       0x3
+#define H2_SETTINGS         0x4
+#define H2_PING             0x6
+#define H2_GOAWAY           0x7
+#define H2_WINDOW_UPDATE    0x8
+
+#define H2_FLAG_END_STREAM  0x1
+#define H2_FLAG_ACK         0x1
+#define H2_FLAG_END_HEADERS 0x4
+#define H2_FLAG_PADDED      0x8
+#define H2_FLAG_PRIORITY    0x20
+
+#define H2_PREFACE          "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"
+#define H2_FRAME_HDRLEN     9
+#define H2_FRAME_MAX        16384      /* Default SETTINGS_MAX_FRAME_SIZE */
+#define H2_WINDOW_DEFAULT   65535
+#define H2_WINDOW_MAX       0x7fffffff
+
+/* HPACK static table indexes, RFC 7541 Appendix A */
+#define HPACK_AUTHORITY       1
+#define HPACK_METHOD          2
+#define HPACK_METHOD_GET      2
+#define HPACK_METHOD_POST     3
+#define HPACK_PATH            4
+#define HPACK_SCHEME_HTTP     6
+#define HPACK_STATUS          8
+#define HPACK_ACCEPT          19
+#define HPACK_CONTENT_LENGTH  28
+#define HPACK_CONTENT_TYPE    31
+
+#define YANG_DATA_XML "application/yang-data+xml"
+
+/*! Connect to a RESTCONF server using TCP
+ *
+ * @param[in]  addr  Host name or IP address
+ * @param[in]  port  TCP port
+ * @param[out] sp    Connected socket
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+int
+loadgen_http_connect(const char     *addr,
+                     unsigned short  port,
+                     int            *sp)
+{
+    int              retval = -1;
+    int              s = -1;
+    struct addrinfo  hints = {0,};
+    struct addrinfo *ai = NULL;
+    char             portstr[8];
+    int              one = 1;
+    int              ret;
+
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    snprintf(portstr, sizeof(portstr), "%hu", port);
+    if ((ret = getaddrinfo(addr, portstr, &hints, &ai)) != 0){
+        clixon_err(OE_UNIX, 0, "getaddrinfo %s: %s", addr, gai_strerror(ret));
+        goto done;
+    }
+    if ((s = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol)) < 0){
+        clixon_err(OE_UNIX, errno, "socket");
+        goto done;
+    }
+    if (connect(s, ai->ai_addr, ai->ai_addrlen) < 0){
+        clixon_err(OE_UNIX, errno, "connect %s:%hu", addr, port);
+        goto done;
+    }
+    /* Requests are small and latency is measured, do not delay them */
+    if (setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)) < 0){
+        clixon_err(OE_UNIX, errno, "setsockopt TCP_NODELAY");
+        goto done;
+    }
+    *sp = s;
+    s = -1;
+    retval = 0;
+ done:
+    if (s != -1)
+        close(s);
+    if (ai)
+        freeaddrinfo(ai);
+    return retval;
+}
+
+/*! Write complete buffer to socket
+ *
+ * @param[in]  s    Socket
+ * @param[in]  buf  Data
+ * @param[in]  len  Length of data
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+loadgen_write(int         s,
+              const void *buf,
+              size_t      len)
+{
+    const char *p = buf;
+    ssize_t     n;
+
+    while (len > 0){
+        if ((n = write(s, p, len)) < 0){
+            if (errno == EINTR)
+                continue;
+            clixon_err(OE_UNIX, errno, "write");
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/*! Read exactly len bytes from socket
+ *
+ * @param[in]  s    Socket
+ * @param[out] buf  Data
+ * @param[in]  len  Length to read
+ * @retval     0    OK
+ * @retval    -1    Error, including unexpected EOF
+ */
+static int
+loadgen_read(int    s,
+             void  *buf,
+             size_t len)
+{
+    char   *p = buf;
+    ssize_t n;
+
+    while (len > 0){
+        if ((n = read(s, p, len)) < 0){
+            if (errno == EINTR)
+                continue;
+            clixon_err(OE_UNIX, errno, "read");
+            return -1;
+        }
+        if (n == 0){
+            clixon_err(OE_PROTO, ESHUTDOWN, "Unexpected close by server");
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/*! Read more data from socket and append to buffer
+ *
+ * @param[in]  s    Socket
+ * @param[in]  cb   Buffer
+ * @retval     0    OK
+ * @retval    -1    Error, including unexpected EOF
+ */
+static int
+loadgen_read_append(int   s,
+                    cbuf *cb)
+{
+    char    buf[BUFSIZ];
+    ssize_t n;
+
+    while ((n = read(s, buf, sizeof(buf))) < 0){
+        if (errno != EINTR){
+            clixon_err(OE_UNIX, errno, "read");
+            return -1;
+        }
+    }
+    if (n == 0){
+        clixon_err(OE_PROTO, ESHUTDOWN, "Unexpected close by server");
+        return -1;
+    }
+    cprintf(cb, "%.*s", (int)n, buf);
+    return 0;
+}
+
+/*! Send a RESTCONF request over HTTP/1.1 and read the reply
+ *
+ * The connection is kept open, ie persistent connections are used between requests.
+ * @param[in]  s         Connected socket
+ * @param[in]  method    HTTP method, eg GET
+ * @param[in]  path      Request target, eg /restconf/data
+ * @param[in]  authority Host header
+ * @param[in]  header    Extra header line on the form "Name: value", or NULL
+ * @param[in]  body      Request body or NULL
+ * @param[out] cbret     Reply including status line and headers
+ * @param[out] status    HTTP status code
+ * @retval     0         OK
+ * @retval    -1         Error
+ * @note Only replies with Content-Length or without body are handled
+ */
+int
+loadgen_http1_request(int         s,
+                      const char *method,
+                      const char *path,
+                      const char *authority,
+                      const char *header,
+                      const char *body,
+                      cbuf       *cbret,
+                      int        *status)
+{
+    int    retval = -1;
+    cbuf  *cb = NULL;
+    char  *eoh;
+    char  *p;
+    size_t hdrlen;
+    size_t clen = 0;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s %s HTTP/1.1\r\n", method, path);
+    cprintf(cb, "Host: %s\r\n", authority);
+    cprintf(cb, "Accept: %s\r\n", YANG_DATA_XML);
+    if (header)
+        cprintf(cb, "%s\r\n", header);
+    if (body){
+        cprintf(cb, "Content-Type: %s\r\n", YANG_DATA_XML);
+        cprintf(cb, "Content-Length: %zu\r\n", strlen(body));
+    }
+    cprintf(cb, "\r\n");
+    if (body)
+        cprintf(cb, "%s", body);
+    if (loadgen_write(s, cbuf_get(cb), cbuf_len(cb)) < 0)
+        goto done;
+    cbuf_reset(cbret);
+    while ((eoh = strstr(cbuf_get(cbret), "\r\n\r\n")) == NULL)
+        if (loadgen_read_append(s, cbret) < 0)
+            goto done;
+    hdrlen = eoh - cbuf_get(cbret) + 4;
+    if (sscanf(cbuf_get(cbret), "HTTP/%*s %d", status) != 1){
+        clixon_err(OE_PROTO, 0, "Malformed status line");
+        goto done;
+    }
+    p = cbuf_get(cbret);
+    while ((p = strstr(p, "\r\n")) != NULL && p < eoh){
+        p += 2;
+        if (strncasecmp(p, "Content-Length:", strlen("Content-Length:")) == 0){
+            clen = strtoul(p + strlen("Content-Length:"), NULL, 10);
+            break;
+        }
+    }
+    while (cbuf_len(cbret) < hdrlen + clen)
+        if (loadgen_read_append(s, cbret) < 0)
+            goto done;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Append an HPACK integer with n-bit prefix, RFC 7541 Sec 5.1
+ *
+ * @param[in]     buf    Header block
+ * @param[in,out] len    Length of header block
+ * @param[in]     first  Bits of first octet above the prefix
+ * @param[in]     nbits  Prefix size in bits
+ * @param[in]     i      Integer
+ */
+static void
+hpack_int(uint8_t *buf,
+          size_t  *len,
+          uint8_t  first,
+          int      nbits,
+          size_t   i)
+{
+    size_t max = (1 << nbits) - 1;
+
+    if (i < max){
+        buf[(*len)++] = first | i;
+        return;
+    }
+    buf[(*len)++] = first | max;
+    i -= max;
+    while (i >= 128){
+        buf[(*len)++] = (i % 128) + 128;
+        i /= 128;
+    }
+    buf[(*len)++] = i;
+}
+
+/*! Append an HPACK string literal without Huffman coding, RFC 7541 Sec 5.2
+ */
+static void
+hpack_string(uint8_t    *buf,
+             size_t     *len,
+             const char *str,
+             size_t      slen)
+{
+    hpack_int(buf, len, 0x00, 7, slen);
+    memcpy(buf + *len, str, slen);
+    *len += slen;
+}
+
+/*! Append an HPACK literal header field without indexing, RFC 7541 Sec 6.2.2
+ *
+ * @param[in]     buf     Header block
+ * @param[in,out] len     Length of header block
+ * @param[in]     nameidx Static table index of name, or 0 if name is given as literal
+ * @param[in]     name    Name if nameidx is 0, must be lower case
+ * @param[in]     namelen Length of name
+ * @param[in]     value   Header value
+ */
+static void
+hpack_literal(uint8_t    *buf,
+              size_t     *len,
+              int         nameidx,
+              const char *name,
+              size_t      namelen,
+              const char *value)
+{
+    hpack_int(buf, len, 0x00, 4, nameidx);
+    if (nameidx == 0)
+        hpack_string(buf, len, name, namelen);
+    hpack_string(buf, len, value, strlen(value));
+}
+
+/*! Decode a Huffman coded status code, RFC 7541 Appendix B
+ *
+ * Only digits are decoded: 0-2 have 5-bit codes and 3-9 have 6-bit codes
+ * @param[in]  p      Huffman coded string
+ * @param[in]  len    Length of string
+ * @retval     status Three digit status code
+ * @retval     0      Not decoded
+ */
+static int
+hpack_huffman_status(uint8_t *p,
+                     size_t   len)
+{
+    int      status = 0;
+    int      i;
+    int      bit = 0;
+    int      nbits;
+    unsigned v;
+    int      j = 0;
+
+    for (i=0; i<3; i++){
+        v = 0;
+        for (nbits = 1; nbits <= 6; nbits++){
+            if (bit/8 >= len)
+                return 0;
+            v = (v << 1) | ((p[bit/8] >> (7 - bit%8)) & 0x1);
+            bit++;
+            if (nbits == 5 && v <= 2){
+                j = v;
+                break;
+            }
+            if (nbits == 6){
+                if (v < 0x19 || v > 0x1f)
+                    return 0;
+                j = v - 0x19 + 3;
+            }
+        }
+        status = status*10 + j;
+    }
+    return status;
+}
+
+/*! Decode :status from the first field of a response header block
+ *
+ * Static table and literal forms with indexed name are decoded, other forms leave
+ * status as 0, in which case the reply body is used to detect errors.
+ * @param[in]  p      Header block fragment
+ * @param[in]  len    Length of fragment
+ * @param[out] status HTTP status code or 0
+ */
+static void
+hpack_status(uint8_t *p,
+             size_t   len,
+             int     *status)
+{
+    const int statictab[] = {200, 204, 206, 304, 400, 404, 500}; /* Index 8-14 */
+    int       idx;
+    size_t    slen;
+
+    /* Skip dynamic table size updates */
+    while (len > 0 && (p[0] & 0xe0) == 0x20 && (p[0] & 0x1f) != 0x1f){
+        p++;
+        len--;
+    }
+    if (len == 0)
+        return;
+    if (p[0] & 0x80){ /* Indexed header field */
+        idx = p[0] & 0x7f;
+        if (idx >= HPACK_STATUS && idx < HPACK_STATUS + 7)
+            *status = statictab[idx - HPACK_STATUS];
+        return;
+    }
+    /* Literal with incremental indexing (6-bit prefix), or without/never indexed (4-bit) */
+    if ((p[0] & 0xc0) == 0x40)
+        idx = p[0] & 0x3f;
+    else
+        idx = p[0] & 0x0f;
+    if (idx != HPACK_STATUS || len < 2)
+        return;
+    slen = p[1] & 0x7f;
+    if (len < 2 + slen)
+        return;
+    if (p[1] & 0x80)
+        *status = hpack_huffman_status(p + 2, slen);
+    else if (slen == 3)
+        *status = atoi((char*)p + 2) % 1000;
+}
+
+/*! Send an HTTP/2 frame
+ *
+ * @param[in]  s       Socket
+ * @param[in]  type    Frame type
+ * @param[in]  flags   Frame flags
+ * @param[in]  stream  Stream identifier
+ * @param[in]  payload Frame payload
+ * @param[in]  len     Length of payload
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+h2_frame_send(int            s,
+              uint8_t        type,
+              uint8_t        flags,
+              uint32_t       stream,
+              const uint8_t *payload,
+              size_t         len)
+{
+    uint8_t hdr[H2_FRAME_HDRLEN];
+
+    hdr[0] = (len >> 16) & 0xff;
+    hdr[1] = (len >> 8) & 0xff;
+    hdr[2] = len & 0xff;
+    hdr[3] = type;
+    hdr[4] = flags;
+    hdr[5] = (stream >> 24) & 0x7f;
+    hdr[6] = (stream >> 16) & 0xff;
+    hdr[7] = (stream >> 8) & 0xff;
+    hdr[8] = stream & 0xff;
+    if (loadgen_write(s, hdr, sizeof(hdr)) < 0)
+        return -1;
+    if (len && loadgen_write(s, payload, len) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Start an HTTP/2 connection: send preface, settings and open the receive window
+ *
+ * @param[in]  s    Connected socket
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+loadgen_http2_init(int s)
+{
+    uint8_t  settings[] = {
+        0x00, 0x02, 0x00, 0x00, 0x00, 0x00, /* SETTINGS_ENABLE_PUSH = 0 */
+        0x00, 0x04, 0x7f, 0xff, 0xff, 0xff  /* SETTINGS_INITIAL_WINDOW_SIZE = max */
+    };
+    uint8_t  wu[4];
+    uint32_t incr = H2_WINDOW_MAX - H2_WINDOW_DEFAULT;
+
+    if (loadgen_write(s, H2_PREFACE, strlen(H2_PREFACE)) < 0)
+        return -1;
+    if (h2_frame_send(s, H2_SETTINGS, 0, 0, settings, sizeof(settings)) < 0)
+        return -1;
+    wu[0] = (incr >> 24) & 0x7f;
+    wu[1] = (incr >> 16) & 0xff;
+    wu[2] = (incr >> 8) & 0xff;
+    wu[3] = incr & 0xff;
+    if (h2_frame_send(s, H2_WINDOW_UPDATE, 0, 0, wu, sizeof(wu)) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Send a RESTCONF request on a new HTTP/2 stream and read the reply
+ *
+ * @param[in]  s         Socket, see loadgen_http2_init
+ * @param[in]  stream    Stream identifier, odd and increasing
+ * @param[in]  method    HTTP method, eg GET
+ * @param[in]  path      Request target, eg /restconf/data
+ * @param[in]  authority :authority pseudo-header
+ * @param[in]  header    Extra header on the form "Name: value", or NULL
+ * @param[in]  body      Request body or NULL
+ * @param[out] cbret     Reply body
+ * @param[out] status    HTTP status code, 0 if it could not be decoded
+ * @retval     0         OK
+ * @retval    -1         Error
+ * @note Receive windows are opened to max in loadgen_http2_init and never updated
+ */
+int
+loadgen_http2_request(int         s,
+                      uint32_t    stream,
+                      const char *method,
+                      const char *path,
+                      const char *authority,
+                      const char *header,
+                      const char *body,
+                      cbuf       *cbret,
+                      int        *status)
+{
+    int      retval = -1;
+    uint8_t  buf[H2_FRAME_MAX];
+    size_t   len = 0;
+    uint8_t  hdr[H2_FRAME_HDRLEN];
+    size_t   flen;
+    uint8_t  type;
+    uint8_t  flags;
+    uint32_t sid;
+    uint8_t *p;
+    size_t   plen;
+    size_t   blen;
+    size_t   n;
+    char     clen[16];
+    char    *colon;
+    char    *value;
+    int      i;
+    int      eos = 0;
+    char     name[64];
+
+    /* Header block: method, scheme, path, authority, accept and optional headers */
+    if (strlen(path) + strlen(authority) + (header?strlen(header):0) + 128 > sizeof(buf)){
+        clixon_err(OE_PROTO, EINVAL, "Request headers too large");
+        goto done;
+    }
+    if (strcmp(method, "GET") == 0)
+        buf[len++] = 0x80 | HPACK_METHOD_GET;
+    else if (strcmp(method, "POST") == 0)
+        buf[len++] = 0x80 | HPACK_METHOD_POST;
+    else
+        hpack_literal(buf, &len, HPACK_METHOD, NULL, 0, method);
+    buf[len++] = 0x80 | HPACK_SCHEME_HTTP;
+    hpack_literal(buf, &len, HPACK_PATH, NULL, 0, path);
+    hpack_literal(buf, &len, HPACK_AUTHORITY, NULL, 0, authority);
+    hpack_literal(buf, &len, HPACK_ACCEPT, NULL, 0, YANG_DATA_XML);
+    if (body){
+        hpack_literal(buf, &len, HPACK_CONTENT_TYPE, NULL, 0, YANG_DATA_XML);
+        snprintf(clen, sizeof(clen), "%zu", strlen(body));
+        hpack_literal(buf, &len, HPACK_CONTENT_LENGTH, NULL, 0, clen);
+    }
+    if (header && (colon = strchr(header, ':')) != NULL &&
+        colon - header < sizeof(name)){
+        /* Field names are lower case in HTTP/2 */
+        for (i=0; i<colon-header; i++)
+            name[i] = tolower(header[i]);
+        value = colon + 1;
+        while (*value == ' ')
+            value++;
+        hpack_literal(buf, &len, 0, name, colon-header, value);
+    }
+    if (h2_frame_send(s, H2_HEADERS,
+                      H2_FLAG_END_HEADERS | (body?0:H2_FLAG_END_STREAM),
+                      stream, buf, len) < 0)
+        goto done;
+    if (body){
+        blen = strlen(body);
+        do {
+            n = blen > H2_FRAME_MAX ? H2_FRAME_MAX : blen;
+            if (h2_frame_send(s, H2_DATA, n==blen?H2_FLAG_END_STREAM:0,
+                              stream, (uint8_t*)body, n) < 0)
+                goto done;
+            body += n;
+            blen -= n;
+        } while (blen > 0);
+    }
+    /* Read frames until the reply stream ends */
+    cbuf_reset(cbret);
+    *status = 0;
+    while (!eos){
+        if (loadgen_read(s, hdr, sizeof(hdr)) < 0)
+            goto done;
+        flen = (hdr[0] << 16) | (hdr[1] << 8) | hdr[2];
+        type = hdr[3];
+        flags = hdr[4];
+        sid = ((hdr[5] & 0x7f) << 24) | (hdr[6] << 16) | (hdr[7] << 8) | hdr[8];
+        if (flen > sizeof(buf)){
+            clixon_err(OE_PROTO, 0, "HTTP/2 frame size %zu exceeds max", flen);
+            goto done;
+        }
+        if (flen && loadgen_read(s, buf, flen) < 0)
+            goto done;
+        p = buf;
+        plen = flen;
+        switch (type){
+        case H2_SETTINGS:
+            if ((flags & H2_FLAG_ACK) == 0 &&
+                h2_frame_send(s, H2_SETTINGS, H2_FLAG_ACK, 0, NULL, 0) < 0)
+                goto done;
+            break;
+        case H2_PING:
+            if ((flags & H2_FLAG_ACK) == 0 &&
+                h2_frame_send(s, H2_PING, H2_FLAG_ACK, 0, buf, flen) < 0)
+                goto done;
+            break;
+        case H2_GOAWAY:
+            clixon_err(OE_PROTO, 0, "HTTP/2 GOAWAY received");
+            goto done;
+        case H2_RST_STREAM:
+            if (sid == stream){
+                clixon_err(OE_PROTO, 0, "HTTP/2 stream %u reset", stream);
+                goto done;
+            }
+            break;
+        case H2_HEADERS:
+        case H2_DATA:
+            if (sid != stream)
+                break;
+            if (flags & H2_FLAG_PADDED){
+                if (plen < 1 || plen < 1 + p[0])
+                    break;
+                plen -= 1 + p[0];
+                p++;
+            }
+            if (type == H2_HEADERS){
+                if ((flags & H2_FLAG_PRIORITY) && plen >= 5){
+                    p += 5;
+                    plen -= 5;
+                }
+                if (*status == 0)
+                    hpack_status(p, plen, status);
+            }
+            else
+                cprintf(cbret, "%.*s", (int)plen, (char*)p);
+            if (flags & H2_FLAG_END_STREAM)
+                eos++;
+            break;
+        default: /* WINDOW_UPDATE, PRIORITY, CONTINUATION, etc are ignored */
+            break;
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
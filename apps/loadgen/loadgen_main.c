@@ -0,0 +1,1145 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2024 Olof Hagsand
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * Clixon load generator
+ * Runs a configurable mix of get, edit, commit and subscribe requests from many
+ * concurrent sessions against a running backend, and reports throughput and latency
+ * percentiles as JSON on stdout.
+ * Each session is a forked process with its own connection. Sessions are set up
+ * before measurement starts, so that connect and hello are not part of the
+ * measurement. Latencies of all sessions are sent back to the parent over a pipe.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <pwd.h>
+#include <syslog.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include <clixon/clixon.h>
+
+#include "loadgen.h"
+
+/* Command line options to be passed to getopt(3) */
+#define LOADGEN_OPTS "hVD:f:E:l:o:P:m:c:n:t:g:N:e:p:r:a:R:H:U:S:b:T:"
+
+/* Default RESTCONF paths */
+#define LOADGEN_RESTCONF_DATA "/restconf/data"
+
+/*! Load generator settings, shared by all sessions */
+struct loadgen_spec{
+    enum loadgen_proto ls_proto;
+    int                ls_weight[LG_NOPS]; /* Relative weight of each operation */
+    int                ls_wsum;            /* Sum of weights */
+    int                ls_sessions;        /* Nr of concurrent sessions */
+    int                ls_requests;        /* Nr of requests per session */
+    int                ls_duration;        /* If set, run this many seconds instead */
+    char              *ls_get;             /* Get xpath filter, or RESTCONF GET path */
+    cvec              *ls_nsc;             /* Namespace context of xpath filter */
+    char              *ls_edit;            /* Edit data, %u is replaced by random nr */
+    char              *ls_path;            /* RESTCONF PUT path, %u is replaced */
+    unsigned int       ls_range;           /* Range of random nr */
+    char              *ls_addr;            /* RESTCONF server address */
+    unsigned short     ls_port;            /* RESTCONF server port */
+    char              *ls_header;          /* Extra HTTP header */
+    char              *ls_netconf;         /* clixon_netconf program */
+};
+
+/*! Latencies and errors of one session, or the aggregate of all sessions */
+struct loadgen_stats{
+    uint32_t *st_lat[LG_NOPS];    /* Latency of each request in microseconds */
+    uint32_t  st_len[LG_NOPS];    /* Nr of requests */
+    uint32_t  st_alloc[LG_NOPS];  /* Allocated entries of st_lat */
+    uint32_t  st_errors[LG_NOPS]; /* Nr of requests with error reply */
+    uint64_t  st_start;           /* Start of measurement, monotonic microseconds */
+    uint64_t  st_end;             /* End of measurement */
+};
+
+/*! Per-session connection state */
+struct loadgen_conn{
+    int       lc_s;       /* Socket to backend, netconf process or RESTCONF server */
+    pid_t     lc_pid;     /* clixon_netconf process if netconf */
+    uint32_t  lc_id;      /* Session id if internal */
+    uint32_t  lc_stream;  /* Next HTTP/2 stream id */
+    cbuf     *lc_cb;      /* Request buffer */
+    cbuf     *lc_cbret;   /* HTTP reply buffer */
+    unsigned  lc_seed;    /* Random seed */
+};
+
+static const char *loadgen_op_names[LG_NOPS] = {"get", "edit", "commit", "subscribe"};
+static const char *loadgen_proto_names[] = {"internal", "netconf", "http1", "http2"};
+
+/*! Monotonic time in microseconds
+ */
+static uint64_t
+loadgen_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000 + ts.tv_nsec/1000;
+}
+
+/*! Parse operation mix on the form "get=60,edit=30,commit=10"
+ *
+ * @param[in]  spec  Load generator spec
+ * @param[in]  str   Mix string
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+loadgen_mix_parse(struct loadgen_spec *spec,
+                  char                *str)
+{
+    int    retval = -1;
+    char **vec = NULL;
+    int    nvec;
+    char  *v;
+    int    i;
+    int    op;
+
+    if ((vec = clicon_strsep(str, ",", &nvec)) == NULL)
+        goto done;
+    memset(spec->ls_weight, 0, sizeof(spec->ls_weight));
+    spec->ls_wsum = 0;
+    for (i=0; i<nvec; i++){
+        if ((v = index(vec[i], '=')) == NULL){
+            clixon_err(OE_CFG, EINVAL, "Expected <op>=<weight>: %s", vec[i]);
+            goto done;
+        }
+        *v++ = '\0';
+        for (op=0; op<LG_NOPS; op++)
+            if (strcmp(vec[i], loadgen_op_names[op]) == 0)
+                break;
+        if (op == LG_NOPS){
+            clixon_err(OE_CFG, EINVAL, "Unknown operation: %s", vec[i]);
+            goto done;
+        }
+        spec->ls_weight[op] = atoi(v);
+        spec->ls_wsum += spec->ls_weight[op];
+    }
+    if (spec->ls_wsum <= 0){
+        clixon_err(OE_CFG, EINVAL, "Operation mix has no weights");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Add a latency sample
+ */
+static int
+loadgen_stats_add(struct loadgen_stats *st,
+                  enum loadgen_op       op,
+                  uint32_t              lat)
+{
+    if (st->st_len[op] == st->st_alloc[op]){
+        st->st_alloc[op] = st->st_alloc[op] ? st->st_alloc[op]*2 : 1024;
+        if ((st->st_lat[op] = realloc(st->st_lat[op],
+                                      st->st_alloc[op]*sizeof(uint32_t))) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+    }
+    st->st_lat[op][st->st_len[op]++] = lat;
+    return 0;
+}
+
+static void
+loadgen_stats_free(struct loadgen_stats *st)
+{
+    int op;
+
+    for (op=0; op<LG_NOPS; op++)
+        if (st->st_lat[op])
+            free(st->st_lat[op]);
+}
+
+/*! Copy template to buffer and replace every "%u" with nr
+ *
+ * Not using printf since the template is user data
+ */
+static void
+loadgen_subst(cbuf       *cb,
+              const char *template,
+              unsigned    nr)
+{
+    const char *p;
+
+    for (p = template; *p; p++){
+        if (p[0] == '%' && p[1] == 'u'){
+            cprintf(cb, "%u", nr);
+            p++;
+        }
+        else
+            cprintf(cb, "%c", *p);
+    }
+}
+
+/*! Create NETCONF rpc for an operation
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  spec  Load generator spec
+ * @param[in]  op    Operation
+ * @param[in]  nr    Random number used in edit
+ * @param[out] cb    Rpc
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+loadgen_rpc(clixon_handle        h,
+            struct loadgen_spec *spec,
+            enum loadgen_op      op,
+            unsigned             nr,
+            cbuf                *cb)
+{
+    int   retval = -1;
+    char *username;
+
+    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    /* Internal clients identify user, the netconf client does that by itself */
+    if (spec->ls_proto == LG_INTERNAL &&
+        (username = clicon_username_get(h)) != NULL){
+        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    }
+    cprintf(cb, " message-id=\"%d\">", netconf_message_id_next(h));
+    switch (op){
+    case LG_GET:
+        cprintf(cb, "<get>");
+        if (spec->ls_get){
+            cprintf(cb, "<filter type=\"xpath\" select=\"%s\"", spec->ls_get);
+            if (xml_nsctx_cbuf(cb, spec->ls_nsc) < 0)
+                goto done;
+            cprintf(cb, "/>");
+        }
+        cprintf(cb, "</get>");
+        break;
+    case LG_EDIT:
+        cprintf(cb, "<edit-config><target><candidate/></target><config>");
+        loadgen_subst(cb, spec->ls_edit, nr);
+        cprintf(cb, "</config></edit-config>");
+        break;
+    case LG_COMMIT:
+        cprintf(cb, "<commit/>");
+        break;
+    case LG_SUBSCRIBE:
+        cprintf(cb, "<create-subscription xmlns=\"%s\"/>", EVENT_RFC5277_NAMESPACE);
+        break;
+    default:
+        break;
+    }
+    cprintf(cb, "</rpc>");
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Set up connection of one session
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  spec  Load generator spec
+ * @param[in]  lc    Connection
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+loadgen_connect(clixon_handle        h,
+                struct loadgen_spec *spec,
+                struct loadgen_conn *lc)
+{
+    int       retval = -1;
+    char     *argv[10];
+    int       i = 0;
+    char     *username;
+
+    switch (spec->ls_proto){
+    case LG_INTERNAL:
+        /* Socket is cached in handle and used by clicon_rpc_msg_raw */
+        if (clicon_hello_req(h, NULL, NULL, &lc->lc_id) < 0)
+            goto done;
+        clicon_session_id_set(h, lc->lc_id);
+        lc->lc_s = clicon_client_socket_get(h);
+        break;
+    case LG_NETCONF:
+        argv[i++] = spec->ls_netconf;
+        argv[i++] = "-q";
+        argv[i++] = "-1";
+        argv[i++] = "-l";
+        argv[i++] = "e";
+        argv[i++] = "-f";
+        argv[i++] = clicon_configfile(h);
+        if ((username = clicon_username_get(h)) != NULL){
+            argv[i++] = "-U";
+            argv[i++] = username;
+        }
+        argv[i++] = NULL;
+        if (clixon_proc_socket(h, argv, SOCK_STREAM, &lc->lc_pid, &lc->lc_s, NULL) < 0)
+            goto done;
+        break;
+    case LG_HTTP1:
+        if (loadgen_http_connect(spec->ls_addr, spec->ls_port, &lc->lc_s) < 0)
+            goto done;
+        break;
+    case LG_HTTP2:
+        if (loadgen_http_connect(spec->ls_addr, spec->ls_port, &lc->lc_s) < 0)
+            goto done;
+        if (loadgen_http2_init(lc->lc_s) < 0)
+            goto done;
+        lc->lc_stream = 1;
+        break;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+static void
+loadgen_disconnect(clixon_handle        h,
+                   struct loadgen_spec *spec,
+                   struct loadgen_conn *lc)
+{
+    switch (spec->ls_proto){
+    case LG_INTERNAL:
+        clicon_rpc_close_session(h);
+        break;
+    case LG_NETCONF:
+        clixon_proc_socket_close(lc->lc_pid, lc->lc_s);
+        break;
+    case LG_HTTP1:
+    case LG_HTTP2:
+        close(lc->lc_s);
+        break;
+    }
+    lc->lc_s = -1;
+}
+
+/*! Make one NETCONF request on the internal socket or via clixon_netconf
+ *
+ * Subscriptions are made on a new internal socket which is closed when the reply is
+ * received, since notifications would otherwise be interleaved with later replies.
+ * @param[out] error  Set if rpc-error in reply
+ */
+static int
+loadgen_request_netconf(clixon_handle        h,
+                        struct loadgen_spec *spec,
+                        struct loadgen_conn *lc,
+                        enum loadgen_op      op,
+                        int                 *error)
+{
+    int                retval = -1;
+    struct clicon_msg *msg = NULL;
+    char              *ret = NULL;
+    int                eof = 0;
+    int                s = -1;
+
+    cbuf_reset(lc->lc_cb);
+    if (loadgen_rpc(h, spec, op, rand_r(&lc->lc_seed) % spec->ls_range, lc->lc_cb) < 0)
+        goto done;
+    if ((msg = clicon_msg_encode(lc->lc_id, "%s", cbuf_get(lc->lc_cb))) == NULL)
+        goto done;
+    if (op == LG_SUBSCRIBE){
+        if (clicon_rpc_connect(h, &s) < 0)
+            goto done;
+        if (clicon_rpc(s, clicon_sock_str(h), msg, &ret, &eof) < 0)
+            goto done;
+    }
+    else if (spec->ls_proto == LG_INTERNAL){
+        if (clicon_rpc_msg_raw(h, msg, &ret) < 0)
+            goto done;
+    }
+    else if (clicon_rpc(lc->lc_s, "netconf", msg, &ret, &eof) < 0)
+        goto done;
+    if (eof){
+        clixon_err(OE_PROTO, ESHUTDOWN, "Unexpected close");
+        goto done;
+    }
+    *error = ret == NULL || strstr(ret, "<rpc-error") != NULL;
+    retval = 0;
+ done:
+    if (s != -1)
+        close(s);
+    if (msg)
+        free(msg);
+    if (ret)
+        free(ret);
+    return retval;
+}
+
+/*! Make one RESTCONF request, edits are PUT and commits are implicit
+ *
+ * @param[out] error  Set if error status or errors in reply
+ */
+static int
+loadgen_request_restconf(clixon_handle        h,
+                         struct loadgen_spec *spec,
+                         struct loadgen_conn *lc,
+                         enum loadgen_op      op,
+                         int                 *error)
+{
+    int         retval = -1;
+    unsigned    nr;
+    cbuf       *cbpath = NULL;
+    const char *method = "GET";
+    char       *path = spec->ls_get ? spec->ls_get : LOADGEN_RESTCONF_DATA;
+    char       *body = NULL;
+    int         status = 0;
+    int         ret;
+
+    cbuf_reset(lc->lc_cb);
+    if (op == LG_EDIT){
+        if ((cbpath = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        nr = rand_r(&lc->lc_seed) % spec->ls_range;
+        loadgen_subst(cbpath, spec->ls_path, nr);
+        loadgen_subst(lc->lc_cb, spec->ls_edit, nr);
+        method = "PUT";
+        path = cbuf_get(cbpath);
+        body = cbuf_get(lc->lc_cb);
+    }
+    if (spec->ls_proto == LG_HTTP2){
+        ret = loadgen_http2_request(lc->lc_s, lc->lc_stream, method, path,
+                                    spec->ls_addr, spec->ls_header, body,
+                                    lc->lc_cbret, &status);
+        lc->lc_stream += 2;
+    }
+    else
+        ret = loadgen_http1_request(lc->lc_s, method, path,
+                                    spec->ls_addr, spec->ls_header, body,
+                                    lc->lc_cbret, &status);
+    if (ret < 0)
+        goto done;
+    *error = status >= 400 ||
+        (status == 0 && strstr(cbuf_get(lc->lc_cbret), "<errors") != NULL);
+    retval = 0;
+ done:
+    if (cbpath)
+        cbuf_free(cbpath);
+    return retval;
+}
+
+/*! Run one session: connect, wait for start, send requests and report to parent
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  spec    Load generator spec
+ * @param[in]  idx     Session index, used as random seed
+ * @param[in]  startfd Read end of start pipe, start when closed by parent
+ * @param[in]  resfd   Write end of result pipe
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+loadgen_session(clixon_handle        h,
+                struct loadgen_spec *spec,
+                int                  idx,
+                int                  startfd,
+                int                  resfd)
+{
+    int                  retval = -1;
+    struct loadgen_conn  lc = {-1, 0, 0, 0, NULL, NULL, 0};
+    struct loadgen_stats st = {{NULL,},};
+    uint64_t             t0;
+    uint64_t             t1;
+    uint64_t             end = 0;
+    char                 c;
+    int                  i;
+    int                  r;
+    int                  op;
+    int                  error = 0;
+
+    lc.lc_seed = idx + 1;
+    if ((lc.lc_cb = cbuf_new()) == NULL ||
+        (lc.lc_cbret = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (loadgen_connect(h, spec, &lc) < 0)
+        goto done;
+    /* Barrier: all sessions start at the same time */
+    while (read(startfd, &c, 1) < 0 && errno == EINTR)
+        ;
+    st.st_start = loadgen_now();
+    if (spec->ls_duration)
+        end = st.st_start + (uint64_t)spec->ls_duration*1000000;
+    for (i=0; spec->ls_duration ? loadgen_now() < end : i < spec->ls_requests; i++){
+        /* Select operation according to weights */
+        r = rand_r(&lc.lc_seed) % spec->ls_wsum;
+        for (op=0; op<LG_NOPS-1; op++){
+            if (r < spec->ls_weight[op])
+                break;
+            r -= spec->ls_weight[op];
+        }
+        t0 = loadgen_now();
+        if (spec->ls_proto == LG_INTERNAL || spec->ls_proto == LG_NETCONF){
+            if (loadgen_request_netconf(h, spec, &lc, op, &error) < 0)
+                goto done;
+        }
+        else if (loadgen_request_restconf(h, spec, &lc, op, &error) < 0)
+            goto done;
+        t1 = loadgen_now();
+        if (loadgen_stats_add(&st, op, t1 - t0) < 0)
+            goto done;
+        if (error)
+            st.st_errors[op]++;
+    }
+    st.st_end = loadgen_now();
+    loadgen_disconnect(h, spec, &lc);
+    /* Report: start, end, and per operation: count, errors and latencies */
+    if (write(resfd, &st.st_start, sizeof(st.st_start)) < 0 ||
+        write(resfd, &st.st_end, sizeof(st.st_end)) < 0){
+        clixon_err(OE_UNIX, errno, "write");
+        goto done;
+    }
+    for (op=0; op<LG_NOPS; op++){
+        if (write(resfd, &st.st_len[op], sizeof(uint32_t)) < 0 ||
+            write(resfd, &st.st_errors[op], sizeof(uint32_t)) < 0 ||
+            (st.st_len[op] &&
+             write(resfd, st.st_lat[op], st.st_len[op]*sizeof(uint32_t)) < 0)){
+            clixon_err(OE_UNIX, errno, "write");
+            goto done;
+        }
+    }
+    retval = 0;
+ done:
+    if (lc.lc_s != -1)
+        loadgen_disconnect(h, spec, &lc);
+    if (lc.lc_cb)
+        cbuf_free(lc.lc_cb);
+    if (lc.lc_cbret)
+        cbuf_free(lc.lc_cbret);
+    loadgen_stats_free(&st);
+    return retval;
+}
+
+/*! Read exactly len bytes from a result pipe
+ */
+static int
+loadgen_pipe_read(int    fd,
+                  void  *buf,
+                  size_t len)
+{
+    char   *p = buf;
+    ssize_t n;
+
+    while (len > 0){
+        if ((n = read(fd, p, len)) < 0){
+            if (errno == EINTR)
+                continue;
+            clixon_err(OE_UNIX, errno, "read");
+            return -1;
+        }
+        if (n == 0){
+            clixon_err(OE_UNIX, 0, "Session terminated without result");
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/*! Read result of one session and add to aggregate
+ */
+static int
+loadgen_result_read(int                   fd,
+                    struct loadgen_stats *st)
+{
+    uint64_t start;
+    uint64_t end;
+    uint32_t len;
+    uint32_t errors;
+    int      op;
+
+    if (loadgen_pipe_read(fd, &start, sizeof(start)) < 0 ||
+        loadgen_pipe_read(fd, &end, sizeof(end)) < 0)
+        return -1;
+    if (st->st_start == 0 || start < st->st_start)
+        st->st_start = start;
+    if (end > st->st_end)
+        st->st_end = end;
+    for (op=0; op<LG_NOPS; op++){
+        if (loadgen_pipe_read(fd, &len, sizeof(len)) < 0 ||
+            loadgen_pipe_read(fd, &errors, sizeof(errors)) < 0)
+            return -1;
+        st->st_errors[op] += errors;
+        if (len == 0)
+            continue;
+        if (st->st_len[op] + len > st->st_alloc[op]){
+            st->st_alloc[op] = st->st_len[op] + len;
+            if ((st->st_lat[op] = realloc(st->st_lat[op],
+                                          st->st_alloc[op]*sizeof(uint32_t))) == NULL){
+                clixon_err(OE_UNIX, errno, "realloc");
+                return -1;
+            }
+        }
+        if (loadgen_pipe_read(fd, st->st_lat[op] + st->st_len[op], len*sizeof(uint32_t)) < 0)
+            return -1;
+        st->st_len[op] += len;
+    }
+    return 0;
+}
+
+static int
+loadgen_cmp(const void *a,
+            const void *b)
+{
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/*! Percentile of sorted vector, nearest-rank method
+ */
+static uint32_t
+loadgen_percentile(uint32_t *vec,
+                   uint32_t  len,
+                   int       pct)
+{
+    uint64_t i;
+
+    if (len == 0)
+        return 0;
+    i = ((uint64_t)len*pct + 99)/100;
+    return vec[i ? i-1 : 0];
+}
+
+/*! Print latency percentiles of a sorted vector as JSON members
+ */
+static void
+loadgen_latency_json(cbuf     *cb,
+                     uint32_t *vec,
+                     uint32_t  len)
+{
+    cprintf(cb, "\"p50_us\":%u,\"p90_us\":%u,\"p99_us\":%u,\"max_us\":%u",
+            loadgen_percentile(vec, len, 50),
+            loadgen_percentile(vec, len, 90),
+            loadgen_percentile(vec, len, 99),
+            len ? vec[len-1] : 0);
+}
+
+/*! Compute and print result as JSON
+ *
+ * @param[in]  spec       Load generator spec
+ * @param[in]  st         Aggregated statistics, latencies are sorted here
+ * @param[in]  cb         Result
+ * @param[out] throughput Requests per second
+ * @param[out] p99        99th percentile latency of all requests
+ */
+static int
+loadgen_result_json(struct loadgen_spec  *spec,
+                    struct loadgen_stats *st,
+                    cbuf                 *cb,
+                    double               *throughput,
+                    uint32_t             *p99)
+{
+    int       retval = -1;
+    uint32_t *all = NULL;
+    uint32_t  total = 0;
+    uint32_t  errors = 0;
+    double    duration;
+    int       op;
+    int       first = 1;
+
+    for (op=0; op<LG_NOPS; op++){
+        total += st->st_len[op];
+        errors += st->st_errors[op];
+    }
+    if ((all = malloc((total+1)*sizeof(uint32_t))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    total = 0;
+    for (op=0; op<LG_NOPS; op++){
+        if (st->st_len[op] == 0)
+            continue;
+        memcpy(all + total, st->st_lat[op], st->st_len[op]*sizeof(uint32_t));
+        total += st->st_len[op];
+        qsort(st->st_lat[op], st->st_len[op], sizeof(uint32_t), loadgen_cmp);
+    }
+    qsort(all, total, sizeof(uint32_t), loadgen_cmp);
+    duration = (st->st_end - st->st_start)/1000000.0;
+    *throughput = duration > 0 ? total/duration : 0;
+    *p99 = loadgen_percentile(all, total, 99);
+    cprintf(cb, "{\"loadgen\":{");
+    cprintf(cb, "\"proto\":\"%s\",", loadgen_proto_names[spec->ls_proto]);
+    cprintf(cb, "\"sessions\":%d,", spec->ls_sessions);
+    cprintf(cb, "\"requests\":%u,", total);
+    cprintf(cb, "\"errors\":%u,", errors);
+    cprintf(cb, "\"duration\":%.3f,", duration);
+    cprintf(cb, "\"throughput\":%.1f,", *throughput);
+    loadgen_latency_json(cb, all, total);
+    cprintf(cb, ",\"op\":[");
+    for (op=0; op<LG_NOPS; op++){
+        if (st->st_len[op] == 0)
+            continue;
+        cprintf(cb, "%s{\"name\":\"%s\",\"requests\":%u,\"errors\":%u,",
+                first?"":",", loadgen_op_names[op], st->st_len[op], st->st_errors[op]);
+        loadgen_latency_json(cb, st->st_lat[op], st->st_len[op]);
+        cprintf(cb, "}");
+        first = 0;
+    }
+    cprintf(cb, "]}}");
+    retval = 0;
+ done:
+    if (all)
+        free(all);
+    return retval;
+}
+
+/*! Compare result with a baseline result file
+ *
+ * A regression is a throughput below, or a 99th percentile latency above, the
+ * baseline by more than the tolerance.
+ * @param[in]  file       Baseline JSON file, as printed by a previous run
+ * @param[in]  tolerance  Tolerance in percent
+ * @param[in]  throughput Requests per second of this run
+ * @param[in]  p99        99th percentile latency of this run
+ * @retval     1          No regression
+ * @retval     0          Regression, printed on stderr
+ * @retval    -1          Error
+ */
+static int
+loadgen_baseline_cmp(char    *file,
+                     int      tolerance,
+                     double   throughput,
+                     uint32_t p99)
+{
+    int     retval = -1;
+    FILE   *fp = NULL;
+    cxobj  *xt = NULL;
+    char   *str;
+    double  bthroughput;
+    double  bp99;
+    int     ok = 1;
+
+    if ((fp = fopen(file, "r")) == NULL){
+        clixon_err(OE_UNIX, errno, "fopen(%s)", file);
+        goto done;
+    }
+    if (clixon_json_parse_file(fp, 0, YB_NONE, NULL, &xt, NULL) < 0)
+        goto done;
+    if ((str = xml_find_body(xpath_first(xt, NULL, "loadgen"), "throughput")) == NULL){
+        clixon_err(OE_CFG, 0, "%s: No throughput in baseline", file);
+        goto done;
+    }
+    bthroughput = strtod(str, NULL);
+    if (throughput < bthroughput*(100 - tolerance)/100){
+        fprintf(stderr, "Regression: throughput %.1f req/s, baseline %.1f req/s\n",
+                throughput, bthroughput);
+        ok = 0;
+    }
+    if ((str = xml_find_body(xpath_first(xt, NULL, "loadgen"), "p99_us")) != NULL){
+        bp99 = strtod(str, NULL);
+        if (p99 > bp99*(100 + tolerance)/100){
+            fprintf(stderr, "Regression: p99 latency %u us, baseline %.0f us\n",
+                    p99, bp99);
+            ok = 0;
+        }
+    }
+    retval = ok;
+ done:
+    if (fp)
+        fclose(fp);
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
+static void
+usage(clixon_handle h,
+      char         *argv0)
+{
+    fprintf(stderr, "usage:%s\n"
+            "where options are\n"
+            "\t-h\t\tHelp\n"
+            "\t-V \t\tPrint version and exit\n"
+            "\t-D <level>\tDebug level (see available levels below)\n"
+            "\t-f <file>\tConfiguration file (mandatory)\n"
+            "\t-E <dir> \tExtra configuration file directory\n"
+            "\t-l <s|e|o|n|f<file>> \tLog on (s)yslog, std(e)rr, std(o)ut, (n)one or (f)ile (stderr is default)\n"
+            "\t-o \"<option>=<value>\"\tGive configuration option overriding config file (see clixon-config.yang)\n"
+            "\t-P <proto>\tinternal|netconf|http1|http2 (default: internal)\n"
+            "\t-m <mix>\tOperation mix, eg get=60,edit=30,commit=10,subscribe=0 (default: get=1)\n"
+            "\t-c <nr>\t\tNumber of concurrent sessions (default: 1)\n"
+            "\t-n <nr>\t\tNumber of requests per session (default: 100)\n"
+            "\t-t <sec>\tRun for this many seconds instead of a number of requests\n"
+            "\t-g <path>\tGet: xpath filter, or RESTCONF path (default: %s)\n"
+            "\t-N <pfx>:<ns>\tNamespace binding of xpath filter prefix\n"
+            "\t-e <data>\tEdit: XML config, or RESTCONF PUT body. %%u is replaced by a random number\n"
+            "\t-p <path>\tRESTCONF PUT path. %%u is replaced by the same number as in -e\n"
+            "\t-r <nr>\t\tRange of random number (default: 1000)\n"
+            "\t-a <addr>\tRESTCONF server address (default: 127.0.0.1)\n"
+            "\t-R <port>\tRESTCONF server port (default: 80)\n"
+            "\t-H <header>\tExtra HTTP header, eg \"Authorization: Basic Zm9vOmJhcg==\"\n"
+            "\t-U <user>\tOver-ride unix user with a pseudo user for NACM.\n"
+            "\t-S <program>\tclixon_netconf program (default: clixon_netconf)\n"
+            "\t-b <file>\tCompare with baseline result, exit with 1 on regression\n"
+            "\t-T <percent>\tRegression tolerance (default: 20)\n",
+            argv0,
+            LOADGEN_RESTCONF_DATA
+            );
+    fprintf(stderr, "Debug keys: ");
+    clixon_debug_key_dump(stderr);
+    fprintf(stderr, "\n");
+    exit(0);
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+    int                  retval = -1;
+    int                  c;
+    char                *argv0 = argv[0];
+    clixon_handle        h;
+    int                  logdst = CLIXON_LOG_STDERR;
+    struct passwd       *pw;
+    int                  dbg = 0;
+    struct loadgen_spec  spec = {0,};
+    struct loadgen_stats st = {{NULL,},};
+    char                *baseline = NULL;
+    int                  tolerance = 20;
+    int                  startp[2] = {-1, -1};
+    int                 *resfd = NULL;
+    pid_t               *pids = NULL;
+    int                  i;
+    int                  status;
+    int                  failed = 0;
+    char                *prefix;
+    char                *ns;
+    cbuf                *cb = NULL;
+    double               throughput;
+    uint32_t             p99;
+    int                  ret;
+
+    /* Create handle */
+    if ((h = clixon_handle_init()) == NULL)
+        return -1;
+    if (clixon_log_init(h, __PROGRAM__, LOG_INFO, logdst) < 0)
+        return -1;
+    if (clixon_err_init(h) < 0)
+        return -1;
+    /* Set username to clixon handle. Use in all communication to backend */
+    if ((pw = getpwuid(getuid())) == NULL){
+        clixon_err(OE_UNIX, errno, "getpwuid");
+        goto done;
+    }
+    if (clicon_username_set(h, pw->pw_name) < 0)
+        goto done;
+    while ((c = getopt(argc, argv, LOADGEN_OPTS)) != -1)
+        switch (c) {
+        case 'h' : /* help */
+            usage(h, argv[0]);
+            break;
+        case 'V': /* version */
+            cligen_output(stdout, "Clixon version: %s\n", CLIXON_VERSION_STRING);
+            goto ok;
+        case 'D' : { /* debug */
+            int d = 0;
+            /* Try first symbolic, then numeric match */
+            if ((d = clixon_debug_str2key(optarg)) < 0 &&
+                sscanf(optarg, "%d", &d) != 1){
+                usage(h, argv[0]);
+            }
+            dbg |= d;
+            break;
+        }
+        case 'f': /* override config file */
+            if (!strlen(optarg))
+                usage(h, argv[0]);
+            clicon_option_str_set(h, "CLICON_CONFIGFILE", optarg);
+            break;
+        case 'E': /* extra config directory */
+            if (!strlen(optarg))
+                usage(h, argv[0]);
+            clicon_option_str_set(h, "CLICON_CONFIGDIR", optarg);
+            break;
+        case 'l': /* Log destination: s|e|o */
+            if ((logdst = clixon_log_opt(optarg[0])) < 0)
+                usage(h, argv[0]);
+            if (logdst == CLIXON_LOG_FILE &&
+                strlen(optarg)>1 &&
+                clixon_log_file(optarg+1) < 0)
+                goto done;
+            break;
+        }
+    /*
+     * Logs, error and debug to stderr or syslog, set debug level
+     */
+    clixon_log_init(h, __PROGRAM__, dbg?LOG_DEBUG:LOG_INFO, logdst);
+    clixon_debug_init(h, dbg);
+    yang_init(h);
+
+    /* Find, read and parse configfile */
+    if (clicon_options_main(h) < 0)
+        goto done;
+
+    /* Defaults */
+    spec.ls_proto = LG_INTERNAL;
+    spec.ls_weight[LG_GET] = 1;
+    spec.ls_wsum = 1;
+    spec.ls_sessions = 1;
+    spec.ls_requests = 100;
+    spec.ls_range = 1000;
+    spec.ls_addr = "127.0.0.1";
+    spec.ls_port = 80;
+    spec.ls_netconf = "clixon_netconf";
+
+    /* Now rest of options */
+    optind = 1;
+    opterr = 0;
+    while ((c = getopt(argc, argv, LOADGEN_OPTS)) != -1)
+        switch (c) {
+        case 'h' : /* help */
+        case 'V' : /* version */
+        case 'D' : /* debug */
+        case 'f' : /* config file */
+        case 'E' : /* extra config dir */
+        case 'l' : /* log  */
+            break; /* see above */
+        case 'o':{ /* Configuration option */
+            char *val;
+            if ((val = index(optarg, '=')) == NULL)
+                usage(h, argv0);
+            *val++ = '\0';
+            if (clicon_option_add(h, optarg, val) < 0)
+                goto done;
+            break;
+        }
+        case 'P': /* protocol */
+            for (i=0; i<=LG_HTTP2; i++)
+                if (strcmp(optarg, loadgen_proto_names[i]) == 0)
+                    break;
+            if (i > LG_HTTP2)
+                usage(h, argv0);
+            spec.ls_proto = i;
+            break;
+        case 'm': /* operation mix */
+            if (loadgen_mix_parse(&spec, optarg) < 0)
+                goto done;
+            break;
+        case 'c': /* sessions */
+            if ((spec.ls_sessions = atoi(optarg)) <= 0)
+                usage(h, argv0);
+            break;
+        case 'n': /* requests per session */
+            if ((spec.ls_requests = atoi(optarg)) <= 0)
+                usage(h, argv0);
+            break;
+        case 't': /* duration */
+            spec.ls_duration = atoi(optarg);
+            break;
+        case 'g': /* get filter/path */
+            spec.ls_get = optarg;
+            break;
+        case 'N': /* xpath namespace prefix:namespace */
+            if ((ns = index(optarg, ':')) == NULL)
+                usage(h, argv0);
+            *ns++ = '\0';
+            prefix = optarg;
+            if (spec.ls_nsc == NULL){
+                if ((spec.ls_nsc = xml_nsctx_init(prefix, ns)) == NULL)
+                    goto done;
+            }
+            else if (xml_nsctx_add(spec.ls_nsc, prefix, ns) < 0)
+                goto done;
+            break;
+        case 'e': /* edit data */
+            spec.ls_edit = optarg;
+            break;
+        case 'p': /* restconf put path */
+            spec.ls_path = optarg;
+            break;
+        case 'r': /* random range */
+            if ((spec.ls_range = atoi(optarg)) == 0)
+                usage(h, argv0);
+            break;
+        case 'a': /* restconf address */
+            spec.ls_addr = optarg;
+            break;
+        case 'R': /* restconf port */
+            spec.ls_port = atoi(optarg);
+            break;
+        case 'H': /* extra http header */
+            spec.ls_header = optarg;
+            break;
+        case 'U': /* Clixon 'pseudo' user */
+            if (!strlen(optarg))
+                usage(h, argv0);
+            if (clicon_username_set(h, optarg) < 0)
+                goto done;
+            break;
+        case 'S': /* clixon_netconf program */
+            spec.ls_netconf = optarg;
+            break;
+        case 'b': /* baseline */
+            baseline = optarg;
+            break;
+        case 'T': /* tolerance */
+            tolerance = atoi(optarg);
+            break;
+        default:
+            usage(h, argv0);
+            break;
+        }
+    if (spec.ls_weight[LG_EDIT] && spec.ls_edit == NULL){
+        clixon_err(OE_CFG, EINVAL, "Edit operations require -e");
+        goto done;
+    }
+    if (spec.ls_proto == LG_HTTP1 || spec.ls_proto == LG_HTTP2){
+        if (spec.ls_weight[LG_COMMIT] || spec.ls_weight[LG_SUBSCRIBE]){
+            clixon_err(OE_CFG, EINVAL, "RESTCONF supports get and edit operations only");
+            goto done;
+        }
+        if (spec.ls_weight[LG_EDIT] && spec.ls_path == NULL){
+            clixon_err(OE_CFG, EINVAL, "RESTCONF edit operations require -p");
+            goto done;
+        }
+    }
+    /* A server closing a connection is reported as an error, not a signal */
+    set_signal(SIGPIPE, SIG_IGN, NULL);
+    /* Create sessions, they connect and then wait for the start pipe to close */
+    if ((resfd = calloc(spec.ls_sessions, sizeof(int))) == NULL ||
+        (pids = calloc(spec.ls_sessions, sizeof(pid_t))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    if (pipe(startp) < 0){
+        clixon_err(OE_UNIX, errno, "pipe");
+        goto done;
+    }
+    for (i=0; i<spec.ls_sessions; i++){
+        int resp[2];
+
+        if (pipe(resp) < 0){
+            clixon_err(OE_UNIX, errno, "pipe");
+            goto done;
+        }
+        if ((pids[i] = fork()) < 0){
+            clixon_err(OE_UNIX, errno, "fork");
+            goto done;
+        }
+        if (pids[i] == 0){ /* Child */
+            close(startp[1]);
+            close(resp[0]);
+            ret = loadgen_session(h, &spec, i, startp[0], resp[1]);
+            close(resp[1]);
+            _exit(ret < 0 ? 1 : 0);
+        }
+        close(resp[1]);
+        resfd[i] = resp[0];
+    }
+    close(startp[1]); /* Start */
+    startp[1] = -1;
+    for (i=0; i<spec.ls_sessions; i++){
+        if (loadgen_result_read(resfd[i], &st) < 0)
+            failed++;
+        close(resfd[i]);
+        resfd[i] = -1;
+        if (waitpid(pids[i], &status, 0) == pids[i] &&
+            (!WIFEXITED(status) || WEXITSTATUS(status) != 0))
+            failed++;
+        pids[i] = 0;
+    }
+    if (failed){
+        clixon_err(OE_UNIX, 0, "%d sessions failed", failed);
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (loadgen_result_json(&spec, &st, cb, &throughput, &p99) < 0)
+        goto done;
+    fprintf(stdout, "%s\n", cbuf_get(cb));
+    fflush(stdout);
+    if (baseline){
+        if ((ret = loadgen_baseline_cmp(baseline, tolerance, throughput, p99)) < 0)
+            goto done;
+        if (ret == 0){
+            retval = 1;
+            goto done;
+        }
+    }
+ ok:
+    retval = 0;
+ done:
+    if (startp[0] != -1)
+        close(startp[0]);
+    if (startp[1] != -1)
+        close(startp[1]);
+    if (resfd){
+        for (i=0; i<spec.ls_sessions; i++)
+            if (resfd[i] > 0)
+                close(resfd[i]);
+        free(resfd);
+    }
+    if (pids){
+        for (i=0; i<spec.ls_sessions; i++)
+            if (pids[i] > 0){
+                kill(pids[i], SIGTERM);
+                waitpid(pids[i], NULL, 0);
+            }
+        free(pids);
+    }
+    if (cb)
+        cbuf_free(cb);
+    if (spec.ls_nsc)
+        xml_nsctx_free(spec.ls_nsc);
+    loadgen_stats_free(&st);
+    clixon_handle_exit(h);
+    return retval;
+}
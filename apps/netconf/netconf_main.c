@@ -44,6 +44,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <stdarg.h>
+#include <ctype.h>
 #include <errno.h>
 #include <signal.h>
 #include <fcntl.h>
@@ -201,6 +202,294 @@ netconf_hello_msg(clixon_handle h,
     return retval;
 }
 
+/*! Check if a netconf RPC can be forwarded to backend without parsing reply
+ *
+ * @param[in]   xe     RPC operation, eg <get-config>
+ * @retval      1      Forward
+ * @retval      0      Handle in frontend
+ * @see netconf_rpc_dispatch
+ */
+static int
+netconf_rpc_forwardable(cxobj *xe)
+{
+    char  *name = xml_name(xe);
+    cxobj *xf;
+    char  *ftype;
+
+    if (strcmp(name, "get-config") == 0 ||
+        strcmp(name, "get") == 0){
+        /* Subtree filter is made in frontend */
+        if ((xf = xml_find_type(xe, NULL, "filter", CX_ELMNT)) != NULL &&
+            ((ftype = xml_find_value(xf, "type")) == NULL || strcmp(ftype, "xpath") != 0))
+            return 0;
+        return 1;
+    }
+    if (strcmp(name, "copy-config") == 0 ||
+        strcmp(name, "delete-config") == 0 ||
+        strcmp(name, "lock") == 0 ||
+        strcmp(name, "unlock") == 0 ||
+        strcmp(name, "kill-session") == 0 ||
+        strcmp(name, "validate") == 0 ||
+        strcmp(name, "commit") == 0 ||
+        strcmp(name, "cancel-commit") == 0 ||
+        strcmp(name, "discard-changes") == 0)
+        return 1;
+    return 0;
+}
+
+/*! Write all of a buffer to a file descriptor
+ */
+static int
+netconf_write_all(int         s,
+                  const char *buf,
+                  size_t      len)
+{
+    ssize_t n;
+
+    while (len > 0){
+        if ((n = write(s, buf, len)) < 0){
+            if (errno == EINTR)
+                continue;
+            if (errno == EPIPE)
+                clixon_debug(CLIXON_DBG_DEFAULT, "write err SIGPIPE");
+            else
+                clixon_log(NULL, LOG_ERR, "%s: write: %s", __FUNCTION__, strerror(errno));
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/* State of a backend reply forwarded in parts, see netconf_rpc_forward_cb */
+struct forward_state {
+    cxobj               *fs_xrpc;    /* Incoming message on the form <rpc>... */
+    netconf_framing_type fs_framing; /* Output framing */
+    cbuf                *fs_head;    /* Start of reply, until envelope is written */
+    int                  fs_started; /* Envelope is written, rest is forwarded as is */
+};
+
+/*! Write part of a forwarded reply to stdout, as one chunk if chunked framing
+ */
+static int
+netconf_forward_write(struct forward_state *fs,
+                      const char           *buf,
+                      size_t                len)
+{
+    char hdr[32];
+
+    if (len == 0) /* Zero-length chunks are not allowed in RFC 6242 */
+        return 0;
+    if (fs->fs_framing == NETCONF_SSH_CHUNKED){
+        snprintf(hdr, sizeof(hdr), "\n#%zu\n", len);
+        if (netconf_write_all(1, hdr, strlen(hdr)) < 0)
+            return -1;
+    }
+    clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_DETAIL, "Send ext: %.*s", (int)len, buf);
+    return netconf_write_all(1, buf, len);
+}
+
+/*! Write the start of a forwarded reply with request attributes added to <rpc-reply>
+ *
+ * Attributes of the <rpc> element that are not already present are added to the
+ * <rpc-reply> start tag.
+ * @param[in]  fs     Forward state, with start of reply in fs_head
+ * @param[in]  eom    Whole reply is in fs_head
+ * @retval     1      Written
+ * @retval     0      Start tag is not complete, wait for more data
+ * @retval    -1      Error
+ * @see netconf_add_request_attr  for the parsed case
+ */
+static int
+netconf_forward_envelope(struct forward_state *fs,
+                         int                   eom)
+{
+    int     retval = -1;
+    char   *head = cbuf_get(fs->fs_head);
+    char   *p;
+    char   *stag = NULL;  /* Reply start tag */
+    cbuf   *cb = NULL;
+    cbuf   *cbq = NULL;   /* Attribute name */
+    cxobj  *xa;
+    char    q = 0;
+    size_t  ins = 0;
+
+    if ((cb = cbuf_new()) == NULL ||
+        (cbq = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    /* Find end of <rpc-reply ...> start tag, skipping quoted attribute values */
+    p = head;
+    while (isspace(*p))
+        p++;
+    if (!eom && strlen(p) < strlen("<rpc-reply"))
+        goto wait;
+    if (strncmp(p, "<rpc-reply", strlen("<rpc-reply")) == 0){
+        for (; *p != '\0'; p++){
+            if (q){
+                if (*p == q)
+                    q = 0;
+            }
+            else if (*p == '"' || *p == '\'')
+                q = *p;
+            else if (*p == '>')
+                break;
+        }
+        if (*p != '>' && !eom)
+            goto wait;
+        if (*p == '>'){
+            if (p > head && *(p-1) == '/')
+                p--;
+            ins = p - head;
+            if ((stag = strndup(head, ins)) == NULL){
+                clixon_err(OE_UNIX, errno, "strndup");
+                goto done;
+            }
+            cbuf_append_buf(cb, head, ins);
+            xa = NULL;
+            while ((xa = xml_child_each(fs->fs_xrpc, xa, CX_ATTR)) != NULL){
+                /* Same filtering as netconf_add_request_attr */
+                if (xml_prefix(xa) && strcmp(xml_prefix(xa), CLIXON_LIB_PREFIX) == 0)
+                    continue;
+                if (xml_prefix(xa) && strcmp(xml_prefix(xa), "xmlns") == 0 &&
+                    strcmp(xml_name(xa), CLIXON_LIB_PREFIX) == 0)
+                    continue;
+                cbuf_reset(cbq);
+                if (xml_prefix(xa))
+                    cprintf(cbq, " %s:%s=", xml_prefix(xa), xml_name(xa));
+                else
+                    cprintf(cbq, " %s=", xml_name(xa));
+                /* If attribute already exists, dont copy it */
+                if (strstr(stag, cbuf_get(cbq)) == NULL){
+                    cprintf(cb, "%s\"", cbuf_get(cbq));
+                    if (xml_chardata_cbuf_append(cb, xml_value(xa)) < 0)
+                        goto done;
+                    cprintf(cb, "\"");
+                }
+            }
+        }
+    }
+    cbuf_append_buf(cb, head + ins, cbuf_len(fs->fs_head) - ins);
+    if (netconf_forward_write(fs, cbuf_get(cb), cbuf_len(cb)) < 0)
+        goto done;
+    fs->fs_started = 1;
+    retval = 1;
+ done:
+    if (stag)
+        free(stag);
+    if (cbq)
+        cbuf_free(cbq);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ wait:
+    retval = 0;
+    goto done;
+}
+
+/*! Forward a part of a backend reply to stdout
+ *
+ * The start of the reply is buffered until the <rpc-reply> start tag is complete, after
+ * that each part is written as it is received.
+ * @see clixon_msg_part_cb
+ */
+static int
+netconf_rpc_forward_cb(void   *arg,
+                       char   *buf,
+                       size_t  len,
+                       int     eom)
+{
+    int                   retval = -1;
+    struct forward_state *fs = (struct forward_state *)arg;
+    cbuf                 *cb = NULL;
+
+    if (fs->fs_started){
+        if (netconf_forward_write(fs, buf, len) < 0)
+            goto done;
+    }
+    else {
+        cbuf_append_buf(fs->fs_head, buf, len);
+        if (netconf_forward_envelope(fs, eom) < 0)
+            goto done;
+    }
+    if (eom){
+        if ((cb = cbuf_new()) == NULL){
+            clixon_err(OE_XML, errno, "cbuf_new");
+            goto done;
+        }
+        if (netconf_framing_postamble(fs->fs_framing, cb) < 0)
+            goto done;
+        if (netconf_write_all(1, cbuf_get(cb), cbuf_len(cb)) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Forward netconf RPC to backend and write the reply to stdout without parsing it
+ *
+ * Only the reply envelope is inspected: attributes of the <rpc> element that are not already
+ * present are added to the <rpc-reply> start tag. The rest of the reply is written as is,
+ * with only output framing added. The reply is written in parts as it is read from the
+ * backend socket, with one chunk per part if chunked framing, and is not held in memory.
+ * @param[in]   h        Clixon handle
+ * @param[in]   xrpc     Incoming message on the form <rpc>...
+ * @param[in]   framing  Output framing
+ * @retval      1        Forwarded
+ * @retval      0        Not forwarded, handle in frontend
+ * @retval     -1        Error
+ * @see CLICON_NETCONF_FORWARD
+ * @see netconf_add_request_attr  for the parsed case
+ */
+static int
+netconf_rpc_forward(clixon_handle        h,
+                    cxobj               *xrpc,
+                    netconf_framing_type framing)
+{
+    int                  retval = -1;
+    cxobj               *xe;
+    cxobj               *xa;
+    cbuf                *cb = NULL;
+    char                *username;
+    struct forward_state fs = {0,};
+
+    if (!clicon_option_bool(h, "CLICON_NETCONF_FORWARD"))
+        return 0;
+    if ((xe = xml_child_i_type(xrpc, 0, CX_ELMNT)) == NULL ||
+        !netconf_rpc_forwardable(xe))
+        return 0;
+    if ((cb = cbuf_new()) == NULL ||
+        (fs.fs_head = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    fs.fs_xrpc = xrpc;
+    fs.fs_framing = framing;
+    /* Tag username as in netconf_rpc_dispatch */
+    if ((username = clicon_username_get(h)) != NULL){
+        if (xml_add_attr(xrpc, "username", username, CLIXON_LIB_PREFIX, CLIXON_LIB_NS) == NULL)
+            goto done;
+    }
+    if (clixon_xml2cbuf(cb, xrpc, 0, 0, NULL, -1, 0) < 0)
+        goto done;
+    if ((xa = xml_find(xrpc, "username")) != NULL)
+        xml_purge(xa);
+    if (clicon_rpc_netconf_stream(h, cbuf_get(cb), netconf_rpc_forward_cb, &fs) < 0)
+        goto done;
+    retval = 1;
+ done:
+    if (fs.fs_head)
+        cbuf_free(fs.fs_head);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
 /*! Process incoming Netconf RPC netconf message 
  *
  * @param[in]   h     Clixon handle
@@ -264,6 +553,10 @@ netconf_rpc_message(clixon_handle h,
             goto done;
         goto ok;
     }
+    if ((ret = netconf_rpc_forward(h, xrpc, framing)) < 0)
+        goto done;
+    if (ret == 1)
+        goto ok;
     if (netconf_rpc_dispatch(h, xrpc, &xret, eof) < 0)
         goto done;
 
@@ -584,6 +877,7 @@ netconf_terminate(clixon_handle h)
     /* Delete all plugins, and RPC callbacks */
     clixon_plugin_module_exit(h);
     clicon_rpc_close_session(h);
+    xmldb_replica_free(h);
     if ((yspec = clicon_dbspec_yang(h)) != NULL)
         ys_free(yspec);
     if ((yspec = clicon_config_yang(h)) != NULL)
@@ -593,6 +887,7 @@ netconf_terminate(clixon_handle h)
     if ((x = clicon_conf_xml(h)) != NULL)
         xml_free(x);
     xpath_optimize_exit();
+    xpath_profile_exit();
     clixon_event_exit();
     clixon_handle_exit(h);
     clixon_err_exit();
@@ -843,6 +1138,9 @@ main(int    argc,
 
     if ((sz = clicon_option_int(h, "CLICON_LOG_STRING_LIMIT")) != 0)
         clixon_log_string_limit_set(sz);
+    xpath_profile_set(clicon_option_bool(h, "CLICON_XPATH_PROFILE"),
+                      clicon_option_int(h, "CLICON_XPATH_SLOW_THRESHOLD"));
+    clixon_event_watchdog_set(clicon_option_int(h, "CLICON_EVENT_WATCHDOG"));
 
     /* Set default namespace according to CLICON_NAMESPACE_NETCONF_DEFAULT */
     xml_nsctx_namespace_netconf_default(h);
@@ -219,7 +219,7 @@ restconf_reply_send(void  *req0,
     /* Write a body if cbuf is nonzero */
     if (cb != NULL){
         if (!head && cbuf_len(cb)){
-            FCGX_FPrintF(req->out, "%s", cbuf_get(cb));
+            FCGX_PutStr(cbuf_get(cb), cbuf_len(cb), req->out);
             FCGX_FPrintF(req->out, "\r\n");
         }
         cbuf_free(cb);
@@ -247,6 +247,9 @@ restconf_get_indata(void *req0)
     if ((cb = cbuf_new()) == NULL)
         return NULL;
     while ((c = FCGX_GetChar(req->in)) != -1)
-        cprintf(cb, "%c", c);
+        if (cbuf_append(cb, c) < 0){
+            cbuf_free(cb);
+            return NULL;
+        }
     return cb;
 }
@@ -317,6 +317,15 @@ api_return_err(clixon_handle  h,
             cprintf(cb, "}\r\n");
         }
         break;
+    case YANG_DATA_CBOR:
+        clixon_debug(CLIXON_DBG_RESTCONF, "code:%d", code);
+        if (clixon_cbor_head(cb, CBOR_MAP, 1) < 0)
+            goto done;
+        if (clixon_cbor_text(cb, "ietf-restconf:errors") < 0)
+            goto done;
+        if (clixon_cbor2cbuf(cb, xerr, 0) < 0)
+            goto done;
+        break;
     default: /* Just ignore the body so that there is a reply */
         clixon_err(OE_YANG, EINVAL, "Invalid media type %d", media);
         goto done;
@@ -96,6 +96,21 @@ struct restconf_handle {
     int                      rh_pretty;      /* pretty-print for http replies */
     int                      rh_http_data;   /* enable-http-data (and if-feature http-data) */
     char                    *rh_fcgi_socket; /* if-feature fcgi, XXX: use WITH_RESTCONF_FCGI ? */
+    clicon_hash_t           *rh_auth_cache;  /* authentication cache, see CLICON_RESTCONF_AUTH_CACHE_TTL */
+    uint64_t                 rh_auth_hits;   /* authentication cache hits */
+    uint64_t                 rh_auth_misses; /* authentication cache misses */
+    size_t                   rh_auth_count;  /* number of entries in authentication cache */
+    uint64_t                 rh_auth_gen;    /* config generation when cache was last flushed */
+};
+
+/*! Authentication cache entry, value of rh_auth_cache
+ *
+ * Username is stored inline after the expiry time
+ */
+struct restconf_auth_entry {
+    struct timeval ae_expire;                  /* Entry is not valid after this time */
+    uint8_t        ae_cred[SHA256_DIGEST_LEN]; /* SHA-256 of presented credentials */
+    char           ae_user[];                  /* Authenticated username, null-terminated */
 };
 
 /*! Creates and returns a clicon config handle for other CLICON API calls
@@ -122,6 +137,10 @@ restconf_handle_exit(clixon_handle h)
 
     if (rh->rh_fcgi_socket)
         free(rh->rh_fcgi_socket);
+    clixon_debug(CLIXON_DBG_RESTCONF, "auth cache hits:%" PRIu64 " misses:%" PRIu64,
+                 rh->rh_auth_hits, rh->rh_auth_misses);
+    if (rh->rh_auth_cache)
+        clicon_hash_free(rh->rh_auth_cache);
     clixon_handle_exit(h); /* frees h and options (and streams) */
     return 0;
 }
@@ -317,3 +336,174 @@ restconf_fcgi_socket_set(clixon_handle h,
     }
     return 0;
 }
+
+/*! Look up authenticated user in restconf authentication cache
+ *
+ * A hit requires the presented credentials to be exactly those of the cached entry
+ * @param[in]  h     Clixon handle
+ * @param[in]  key   Cache key, connection identity
+ * @param[in]  cred  SHA-256 of presented credentials
+ * @param[out] user  Username, pointer into cache, do not free. Valid until next cache update
+ * @retval     1     Hit, user set
+ * @retval     0     Miss, entry expired, or other credentials
+ * @see restconf_auth_cache_add
+ */
+int
+restconf_auth_cache_get(clixon_handle  h,
+                        const char    *key,
+                        const uint8_t *cred,
+                        char         **user)
+{
+    struct restconf_handle     *rh = handle(h);
+    struct restconf_auth_entry *ae;
+    struct timeval              now;
+
+    if (rh->rh_auth_cache != NULL &&
+        (ae = clicon_hash_value(rh->rh_auth_cache, key, NULL)) != NULL){
+        if (memcmp(ae->ae_cred, cred, SHA256_DIGEST_LEN) != 0){
+            /* Entry is replaced if the new credentials are authenticated */
+            rh->rh_auth_misses++;
+            return 0;
+        }
+        gettimeofday(&now, NULL);
+        if (timercmp(&now, &ae->ae_expire, <)){
+            rh->rh_auth_hits++;
+            *user = ae->ae_user;
+            return 1;
+        }
+        /* Expired entries are removed lazily when looked up */
+        clicon_hash_del(rh->rh_auth_cache, key);
+        rh->rh_auth_count--;
+    }
+    rh->rh_auth_misses++;
+    return 0;
+}
+
+/*! Add authenticated user to restconf authentication cache
+ *
+ * If the cache is full, the whole cache is flushed. Expired entries are removed when looked
+ * up, so a full cache is not scanned on each add.
+ * @param[in]  h     Clixon handle
+ * @param[in]  key   Cache key, connection identity
+ * @param[in]  cred  SHA-256 of authenticated credentials
+ * @param[in]  user  Authenticated username
+ * @param[in]  ttl   Time-to-live of entry in seconds
+ * @param[in]  size  Max number of entries in cache
+ * @retval     0     OK
+ * @retval    -1    Error
+ */
+int
+restconf_auth_cache_add(clixon_handle  h,
+                        const char    *key,
+                        const uint8_t *cred,
+                        const char    *user,
+                        int            ttl,
+                        int            size)
+{
+    int                         retval = -1;
+    struct restconf_handle     *rh = handle(h);
+    struct restconf_auth_entry *ae = NULL;
+    size_t                      len;
+    struct timeval              now;
+    struct timeval              t;
+
+    if (rh->rh_auth_count >= (size_t)size){
+        clixon_debug(CLIXON_DBG_RESTCONF, "auth cache full, flush");
+        if (restconf_auth_cache_flush(h) < 0)
+            goto done;
+    }
+    if (rh->rh_auth_cache == NULL)
+        if ((rh->rh_auth_cache = clicon_hash_init()) == NULL)
+            goto done;
+    gettimeofday(&now, NULL);
+    len = sizeof(*ae) + strlen(user) + 1;
+    if ((ae = malloc(len)) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(ae, 0, len);
+    t.tv_sec = ttl;
+    t.tv_usec = 0;
+    timeradd(&now, &t, &ae->ae_expire);
+    memcpy(ae->ae_cred, cred, SHA256_DIGEST_LEN);
+    strcpy(ae->ae_user, user);
+    if (clicon_hash_value(rh->rh_auth_cache, key, NULL) == NULL)
+        rh->rh_auth_count++;
+    if (clicon_hash_add(rh->rh_auth_cache, key, ae, len) == NULL)
+        goto done;
+    retval = 0;
+ done:
+    if (ae)
+        free(ae);
+    return retval;
+}
+
+/*! Flush restconf authentication cache
+ *
+ * Called when authentication data may have changed, such as NACM users and groups.
+ * Plugins that maintain their own user database may also call this function.
+ * @param[in]  h     Clixon handle
+ * @retval     0     OK
+ * @retval    -1    Error
+ */
+int
+restconf_auth_cache_flush(clixon_handle h)
+{
+    struct restconf_handle *rh = handle(h);
+
+    if (rh->rh_auth_cache != NULL){
+        if (clicon_hash_free(rh->rh_auth_cache) < 0)
+            return -1;
+        rh->rh_auth_cache = NULL;
+    }
+    rh->rh_auth_count = 0;
+    return 0;
+}
+
+/*! Flush restconf authentication cache if config generation has changed
+ *
+ * NACM users and groups may be changed by any frontend. Every change of running gives
+ * a new generation, in which case the cache is flushed.
+ * @param[in]  h     Clixon handle
+ * @param[in]  gen   Current config generation
+ * @retval     0     OK
+ * @retval    -1    Error
+ * @see xmldb_replica_gen
+ */
+int
+restconf_auth_cache_gen(clixon_handle h,
+                        uint64_t      gen)
+{
+    struct restconf_handle *rh = handle(h);
+
+    if (gen == rh->rh_auth_gen)
+        return 0;
+    clixon_debug(CLIXON_DBG_RESTCONF, "config generation %" PRIu64 ", auth cache flush", gen);
+    rh->rh_auth_gen = gen;
+    return restconf_auth_cache_flush(h);
+}
+
+/*! Get restconf authentication cache statistics
+ *
+ * @param[in]  h       Clixon handle
+ * @param[out] hits    Number of cache hits
+ * @param[out] misses  Number of cache misses
+ * @param[out] entries Number of entries in cache, including expired not yet removed
+ * @retval     0       OK
+ */
+int
+restconf_auth_cache_stats(clixon_handle h,
+                          uint64_t     *hits,
+                          uint64_t     *misses,
+                          size_t       *entries)
+{
+    struct restconf_handle *rh = handle(h);
+
+    if (hits)
+        *hits = rh->rh_auth_hits;
+    if (misses)
+        *misses = rh->rh_auth_misses;
+    if (entries)
+        *entries = rh->rh_auth_count;
+    return 0;
+}
@@ -55,5 +55,10 @@ int           restconf_http_data_get(clixon_handle h);
 int           restconf_http_data_set(clixon_handle h, int http_data);
 char         *restconf_fcgi_socket_get(clixon_handle h);
 int           restconf_fcgi_socket_set(clixon_handle h, char *socketpath);
+int           restconf_auth_cache_get(clixon_handle h, const char *key, const uint8_t *cred, char **user);
+int           restconf_auth_cache_add(clixon_handle h, const char *key, const uint8_t *cred, const char *user, int ttl, int size);
+int           restconf_auth_cache_flush(clixon_handle h);
+int           restconf_auth_cache_gen(clixon_handle h, uint64_t gen);
+int           restconf_auth_cache_stats(clixon_handle h, uint64_t *hits, uint64_t *misses, size_t *entries);
 
 #endif  /* _RESTCONF_HANDLE_H_ */
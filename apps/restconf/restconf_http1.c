@@ -361,6 +361,7 @@ restconf_http1_path_root(clixon_handle  h,
     char                 *subject = NULL;
     cxobj                *xerr = NULL;
     int                   pretty;
+    char                  idstr[32];
 #ifdef HAVE_LIBNGHTTP2
     int                   ret;
 #endif
@@ -405,6 +406,10 @@ restconf_http1_path_root(clixon_handle  h,
         rc->rc_proto = HTTP_10;
     else if (rc->rc_proto_d2 == 1 && rc->rc_proto != HTTP_10)
         rc->rc_proto = HTTP_11;
+    /* Connection identity, used as key in authentication cache */
+    snprintf(idstr, sizeof(idstr), "%lu", rc->rc_id);
+    if (restconf_param_set(h, "CONNECTION_ID", idstr) < 0)
+        goto done;
     if (rc->rc_ssl != NULL){
         /* Slightly awkward way of taking SSL cert subject and CN and add it to restconf parameters
          * instead of accessing it directly 
@@ -504,6 +509,42 @@ http1_check_expect(clixon_handle         h,
     return retval;
 }
 
+/*! Replace parsed body with raw body bytes following the message header
+ *
+ * The http1 parser operates on strings and truncates a body at the first NUL character,
+ * which breaks binary bodies such as application/yang-data+cbor
+ * @param[in] h   Clixon handle
+ * @param[in] sd  Restconf stream data (for http1 only stream 0)
+ * @retval    0   OK
+ * @retval   -1   Error
+ */
+int
+http1_body_raw(clixon_handle         h,
+               restconf_stream_data *sd)
+{
+    int    retval = -1;
+    char  *buf;
+    size_t len;
+    size_t i;
+
+    buf = cbuf_get(sd->sd_inbuf);
+    len = cbuf_len(sd->sd_inbuf);
+    for (i=0; i+3<len; i++)
+        if (memcmp(&buf[i], "\r\n\r\n", 4) == 0)
+            break;
+    if (i+3 < len){
+        i += 4;
+        cbuf_reset(sd->sd_indata);
+        if (cbuf_append_buf(sd->sd_indata, &buf[i], len-i) < 0){
+            clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+            goto done;
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Is there more data to be read?
  *
  * Use Content-Length header as an indicator on the status of reading an input message:
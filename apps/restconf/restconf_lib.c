@@ -43,6 +43,7 @@
 #endif
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
@@ -208,6 +209,7 @@ static const map_str2int http_media_map[] = {
     {"application/yang-patch+xml",       YANG_PATCH_XML},
     {"application/yang-patch+json",      YANG_PATCH_JSON},
     {"application/yang-data+xml-list",  YANG_PAGINATION_XML},  /* draft-wwlh-netconf-list-pagination-rc-02 */
+    {"application/yang-data+cbor",       YANG_DATA_CBOR},       /* RFC 9254 */
     {NULL,                            -1}
 };
 
@@ -367,6 +369,7 @@ restconf_terminate(clixon_handle h)
     clixon_plugin_module_exit(h);
 
     clicon_rpc_close_session(h);
+    xmldb_replica_free(h);
     if ((yspec = clicon_dbspec_yang(h)) != NULL)
         ys_free(yspec);
     if ((yspec = clicon_config_yang(h)) != NULL)
@@ -376,6 +379,7 @@ restconf_terminate(clixon_handle h)
     if ((x = clicon_conf_xml(h)) != NULL)
         xml_free(x);
     xpath_optimize_exit();
+    xpath_profile_exit();
     clixon_err_exit();
     clixon_debug(CLIXON_DBG_RESTCONF, "pid:%u done", getpid());
     restconf_handle_exit(h);
@@ -647,6 +651,74 @@ restconf_drop_privileges(clixon_handle h)
     return retval;
 }
 
+/*! Check if current request is a write that may change NACM users and groups
+ *
+ * Such a request does not use the authentication cache, and flushes it once the request
+ * is authenticated.
+ * @param[in]  h         Clixon handle
+ * @retval     1         Write of NACM or of data root
+ * @retval     0         Other request
+ */
+static int
+restconf_auth_cache_nacm_write(clixon_handle h)
+{
+    char *method;
+    char *uri;
+
+    method = restconf_param_get(h, "REQUEST_METHOD");
+    uri = restconf_param_get(h, "REQUEST_URI");
+    return method != NULL && uri != NULL &&
+        strcmp(method, "GET") != 0 && strcmp(method, "HEAD") != 0 && strcmp(method, "OPTIONS") != 0 &&
+        (strstr(uri, "ietf-netconf-acm") != NULL ||
+         strcmp(uri, "/restconf/data") == 0 || strncmp(uri, "/restconf/data?", 15) == 0);
+}
+
+/*! Compute authentication cache key and credential digest of current request
+ *
+ * Key is connection identity and authentication type. Native restconf sets
+ * CONNECTION_ID, fcgi uses remote address and port.
+ * The credential digest is a SHA-256 of the presented credentials (authorization header
+ * and client cert CN), which must match exactly for a cache hit.
+ * @param[in]  h         Clixon handle
+ * @param[in]  auth_type Authentication type
+ * @param[in]  cb        Key is written here
+ * @param[out] cred      SHA-256 of presented credentials
+ * @retval     1         OK, request may use cache
+ * @retval     0         Request has no connection identity, do not use cache
+ */
+static int
+restconf_auth_cache_key(clixon_handle      h,
+                        clixon_auth_type_t auth_type,
+                        cbuf              *cb,
+                        uint8_t           *cred)
+{
+    clixon_sha256_ctx ctx;
+    char             *conn;
+    char             *port;
+    char             *str[2];
+    uint8_t           present;
+    int               i;
+
+    if ((conn = restconf_param_get(h, "CONNECTION_ID")) != NULL)
+        cprintf(cb, "%s", conn);
+    else if ((conn = restconf_param_get(h, "REMOTE_ADDR")) != NULL &&
+             (port = restconf_param_get(h, "REMOTE_PORT")) != NULL)
+        cprintf(cb, "%s:%s", conn, port);
+    else
+        return 0;
+    cprintf(cb, "/%d", auth_type);
+    str[0] = restconf_param_get(h, "HTTP_AUTHORIZATION");
+    str[1] = restconf_param_get(h, "SSL_CN");
+    clixon_sha256_init(&ctx);
+    for (i=0; i<2; i++){
+        present = str[i] != NULL;
+        clixon_sha256_update(&ctx, &present, 1);
+        clixon_sha256_field(&ctx, str[i], str[i] ? strlen(str[i]) : 0);
+    }
+    clixon_sha256_final(&ctx, cred);
+    return 1;
+}
+
 /*! restconf auth cb
  *
  * @param[in]  h         Clixon handle
@@ -671,11 +743,45 @@ restconf_authentication_cb(clixon_handle  h,
     cxobj             *xret = NULL;
     cxobj             *xerr;
     char              *anonymous = NULL;
+    int                ttl;
+    cbuf              *cbkey = NULL;
+    uint8_t            cred[SHA256_DIGEST_LEN];
+    char              *cached;
+    int                nacmwrite = 0;
+    uint64_t           gen;
 
     auth_type = restconf_auth_type_get(h);
     clixon_debug(CLIXON_DBG_RESTCONF, "auth-type:%s", clixon_auth_type_int2str(auth_type));
     ret = 0;
     authenticated = 0;
+    if ((ttl = clicon_option_int(h, "CLICON_RESTCONF_AUTH_CACHE_TTL")) > 0){
+        if ((cbkey = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        /* Flush if running, including NACM, has been changed by any frontend */
+        if (xmldb_replica_gen(h, &gen) == 1 &&
+            restconf_auth_cache_gen(h, gen) < 0)
+            goto done;
+        /* A write that may change NACM users and groups does not use the cache */
+        if ((nacmwrite = restconf_auth_cache_nacm_write(h)) == 1)
+            ret = 0;
+        else
+            ret = restconf_auth_cache_key(h, auth_type, cbkey, cred);
+        if (ret == 0){
+            cbuf_free(cbkey);
+            cbkey = NULL;
+        }
+        else if (restconf_auth_cache_get(h, cbuf_get(cbkey), cred, &cached) == 1){
+            clixon_debug(CLIXON_DBG_RESTCONF, "auth cache hit: %s", cached);
+            clicon_username_set(h, cached);
+            authenticated = 1;
+            retval = 1;
+            goto done;
+        }
+        else
+            clixon_debug(CLIXON_DBG_RESTCONF, "auth cache miss");
+    }
     /* ret: -1 Error, 0: Ignore/not handled, 1: OK see authenticated parameter */
     if ((ret = clixon_plugin_auth_all(h, req,
                                       auth_type,
@@ -722,11 +828,23 @@ restconf_authentication_cb(clixon_handle  h,
         retval = 0;
         goto notauth;
     }
+    /* Flush only after authentication, unauthenticated requests cannot flush the cache */
+    if (nacmwrite){
+        clixon_debug(CLIXON_DBG_RESTCONF, "auth cache flush");
+        if (restconf_auth_cache_flush(h) < 0)
+            goto done;
+    }
+    if (cbkey != NULL && clicon_username_get(h) != NULL)
+        if (restconf_auth_cache_add(h, cbuf_get(cbkey), cred, clicon_username_get(h), ttl,
+                                    clicon_option_int(h, "CLICON_RESTCONF_AUTH_CACHE_SIZE")) < 0)
+            goto done;
     /* If set but no user, set a dummy user */
     retval = 1;
  done:
     clixon_debug(CLIXON_DBG_RESTCONF, "retval:%d authenticated:%d user:%s",
                  retval, authenticated, clicon_username_get(h));
+    if (cbkey)
+        cbuf_free(cbkey);
     if (username)
         free(username);
     if (xret)
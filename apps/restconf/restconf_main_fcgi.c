@@ -474,6 +474,8 @@ main(int    argc,
 
     if ((sz = clicon_option_int(h, "CLIXON_LOG_STRING_LIMIT")) != 0)
         clixon_log_string_limit_set(sz);
+    xpath_profile_set(clicon_option_bool(h, "CLICON_XPATH_PROFILE"),
+                      clicon_option_int(h, "CLICON_XPATH_SLOW_THRESHOLD"));
 
     /* Set default namespace according to CLICON_NAMESPACE_NETCONF_DEFAULT */
     xml_nsctx_namespace_netconf_default(h);
@@ -946,6 +946,9 @@ restconf_clixon_init(clixon_handle h,
 
     if ((sz = clicon_option_int(h, "CLICON_LOG_STRING_LIMIT")) != 0)
         clixon_log_string_limit_set(sz);
+    xpath_profile_set(clicon_option_bool(h, "CLICON_XPATH_PROFILE"),
+                      clicon_option_int(h, "CLICON_XPATH_SLOW_THRESHOLD"));
+    clixon_event_watchdog_set(clicon_option_int(h, "CLICON_EVENT_WATCHDOG"));
 
     /* Add (hardcoded) netconf features in case ietf-netconf loaded here
      * Otherwise it is loaded in netconf_module_load below
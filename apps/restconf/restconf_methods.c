@@ -186,6 +186,8 @@ match_list_keys(yang_stmt *y,
  * PUT:   If it does not, set op to create, otherwise replace
  * PATCH: If it does not, fail, otherwise replace/merge
  * @param[in] plain_patch  fail if object does not exists AND merge (not replace)
+ * @param[in]  data     Stream input data
+ * @param[in]  datalen  Length of data, CBOR input may contain null bytes
  * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
  * @param[in]  pretty    Pretty-print
  * @param[in]  media_in  Restconf input media
@@ -200,6 +202,7 @@ api_data_write(clixon_handle h,
                int           pi,
                cvec         *qvec,
                char         *data,
+               size_t        datalen,
                int           pretty,
                restconf_media media_in,
                restconf_media media_out,
@@ -281,7 +284,7 @@ api_data_write(clixon_handle h,
     /* 4.4.1: The message-body MUST contain exactly one instance of the
      * expected data resource.  (tested again below)
      */
-    if (data == NULL || strlen(data) == 0){
+    if (data == NULL || datalen == 0){
         if (netconf_malformed_message_xml(&xerr, "The message-body MUST contain exactly one instance of the expected data resource") < 0)
             goto done;
         if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
@@ -354,6 +357,20 @@ api_data_write(clixon_handle h,
             goto ok;
         }
         break;
+    case YANG_DATA_CBOR:
+        if ((ret = clixon_cbor_parse_buf(data, datalen, yb, yspec, &xdata0, &xerr)) < 0){
+            if (netconf_malformed_message_xml(&xerr, clixon_err_reason()) < 0)
+                goto done;
+            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+                goto done;
+            goto ok;
+        }
+        if (ret == 0){
+            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+                goto done;
+            goto ok;
+        }
+        break;
     default:
         restconf_unsupported_media(h, req, pretty, media_out);
         goto ok;
@@ -590,6 +607,7 @@ api_data_write(clixon_handle h,
  * @param[in]  pi       Offset, where to start pcvec
  * @param[in]  qvec     Vector of query string (QUERY_STRING)
  * @param[in]  data     Stream input data
+ * @param[in]  datalen  Length of data
  * @param[in]  pretty   Set to 1 for pretty-printed xml/json output
  * @param[in]  media_out Output media
  * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
@@ -626,6 +644,7 @@ api_data_put(clixon_handle h,
              int           pi,
              cvec         *qvec,
              char         *data,
+             size_t        datalen,
              int           pretty,
              restconf_media media_out,
              ietf_ds_t     ds)
@@ -633,7 +652,7 @@ api_data_put(clixon_handle h,
     restconf_media media_in;
 
     media_in = restconf_content_type(h);
-    return api_data_write(h, req, api_path0, pi, qvec, data, pretty,
+    return api_data_write(h, req, api_path0, pi, qvec, data, datalen, pretty,
                           media_in, media_out, 0, ds);
 }
 
@@ -645,6 +664,7 @@ api_data_put(clixon_handle h,
  * @param[in]  pi       Offset, where to start qvec
  * @param[in]  qvec     Vector of query string (QUERY_STRING)
  * @param[in]  data     Stream input data
+ * @param[in]  datalen  Length of data
  * @param[in]  pretty   Set to 1 for pretty-printed xml/json output
  * @param[in]  media_out Output media
  * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
@@ -664,6 +684,7 @@ api_data_patch(clixon_handle h,
                int           pi,
                cvec         *qvec,
                char         *data,
+               size_t        datalen,
                int           pretty,
                restconf_media media_out,
                ietf_ds_t     ds)
@@ -675,7 +696,8 @@ api_data_patch(clixon_handle h,
     switch (media_in){
     case YANG_DATA_XML:
     case YANG_DATA_JSON:        /* plain patch */
-        ret = api_data_write(h, req, api_path0, pi, qvec, data, pretty,
+    case YANG_DATA_CBOR:
+        ret = api_data_write(h, req, api_path0, pi, qvec, data, datalen, pretty,
                              media_in, media_out, 1, ds);
         break;
     case YANG_PATCH_JSON:       /* RFC 8072 patch */
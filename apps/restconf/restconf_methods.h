@@ -44,18 +44,18 @@
 int api_data_options(clixon_handle h, void *req);
 int api_data_write(clixon_handle h, void *req, char *api_path0,
                    int pi,
-                   cvec *qvec, char *data,
+                   cvec *qvec, char *data, size_t datalen,
                    int pretty, restconf_media media_in, restconf_media media_out,
                    int plain_patch, ietf_ds_t ds);
 
 int api_data_put(clixon_handle h, void *req, char *api_path,
                  int pi,
-                 cvec *qvec, char *data,
+                 cvec *qvec, char *data, size_t datalen,
                  int pretty, restconf_media media_out, ietf_ds_t ds);
 
 int api_data_patch(clixon_handle h, void *req, char *api_path,
                    int pi,
-                   cvec *qvec, char *data, int pretty,
+                   cvec *qvec, char *data, size_t datalen, int pretty,
                    restconf_media media_out, ietf_ds_t ds);
 
 int api_data_delete(clixon_handle h, void *req, char *api_path, int pi,
@@ -240,6 +240,10 @@ api_data_get2(clixon_handle  h,
             if (clixon_json2cbuf(cbx, xret, pretty, 0, 0) < 0)
                 goto done;
             break;
+        case YANG_DATA_CBOR:
+            if (clixon_cbor2cbuf(cbx, xret, 0) < 0)
+                goto done;
+            break;
         default:
             break;
         }
@@ -288,11 +292,15 @@ api_data_get2(clixon_handle  h,
             if (xml2json_cbuf_vec(cbx, xvec, xlen, pretty, 0) < 0)
                 goto done;
             break;
+        case YANG_DATA_CBOR:
+            if (clixon_cbor2cbuf_vec(cbx, xvec, xlen) < 0)
+                goto done;
+            break;
         default:
             break;
         }
     }
-    clixon_debug(CLIXON_DBG_RESTCONF, "cbuf:%s", cbuf_get(cbx));
+    clixon_debug(CLIXON_DBG_RESTCONF, "cbuf len:%zu", cbuf_len(cbx));
     if (restconf_reply_header(req, "Content-Type", "%s", restconf_media_int2str(media_out)) < 0)
         goto done;
     if (restconf_reply_header(req, "Cache-Control", "no-cache") < 0)
@@ -659,6 +667,7 @@ api_data_get(clixon_handle h,
     switch (media_out){
     case YANG_DATA_XML:
     case YANG_DATA_JSON: /* ad-hoc algorithm in get to determine if a paginated request */
+    case YANG_DATA_CBOR:
         if (api_data_get2(h, req, api_path, pi, qvec, pretty, media_out, 0) < 0)
             goto done;
         break;
@@ -715,6 +724,7 @@ api_operations_get(clixon_handle h,
     yang_stmt *yc;
     char      *namespace;
     cbuf      *cbx = NULL;
+    cbuf      *cbn = NULL;
     cxobj     *xt = NULL;
     int        i;
 
@@ -722,6 +732,8 @@ api_operations_get(clixon_handle h,
     yspec = clicon_dbspec_yang(h);
     if ((cbx = cbuf_new()) == NULL)
         goto done;
+    if ((cbn = cbuf_new()) == NULL)
+        goto done;
     switch (media_out){
     case YANG_DATA_XML:
         cprintf(cbx, "<operations>");
@@ -758,6 +770,17 @@ api_operations_get(clixon_handle h,
                 else
                     cprintf(cbx, "\"%s:%s\":[null]", yang_argument_get(ymod), yang_argument_get(yc));
                 break;
+            case YANG_DATA_CBOR: /* Members only, map head is added last */
+                i++;
+                cbuf_reset(cbn);
+                cprintf(cbn, "%s:%s", yang_argument_get(ymod), yang_argument_get(yc));
+                if (clixon_cbor_text(cbx, cbuf_get(cbn)) < 0)
+                    goto done;
+                if (clixon_cbor_head(cbx, CBOR_ARRAY, 1) < 0)
+                    goto done;
+                if (clixon_cbor_head(cbx, CBOR_SIMPLE, CBOR_NULL) < 0)
+                    goto done;
+                break;
             default:
                 break;
             }
@@ -773,6 +796,22 @@ api_operations_get(clixon_handle h,
         else
             cprintf(cbx, "}}");
         break;
+    case YANG_DATA_CBOR:
+        cbuf_reset(cbn);
+        if (clixon_cbor_head(cbn, CBOR_MAP, 1) < 0)
+            goto done;
+        if (clixon_cbor_text(cbn, "operations") < 0)
+            goto done;
+        if (clixon_cbor_head(cbn, CBOR_MAP, i) < 0)
+            goto done;
+        if (cbuf_append_buf(cbn, cbuf_get(cbx), cbuf_len(cbx)) < 0){
+            clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+            goto done;
+        }
+        cbuf_free(cbx);
+        cbx = cbn;
+        cbn = NULL;
+        break;
     default:
         break;
     }
@@ -789,6 +828,8 @@ api_operations_get(clixon_handle h,
     clixon_debug(CLIXON_DBG_RESTCONF, "retval:%d", retval);
     if (cbx)
         cbuf_free(cbx);
+    if (cbn)
+        cbuf_free(cbn);
     if (xt)
         xml_free(xt);
     return retval;
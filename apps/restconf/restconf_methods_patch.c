@@ -275,7 +275,7 @@ yang_patch_do_replace(clixon_handle  h,
         goto done;
 
     // Send the POST request
-    if (api_data_post(h, req, cbuf_get(simple_patch_request_uri), pi, qvec, cbuf_get(json_simple_patch), pretty, YANG_DATA_JSON, media_out, ds ) < 0)
+    if (api_data_post(h, req, cbuf_get(simple_patch_request_uri), pi, qvec, cbuf_get(json_simple_patch), cbuf_len(json_simple_patch), pretty, YANG_DATA_JSON, media_out, ds ) < 0)
         goto done;
     retval = 0;
  done:
@@ -340,7 +340,7 @@ yang_patch_do_create(clixon_handle  h,
         goto done;
     if (api_data_post(h, req, cbuf_get(simple_patch_request_uri),
                       pi, qvec,
-                      cbuf_get(cb), pretty, YANG_DATA_JSON, media_out, ds) < 0)
+                      cbuf_get(cb), cbuf_len(cb), pretty, YANG_DATA_JSON, media_out, ds) < 0)
         goto done;
      retval = 0;
  done:
@@ -427,7 +427,7 @@ yang_patch_do_insert(clixon_handle  h,
     cv_string_set(cv, cbuf_get(point_str));
 
     // Send the POST request
-    if (api_data_post(h, req, cbuf_get(simple_patch_request_uri), pi, qvec_tmp, cbuf_get(json_simple_patch), pretty, YANG_DATA_JSON, media_out, ds)<  0)
+    if (api_data_post(h, req, cbuf_get(simple_patch_request_uri), pi, qvec_tmp, cbuf_get(json_simple_patch), cbuf_len(json_simple_patch), pretty, YANG_DATA_JSON, media_out, ds)<  0)
         goto done;
     retval = 0;
  done:
@@ -498,7 +498,7 @@ yang_patch_do_merge(clixon_handle  h,
         if ((json_simple_patch = yang_patch_xml2json_modified_cbuf(x_simple_patch)) == NULL)
             goto done;
         // Send the simple patch request
-        if (api_data_write(h, req, cbuf_get(simple_patch_request_uri), pi, qvec, cbuf_get(json_simple_patch), pretty, YANG_DATA_JSON, media_out, 1, ds ) < 0)
+        if (api_data_write(h, req, cbuf_get(simple_patch_request_uri), pi, qvec, cbuf_get(json_simple_patch), cbuf_len(json_simple_patch), pretty, YANG_DATA_JSON, media_out, 1, ds ) < 0)
             goto done;
         if (json_simple_patch){
             cbuf_free(json_simple_patch);
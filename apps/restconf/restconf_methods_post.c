@@ -50,6 +50,8 @@
 #include <time.h>
 #include <signal.h>
 #include <limits.h>
+#include <stdint.h>
+#include <inttypes.h>
 #include <sys/time.h>
 #include <sys/wait.h>
 
@@ -127,6 +129,7 @@ http_location_header(clixon_handle h,
  * @param[in]  pi       Offset, where to start pcvec
  * @param[in]  qvec     Vector of query string (QUERY_STRING)
  * @param[in]  data     Stream input data
+ * @param[in]  datalen  Length of data, CBOR input may contain null bytes
  * @param[in]  pretty   Set to 1 for pretty-printed xml/json output
  * @param[in]  media_out Output media
  * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
@@ -161,6 +164,7 @@ api_data_post(clixon_handle h,
               int           pi,
               cvec         *qvec,
               char         *data,
+              size_t        datalen,
               int           pretty,
               restconf_media media_in,
               restconf_media media_out,
@@ -215,7 +219,7 @@ api_data_post(clixon_handle h,
     /* 4.4.1: The message-body MUST contain exactly one instance of the
      * expected data resource.  (tested again below)
      */
-    if (data == NULL || strlen(data) == 0){
+    if (data == NULL || datalen == 0){
         if (netconf_malformed_message_xml(&xerr, "The message-body of POST MUST contain exactly one instance of the expected data resource") < 0)
             goto done;
         if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
@@ -267,6 +271,20 @@ api_data_post(clixon_handle h,
             goto ok;
         }
         break;
+    case YANG_DATA_CBOR:
+        if ((ret = clixon_cbor_parse_buf(data, datalen, yb, yspec, &xbot, &xerr)) < 0){
+            if (netconf_malformed_message_xml(&xerr, clixon_err_reason()) < 0)
+                goto done;
+            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+                goto done;
+            goto ok;
+        }
+        if (ret == 0){
+            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+                goto done;
+            goto ok;
+        }
+        break;
     default:
         restconf_unsupported_media(h, req, pretty, media_out);
         goto ok;
@@ -400,11 +418,80 @@ api_data_post(clixon_handle h,
    return retval;
 } /* api_data_post */
 
+/*! Add event loop statistics of this restconf process to reply of stats rpc
+ *
+ * @param[in]  xreply  Reply from backend: <rpc-reply>...</rpc-reply>
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @note fcgi restconf does not use the clixon event loop, its entry has no handlers
+ */
+static int
+restconf_event_stats(cxobj *xreply)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_event_stats(cb, CLIXON_LIB_NS, "restconf") < 0)
+        goto done;
+    if (clixon_xml_parse_string(cbuf_get(cb), YB_NONE, NULL, &xreply, NULL) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Add authentication cache statistics of this restconf process to reply of stats rpc
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  xreply  Reply from backend: <rpc-reply>...</rpc-reply>
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see CLICON_RESTCONF_AUTH_CACHE_TTL
+ */
+static int
+restconf_auth_stats(clixon_handle h,
+                    cxobj        *xreply)
+{
+    int      retval = -1;
+    cbuf    *cb = NULL;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    size_t   entries = 0;
+
+    if (clicon_option_int(h, "CLICON_RESTCONF_AUTH_CACHE_TTL") <= 0)
+        goto ok;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    restconf_auth_cache_stats(h, &hits, &misses, &entries);
+    cprintf(cb, "<restconf-auth-cache xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cb, "<hits>%" PRIu64 "</hits>", hits);
+    cprintf(cb, "<misses>%" PRIu64 "</misses>", misses);
+    cprintf(cb, "<entries>%zu</entries>", entries);
+    cprintf(cb, "</restconf-auth-cache>");
+    if (clixon_xml_parse_string(cbuf_get(cb), YB_NONE, NULL, &xreply, NULL) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
 /*! Handle input data to api_operations_post 
  *
  * @param[in]  h      Clixon handle
  * @param[in]  req    Generic Www handle
  * @param[in]  data   Stream input data
+ * @param[in]  datalen Length of data
  * @param[in]  yspec  Yang top-level specification 
  * @param[in]  yrpc   Yang rpc spec
  * @param[in]  xrpc   XML pointer to rpc method
@@ -426,6 +513,7 @@ static int
 api_operations_post_input(clixon_handle h,
                           void         *req,
                           char         *data,
+                          size_t        datalen,
                           yang_stmt    *yspec,
                           yang_stmt    *yrpc,
                           cxobj        *xrpc,
@@ -481,6 +569,20 @@ api_operations_post_input(clixon_handle h,
             goto fail;
         }
         break;
+    case YANG_DATA_CBOR:
+        if ((ret = clixon_cbor_parse_buf(data, datalen, YB_NONE, yspec, &xdata, &xerr)) < 0){
+            if (netconf_malformed_message_xml(&xerr, clixon_err_reason()) < 0)
+                goto done;
+            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+                goto done;
+            goto fail;
+        }
+        if (ret == 0){
+            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+                goto done;
+            goto fail;
+        }
+        break;
     default:
         restconf_unsupported_media(h, req, pretty, media_out);
         goto fail;
@@ -665,6 +767,7 @@ api_operations_post_output(clixon_handle h,
  * @param[in]  api_path According to restconf (Sec 3.5.3.1 in rfc8040)
  * @param[in]  qvec     Vector of query string (QUERY_STRING)
  * @param[in]  data     Stream input data
+ * @param[in]  datalen  Length of data
  * @param[in]  pretty   Set to 1 for pretty-printed xml/json output
  * @param[in]  media_out Output media
  * @retval     0        OK
@@ -697,6 +800,7 @@ api_operations_post(clixon_handle h,
                     int           pi,
                     cvec         *qvec,
                     char         *data,
+                    size_t        datalen,
                     int           pretty,
                     restconf_media media_out)
 {
@@ -793,8 +897,8 @@ api_operations_post(clixon_handle h,
      */
     namespace = xml_find_type_value(xbot, NULL, "xmlns", CX_ATTR);
     clixon_debug(CLIXON_DBG_RESTCONF, "4. Parse input data: %s", data);
-    if (data && strlen(data)){
-        if ((ret = api_operations_post_input(h, req, data, yspec, yrpc, xbot,
+    if (data && datalen){
+        if ((ret = api_operations_post_input(h, req, data, datalen, yspec, yrpc, xbot,
                                              pretty, media_out)) < 0)
             goto done;
         if (ret == 0)
@@ -860,6 +964,13 @@ api_operations_post(clixon_handle h,
                 goto done;
             goto ok;
         }
+        /* Add event loop statistics of restconf to those of backend */
+        if (namespace && strcmp(namespace, CLIXON_LIB_NS) == 0 &&
+            strcmp(xml_name(xbot), "stats") == 0 &&
+            (xe = xpath_first(xret, NULL, "rpc-reply")) != NULL)
+            if (restconf_event_stats(xe) < 0 ||
+                restconf_auth_stats(h, xe) < 0)
+                goto done;
     }
     /* 8. Receive reply from local/backend handler as Netconf RPC
      *       <rpc-reply><x xmlns="uri">0</x></rpc-reply>
@@ -888,6 +999,10 @@ api_operations_post(clixon_handle h,
             goto done;
         /* xoutput should now look: {"example:output": {"x":0,"y":42}} */
         break;
+    case YANG_DATA_CBOR:
+        if (clixon_cbor2cbuf(cbret, xoutput, 0) < 0)
+            goto done;
+        break;
     default:
         break;
     }
@@ -187,7 +187,8 @@ restconf_conn_new(clixon_handle    h,
                   int              s,
                   restconf_socket *rsock)
 {
-    restconf_conn *rc;
+    static unsigned long id = 0;
+    restconf_conn       *rc;
 
     if ((rc = (restconf_conn*)malloc(sizeof(restconf_conn))) == NULL){
         clixon_err(OE_UNIX, errno, "malloc");
@@ -196,6 +197,7 @@ restconf_conn_new(clixon_handle    h,
     memset(rc, 0, sizeof(restconf_conn));
     rc->rc_h = h;
     rc->rc_s = s;
+    rc->rc_id = ++id;
     rc->rc_callhome = rsock->rs_callhome;
     rc->rc_socket = rsock;
     INSQ(rc, rsock->rs_conns);
@@ -758,6 +760,9 @@ restconf_http1_process(restconf_conn *rc,
                 goto closed;
             }
         }
+        /* Parser may have truncated a binary body */
+        if (http1_body_raw(h, sd) < 0)
+            goto done;
     }
     /* Check whole message is read. 
      * Only way this could happen is that body is read
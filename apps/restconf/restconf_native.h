@@ -109,6 +109,7 @@ typedef struct restconf_conn {
     int                   rc_proto_d1;  /* parsed version digit 1 */
     int                   rc_proto_d2;  /* parsed version digit 2 */
     int                   rc_s;         /* Connection socket */
+    unsigned long         rc_id;        /* Unique connection id, eg for authentication cache */
     clixon_handle         rc_h;         /* Clixon handle */
     SSL                  *rc_ssl;       /* Structure for SSL connection */
     restconf_stream_data *rc_streams; /* List of http/2 session streams */
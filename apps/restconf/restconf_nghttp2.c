@@ -293,6 +293,7 @@ restconf_nghttp2_path(restconf_stream_data *sd)
     char          *oneline = NULL;
     cvec          *cvv = NULL;
     char          *cn;
+    char           idstr[32];
 
     clixon_debug(CLIXON_DBG_RESTCONF, "------------");
     rc = sd->sd_conn;
@@ -300,6 +301,10 @@ restconf_nghttp2_path(restconf_stream_data *sd)
         clixon_err(OE_RESTCONF, EINVAL, "arg is NULL");
         goto done;
     }
+    /* Connection identity, used as key in authentication cache */
+    snprintf(idstr, sizeof(idstr), "%lu", rc->rc_id);
+    if (restconf_param_set(h, "CONNECTION_ID", idstr) < 0)
+        goto done;
     if (rc->rc_ssl != NULL){
         /* Slightly awkward way of taking SSL cert subject and CN and add it to restconf parameters
          * instead of accessing it directly 
@@ -217,6 +217,10 @@ api_root_restconf_exact(clixon_handle  h,
         if (clixon_json2cbuf(cb, xt, pretty, 0, 0) < 0)
             goto done;
         break;
+    case YANG_DATA_CBOR:
+        if (clixon_cbor2cbuf(cb, xt, 0) < 0)
+            goto done;
+        break;
     default:
         break;
     }
@@ -303,6 +307,10 @@ api_yang_library_version(clixon_handle h,
         if (clixon_json2cbuf(cb, xt, pretty, 0, 0) < 0)
             goto done;
         break;
+    case YANG_DATA_CBOR:
+        if (clixon_cbor2cbuf(cb, xt, 0) < 0)
+            goto done;
+        break;
     default:
         break;
     }
@@ -326,6 +334,8 @@ api_yang_library_version(clixon_handle h,
  * @param[in]  pcvec     Vector of path ie DOCUMENT_URI element
  * @param[in]  pi        Offset, where to start pcvec
  * @param[in]  qvec      Vector of query string (QUERY_STRING)
+ * @param[in]  data      Stream input data
+ * @param[in]  datalen   Length of data
  * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
  * @param[in]  media_out Restconf output media
  * @param[in]  ds        0 if "data" resource, 1 if rfc8527 "ds" resource
@@ -340,6 +350,7 @@ api_data(clixon_handle h,
          int           pi,
          cvec         *qvec,
          char         *data,
+         size_t        datalen,
          int           pretty,
          restconf_media media_out,
          ietf_ds_t     ds)
@@ -374,19 +385,19 @@ api_data(clixon_handle h,
         retval = api_data_get(h, req, api_path, pi, qvec, pretty, media_out, ds);
     }
     else if (strcmp(request_method, "POST")==0) {
-        retval = api_data_post(h, req, api_path, pi, qvec, data, pretty, restconf_content_type(h), media_out, ds);
+        retval = api_data_post(h, req, api_path, pi, qvec, data, datalen, pretty, restconf_content_type(h), media_out, ds);
     }
     else if (strcmp(request_method, "PUT")==0) {
         if (read_only)
             retval = restconf_method_notallowed(h, req, "GET,POST", pretty, media_out);
         else
-            retval = api_data_put(h, req, api_path, pi, qvec, data, pretty, media_out, ds);
+            retval = api_data_put(h, req, api_path, pi, qvec, data, datalen, pretty, media_out, ds);
     }
     else if (strcmp(request_method, "PATCH")==0) {
         if (read_only) {
             retval = restconf_method_notallowed(h, req, "GET,POST", pretty, media_out);
         }
-        retval = api_data_patch(h, req, api_path, pi, qvec, data, pretty, media_out, ds);
+        retval = api_data_patch(h, req, api_path, pi, qvec, data, datalen, pretty, media_out, ds);
     }
     else if (strcmp(request_method, "DELETE")==0) {
         if (read_only)
@@ -416,6 +427,7 @@ api_data(clixon_handle h,
  * @param[in]  pi     Offset, where to start pcvec
  * @param[in]  qvec   Vector of query string (QUERY_STRING)
  * @param[in]  data   Stream input data
+ * @param[in]  datalen Length of data
  * @param[in]  media_out Output media
  * @retval     0         OK
  * @retval    -1         Error
@@ -429,6 +441,7 @@ api_operations(clixon_handle h,
                int           pi,
                cvec         *qvec,
                char         *data,
+               size_t        datalen,
                int           pretty,
                restconf_media media_out)
 {
@@ -439,7 +452,7 @@ api_operations(clixon_handle h,
     if (strcmp(request_method, "GET")==0)
         retval = api_operations_get(h, req, path, pi, qvec, data, pretty, media_out);
     else if (strcmp(request_method, "POST")==0)
-        retval = api_operations_post(h, req, path, pi, qvec, data,
+        retval = api_operations_post(h, req, path, pi, qvec, data, datalen,
                                      pretty, media_out);
     else{
         if (netconf_invalid_value_xml(&xerr, "protocol", "Invalid HTTP operations method") < 0)
@@ -568,7 +581,7 @@ api_root_restconf(clixon_handle        h,
             goto done;
     }
     else if (strcmp(api_resource, NETCONF_OUTPUT_DATA) == 0){ /* restconf, skip /api/data */
-        if (api_data(h, req, path, pcvec, 2, qvec, indata,
+        if (api_data(h, req, path, pcvec, 2, qvec, indata, cbuf_len(cb),
                      pretty, media_out, IETF_DS_NONE) < 0)
             goto done;
     }
@@ -609,11 +622,11 @@ api_root_restconf(clixon_handle        h,
            goto ok;
         }
         /* ds is assigned at this point */
-        if (0 > api_data(h, req, path, pcvec, 3, qvec, indata, pretty, media_out, ds))
+        if (0 > api_data(h, req, path, pcvec, 3, qvec, indata, cbuf_len(cb), pretty, media_out, ds))
             goto done;
     }
     else if (strcmp(api_resource, "operations") == 0){ /* rpc */
-        if (api_operations(h, req, request_method, path, pcvec, 2, qvec, indata,
+        if (api_operations(h, req, request_method, path, pcvec, 2, qvec, indata, cbuf_len(cb),
                            pretty, media_out) < 0)
             goto done;
     }
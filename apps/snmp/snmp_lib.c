@@ -89,8 +89,8 @@
 static const map_str2int snmp_access_map[] = {
     {"read-only",             HANDLER_CAN_RONLY}, /* HANDLER_CAN_GETANDGETNEXT */
     {"read-write",            HANDLER_CAN_RWRITE}, /* HANDLER_CAN_GETANDGETNEXT | HANDLER_CAN_SET */
-    {"not-accessible",        0}, // XXX
-    {"accessible-for-notify", 0}, // XXX
+    {"not-accessible",        0},
+    {"accessible-for-notify", 0}, /* Only in notifications, see snmp_notify.c */
     {NULL,                   -1}
 };
 
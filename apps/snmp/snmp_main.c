@@ -68,6 +68,7 @@
 
 #include "snmp_lib.h"
 #include "snmp_register.h"
+#include "snmp_notify.h"
 
 /* Command line options to be passed to getopt(3) */
 #define SNMP_OPTS "hVD:f:l:C:o:z"
@@ -120,6 +121,7 @@ snmp_terminate(clixon_handle h)
         x = NULL;
     }
     clicon_rpc_close_session(h);
+    xmldb_replica_free(h);
     if ((yspec = clicon_dbspec_yang(h)) != NULL)
         ys_free(yspec);
     if ((yspec = clicon_config_yang(h)) != NULL)
@@ -129,6 +131,9 @@ snmp_terminate(clixon_handle h)
     if ((x = clicon_conf_xml(h)) != NULL)
         xml_free(x);
     xpath_optimize_exit();
+    xpath_profile_exit();
+    /* clixon_snmp has no RPC interface, log event loop statistics instead */
+    clixon_event_stats_log(LOG_INFO);
     clixon_event_exit();
     clixon_handle_exit(h);
     clixon_err_exit();
@@ -501,6 +506,9 @@ main(int    argc,
 
     if ((sz = clicon_option_int(h, "CLIXON_LOG_STRING_LIMIT")) != 0)
         clixon_log_string_limit_set(sz);
+    xpath_profile_set(clicon_option_bool(h, "CLICON_XPATH_PROFILE"),
+                      clicon_option_int(h, "CLICON_XPATH_SLOW_THRESHOLD"));
+    clixon_event_watchdog_set(clicon_option_int(h, "CLICON_EVENT_WATCHDOG"));
 
     /* Set default namespace according to CLICON_NAMESPACE_NETCONF_DEFAULT */
     xml_nsctx_namespace_netconf_default(h);
@@ -574,6 +582,10 @@ main(int    argc,
     if (clixon_snmp_traverse_mibyangs(h) < 0)
         goto done;
 
+    /* Subscribe to backend event stream and send notifications to snmp master agent */
+    if (clixon_snmp_notify_init(h) < 0)
+        goto done;
+
     /* Write pid-file */
     if (pidfile_write(pidfile) <  0)
         goto done;
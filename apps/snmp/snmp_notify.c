@@ -0,0 +1,395 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2022 Olof Hagsand and Kristofer Hallin
+  Sponsored by Siklu Communications LTD
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+  * SNMP notifications generated from YANG notifications, see RFC 6643 Section 11
+  * clixon_snmp subscribes to the backend event stream CLICON_SNMP_NOTIFY_STREAM.
+  * A YANG notification translated from a SMIv2 NOTIFICATION-TYPE is sent as an SNMPv2
+  * notification to the master agent over AgentX. Example:
+  *   notification linkDown {
+  *      smiv2:oid "1.3.6.1.6.3.1.1.5.3";
+  *      container linkDown-ifIndex {
+  *         leaf ifIndex {
+  *            type leafref { path "/if-mib:IF-MIB/if-mib:ifTable/if-mib:ifEntry/if-mib:ifIndex"; }
+  *         }
+  *         leaf ifOperStatus {
+  *            type leafref { path "/if-mib:IF-MIB/if-mib:ifTable/if-mib:ifEntry/if-mib:ifOperStatus"; }
+  *         }
+  *      }
+  *   }
+  * The varbinds are snmpTrapOID.0 followed by all leafs of the payload that refer to
+  * MIB objects, sysUpTime.0 is added by netsnmp.
+  * Whether the master agent sends it as trap or inform is configured in snmpd, eg trap2sink
+  * or informsink in snmpd.conf.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <syslog.h>
+#include <errno.h>
+#include <sys/types.h>
+
+/* net-snmp */
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-includes.h>
+#include <net-snmp/agent/net-snmp-agent-includes.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include <clixon/clixon.h>
+
+#include "snmp_lib.h"
+#include "snmp_notify.h"
+
+/* snmpTrapOID.0 from SNMPv2-MIB, first varbind after sysUpTime.0 */
+static oid snmptrap_oid[] = {1, 3, 6, 1, 6, 3, 1, 1, 4, 1, 0};
+
+/*! Get instance part of OID of a MIB object referred to by a notification leaf
+ *
+ * For a columnar object, the instance is the index values of the conceptual row, taken from
+ * sibling leafs referring to the index objects. For a scalar object the instance is 0.
+ * @param[in]  x         Notification leaf XML
+ * @param[in]  yref      Referred MIB object
+ * @param[out] objidk    Instance OID, assume allocated with MAX_OID_LEN
+ * @param[out] objidklen Length of instance OID
+ * @retval     1         OK
+ * @retval     0         Index value not found in notification
+ * @retval    -1         Error
+ * @see snmp_xmlkey2val_oid  Same for a table row
+ */
+static int
+snmp_notify_instance(cxobj     *x,
+                     yang_stmt *yref,
+                     oid       *objidk,
+                     size_t    *objidklen)
+{
+    int        retval = -1;
+    yang_stmt *ylist;
+    yang_stmt *ykey;
+    yang_stmt *ys;
+    yang_stmt *yref1;
+    cvec      *cvk;
+    cg_var    *cvi;
+    cxobj     *xs;
+    oid        objid[MAX_OID_LEN] = {0,};
+    size_t     objidlen = MAX_OID_LEN;
+
+    *objidklen = 0;
+    ylist = yang_parent_get(yref);
+    if (ylist == NULL || yang_keyword_get(ylist) != Y_LIST){
+        objidk[(*objidklen)++] = 0;
+        goto ok;
+    }
+    if ((cvk = yang_cvec_get(ylist)) == NULL){
+        clixon_err(OE_YANG, 0, "No keys");
+        goto done;
+    }
+    cvi = NULL;
+    while ((cvi = cvec_each(cvk, cvi)) != NULL){
+        if ((ykey = yang_find(ylist, Y_LEAF, cv_string_get(cvi))) == NULL){
+            clixon_err(OE_YANG, 0, "Key %s not found in %s", cv_string_get(cvi), yang_argument_get(ylist));
+            goto done;
+        }
+        xs = NULL;
+        while ((xs = xml_child_each(xml_parent(x), xs, CX_ELMNT)) != NULL){
+            if ((ys = xml_spec(xs)) == NULL || yang_keyword_get(ys) != Y_LEAF)
+                continue;
+            if (snmp_yang_type_get(ys, &yref1, NULL, NULL, NULL) < 0)
+                goto done;
+            if (yref1 == ykey)
+                break;
+        }
+        if (xs == NULL || xml_body(xs) == NULL){
+            clixon_debug(CLIXON_DBG_SNMP, "Index %s of %s not found", cv_string_get(cvi), xml_name(x));
+            goto fail;
+        }
+        if (snmp_str2oid(xml_body(xs), ykey, objid, &objidlen) < 0)
+            goto done;
+        if (oid_append(objidk, objidklen, objid, objidlen) < 0)
+            goto done;
+    }
+ ok:
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Add a varbind for each leaf of a notification payload referring to a MIB object
+ *
+ * @param[in]     xn    Notification XML node, leafs are found recursively
+ * @param[in,out] vars  Variable list
+ * @retval        0     OK
+ * @retval       -1     Error
+ */
+static int
+snmp_notify_varbinds(cxobj                  *xn,
+                     netsnmp_variable_list **vars)
+{
+    int        retval = -1;
+    cxobj     *x;
+    yang_stmt *ys;
+    yang_stmt *yref;
+    oid        objid[MAX_OID_LEN] = {0,};
+    size_t     objidlen = MAX_OID_LEN;
+    oid        objidk[MAX_OID_LEN] = {0,};
+    size_t     objidklen = 0;
+    char      *modes_str = NULL;
+    char      *xmlstr = NULL;
+    u_char    *snmpval = NULL;
+    size_t     snmplen = 0;
+    char      *reason = NULL;
+    int        asn1type;
+    int        ret;
+
+    x = NULL;
+    while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL){
+        if ((ys = xml_spec(x)) == NULL)
+            continue;
+        if (yang_keyword_get(ys) != Y_LEAF){
+            if (snmp_notify_varbinds(x, vars) < 0)
+                goto done;
+            continue;
+        }
+        if (xml_body(x) == NULL)
+            continue;
+        objidlen = MAX_OID_LEN;
+        if ((ret = yangext_oid_get(ys, objid, &objidlen, NULL)) < 0)
+            goto done;
+        if (ret == 0)
+            continue;
+        if (snmp_yang_type_get(ys, &yref, NULL, NULL, NULL) < 0)
+            goto done;
+        /* Index objects are not-accessible and only part of instance of other objects */
+        if (yang_extension_value_opt(yref, "smiv2:max-access", NULL, &modes_str) < 0)
+            goto done;
+        if (modes_str && strcmp(modes_str, "not-accessible") == 0)
+            continue;
+        if ((ret = snmp_notify_instance(x, yref, objidk, &objidklen)) < 0)
+            goto done;
+        if (ret == 0)
+            continue;
+        if (oid_append(objid, &objidlen, objidk, objidklen) < 0)
+            goto done;
+        if ((ret = type_xml2snmp_pre(xml_body(x), ys, &xmlstr)) < 0)
+            goto done;
+        if (ret == 0)
+            continue;
+        if (type_yang2asn1(ys, &asn1type, 1) < 0)
+            goto done;
+        if ((ret = type_xml2snmp(xmlstr, ys, &asn1type, &snmpval, &snmplen, &reason)) < 0)
+            goto done;
+        if (ret == 0)
+            clixon_debug(CLIXON_DBG_SNMP, "%s: %s", xml_name(x), reason);
+        else if (snmp_varlist_add_variable(vars, objid, objidlen, asn1type, snmpval, snmplen) == NULL){
+            clixon_err(OE_SNMP, 0, "snmp_varlist_add_variable");
+            goto done;
+        }
+        free(xmlstr);
+        xmlstr = NULL;
+        if (snmpval){
+            free(snmpval);
+            snmpval = NULL;
+        }
+        if (reason){
+            free(reason);
+            reason = NULL;
+        }
+    }
+    retval = 0;
+ done:
+    if (xmlstr)
+        free(xmlstr);
+    if (snmpval)
+        free(snmpval);
+    if (reason)
+        free(reason);
+    return retval;
+}
+
+/*! Send a YANG notification as SNMPv2 notification if it is translated from a MIB
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  xn    Notification payload, eg <linkDown>, sibling of <eventTime>
+ * @retval     0     OK, sent or ignored
+ * @retval    -1     Error
+ */
+static int
+snmp_notify_send(clixon_handle h,
+                 cxobj        *xn)
+{
+    int                    retval = -1;
+    yang_stmt             *yspec;
+    yang_stmt             *ymod;
+    yang_stmt             *ynotif;
+    char                  *ns = NULL;
+    oid                    objid[MAX_OID_LEN] = {0,};
+    size_t                 objidlen = MAX_OID_LEN;
+    netsnmp_variable_list *vars = NULL;
+    cbuf                  *cb = NULL;
+    int                    ret;
+
+    yspec = clicon_dbspec_yang(h);
+    if (xml2ns(xn, xml_prefix(xn), &ns) < 0)
+        goto done;
+    if (ns == NULL ||
+        (ymod = yang_find_module_by_namespace(yspec, ns)) == NULL ||
+        (ynotif = yang_find(ymod, Y_NOTIFICATION, xml_name(xn))) == NULL){
+        clixon_debug(CLIXON_DBG_SNMP, "No yang notification for %s", xml_name(xn));
+        goto ok;
+    }
+    if ((ret = yangext_oid_get(ynotif, objid, &objidlen, NULL)) < 0)
+        goto done;
+    if (ret == 0) /* Not translated from a NOTIFICATION-TYPE */
+        goto ok;
+    xml_spec_set(xn, ynotif);
+    if ((ret = xml_bind_yang(h, xn, YB_PARENT, yspec, NULL)) < 0)
+        goto done;
+    if (ret == 0)
+        clixon_debug(CLIXON_DBG_SNMP, "Notification %s partially bound", xml_name(xn));
+    if (snmp_varlist_add_variable(&vars, snmptrap_oid, OID_LENGTH(snmptrap_oid),
+                                  ASN_OBJECT_ID, (u_char*)objid, objidlen*sizeof(oid)) == NULL){
+        clixon_err(OE_SNMP, 0, "snmp_varlist_add_variable");
+        goto done;
+    }
+    if (snmp_notify_varbinds(xn, &vars) < 0)
+        goto done;
+    if (clixon_debug_get()){
+        if ((cb = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        oid_cbuf(cb, objid, objidlen);
+        clixon_debug(CLIXON_DBG_SNMP, "notify: %s %s", xml_name(xn), cbuf_get(cb));
+    }
+    send_v2trap(vars);
+ ok:
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (vars)
+        snmp_free_varbind(vars);
+    return retval;
+}
+
+/*! Callback for notifications of backend event stream
+ *
+ * @param[in]  s    Notification socket
+ * @param[in]  arg  Clixon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see netconf_notification_cb
+ */
+static int
+snmp_notify_cb(int   s,
+               void *arg)
+{
+    int           retval = -1;
+    clixon_handle h = (clixon_handle)arg;
+    cbuf         *cbmsg = NULL;
+    cxobj        *xt = NULL;
+    cxobj        *xn;
+    cxobj        *x;
+    cvec         *nsc = NULL;
+    int           eof = 0;
+
+    clixon_debug(CLIXON_DBG_SNMP, "");
+    if (clixon_msg_rcv11(s, NULL, 0, &cbmsg, &eof) < 0)
+        goto done;
+    if (eof){
+        clixon_err(OE_PROTO, ESHUTDOWN, "Socket unexpected close");
+        close(s);
+        errno = ESHUTDOWN;
+        clixon_event_unreg_fd(s, snmp_notify_cb);
+        goto done;
+    }
+    if (clixon_xml_parse_string(cbuf_get(cbmsg), YB_NONE, NULL, &xt, NULL) < 0)
+        goto done;
+    if ((nsc = xml_nsctx_init(NULL, NETCONF_NOTIFICATION_NAMESPACE)) == NULL)
+        goto done;
+    if ((xn = xpath_first(xt, nsc, "notification")) == NULL)
+        goto ok;
+    x = NULL;
+    while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL){
+        if (strcmp(xml_name(x), "eventTime") == 0)
+            continue;
+        if (snmp_notify_send(h, x) < 0)
+            goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (xt)
+        xml_free(xt);
+    if (cbmsg)
+        cbuf_free(cbmsg);
+    return retval;
+}
+
+/*! Subscribe to backend event stream and send its MIB notifications to SNMP master agent
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+clixon_snmp_notify_init(clixon_handle h)
+{
+    int   retval = -1;
+    char *stream;
+    int   s;
+
+    if ((stream = clicon_option_str(h, "CLICON_SNMP_NOTIFY_STREAM")) == NULL)
+        goto ok;
+    clixon_debug(CLIXON_DBG_SNMP, "%s", stream);
+    if (clicon_rpc_create_subscription(h, stream, NULL, &s) < 0)
+        goto done;
+    if (clixon_event_reg_fd(s, snmp_notify_cb, h, "snmp notification socket") < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
@@ -138,6 +138,10 @@ mibyang_leaf_register(clixon_handle h,
     if (modes_str == NULL)
         goto ok;
     modes = snmp_access_str2int(modes_str);
+    /* not-accessible and accessible-for-notify objects are not served, the latter only
+     * appear in notifications */
+    if (modes == 0)
+        goto ok;
 
     /* SMI default value, How is this different from yang defaults?
      */
@@ -572,6 +576,9 @@ mibyang_traverse(clixon_handle h,
         break;
     case Y_CONTAINER: /* See list case */
         break;
+    case Y_NOTIFICATION: /* Not registered, sent as notifications, see snmp_notify.c */
+        goto ok;
+        break;
     case Y_LIST: /* If parent is container -> identify as table */
         yp = yang_parent_get(yn);
         if (yang_keyword_get(yp) == Y_CONTAINER){
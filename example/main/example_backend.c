@@ -70,7 +70,7 @@
 #include <clixon/clixon_backend.h>
 
 /* Command line options to be passed to getopt(3) */
-#define BACKEND_EXAMPLE_OPTS "a:m:M:nrsS:x:iuUtV:"
+#define BACKEND_EXAMPLE_OPTS "a:e:m:M:nrsS:x:iuUtV:"
 
 /* Enabling this improves performance in tests, but there may trigger the "double XPath"
  * problem.
@@ -101,6 +101,13 @@ static char *_mount_namespace = NULL;
  */
 static int _notification_stream = 0;
 
+/*! File with notification sent on the example stream instead of the example event
+ *
+ * Primarily for testing
+ * Start backend with -- -n -e <file>
+ */
+static char *_notification_file = NULL;
+
 /*! Variable to control if reset code is run.
  *
  * The reset code inserts "extra XML" which assumes ietf-interfaces is
@@ -298,6 +305,41 @@ main_abort(clixon_handle    h,
     return 0;
 }
 
+/*! Send notification read from file on example stream
+ *
+ * @param[in]  h    Clixon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+example_stream_file(clixon_handle h)
+{
+    int   retval = -1;
+    FILE *fp = NULL;
+    cbuf *cb = NULL;
+    char  buf[1024];
+
+    if ((fp = fopen(_notification_file, "r")) == NULL){
+        clixon_err(OE_UNIX, errno, "open(%s)", _notification_file);
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    while (fgets(buf, sizeof(buf), fp) != NULL)
+        cprintf(cb, "%s", buf);
+    if (stream_notify(h, "EXAMPLE", "%s", cbuf_get(cb)) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (fp)
+        fclose(fp);
+    return retval;
+}
+
 /*! Routing example notification timer handler. Here is where the periodic action is 
  */
 static int
@@ -307,8 +349,12 @@ example_stream_timer(int   fd,
     int                    retval = -1;
     clixon_handle          h = (clixon_handle)arg;
 
+    if (_notification_file){
+        if (example_stream_file(h) < 0)
+            goto done;
+    }
     /* XXX Change to actual netconf notifications and namespace */
-    if (stream_notify(h, "EXAMPLE", "<event xmlns=\"urn:example:clixon\"><event-class>fault</event-class><reportingEntity><card>Ethernet0</card></reportingEntity><severity>major</severity></event>") < 0)
+    else if (stream_notify(h, "EXAMPLE", "<event xmlns=\"urn:example:clixon\"><event-class>fault</event-class><reportingEntity><card>Ethernet0</card></reportingEntity><severity>major</severity></event>") < 0)
         goto done;
     if (example_stream_timer_setup(h) < 0)
         goto done;
@@ -1444,6 +1490,9 @@ clixon_plugin_init(clixon_handle h)
         case 'a':
             _action_instanceid = optarg;
             break;
+        case 'e': /* notification file (requires -n) */
+            _notification_file = optarg;
+            break;
         case 'm':
             _mount_yang = optarg;
             break;
@@ -75,6 +75,7 @@ int xmldb_get(clixon_handle h, const char *db, cvec *nsc, char *xpath, cxobj **x
 int xmldb_get0(clixon_handle h, const char *db, yang_bind yb,
                cvec *nsc, const char *xpath, int copy, withdefaults_type wdef,
                cxobj **xret, modstate_diff_t *msd, cxobj **xerr);
+int xmldb_tree_get(clixon_handle h, cxobj *x0t, cvec *nsc, const char *xpath, cxobj **xret);
 int xmldb_put(clixon_handle h, const char *db, enum operation_type op, cxobj *xt, char *username, cbuf *cbret); /* in clixon_datastore_write.[ch] */
 int xmldb_copy(clixon_handle h, const char *from, const char *to);
 int xmldb_lock(clixon_handle h, const char *db, uint32_t id);
@@ -100,5 +101,13 @@ int xmldb_rename(clixon_handle h, const char *db, const char *newdb, const char
 int xmldb_populate(clixon_handle h, const char *db);
 int xmldb_write_cache2file(clixon_handle h, const char *db);
 int xmldb_dump(clixon_handle h, FILE *f, cxobj *xt, withdefaults_type wdef);
+/* in clixon_datastore_replica.c */
+void xmldb_replica_modified(clixon_handle h);
+int xmldb_replica_sync(clixon_handle h);
+int xmldb_replica_publish(clixon_handle h);
+int xmldb_replica_get(clixon_handle h, cxobj **xtp);
+int xmldb_replica_gen(clixon_handle h, uint64_t *gen);
+int xmldb_replica_free(clixon_handle h);
+int xmldb_replica_remove(clixon_handle h);
 
 #endif /* _CLIXON_DATASTORE_H */
@@ -74,6 +74,7 @@ enum clixon_err{
     OE_ROUTING,  /* routing daemon error (eg quagga) */
     OE_XML,      /* xml parsing */
     OE_JSON,     /* json parsing */
+    OE_CBOR,     /* cbor encoding and decoding */
     OE_RESTCONF, /* RESTCONF errors */
     OE_PLUGIN,   /* plugin loading, etc */
     OE_YANG ,    /* Yang error */
@@ -55,6 +55,12 @@ int clicon_sig_ignore_set(int val);
 
 int clicon_sig_ignore_get(void);
 
+int clixon_event_watchdog_set(uint32_t ms);
+
+int clixon_event_stats(cbuf *cb, const char *ns, const char *process);
+
+int clixon_event_stats_log(int level);
+
 int clixon_event_reg_fd(int fd, int (*fn)(int, void*), void *arg, char *str);
 
 int clixon_event_unreg_fd(int s, int (*fn)(int, void*));
@@ -44,6 +44,7 @@
  * Prototypes
  */
 int json2xml_decode(cxobj *x, cxobj **xerr);
+int json_xmlns_translate(yang_stmt *yspec, cxobj *x, cxobj **xerr);
 int clixon_json2cbuf(cbuf *cb, cxobj *x, int pretty, int skiptop, int autocliext);
 int xml2json_cbuf_vec(cbuf *cb, cxobj **vec, size_t veclen, int pretty, int skiptop);
 int clixon_json2file(FILE *f, cxobj *x, int pretty, clicon_output_cb *fn, int skiptop, int autocliext);
@@ -76,6 +76,14 @@
  */
 #define NETCONF_MONITORING_NAMESPACE "urn:ietf:params:xml:ns:yang:ietf-netconf-monitoring"
 
+/* RFC 8526 NETCONF Extensions to Support the Network Management Datastore Architecture
+ * RFC 8342 Network Management Datastore Architecture (NMDA): datastores and origin
+ */
+#define NETCONF_NMDA_NAMESPACE "urn:ietf:params:xml:ns:yang:ietf-netconf-nmda"
+#define NMDA_DATASTORES_NAMESPACE "urn:ietf:params:xml:ns:yang:ietf-datastores"
+#define NMDA_ORIGIN_NAMESPACE "urn:ietf:params:xml:ns:yang:ietf-origin"
+#define NMDA_ORIGIN_PREFIX "or"
+
 /* Default STREAM namespace (see rfc5277 3.1)
  * From RFC8040: 
  *  The structure of the event data is based on the <notification>
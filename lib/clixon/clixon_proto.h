@@ -53,6 +53,18 @@ struct clicon_msg {
     char        op_body[0]; /* rest of message, actual data */
 };
 
+/*! Callback for each part of a message as it is received
+ *
+ * @param[in]  arg   Argument given when receiving
+ * @param[in]  buf   Part of message, not NULL-terminated
+ * @param[in]  len   Length of part, may be 0 if eom is set
+ * @param[in]  eom   Set on last part of message
+ * @retval     0     OK
+ * @retval    -1     Error, stop receiving
+ * @see clixon_msg_rcv11_stream
+ */
+typedef int (clixon_msg_part_cb)(void *arg, char *buf, size_t len, int eom);
+
 /*
  * Prototypes
  */
@@ -74,7 +86,9 @@ int clixon_rpc10(int sock, const char *descr, cbuf *msgin, cbuf *msgret, int *eo
 
 /* NETCONF 1.1 */
 int clixon_msg_rcv11(int s, const char *descr, int intr, cbuf **cb, int *eof);
+int clixon_msg_rcv11_stream(int s, const char *descr, clixon_msg_part_cb *fn, void *arg, int *eof);
 int clicon_rpc(int sock, const char *descr, struct clicon_msg *msg, char **xret, int *eof);
+int clicon_rpc_stream(int sock, const char *descr, struct clicon_msg *msg, clixon_msg_part_cb *fn, void *arg, int *eof);
 int send_msg_reply(int s, const char *descr, char *data, uint32_t datalen);
 int send_msg_notify_xml(clixon_handle h, int s, const char *descr, cxobj *xev);
 
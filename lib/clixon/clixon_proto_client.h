@@ -43,9 +43,11 @@
 #define _CLIXON_PROTO_CLIENT_H_
 
 int clicon_rpc_connect(clixon_handle h, int *sock0);
+int clicon_rpc_msg_raw(clixon_handle h, struct clicon_msg *msg, char **retdata);
 int clicon_rpc_msg(clixon_handle h, struct clicon_msg *msg, cxobj **xret0);
 int clicon_rpc_msg_persistent(clixon_handle h, struct clicon_msg *msg, cxobj **xret0, int *sock0);
 int clicon_rpc_netconf(clixon_handle h, char *xmlst, cxobj **xret, int *sp);
+int clicon_rpc_netconf_stream(clixon_handle h, char *xmlstr, clixon_msg_part_cb *fn, void *arg);
 int clicon_rpc_netconf_xml(clixon_handle h, cxobj *xml, cxobj **xret, int *sp);
 int clicon_rpc_get_config(clixon_handle h, char *username, char *db, char *xpath, cvec *nsc, char *defaults, cxobj **xret);
 int clicon_rpc_edit_config(clixon_handle h, char *db, enum operation_type op,
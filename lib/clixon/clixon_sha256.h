@@ -0,0 +1,69 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2024 Olof Hagsand
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * SHA-256 message digest, FIPS 180-4
+ * Used where content must be identified without trusting its source, eg persisted
+ * digests and credential caches. Not intended for bulk hashing of large data.
+ */
+#ifndef _CLIXON_SHA256_H
+#define _CLIXON_SHA256_H
+
+/*
+ * Constants
+ */
+#define SHA256_DIGEST_LEN 32 /* Digest length in bytes */
+#define SHA256_BLOCK_LEN  64 /* Internal block length in bytes */
+
+/*
+ * Types
+ */
+/*! SHA-256 running state, see clixon_sha256_init
+ */
+typedef struct {
+    uint32_t sh_state[8];                /* Intermediate hash value H */
+    uint64_t sh_len;                     /* Total number of message bytes */
+    uint8_t  sh_buf[SHA256_BLOCK_LEN];   /* Partial block */
+    size_t   sh_buflen;                  /* Bytes in sh_buf */
+} clixon_sha256_ctx;
+
+/*
+ * Prototypes
+ */
+void clixon_sha256_init(clixon_sha256_ctx *ctx);
+void clixon_sha256_update(clixon_sha256_ctx *ctx, const void *data, size_t len);
+void clixon_sha256_field(clixon_sha256_ctx *ctx, const void *data, size_t len);
+void clixon_sha256_final(clixon_sha256_ctx *ctx, uint8_t digest[SHA256_DIGEST_LEN]);
+int  clixon_sha256_hex(const uint8_t digest[SHA256_DIGEST_LEN], cbuf *cb);
+
+#endif /* _CLIXON_SHA256_H */
@@ -45,8 +45,10 @@
  */
 int xml_yang_validate_rpc(clixon_handle h, cxobj *xrpc, int expanddefault, cxobj **xret);
 int xml_yang_validate_rpc_reply(clixon_handle h, cxobj *xrpc, cxobj **xret);
+int xml_yang_validate_add_node(clixon_handle h, cxobj *xt, cxobj **xret, int *skip);
 int xml_yang_validate_add(clixon_handle h, cxobj *xt, cxobj **xret);
 int xml_yang_validate_list_key_only(cxobj *xt, cxobj **xret);
+int xml_yang_validate_all_node(clixon_handle h, cxobj *xt, cxobj **xret, int *skip);
 int xml_yang_validate_all(clixon_handle h, cxobj *xt, cxobj **xret);
 int xml_yang_validate_all_top(clixon_handle h, cxobj *xt, cxobj **xret);
 int rpc_reply_check(clixon_handle h, char *rpcname, cbuf *cbret);
@@ -190,6 +190,7 @@ enum format_enum{
     FORMAT_TEXT,
     FORMAT_CLI,
     FORMAT_NETCONF,
+    FORMAT_CBOR,
     FORMAT_DEFAULT
 };
 
@@ -260,6 +261,7 @@ int       xml_spec_set(cxobj *x, yang_stmt *spec);
 cg_var   *xml_cv(cxobj *x);
 int       xml_cv_set(cxobj *x, cg_var *cv);
 cxobj    *xml_find(cxobj *xn_parent, char *name);
+cxobj    *xml_find_len(cxobj *xp, const char *name, size_t len);
 int       xml_addsub(cxobj *xp, cxobj *xc);
 cxobj    *xml_wrap_all(cxobj *xp, char *tag);
 cxobj    *xml_wrap(cxobj *xc, char *tag);
@@ -304,8 +306,8 @@ cxobj    *xml_add_attr(cxobj *xn, char *name, char *value, char *prefix, char *n
 #ifdef XML_EXPLICIT_INDEX
 int       xml_search_index_p(cxobj *x);
 int       xml_search_vector_get(cxobj *x, char *name, clixon_xvec **xvec);
-int       xml_search_child_insert(cxobj *xp, cxobj *x);
-int       xml_search_child_rm(cxobj *xp, cxobj *x);
+int       xml_search_index_pre(cxobj *xp, cxobj *xc, cxobj **xep);
+int       xml_search_index_post(cxobj *xe);
 cxobj    *xml_child_index_each(cxobj *xparent, char *name, cxobj *xprev, enum cxobj_type type);
 
 #endif
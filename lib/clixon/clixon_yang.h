@@ -59,7 +59,8 @@
                                */
 #ifdef XML_EXPLICIT_INDEX
 #define YANG_FLAG_INDEX 0x08  /* This yang node under list is (extra) index. --> you can access
-                               * list elements using this index with binary search */
+                               * list elements using this index with binary search
+                               * Also set on lists with indexes and on index extension statements */
 #endif
 #define YANG_FLAG_STATE_LOCAL  0x10  /* Local inverted value of Y_CONFIG child */
 #define YANG_FLAG_DISABLED     0x40  /* Disabled due to if-feature evaluate to false
@@ -299,6 +300,11 @@ int        yang_deviation(yang_stmt *ys, void *arg);
 int        yang_spec_print(FILE *f, yang_stmt *yspec);
 int        yang_spec_dump(yang_stmt *yspec, int debuglevel);
 int        if_feature(yang_stmt *yspec, char *module, char *feature);
+int        yang_identity_index_build(yang_stmt *yspec);
+yang_stmt *yang_identity_find(yang_stmt *yspec, const char *module, const char *id);
+yang_stmt *yang_identity_value(yang_stmt *ys, const char *value);
+yang_stmt *yang_identity_base(yang_stmt *ybase);
+int        yang_identity_derived(yang_stmt *yid, yang_stmt *ybase, int self);
 int        ys_populate(yang_stmt *ys, void *arg);
 int        ys_populate2(yang_stmt *ys, void *arg);
 int        yang_apply(yang_stmt *yn, enum rfc_6020 key, yang_applyfn_t fn, int from, void *arg);
@@ -319,6 +325,11 @@ yang_stmt *yang_anydata_add(yang_stmt *yp, char *name);
 int        yang_extension_value(yang_stmt *ys, char *name, char *ns, int *exist, char **value);
 int        yang_sort_subelements(yang_stmt *ys);
 int        yang_init(clixon_handle h);
+#ifdef XML_EXPLICIT_INDEX
+char      *yang_list_index_each(yang_stmt *ylist, int *i);
+char      *yang_list_index_match(yang_stmt *ylist, cvec *cvk);
+char      *yang_list_index_key(yang_stmt *ylist);
+#endif
 int        yang_single_child_type(yang_stmt *ys, enum rfc_6020 subkeyw);
 void      *yang_action_cb_get(yang_stmt *ys);
 int        yang_action_cb_add(yang_stmt *ys, void *rc);
@@ -64,6 +64,7 @@ typedef struct {
  */
 modstate_diff_t * modstate_diff_new(void);
 int modstate_diff_free(modstate_diff_t *);
+int yang_modules_state_diff(yang_stmt *yspec, cxobj *xfrom, cxobj *xto, modstate_diff_t *msdiff);
 
 int yang_modules_init(clixon_handle h);
 char *yang_modules_revision(clixon_handle h);
@@ -0,0 +1,308 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2024 Olof Hagsand
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+
+ *
+ * Cooperative cancellation of long-running operations
+ * An operation, eg a backend RPC, is started with an optional deadline and an optional
+ * socket of the requesting client. Loops over large trees, such as xpath evaluation, tree
+ * copy, serialization and validation, call clixon_cancel_check() which fails when the
+ * deadline has passed or the client has closed its socket. The operation then unwinds via
+ * the regular error path.
+ * An operation may also have a memory budget. Allocations of XML nodes and node vectors
+ * are accounted with clixon_cancel_alloc(), and output buffers are checked with
+ * clixon_cancel_mem(). The operation is cancelled when the budget is exceeded. Memory
+ * freed during the operation is not subtracted, ie the budget limits allocation volume.
+ * Sections that must not be interrupted, eg the commit phase of a transaction or writes
+ * to the datastore cache, are bracketed by clixon_cancel_hold().
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+
+#include <cligen/cligen.h>
+
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_log.h"
+#include "clixon_debug.h"
+#include "clixon_err.h"
+#include "clixon_cancel.h"
+
+/*
+ * Constants
+ */
+/* Number of clixon_cancel_check calls between each check of time and socket */
+#define CANCEL_INTERVAL 1024
+
+/*
+ * Variables
+ */
+static int            _cancel_active = 0;   /* An operation is started */
+static struct timeval _cancel_deadline;     /* Deadline, if set */
+static int            _cancel_fd = -1;      /* Socket of client, or -1 */
+static int            _cancel_hold = 0;     /* Nesting of non-cancellable sections */
+static uint32_t       _cancel_count = 0;    /* Calls since last check */
+static int            _cancel_reason = 0;   /* ETIMEDOUT, ECONNRESET or E2BIG if cancelled */
+static size_t         _cancel_budget = 0;   /* Memory budget in bytes, or 0 */
+static size_t         _cancel_used = 0;     /* Bytes allocated by operation */
+
+/*! Start cancellable operation
+ *
+ * @param[in]  ms   Deadline in milliseconds from now, or 0 for no deadline
+ * @param[in]  fd   Socket of client, cancel if closed, or -1
+ * @retval     0    OK
+ * @see clixon_cancel_stop
+ */
+int
+clixon_cancel_start(uint32_t ms,
+                    int      fd)
+{
+    struct timeval t;
+
+    timerclear(&_cancel_deadline);
+    if (ms){
+        gettimeofday(&t, NULL);
+        _cancel_deadline.tv_sec = ms / 1000;
+        _cancel_deadline.tv_usec = (ms % 1000) * 1000;
+        timeradd(&t, &_cancel_deadline, &_cancel_deadline);
+    }
+    _cancel_fd = fd;
+    _cancel_count = 0;
+    _cancel_reason = 0;
+    _cancel_budget = 0;
+    _cancel_used = 0;
+    _cancel_active = 1;
+    return 0;
+}
+
+/*! Set memory budget of current operation
+ *
+ * @param[in]  max  Max bytes allocated by operation, or 0 for no limit
+ * @retval     0    OK
+ * @see clixon_cancel_alloc
+ */
+int
+clixon_cancel_budget(size_t max)
+{
+    _cancel_budget = max;
+    return 0;
+}
+
+/*! Get bytes allocated by current or last operation
+ */
+size_t
+clixon_cancel_used(void)
+{
+    return _cancel_used;
+}
+
+/*! Stop cancellable operation
+ *
+ * @retval     0    OK
+ */
+int
+clixon_cancel_stop(void)
+{
+    _cancel_active = 0;
+    _cancel_fd = -1;
+    _cancel_budget = 0;
+    timerclear(&_cancel_deadline);
+    return 0;
+}
+
+/*! Enter or leave section that is not cancelled
+ *
+ * Sections may be nested.
+ * @param[in]  on   1: enter, 0: leave
+ * @retval     0    OK
+ */
+int
+clixon_cancel_hold(int on)
+{
+    if (on)
+        _cancel_hold++;
+    else if (_cancel_hold > 0)
+        _cancel_hold--;
+    return 0;
+}
+
+/*! Get reason of cancellation of current or last operation
+ *
+ * @retval     0           Not cancelled
+ * @retval     ETIMEDOUT   Deadline has passed
+ * @retval     ECONNRESET  Client has closed its socket
+ * @retval     E2BIG       Memory budget is exceeded
+ */
+int
+clixon_cancel_reason(void)
+{
+    return _cancel_reason;
+}
+
+/*! Check if client socket is closed without consuming any pending input
+ *
+ * @param[in]  fd   Socket
+ * @retval     1    Closed
+ * @retval     0    Open
+ */
+static int
+cancel_fd_closed(int fd)
+{
+    struct pollfd pfd = {fd, POLLIN, 0};
+    char          c;
+
+    if (poll(&pfd, 1, 0) <= 0)
+        return 0;
+    if (pfd.revents & (POLLHUP | POLLERR | POLLNVAL))
+        return 1;
+    /* Readable: either pending requests or end-of-file */
+    if (pfd.revents & POLLIN)
+        return recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 0;
+    return 0;
+}
+
+/*! Set error of cancelled operation
+ *
+ * @retval    -1    Always
+ */
+static int
+cancel_err(void)
+{
+    switch (_cancel_reason){
+    case ETIMEDOUT:
+        clixon_err(OE_EVENTS, ETIMEDOUT, "Deadline exceeded");
+        break;
+    case E2BIG:
+        clixon_err(OE_EVENTS, E2BIG, "Memory budget exceeded");
+        break;
+    default:
+        clixon_err(OE_EVENTS, ECONNRESET, "Client closed session");
+        break;
+    }
+    return -1;
+}
+
+/*! Check if current operation is cancelled
+ *
+ * In loops, deadline and client socket are only checked every CANCEL_INTERVAL call.
+ * Once cancelled, all subsequent checks of the operation fail.
+ * @param[in]  now  Check deadline and socket now, eg before calling a plugin callback
+ * @retval     0    Continue
+ * @retval    -1    Cancelled, clixon_err is set
+ * @code
+ *   if (clixon_cancel_check(0) < 0)
+ *      goto done;
+ * @endcode
+ */
+int
+clixon_cancel_check(int now)
+{
+    struct timeval t;
+
+    if (!_cancel_active || _cancel_hold)
+        return 0;
+    if (_cancel_reason == 0){
+        if (!now && ++_cancel_count < CANCEL_INTERVAL)
+            return 0;
+        _cancel_count = 0;
+        if (timerisset(&_cancel_deadline)){
+            gettimeofday(&t, NULL);
+            if (timercmp(&t, &_cancel_deadline, >))
+                _cancel_reason = ETIMEDOUT;
+        }
+        if (_cancel_reason == 0 && _cancel_fd != -1 && cancel_fd_closed(_cancel_fd))
+            _cancel_reason = ECONNRESET;
+        if (_cancel_reason == 0)
+            return 0;
+        clixon_debug(CLIXON_DBG_DEFAULT, "cancelled: %s", strerror(_cancel_reason));
+    }
+    return cancel_err();
+}
+
+/*! Account memory allocated by current operation
+ *
+ * @param[in]  len  Bytes allocated
+ * @retval     0    Continue
+ * @retval    -1    Cancelled, clixon_err is set
+ * @code
+ *   if ((x = malloc(len)) == NULL)
+ *      err;
+ *   if (clixon_cancel_alloc(len) < 0){
+ *      free(x);
+ *      err;
+ *   }
+ * @endcode
+ */
+int
+clixon_cancel_alloc(size_t len)
+{
+    if (!_cancel_active || _cancel_hold)
+        return 0;
+    _cancel_used += len;
+    return clixon_cancel_mem(0);
+}
+
+/*! Check if allocated memory and a buffer of given size exceeds the budget
+ *
+ * Use for buffers that grow, eg a cbuf during serialization, where the current size
+ * is known but allocations are not accounted.
+ * @param[in]  len  Current size of buffer
+ * @retval     0    Continue
+ * @retval    -1    Cancelled, clixon_err is set
+ */
+int
+clixon_cancel_mem(size_t len)
+{
+    if (!_cancel_active || _cancel_hold)
+        return 0;
+    if (_cancel_reason == 0){
+        if (_cancel_budget == 0 || _cancel_used + len <= _cancel_budget)
+            return 0;
+        _cancel_reason = E2BIG;
+        clixon_debug(CLIXON_DBG_DEFAULT, "cancelled: %zu bytes", _cancel_used + len);
+    }
+    return cancel_err();
+}
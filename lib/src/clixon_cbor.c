@@ -0,0 +1,1459 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2024 Olof Hagsand
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * YANG-CBOR: Encoding of data modeled with YANG in CBOR, RFC 9254
+ * Only name-based member identifiers are supported, ie the same qualified names as in
+ * RFC 7951 JSON, module name qualifying a member if it differs from its parent.
+ * SIDs (YANG schema item identifiers) require .sid files and are not supported.
+ * Values are encoded according to their YANG type:
+ *   integers                   CBOR unsigned or negative integer
+ *   decimal64                  Decimal fraction, tag 4: [exponent, mantissa]
+ *   boolean                    CBOR true / false
+ *   empty                      CBOR null
+ *   binary                     Byte string (base64 text in XML)
+ *   identityref                Text string <module>:<identity>
+ *   others, or if unknown      Text string
+ * Containers are encoded as maps, lists and leaf-lists as arrays of entries.
+ * XML attributes (eg RFC 7952 meta-data) are not encoded.
+ * The decoder is type-agnostic: integers are decoded to decimal strings, etc, and the
+ * XML tree is then bound to YANG as in the JSON parser.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <syslog.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_queue.h"
+#include "clixon_string.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_debug.h"
+#include "clixon_yang_type.h"
+#include "clixon_yang_module.h"
+#include "clixon_xml_sort.h"
+#include "clixon_xml_bind.h"
+#include "clixon_xml_nsctx.h"
+#include "clixon_netconf_lib.h"
+#include "clixon_json.h"
+#include "clixon_cbor.h"
+
+/* Size of read chunks when parsing from file */
+#define CBOR_BUFLEN 4096
+
+/* Top symbol if xt is not given (same as JSON) */
+#define CBOR_TOP_SYMBOL "top"
+
+/* Tag number of decimal fraction, RFC 8949 Sec 3.4.4 */
+#define CBOR_TAG_DECIMAL 4
+
+/* Additional information of indefinite length items */
+#define CBOR_AI_INDEF 31
+
+/* Stop code of indefinite length items */
+#define CBOR_BREAK 0xff
+
+/* Max absolute value of decimal fraction exponent, decimal64 has at most 18 fraction-digits */
+#define CBOR_EXP_MAX 20
+
+/* Max nesting depth of maps when decoding, limits recursion on untrusted input */
+#define CBOR_DEPTH_MAX 256
+
+/*! CBOR decoder state
+ */
+struct cbor_parse{
+    const uint8_t *cp_buf;  /* Input buffer */
+    size_t         cp_len;  /* Length of input buffer */
+    size_t         cp_pos;  /* Current position in input buffer */
+    int            cp_depth; /* Nesting depth of maps */
+};
+typedef struct cbor_parse cbor_parse;
+
+static const char b64chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/*! Encode CBOR data item head: major type and argument
+ *
+ * The shortest form of the argument is always used (preferred serialization)
+ * @param[in,out] cb     CLIgen buffer
+ * @param[in]     major  Major type, eg CBOR_MAP
+ * @param[in]     val    Argument: value, length or number of items
+ * @retval        0      OK
+ * @retval       -1      Error
+ * @see RFC 8949 Sec 3 and 4.1
+ */
+int
+clixon_cbor_head(cbuf    *cb,
+                 int      major,
+                 uint64_t val)
+{
+    uint8_t buf[9];
+    size_t  len;
+    size_t  i;
+
+    buf[0] = (major & 0x07) << 5;
+    if (val < 24){
+        buf[0] |= val;
+        len = 1;
+    }
+    else if (val <= UINT8_MAX){
+        buf[0] |= 24;
+        len = 2;
+    }
+    else if (val <= UINT16_MAX){
+        buf[0] |= 25;
+        len = 3;
+    }
+    else if (val <= UINT32_MAX){
+        buf[0] |= 26;
+        len = 5;
+    }
+    else{
+        buf[0] |= 27;
+        len = 9;
+    }
+    for (i = len-1; i > 0; i--){
+        buf[i] = val & 0xff;
+        val >>= 8;
+    }
+    if (cbuf_append_buf(cb, buf, len) < 0){
+        clixon_err(OE_CBOR, errno, "cbuf_append_buf");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Encode a byte or text string
+ *
+ * @param[in,out] cb     CLIgen buffer
+ * @param[in]     major  CBOR_BYTES or CBOR_TEXT
+ * @param[in]     buf    String
+ * @param[in]     len    Length of string
+ * @retval        0      OK
+ * @retval       -1      Error
+ */
+static int
+cbor_encode_string(cbuf       *cb,
+                   int         major,
+                   const char *buf,
+                   size_t      len)
+{
+    if (clixon_cbor_head(cb, major, len) < 0)
+        return -1;
+    if (len && cbuf_append_buf(cb, (void*)buf, len) < 0){
+        clixon_err(OE_CBOR, errno, "cbuf_append_buf");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Encode a text string
+ *
+ * @param[in,out] cb     CLIgen buffer
+ * @param[in]     str    UTF-8 string
+ * @retval        0      OK
+ * @retval       -1      Error
+ */
+int
+clixon_cbor_text(cbuf       *cb,
+                 const char *str)
+{
+    return cbor_encode_string(cb, CBOR_TEXT, str, strlen(str));
+}
+
+/*! Decode a base64 string into binary data
+ *
+ * @param[in]  str   Base64 string, whitespace is ignored
+ * @param[out] cb    Binary data
+ * @retval     1     OK
+ * @retval     0     Not valid base64
+ * @retval    -1     Error
+ */
+static int
+cbor_b64_decode(const char *str,
+                cbuf       *cb)
+{
+    const char *p;
+    char       *s;
+    uint32_t    acc = 0;
+    int         bits = 0;
+    int         pad = 0;
+    uint8_t     c;
+
+    for (p = str; *p; p++){
+        if (isspace((unsigned char)*p))
+            continue;
+        if (*p == '='){
+            pad++;
+            continue;
+        }
+        if (pad || (s = strchr(b64chars, *p)) == NULL)
+            return 0;
+        acc = (acc << 6) | (s - b64chars);
+        bits += 6;
+        if (bits >= 8){
+            bits -= 8;
+            c = (acc >> bits) & 0xff;
+            if (cbuf_append_buf(cb, &c, 1) < 0){
+                clixon_err(OE_CBOR, errno, "cbuf_append_buf");
+                return -1;
+            }
+        }
+    }
+    return 1;
+}
+
+/*! Encode binary data as base64 string
+ *
+ * @param[in]  buf   Binary data
+ * @param[in]  len   Length of data
+ * @param[out] cb    Base64 string
+ */
+static void
+cbor_b64_encode(const uint8_t *buf,
+                size_t         len,
+                cbuf          *cb)
+{
+    size_t   i;
+    uint32_t v;
+
+    for (i = 0; i < len; i += 3){
+        v = buf[i] << 16;
+        if (i+1 < len)
+            v |= buf[i+1] << 8;
+        if (i+2 < len)
+            v |= buf[i+2];
+        cprintf(cb, "%c%c%c%c",
+                b64chars[(v >> 18) & 0x3f],
+                b64chars[(v >> 12) & 0x3f],
+                i+1 < len ? b64chars[(v >> 6) & 0x3f] : '=',
+                i+2 < len ? b64chars[v & 0x3f] : '=');
+    }
+}
+
+/*! Encode integer string as CBOR unsigned or negative integer
+ *
+ * @param[in,out] cb        CLIgen buffer
+ * @param[in]     body      Integer as decimal string
+ * @param[in]     issigned  Signed YANG type
+ * @retval        1         OK
+ * @retval        0         Not an integer, nothing encoded
+ * @retval       -1         Error
+ */
+static int
+cbor_encode_int(cbuf *cb,
+                char *body,
+                int   issigned)
+{
+    char    *ep = NULL;
+    int64_t  i;
+    uint64_t u;
+
+    errno = 0;
+    if (issigned){
+        i = strtoll(body, &ep, 10);
+        if (errno || ep == body || *ep != '\0')
+            return 0;
+        if (i < 0){
+            if (clixon_cbor_head(cb, CBOR_NINT, (uint64_t)(-1 - i)) < 0)
+                return -1;
+        }
+        else if (clixon_cbor_head(cb, CBOR_UINT, i) < 0)
+            return -1;
+    }
+    else{
+        if (*body == '-')
+            return 0;
+        u = strtoull(body, &ep, 10);
+        if (errno || ep == body || *ep != '\0')
+            return 0;
+        if (clixon_cbor_head(cb, CBOR_UINT, u) < 0)
+            return -1;
+    }
+    return 1;
+}
+
+/*! Encode decimal64 string as CBOR decimal fraction, tag 4: [exponent, mantissa]
+ *
+ * The number of fraction digits of the string is kept, eg "1.50" is [-2, 150]
+ * @param[in,out] cb    CLIgen buffer
+ * @param[in]     body  Decimal number as string
+ * @retval        1     OK
+ * @retval        0     Not a decimal number, nothing encoded
+ * @retval       -1     Error
+ * @see RFC 9254 Sec 6.3
+ */
+static int
+cbor_encode_decimal(cbuf *cb,
+                    char *body)
+{
+    char    *p = body;
+    int      neg = 0;
+    int      frac = 0;
+    int      digits = 0;
+    int      exp = 0;
+    uint64_t m = 0;
+
+    if (*p == '-' || *p == '+')
+        neg = (*p++ == '-');
+    for (; *p; p++){
+        if (*p == '.' && !frac){
+            frac++;
+            continue;
+        }
+        if (!isdigit((unsigned char)*p) || m > (UINT64_MAX - 9) / 10)
+            return 0;
+        m = m*10 + (*p - '0');
+        digits++;
+        if (frac)
+            exp--;
+    }
+    if (digits == 0)
+        return 0;
+    if (clixon_cbor_head(cb, CBOR_TAG, CBOR_TAG_DECIMAL) < 0 ||
+        clixon_cbor_head(cb, CBOR_ARRAY, 2) < 0)
+        return -1;
+    if (exp < 0){
+        if (clixon_cbor_head(cb, CBOR_NINT, -1 - exp) < 0)
+            return -1;
+    }
+    else if (clixon_cbor_head(cb, CBOR_UINT, exp) < 0)
+        return -1;
+    if (neg && m){
+        if (clixon_cbor_head(cb, CBOR_NINT, m - 1) < 0)
+            return -1;
+    }
+    else if (clixon_cbor_head(cb, CBOR_UINT, m) < 0)
+        return -1;
+    return 1;
+}
+
+/*! Encode identityref as text string <module>:<identity>
+ *
+ * Module is omitted if it is the same as the module of the leaf, as in JSON
+ * @param[in,out] cb    CLIgen buffer
+ * @param[in]     x     XML leaf
+ * @param[in]     body  Identityref as XML <prefix>:<identity>
+ * @param[in]     y     Yang spec of leaf
+ * @retval        0     OK
+ * @retval       -1     Error
+ * @see xml2json_encode_identityref
+ */
+static int
+cbor_encode_identityref(cbuf      *cb,
+                        cxobj     *x,
+                        char      *body,
+                        yang_stmt *y)
+{
+    int        retval = -1;
+    char      *prefix = NULL;
+    char      *id = NULL;
+    char      *ns = NULL;
+    yang_stmt *ymod = NULL;
+    cbuf      *cbv = NULL;
+
+    if (nodeid_split(body, &prefix, &id) < 0)
+        goto done;
+    if (xml2ns(x, prefix, &ns) < 0)
+        goto done;
+    if (ns != NULL)
+        ymod = yang_find_module_by_namespace(ys_spec(y), ns);
+    if (ymod == NULL || ymod == ys_module(y)){
+        if (clixon_cbor_text(cb, id) < 0)
+            goto done;
+    }
+    else {
+        if ((cbv = cbuf_new()) == NULL){
+            clixon_err(OE_CBOR, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(cbv, "%s:%s", yang_argument_get(ymod), id);
+        if (clixon_cbor_text(cb, cbuf_get(cbv)) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (prefix)
+        free(prefix);
+    if (id)
+        free(id);
+    if (cbv)
+        cbuf_free(cbv);
+    return retval;
+}
+
+/*! Encode value of leaf or leaf-list entry according to its YANG type
+ *
+ * Values that do not match their type are encoded as text strings
+ * @param[in,out] cb    CLIgen buffer
+ * @param[in]     x     XML leaf
+ * @param[in]     y     Yang spec of leaf
+ * @retval        0     OK
+ * @retval       -1     Error
+ */
+static int
+cbor_encode_leaf(cbuf      *cb,
+                 cxobj     *x,
+                 yang_stmt *y)
+{
+    int        retval = -1;
+    char      *body;
+    char      *origtype = NULL;
+    yang_stmt *ytype = NULL;
+    char      *restype;
+    cbuf      *cbb = NULL;
+    int        ret = 0;
+
+    if (yang_type_get(y, &origtype, &ytype, NULL, NULL, NULL, NULL, NULL) < 0)
+        goto done;
+    restype = ytype?yang_argument_get(ytype):"";
+    if ((body = xml_body(x)) == NULL){
+        if (strcmp(restype, "empty") == 0)
+            ret = clixon_cbor_head(cb, CBOR_SIMPLE, CBOR_NULL);
+        else
+            ret = clixon_cbor_text(cb, "");
+        if (ret < 0)
+            goto done;
+        goto ok;
+    }
+    if (strcmp(restype, "identityref") == 0){
+        if (cbor_encode_identityref(cb, x, body, y) < 0)
+            goto done;
+        goto ok;
+    }
+    if (strcmp(restype, "binary") == 0){
+        if ((cbb = cbuf_new()) == NULL){
+            clixon_err(OE_CBOR, errno, "cbuf_new");
+            goto done;
+        }
+        if ((ret = cbor_b64_decode(body, cbb)) < 0)
+            goto done;
+        if (ret == 1 &&
+            cbor_encode_string(cb, CBOR_BYTES, cbuf_get(cbb), cbuf_len(cbb)) < 0)
+            goto done;
+    }
+    else switch (yang_type2cv(y)){
+    case CGV_INT8:
+    case CGV_INT16:
+    case CGV_INT32:
+    case CGV_INT64:
+        if ((ret = cbor_encode_int(cb, body, 1)) < 0)
+            goto done;
+        break;
+    case CGV_UINT8:
+    case CGV_UINT16:
+    case CGV_UINT32:
+    case CGV_UINT64:
+        if ((ret = cbor_encode_int(cb, body, 0)) < 0)
+            goto done;
+        break;
+    case CGV_DEC64:
+        if ((ret = cbor_encode_decimal(cb, body)) < 0)
+            goto done;
+        break;
+    case CGV_BOOL:
+        if (strcmp(body, "true") == 0 || strcmp(body, "false") == 0){
+            if (clixon_cbor_head(cb, CBOR_SIMPLE, *body=='t'?CBOR_TRUE:CBOR_FALSE) < 0)
+                goto done;
+            ret = 1;
+        }
+        break;
+    default:
+        break;
+    }
+    if (ret == 0 && clixon_cbor_text(cb, body) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (origtype)
+        free(origtype);
+    if (cbb)
+        cbuf_free(cbb);
+    return retval;
+}
+
+/*! Encode member name, qualified with module name if it differs from parent's
+ *
+ * @param[in,out] cb        CLIgen buffer
+ * @param[in]     x         XML node
+ * @param[in]     modname0  Module name of parent, or NULL
+ * @param[out]    modname   Module name of x, to pass to children
+ * @retval        0         OK
+ * @retval       -1         Error
+ */
+static int
+cbor_encode_name(cbuf   *cb,
+                 cxobj  *x,
+                 char   *modname0,
+                 char  **modname)
+{
+    int        retval = -1;
+    yang_stmt *y;
+    yang_stmt *ymod = NULL;
+    char      *mod = NULL;
+    char      *name;
+    size_t     len;
+
+    if ((y = xml_spec(x)) != NULL){
+        if (ys_real_module(y, &ymod) < 0)
+            goto done;
+        if (ymod){
+            mod = yang_argument_get(ymod);
+            /* Special case for ietf-netconf -> ietf-restconf translation
+             * See also xml2json1_cbuf() */
+            if (strcmp(mod, "ietf-netconf") == 0)
+                mod = "ietf-restconf";
+        }
+    }
+    name = xml_name(x);
+    if (mod && (modname0 == NULL || strcmp(mod, modname0) != 0)){
+        len = strlen(mod);
+        if (clixon_cbor_head(cb, CBOR_TEXT, len + 1 + strlen(name)) < 0)
+            goto done;
+        if (cbuf_append_buf(cb, mod, len) < 0 ||
+            cbuf_append(cb, ':') < 0 ||
+            cbuf_append_buf(cb, name, strlen(name)) < 0){
+            clixon_err(OE_CBOR, errno, "cbuf_append");
+            goto done;
+        }
+    }
+    else if (clixon_cbor_text(cb, name) < 0)
+        goto done;
+    *modname = mod?mod:modname0;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get member i of a vector, or child i of a parent if vector is NULL
+ */
+static inline cxobj *
+cbor_member_i(cxobj  *xp,
+              cxobj **vec,
+              size_t  i)
+{
+    return vec ? vec[i] : xml_child_i(xp, i);
+}
+
+/*! Check if two sibling nodes are entries of the same member
+ */
+static int
+cbor_member_same(cxobj *x0,
+                 cxobj *x1)
+{
+    if (xml_spec(x0) != xml_spec(x1))
+        return 0;
+    if (strcmp(xml_name(x0), xml_name(x1)) != 0)
+        return 0;
+    if (xml_spec(x0) == NULL && clicon_strcmp(xml_prefix(x0), xml_prefix(x1)) != 0)
+        return 0;
+    return 1;
+}
+
+static int cbor_encode_map(cbuf *cb, cxobj *xp, cxobj **vec, size_t veclen, char *modname0);
+
+/*! Encode value of an XML node: map, leaf value or text
+ *
+ * @param[in,out] cb       CLIgen buffer
+ * @param[in]     x        XML node
+ * @param[in]     modname  Module name of x
+ * @retval        0        OK
+ * @retval       -1        Error
+ */
+static int
+cbor_encode_value(cbuf  *cb,
+                  cxobj *x,
+                  char  *modname)
+{
+    yang_stmt    *y;
+    enum rfc_6020 keyword = Y_CONTAINER;
+    char         *body;
+
+    if ((y = xml_spec(x)) != NULL)
+        keyword = yang_keyword_get(y);
+    if (y && (keyword == Y_LEAF || keyword == Y_LEAF_LIST))
+        return cbor_encode_leaf(cb, x, y);
+    if (xml_child_each(x, NULL, CX_ELMNT) != NULL)
+        return cbor_encode_map(cb, x, NULL, 0, modname);
+    if ((body = xml_body(x)) != NULL)
+        return clixon_cbor_text(cb, body);
+    return clixon_cbor_head(cb, CBOR_MAP, 0);
+}
+
+/*! Encode XML nodes as members of a CBOR map
+ *
+ * Consecutive siblings with same name are encoded as one member whose value is an
+ * array of entries, as are list and leaf-list entries in general.
+ * @param[in,out] cb        CLIgen buffer
+ * @param[in]     xp        Parent of members, if vec is NULL
+ * @param[in]     vec       Vector of members, or NULL
+ * @param[in]     veclen    Length of vec
+ * @param[in]     modname0  Module name of parent, or NULL
+ * @retval        0         OK
+ * @retval       -1         Error
+ */
+static int
+cbor_encode_map(cbuf   *cb,
+                cxobj  *xp,
+                cxobj **vec,
+                size_t  veclen,
+                char   *modname0)
+{
+    int           retval = -1;
+    size_t        n;
+    size_t        i;
+    size_t        j;
+    size_t        k;
+    cxobj        *x;
+    cxobj        *xn;
+    cxobj        *xprev = NULL;
+    uint64_t      members = 0;
+    uint64_t      entries;
+    yang_stmt    *y;
+    enum rfc_6020 keyword;
+    char         *modname = NULL;
+
+    n = vec ? veclen : xml_child_nr(xp);
+    for (i = 0; i < n; i++){
+        x = cbor_member_i(xp, vec, i);
+        if (xml_type(x) != CX_ELMNT)
+            continue;
+        if (xprev == NULL || !cbor_member_same(xprev, x))
+            members++;
+        xprev = x;
+    }
+    if (clixon_cbor_head(cb, CBOR_MAP, members) < 0)
+        goto done;
+    i = 0;
+    while (i < n){
+        x = cbor_member_i(xp, vec, i);
+        if (xml_type(x) != CX_ELMNT){
+            i++;
+            continue;
+        }
+        entries = 1;
+        for (j = i+1; j < n; j++){
+            xn = cbor_member_i(xp, vec, j);
+            if (xml_type(xn) != CX_ELMNT)
+                continue;
+            if (!cbor_member_same(x, xn))
+                break;
+            entries++;
+        }
+        if (cbor_encode_name(cb, x, modname0, &modname) < 0)
+            goto done;
+        keyword = (y = xml_spec(x)) != NULL ? yang_keyword_get(y) : Y_CONTAINER;
+        if (entries > 1 || keyword == Y_LIST || keyword == Y_LEAF_LIST){
+            if (clixon_cbor_head(cb, CBOR_ARRAY, entries) < 0)
+                goto done;
+        }
+        for (k = i; k < j; k++){
+            xn = cbor_member_i(xp, vec, k);
+            if (xml_type(xn) != CX_ELMNT)
+                continue;
+            if (cbor_encode_value(cb, xn, modname) < 0)
+                goto done;
+        }
+        i = j;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Translate an XML tree to YANG-CBOR in a CLIgen buffer
+ *
+ * XML namespaces in tree, RFC 9254 name-based encoding in output, assume yang populated
+ * @param[in,out] cb      CLIgen buffer to write to
+ * @param[in]     xt      Top-level XML object
+ * @param[in]     skiptop 0: Include top object 1: Skip top-object, only children
+ * @retval        0       OK
+ * @retval       -1       Error
+ * @code
+ *   cbuf *cb = cbuf_new();
+ *   if (clixon_cbor2cbuf(cb, xt, 0) < 0)
+ *     goto err;
+ *   fwrite(cbuf_get(cb), 1, cbuf_len(cb), f);
+ *   cbuf_free(cb);
+ * @endcode
+ * @note Output is binary, use cbuf_len() and not string functions on cb
+ * @see clixon_json2cbuf  JSON corresponding function
+ */
+int
+clixon_cbor2cbuf(cbuf  *cb,
+                 cxobj *xt,
+                 int    skiptop)
+{
+    if (skiptop)
+        return cbor_encode_map(cb, xt, NULL, 0, NULL);
+    else
+        return cbor_encode_map(cb, NULL, &xt, 1, NULL);
+}
+
+/*! Translate a vector of XML objects to YANG-CBOR as members of one map
+ *
+ * Objects are encoded in place, ie namespace context of ancestors is used
+ * @param[in,out] cb      CLIgen buffer to write to
+ * @param[in]     vec     Vector of XML objects
+ * @param[in]     veclen  Length of vector
+ * @retval        0       OK
+ * @retval       -1       Error
+ * @see xml2json_cbuf_vec  JSON corresponding function
+ */
+int
+clixon_cbor2cbuf_vec(cbuf   *cb,
+                     cxobj **vec,
+                     size_t  veclen)
+{
+    return cbor_encode_map(cb, NULL, vec, veclen, NULL);
+}
+
+/*! Translate an XML tree to YANG-CBOR and write to file
+ *
+ * @param[in]  f       File to write to
+ * @param[in]  xt      Top-level XML object
+ * @param[in]  skiptop 0: Include top object 1: Skip top-object, only children
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see clixon_json2file  JSON corresponding function
+ */
+int
+clixon_cbor2file(FILE  *f,
+                 cxobj *xt,
+                 int    skiptop)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_CBOR, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_cbor2cbuf(cb, xt, skiptop) < 0)
+        goto done;
+    if (fwrite(cbuf_get(cb), 1, cbuf_len(cb), f) != cbuf_len(cb)){
+        clixon_err(OE_UNIX, errno, "fwrite");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Decode head of a CBOR data item
+ *
+ * @param[in]  cp     Decoder state
+ * @param[out] major  Major type
+ * @param[out] ai     Additional information, CBOR_AI_INDEF if indefinite length
+ * @param[out] val    Argument: value, length or number of items
+ * @retval     0      OK
+ * @retval    -1      Error, malformed data
+ */
+static int
+cbor_decode_head(cbor_parse *cp,
+                 int        *major,
+                 int        *ai,
+                 uint64_t   *val)
+{
+    uint8_t ib;
+    size_t  n;
+    size_t  i;
+
+    if (cp->cp_pos >= cp->cp_len){
+        clixon_err(OE_CBOR, 0, "Premature end of CBOR data");
+        return -1;
+    }
+    ib = cp->cp_buf[cp->cp_pos++];
+    *major = ib >> 5;
+    *ai = ib & 0x1f;
+    *val = 0;
+    if (*ai < 24){
+        *val = *ai;
+        return 0;
+    }
+    switch (*ai){
+    case 24:
+        n = 1;
+        break;
+    case 25:
+        n = 2;
+        break;
+    case 26:
+        n = 4;
+        break;
+    case 27:
+        n = 8;
+        break;
+    case CBOR_AI_INDEF:
+        if (*major == CBOR_UINT || *major == CBOR_NINT || *major == CBOR_TAG){
+            clixon_err(OE_CBOR, 0, "Indefinite length of CBOR major type %d", *major);
+            return -1;
+        }
+        return 0;
+    default:
+        clixon_err(OE_CBOR, 0, "Reserved CBOR additional information %d", *ai);
+        return -1;
+    }
+    if (cp->cp_len - cp->cp_pos < n){
+        clixon_err(OE_CBOR, 0, "Premature end of CBOR data");
+        return -1;
+    }
+    for (i = 0; i < n; i++)
+        *val = (*val << 8) | cp->cp_buf[cp->cp_pos++];
+    return 0;
+}
+
+/*! Check and consume stop code of indefinite length item
+ *
+ * @retval  1  Break, consumed
+ * @retval  0  No break
+ */
+static int
+cbor_decode_break(cbor_parse *cp)
+{
+    if (cp->cp_pos < cp->cp_len && cp->cp_buf[cp->cp_pos] == CBOR_BREAK){
+        cp->cp_pos++;
+        return 1;
+    }
+    return 0;
+}
+
+/*! Check that number of items can be present in remaining data
+ *
+ * Sanity check before iterating over items of arrays or maps
+ */
+static int
+cbor_decode_check(cbor_parse *cp,
+                  int         ai,
+                  uint64_t    items)
+{
+    if (ai != CBOR_AI_INDEF && items > cp->cp_len - cp->cp_pos){
+        clixon_err(OE_CBOR, 0, "Premature end of CBOR data");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Decode a byte or text string, definite or indefinite length
+ *
+ * @param[in]  cp     Decoder state
+ * @param[in]  major  CBOR_BYTES or CBOR_TEXT
+ * @param[in]  ai     Additional information of head
+ * @param[in]  len    Length of string
+ * @param[out] cbv    String is appended to this buffer
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+cbor_decode_string(cbor_parse *cp,
+                   int         major,
+                   int         ai,
+                   uint64_t    len,
+                   cbuf       *cbv)
+{
+    int      major1;
+    int      ai1;
+    uint64_t len1;
+
+    if (ai == CBOR_AI_INDEF){
+        while (!cbor_decode_break(cp)){
+            if (cbor_decode_head(cp, &major1, &ai1, &len1) < 0)
+                return -1;
+            if (major1 != major || ai1 == CBOR_AI_INDEF){
+                clixon_err(OE_CBOR, 0, "Invalid chunk of indefinite length CBOR string");
+                return -1;
+            }
+            if (cbor_decode_string(cp, major1, ai1, len1, cbv) < 0)
+                return -1;
+        }
+        return 0;
+    }
+    if (len > cp->cp_len - cp->cp_pos){
+        clixon_err(OE_CBOR, 0, "Premature end of CBOR data");
+        return -1;
+    }
+    if (len && cbuf_append_buf(cbv, (void*)(cp->cp_buf + cp->cp_pos), len) < 0){
+        clixon_err(OE_CBOR, errno, "cbuf_append_buf");
+        return -1;
+    }
+    cp->cp_pos += len;
+    return 0;
+}
+
+/*! Decode an integer data item
+ *
+ * @param[in]  cp     Decoder state
+ * @param[out] neg    Set if negative
+ * @param[out] abs    Absolute value
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+cbor_decode_int(cbor_parse *cp,
+                int        *neg,
+                uint64_t   *abs)
+{
+    int      major;
+    int      ai;
+    uint64_t val;
+
+    if (cbor_decode_head(cp, &major, &ai, &val) < 0)
+        return -1;
+    if (major == CBOR_UINT){
+        *neg = 0;
+        *abs = val;
+    }
+    else if (major == CBOR_NINT && val < UINT64_MAX){
+        *neg = 1;
+        *abs = val + 1;
+    }
+    else{
+        clixon_err(OE_CBOR, 0, "Expected CBOR integer");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Decode CBOR decimal fraction [exponent, mantissa] to decimal string
+ *
+ * @param[in]  cp     Decoder state, after tag 4
+ * @param[out] cbv    Decimal string
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see cbor_encode_decimal
+ */
+static int
+cbor_decode_decimal(cbor_parse *cp,
+                    cbuf       *cbv)
+{
+    int      major;
+    int      ai;
+    uint64_t val;
+    int      eneg;
+    uint64_t e;
+    int      neg;
+    uint64_t m;
+    char     digits[24];
+    size_t   len;
+
+    if (cbor_decode_head(cp, &major, &ai, &val) < 0)
+        return -1;
+    if (major != CBOR_ARRAY || val != 2){
+        clixon_err(OE_CBOR, 0, "CBOR decimal fraction is not an array of two integers");
+        return -1;
+    }
+    if (cbor_decode_int(cp, &eneg, &e) < 0 ||
+        cbor_decode_int(cp, &neg, &m) < 0)
+        return -1;
+    if (e > CBOR_EXP_MAX){
+        clixon_err(OE_CBOR, 0, "CBOR decimal fraction exponent out of range");
+        return -1;
+    }
+    len = snprintf(digits, sizeof(digits), "%" PRIu64, m);
+    if (neg)
+        cprintf(cbv, "-");
+    if (!eneg){
+        cprintf(cbv, "%s", digits);
+        for (; e > 0; e--)
+            cprintf(cbv, "0");
+    }
+    else if (len <= e){
+        cprintf(cbv, "0.");
+        for (; e > len; e--)
+            cprintf(cbv, "0");
+        cprintf(cbv, "%s", digits);
+    }
+    else
+        cprintf(cbv, "%.*s.%s", (int)(len - e), digits, digits + len - e);
+    return 0;
+}
+
+static int cbor_decode_map(cbor_parse *cp, cxobj *xp, int ai, uint64_t n);
+
+/*! Decode a CBOR data item as value of an XML element
+ *
+ * Maps are decoded as child elements, other items as body
+ * @param[in]  cp     Decoder state
+ * @param[in]  x      XML element
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+cbor_decode_value(cbor_parse *cp,
+                  cxobj      *x)
+{
+    int      retval = -1;
+    int      major;
+    int      ai;
+    uint64_t val;
+    cbuf    *cbv = NULL;
+    cbuf    *cbb = NULL;
+    cxobj   *xb;
+
+    if (cbor_decode_head(cp, &major, &ai, &val) < 0)
+        goto done;
+    /* Tags other than decimal fraction are ignored */
+    while (major == CBOR_TAG && val != CBOR_TAG_DECIMAL)
+        if (cbor_decode_head(cp, &major, &ai, &val) < 0)
+            goto done;
+    if ((cbv = cbuf_new()) == NULL){
+        clixon_err(OE_CBOR, errno, "cbuf_new");
+        goto done;
+    }
+    switch (major){
+    case CBOR_UINT:
+        cprintf(cbv, "%" PRIu64, val);
+        break;
+    case CBOR_NINT:
+        if (val == UINT64_MAX){
+            clixon_err(OE_CBOR, 0, "CBOR negative integer out of range");
+            goto done;
+        }
+        cprintf(cbv, "-%" PRIu64, val + 1);
+        break;
+    case CBOR_BYTES:
+        if ((cbb = cbuf_new()) == NULL){
+            clixon_err(OE_CBOR, errno, "cbuf_new");
+            goto done;
+        }
+        if (cbor_decode_string(cp, major, ai, val, cbb) < 0)
+            goto done;
+        cbor_b64_encode((uint8_t*)cbuf_get(cbb), cbuf_len(cbb), cbv);
+        break;
+    case CBOR_TEXT:
+        if (cbor_decode_string(cp, major, ai, val, cbv) < 0)
+            goto done;
+        break;
+    case CBOR_ARRAY:
+        clixon_err(OE_CBOR, 0, "Nested CBOR array not expected");
+        goto done;
+        break;
+    case CBOR_MAP:
+        if (cbor_decode_map(cp, x, ai, val) < 0)
+            goto done;
+        goto ok;
+        break;
+    case CBOR_TAG: /* decimal fraction */
+        if (cbor_decode_decimal(cp, cbv) < 0)
+            goto done;
+        break;
+    case CBOR_SIMPLE:
+        if (ai == CBOR_FALSE)
+            cprintf(cbv, "false");
+        else if (ai == CBOR_TRUE)
+            cprintf(cbv, "true");
+        else if (ai == CBOR_NULL)
+            goto ok; /* YANG empty type */
+        else{
+            clixon_err(OE_CBOR, 0, "CBOR float or simple value %d not supported", ai);
+            goto done;
+        }
+        break;
+    }
+    if (cbuf_len(cbv)){
+        if ((xb = xml_new("body", x, CX_BODY)) == NULL)
+            goto done;
+        if (xml_value_set(xb, cbuf_get(cbv)) < 0)
+            goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (cbv)
+        cbuf_free(cbv);
+    if (cbb)
+        cbuf_free(cbb);
+    return retval;
+}
+
+/*! Create XML element from member name
+ *
+ * Names on the form <module>:<name> are split, and module is set as prefix as in
+ * the JSON parser, to be translated to namespace later
+ * @see json_current_new
+ */
+static cxobj *
+cbor_decode_element(cxobj *xp,
+                    char  *prefix,
+                    char  *id)
+{
+    cxobj *x;
+
+    if ((x = xml_new(id, xp, CX_ELMNT)) == NULL)
+        return NULL;
+    if (xml_prefix_set(x, prefix) < 0)
+        return NULL;
+    return x;
+}
+
+/*! Decode one map member: name and value, arrays are decoded as one element per entry
+ *
+ * @param[in]  cp     Decoder state
+ * @param[in]  xp     XML parent
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+cbor_decode_member(cbor_parse *cp,
+                   cxobj      *xp)
+{
+    int      retval = -1;
+    int      major;
+    int      ai;
+    uint64_t val;
+    uint64_t i;
+    cbuf    *cbn = NULL;
+    char    *prefix = NULL;
+    char    *id = NULL;
+    cxobj   *x;
+
+    if (cbor_decode_head(cp, &major, &ai, &val) < 0)
+        goto done;
+    if (major != CBOR_TEXT){
+        clixon_err(OE_CBOR, 0, "CBOR map key is not a text string (only name-based YANG-CBOR is supported)");
+        goto done;
+    }
+    if ((cbn = cbuf_new()) == NULL){
+        clixon_err(OE_CBOR, errno, "cbuf_new");
+        goto done;
+    }
+    if (cbor_decode_string(cp, major, ai, val, cbn) < 0)
+        goto done;
+    if (nodeid_split(cbuf_get(cbn), &prefix, &id) < 0)
+        goto done;
+    if (cp->cp_pos < cp->cp_len && (cp->cp_buf[cp->cp_pos] >> 5) == CBOR_ARRAY){
+        if (cbor_decode_head(cp, &major, &ai, &val) < 0)
+            goto done;
+        if (cbor_decode_check(cp, ai, val) < 0)
+            goto done;
+        for (i = 0; ai == CBOR_AI_INDEF || i < val; i++){
+            if (ai == CBOR_AI_INDEF && cbor_decode_break(cp))
+                break;
+            if ((x = cbor_decode_element(xp, prefix, id)) == NULL)
+                goto done;
+            if (cbor_decode_value(cp, x) < 0)
+                goto done;
+        }
+    }
+    else {
+        if ((x = cbor_decode_element(xp, prefix, id)) == NULL)
+            goto done;
+        if (cbor_decode_value(cp, x) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (cbn)
+        cbuf_free(cbn);
+    if (prefix)
+        free(prefix);
+    if (id)
+        free(id);
+    return retval;
+}
+
+/*! Decode members of a CBOR map as child elements
+ *
+ * @param[in]  cp     Decoder state, after map head
+ * @param[in]  xp     XML parent
+ * @param[in]  ai     Additional information of map head
+ * @param[in]  n      Number of members (if not indefinite length)
+ * @retval     0      OK
+ * @retval    -1      Error, also if maps are nested deeper than CBOR_DEPTH_MAX
+ */
+static int
+cbor_decode_map(cbor_parse *cp,
+                cxobj      *xp,
+                int         ai,
+                uint64_t    n)
+{
+    uint64_t i;
+
+    if (++cp->cp_depth > CBOR_DEPTH_MAX){
+        clixon_err(OE_CBOR, 0, "CBOR maps nested deeper than %d", CBOR_DEPTH_MAX);
+        return -1;
+    }
+    if (cbor_decode_check(cp, ai, n) < 0)
+        return -1;
+    for (i = 0; ai == CBOR_AI_INDEF || i < n; i++){
+        if (ai == CBOR_AI_INDEF && cbor_decode_break(cp))
+            break;
+        if (cbor_decode_member(cp, xp) < 0)
+            return -1;
+    }
+    cp->cp_depth--;
+    return 0;
+}
+
+/*! Parse a buffer containing YANG-CBOR and add to XML tree
+ *
+ * @param[in]  buf    Input buffer containing one CBOR map
+ * @param[in]  len    Length of buffer
+ * @param[in]  yb     How to bind yang to XML top-level when parsing
+ * @param[in]  yspec  Yang specification
+ * @param[in]  xt     XML top of tree, new objects are added as children
+ * @param[out] xerr   Reason for invalid returned as netconf err msg 
+ * @retval     1      OK and valid
+ * @retval     0      Invalid w xerr set
+ * @retval    -1      Error
+ * @see _json_parse   JSON corresponding function
+ */
+static int
+_cbor_parse(const char *buf,
+            size_t      len,
+            yang_bind   yb,
+            yang_stmt  *yspec,
+            cxobj      *xt,
+            cxobj     **xerr)
+{
+    int        retval = -1;
+    cbor_parse cp = {(const uint8_t*)buf, len, 0, 0};
+    int        major;
+    int        ai;
+    uint64_t   val;
+    int        i;
+    int        i0;
+    cxobj     *x;
+    cbuf      *cberr = NULL;
+    int        ret;
+    int        failed = 0; /* yang assignment */
+
+    clixon_debug(CLIXON_DBG_DEFAULT, "%d len:%zu", yb, len);
+    i0 = xml_child_nr(xt);
+    if (cbor_decode_head(&cp, &major, &ai, &val) < 0)
+        goto done;
+    if (major != CBOR_MAP){
+        clixon_err(OE_CBOR, 0, "Top-level CBOR data item is not a map");
+        goto done;
+    }
+    if (cbor_decode_map(&cp, xt, ai, val) < 0)
+        goto done;
+    if (cp.cp_pos != cp.cp_len){
+        clixon_err(OE_CBOR, 0, "Trailing bytes after CBOR data item");
+        goto done;
+    }
+    /* Traverse new objects */
+    for (i = i0; i < xml_child_nr(xt); i++){
+        x = xml_child_i(xt, i);
+        if (xml_type(x) != CX_ELMNT)
+            continue;
+        /* As RFC 7951 Section 4: top-level members must be qualified with module name */
+        if (xml_prefix(x) == NULL &&
+            (yb != YB_NONE || strcmp(xml_name(x), DATASTORE_TOP_SYMBOL) != 0)){
+            if ((cberr = cbuf_new()) == NULL){
+                clixon_err(OE_UNIX, errno, "cbuf_new");
+                goto done;
+            }
+            cprintf(cberr, "Top-level CBOR member %s is not qualified with module name", xml_name(x));
+            if (xerr && netconf_malformed_message_xml(xerr, cbuf_get(cberr)) < 0)
+                goto done;
+            goto fail;
+        }
+        /* Names are split into name/prefix, but now add namespace info */
+        if ((ret = json_xmlns_translate(yspec, x, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        switch (yb){
+        case YB_PARENT:
+            if ((ret = xml_bind_yang0(NULL, x, yb, yspec, xerr)) < 0)
+                goto done;
+            if (ret == 0)
+                failed++;
+            break;
+        case YB_MODULE_NEXT:
+            if ((ret = xml_bind_yang(NULL, x, YB_MODULE, yspec, xerr)) < 0)
+                goto done;
+            if (ret == 0)
+                failed++;
+            break;
+        case YB_MODULE:
+            if ((ret = xml_bind_yang0(NULL, x, yb, yspec, xerr)) < 0)
+                goto done;
+            if (ret == 0)
+                failed++;
+            break;
+        case YB_NONE:
+            break;
+        case YB_RPC:
+            if ((ret = xml_bind_yang_rpc(NULL, x, yspec, xerr)) < 0)
+                goto done;
+            if (ret == 0)
+                failed++;
+            break;
+        }
+        /* Translate module prefixes in identityref values to XML namespaces */
+        if ((ret = json2xml_decode(x, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    if (failed)
+        goto fail;
+    if (yb != YB_NONE)
+        if (xml_sort_recurse(xt) < 0)
+            goto done;
+    retval = 1;
+ done:
+    clixon_debug(CLIXON_DBG_DEFAULT, "retval:%d", retval);
+    if (cberr)
+        cbuf_free(cberr);
+    return retval;
+ fail: /* invalid */
+    retval = 0;
+    goto done;
+}
+
+/*! Parse a buffer containing YANG-CBOR and return an XML tree
+ *
+ * @param[in]     buf   Buffer containing CBOR, not NULL-terminated
+ * @param[in]     len   Length of buffer
+ * @param[in]     yb    How to bind yang to XML top-level when parsing
+ * @param[in]     yspec Yang specification, mandatory to make module->xmlns translation
+ * @param[in,out] xt    Top object, if not exists, on success it is created with name 'top'
+ * @param[out]    xerr  Reason for invalid returned as netconf err msg 
+ * @retval        1     OK and valid
+ * @retval        0     Invalid w xerr set
+ * @retval       -1     Error
+ * @code
+ *  cxobj *x = NULL;
+ *  if (clixon_cbor_parse_buf(cbuf_get(cb), cbuf_len(cb), YB_MODULE, yspec, &x, &xerr) < 0)
+ *    err;
+ *  xml_free(x);
+ * @endcode
+ * @note  you need to free the xml parse tree after use, using xml_free()
+ * @see clixon_json_parse_string  JSON instead of CBOR
+ */
+int
+clixon_cbor_parse_buf(const char *buf,
+                      size_t      len,
+                      yang_bind   yb,
+                      yang_stmt  *yspec,
+                      cxobj     **xt,
+                      cxobj     **xerr)
+{
+    clixon_debug(CLIXON_DBG_DEFAULT, "");
+    if (xt == NULL){
+        clixon_err(OE_CBOR, EINVAL, "xt is NULL");
+        return -1;
+    }
+    if (*xt == NULL){
+        if ((*xt = xml_new(CBOR_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            return -1;
+    }
+    return _cbor_parse(buf, len, yb, yspec, *xt, xerr);
+}
+
+/*! Read YANG-CBOR from file and parse it into an XML tree
+ *
+ * An empty file gives an empty tree
+ * @param[in]     fp    File descriptor to the CBOR file
+ * @param[in]     yb    How to bind yang to XML top-level when parsing
+ * @param[in]     yspec Yang specification
+ * @param[in,out] xt    Pointer to (XML) parse tree. If empty, create.
+ * @param[out]    xerr  Reason for invalid returned as netconf err msg 
+ * @retval        1     OK and valid
+ * @retval        0     Invalid w xerr set
+ * @retval       -1     Error
+ * @note  you need to free the xml parse tree after use, using xml_free()
+ * @note May block on file I/O
+ * @see clixon_json_parse_file  JSON instead of CBOR
+ */
+int
+clixon_cbor_parse_file(FILE      *fp,
+                       yang_bind  yb,
+                       yang_stmt *yspec,
+                       cxobj    **xt,
+                       cxobj    **xerr)
+{
+    int     retval = -1;
+    int     ret;
+    cbuf   *cb = NULL;
+    char    buf[CBOR_BUFLEN];
+    size_t  n;
+
+    if (xt == NULL){
+        clixon_err(OE_CBOR, EINVAL, "xt is NULL");
+        return -1;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_CBOR, errno, "cbuf_new");
+        goto done;
+    }
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+        if (cbuf_append_buf(cb, buf, n) < 0){
+            clixon_err(OE_CBOR, errno, "cbuf_append_buf");
+            goto done;
+        }
+    if (ferror(fp)){
+        clixon_err(OE_CBOR, errno, "fread");
+        goto done;
+    }
+    if (*xt == NULL)
+        if ((*xt = xml_new(CBOR_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            goto done;
+    if (cbuf_len(cb)){
+        if ((ret = _cbor_parse(cbuf_get(cb), cbuf_len(cb), yb, yspec, *xt, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
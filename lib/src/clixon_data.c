@@ -747,8 +747,10 @@ clicon_modst_cache_set(clixon_handle h,
 
     if ((x = clicon_modst_cache_get(h, brief)) != NULL)
         xml_free(x);
-    if (xms == NULL)
+    if (xms == NULL){
+        clicon_hash_del(cdat, brief?"modst_brief":"modst_full");
         goto ok;
+    }
     if ((x = xml_dup(xms)) == NULL)
         return -1;
     if (clicon_hash_add(cdat, brief?"modst_brief":"modst_full", &x, sizeof(x))==NULL)
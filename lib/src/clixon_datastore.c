@@ -68,6 +68,7 @@
 #include "clixon_yang.h"
 #include "clixon_xml.h"
 #include "clixon_err.h"
+#include "clixon_cancel.h"
 #include "clixon_log.h"
 #include "clixon_debug.h"
 #include "clixon_string.h"
@@ -81,6 +82,7 @@
 #include "clixon_xml_default.h"
 #include "clixon_xml_io.h"
 #include "clixon_json.h"
+#include "clixon_cbor.h"
 #include "clixon_datastore.h"
 #include "clixon_datastore_write.h"
 #include "clixon_datastore_read.h"
@@ -193,6 +195,7 @@ xmldb_disconnect(clixon_handle h)
     int       i;
     db_elmnt *de;
     
+    xmldb_replica_remove(h);
     if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
         goto done;
     for(i = 0; i < klen; i++) 
@@ -232,6 +235,8 @@ xmldb_copy(clixon_handle h,
     cxobj     *x2 = NULL;  /* to */
 
     clixon_debug(CLIXON_DBG_DATASTORE, "%s %s", from, to);
+    /* Cache of "to" is replaced, do not cancel in between */
+    clixon_cancel_hold(1);
     /* XXX lock */
     /* Copy in-memory cache */
     /* 1. "to" xml tree in x1 */
@@ -276,8 +281,11 @@ xmldb_copy(clixon_handle h,
         goto done;
     if (clicon_file_copy(fromfile, tofile) < 0)
         goto done;
+    if (strcmp(to, "running") == 0)
+        xmldb_replica_modified(h);
     retval = 0;
  done:
+    clixon_cancel_hold(0);
     clixon_debug(CLIXON_DBG_DATASTORE, "retval:%d", retval);
     if (fromfile)
         free(fromfile);
@@ -877,6 +885,10 @@ xmldb_dump(clixon_handle     h,
         if (clixon_xml2file1(f, xt, 0, pretty, NULL, fprintf, 0, 0, wdef) < 0)
             goto done;
         break;
+    case FORMAT_CBOR:
+        if (clixon_cbor2file(f, xt, 0) < 0)
+            goto done;
+        break;
     default:
         clixon_err(OE_XML, 0, "Format %s not supported", format_int2str(format));
         goto done;
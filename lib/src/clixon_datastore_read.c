@@ -72,6 +72,7 @@
 #include "clixon_xpath_ctx.h"
 #include "clixon_xpath.h"
 #include "clixon_json.h"
+#include "clixon_cbor.h"
 #include "clixon_nacm.h"
 #include "clixon_path.h"
 #include "clixon_netconf_lib.h"
@@ -287,13 +288,7 @@ text_read_modstate(clixon_handle       h,
     cxobj *xyanglib = NULL;
     cxobj *xmodcache;
     cxobj *xmodsystem = NULL; /* modstate of file, eg startup */
-    cxobj *xf = NULL;         /* xml modstate in file */
-    cxobj *xf2;               /* copy */
-    cxobj *xs;                /* xml modstate in system */
-    cxobj *xs2;               /* copy */
-    char  *name;              /* module name */
-    char  *frev;              /* file revision */
-    char  *srev;              /* system revision */
+    cxobj *xf = NULL;         /* content-id in file */
     int    rfc7895=0;         /* backward-compatible: old version */
 
     /* Read module-state as computed at startup, see startup_module_state() */
@@ -306,80 +301,17 @@ text_read_modstate(clixon_handle       h,
     else if ((xmodfile = xml_find_type(xt, NULL, "modules-state", CX_ELMNT)) != NULL)
         rfc7895++;
     if (xmodfile && xmodsystem && msdiff){
-        msdiff->md_status = 1;  /* There is module state in the file */
-        /* Create modstate tree for this file 
-         * Note, module-set is not a top-level symbol, so cannot bind using module-set
-         */
-        if (clixon_xml_parse_string("<module-set xmlns=\"urn:ietf:params:xml:ns:yang:ietf-yang-library\"/>",
-                                    YB_NONE, yspec, &msdiff->md_diff, NULL) < 0)
-            goto done;
-        if (xml_rootchild(msdiff->md_diff, 0, &msdiff->md_diff) < 0)
+        if (rfc7895)
+            xf = xml_find_type(xmodfile, NULL, "module-set-id", CX_ELMNT);
+        else
+            xf = xpath_first(xt, NULL, "yang-library/content-id");
+        if (xf && xml_body(xf) && (msdiff->md_content_id = strdup(xml_body(xf))) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
             goto done;
-
-        if (!rfc7895){
-            if ((xf = xpath_first(xt, NULL, "yang-library/content-id")) != NULL){
-                if (xml_body(xf) && (msdiff->md_content_id = strdup(xml_body(xf))) == NULL){
-                    clixon_err(OE_UNIX, errno, "strdup");
-                    goto done;
-                }
-            }
-        }
-        /* 3) For each module state m in the file */
-        xf = NULL;
-        while ((xf = xml_child_each(xmodfile, xf, CX_ELMNT)) != NULL) {
-            if (rfc7895){
-                if (strcmp(xml_name(xf), "module-set-id") == 0){
-                    if (xml_body(xf) && (msdiff->md_content_id = strdup(xml_body(xf))) == NULL){
-                        clixon_err(OE_UNIX, errno, "strdup");
-                        goto done;
-                    }
-                    continue;
-                }
-            }
-            if (strcmp(xml_name(xf), "module"))
-                continue; /* ignore other tags, such as module-set-id */
-            if ((name = xml_find_body(xf, "name")) == NULL)
-                continue;
-            /* 3a) There is no such module in the system */
-            if ((xs = xpath_first(xmodsystem, NULL, "module[name=\"%s\"]", name)) == NULL){
-                if ((xf2 = xml_dup(xf)) == NULL)          /* Make a copy of this modstate */
-                    goto done;
-                if (xml_addsub(msdiff->md_diff, xf2) < 0)   /* Add it to modstatediff */
-                    goto done;
-                xml_flag_set(xf2, XML_FLAG_DEL);
-                continue;
-            }
-            /* These two shouldnt happen since revision is key, just ignore */
-            if ((frev = xml_find_body(xf, "revision")) == NULL)
-                continue;
-            if ((srev = xml_find_body(xs, "revision")) == NULL)
-                continue;
-            if (strcmp(frev, srev) != 0){
-                /* 3c) File module-state does not match system */
-                if ((xf2 = xml_dup(xf)) == NULL)
-                    goto done;
-                if (xml_addsub(msdiff->md_diff, xf2) < 0)
-                    goto done;
-                xml_flag_set(xf2, XML_FLAG_CHANGE);
-            }
-        }
-        /* 4) For each module state s in the system (xmodsystem) */
-        xs = NULL;
-        while ((xs = xml_child_each(xmodsystem, xs, CX_ELMNT)) != NULL) {
-            if (strcmp(xml_name(xs), "module"))
-                continue; /* ignore other tags, such as module-set-id */
-            if ((name = xml_find_body(xs, "name")) == NULL)
-                continue;
-            /* 4a) If there is no such module in the file -> add to list mark as ADD */
-            if ((xf = xpath_first(xmodfile, NULL, "module[name=\"%s\"]", name)) == NULL){
-                if ((xs2 = xml_dup(xs)) == NULL)          /* Make a copy of this modstate */
-                    goto done;
-                if (xml_addsub(msdiff->md_diff, xs2) < 0)   /* Add it to modstatediff */
-                    goto done;
-                xml_flag_set(xs2, XML_FLAG_ADD);
-                continue;
-            }
         }
+        /* 3) and 4) */
+        if (yang_modules_state_diff(yspec, xmodfile, xmodsystem, msdiff) < 0)
+            goto done;
     }
     /* The module-state is removed from the input XML tree. This is done
      * in all cases, whether CLICON_XMLDB_MODSTATE is on or not.
@@ -520,6 +452,10 @@ xmldb_readfile(clixon_handle    h,
         if (clixon_json_parse_file(fp, 1, YB_NONE, yspec, &x0, xerr) < 0)
             goto done;
     }
+    else if (strcmp(format, "cbor")==0){
+        if (clixon_cbor_parse_file(fp, YB_NONE, yspec, &x0, xerr) < 0)
+            goto done;
+    }
     else {
         if (clixon_xml_parse_file(fp, YB_NONE, yspec, &x0, xerr) < 0){
             goto done;
@@ -664,6 +600,95 @@ xmldb_readfile(clixon_handle    h,
     goto done;
 }
 
+/*! Copy the parts of a datastore tree that match xpath to a new tree
+ *
+ * The new tree is minimal: it includes all sub-trees that match xpath and their ancestors
+ * @param[in]  h      Clixon handle
+ * @param[in]  x0t    Top of datastore tree, eg cache, on the form <config>...</config>
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  xpath  String with XPath syntax. or NULL for all
+ * @param[out] xret   Single return XML tree. Free with xml_free()
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xmldb_get0
+ */
+int
+xmldb_tree_get(clixon_handle h,
+               cxobj        *x0t,
+               cvec         *nsc,
+               const char   *xpath,
+               cxobj       **xret)
+{
+    int        retval = -1;
+    yang_stmt *yspec;
+    cxobj     *x0;
+    cxobj    **xvec = NULL;
+    size_t     xlen;
+    int        i;
+    cxobj     *x1t = NULL;
+
+    yspec = clicon_dbspec_yang(h);
+    /* Given the xpath, return a vector of matches in xvec 
+     * Can we do everything in one go?
+     * 0) Make a new tree
+     * 1) make the xpath check 
+     * 2) iterate thru matches (maybe this can be folded into the xpath_vec?)
+     *   a) for every node that is found, copy to new tree
+     *   b) if config dont dont state data
+     */
+    if (xpath_vec(x0t, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
+        goto done;
+    // XXX: Remove copying and return x0 eventually
+    /* Make new tree by copying top-of-tree from x0t to x1t */
+    if ((x1t = xml_new(xml_name(x0t), NULL, CX_ELMNT)) == NULL)
+        goto done;
+    xml_flag_set(x1t, XML_FLAG_TOP);
+    xml_spec_set(x1t, xml_spec(x0t));
+    if (xlen < 1000){
+        /* This is optimized for the case when the tree is large and xlen is small
+         * If the tree is large and xlen too, then the other is better.
+         * This only works if yang bind
+         */
+        for (i=0; i<xlen; i++){
+            x0 = xvec[i];
+            if (xml_copy_from_bottom(x0t, x0, x1t) < 0) /* config */
+                goto done;
+        }
+    }
+    else {
+        /* Iterate through the match vector
+         * For every node found in x0, mark the tree up to t1
+         * XXX can we do this directly from xvec?
+         */
+        for (i=0; i<xlen; i++){
+            x0 = xvec[i];
+            xml_flag_set(x0, XML_FLAG_MARK);
+            xml_apply_ancestor(x0, (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
+        }
+        if (xml_copy_marked(x0t, x1t) < 0) /* config */
+            goto done;
+        if (xml_apply(x0t, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE)) < 0)
+            goto done;
+        if (xml_apply(x1t, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE)) < 0)
+            goto done;
+    }
+    /* If empty NACM config, then disable NACM if loaded
+     */
+    if (clicon_option_bool(h, "CLICON_NACM_DISABLED_ON_EMPTY")){
+        if (disable_nacm_on_empty(x1t, yspec) < 0)
+            goto done;
+    }
+    *xret = x1t;
+    x1t = NULL;
+    retval = 0;
+ done:
+    if (x1t)
+        xml_free(x1t);
+    if (xvec)
+        free(xvec);
+    return retval;
+}
+
 /*! Get content of database using xpath. return a set of matching sub-trees
  *
  * The function returns a minimal tree that includes all sub-trees that match
@@ -696,10 +721,6 @@ xmldb_get_cache(clixon_handle     h,
     int        retval = -1;
     yang_stmt *yspec;
     cxobj     *x0t = NULL; /* (cached) top of tree */
-    cxobj     *x0;
-    cxobj    **xvec = NULL;
-    size_t     xlen;
-    int        i;
     db_elmnt  *de = NULL;
     cxobj     *x1t = NULL;
     db_elmnt   de0 = {0,};
@@ -742,63 +763,13 @@ xmldb_get_cache(clixon_handle     h,
     else
         x0t = de->de_xml;
     /* Here x0t looks like: <config>...</config> */
-    /* Given the xpath, return a vector of matches in xvec 
-     * Can we do everything in one go?
-     * 0) Make a new tree
-     * 1) make the xpath check 
-     * 2) iterate thru matches (maybe this can be folded into the xpath_vec?)
-     *   a) for every node that is found, copy to new tree
-     *   b) if config dont dont state data
-     */
-    if (xpath_vec(x0t, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
-        goto done;
-    // XXX: Remove copying and return x0 eventually
-    /* Make new tree by copying top-of-tree from x0t to x1t */
-    if ((x1t = xml_new(xml_name(x0t), NULL, CX_ELMNT)) == NULL)
+    if (xmldb_tree_get(h, x0t, nsc, xpath, &x1t) < 0)
         goto done;
-    xml_flag_set(x1t, XML_FLAG_TOP);
-    xml_spec_set(x1t, xml_spec(x0t));
-    if (xlen < 1000){
-        /* This is optimized for the case when the tree is large and xlen is small
-         * If the tree is large and xlen too, then the other is better.
-         * This only works if yang bind
-         */
-        for (i=0; i<xlen; i++){
-            x0 = xvec[i];
-            if (xml_copy_from_bottom(x0t, x0, x1t) < 0) /* config */
-                goto done;
-        }
-    }
-    else {
-        /* Iterate through the match vector
-         * For every node found in x0, mark the tree up to t1
-         * XXX can we do this directly from xvec?
-         */
-        for (i=0; i<xlen; i++){
-            x0 = xvec[i];
-            xml_flag_set(x0, XML_FLAG_MARK);
-            xml_apply_ancestor(x0, (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
-        }
-        if (xml_copy_marked(x0t, x1t) < 0) /* config */
-            goto done;
-        if (xml_apply(x0t, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE)) < 0)
-            goto done;
-        if (xml_apply(x1t, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE)) < 0)
-            goto done;
-    }
-    /* If empty NACM config, then disable NACM if loaded
-     */
-    if (clicon_option_bool(h, "CLICON_NACM_DISABLED_ON_EMPTY")){
-        if (disable_nacm_on_empty(x1t, yspec) < 0)
-            goto done;
-    }
     clixon_debug_xml(CLIXON_DBG_DATASTORE | CLIXON_DBG_DETAIL, x1t, "");
     *xret = x1t;
     retval = 1;
  done:
     clixon_debug(CLIXON_DBG_DATASTORE | CLIXON_DBG_DETAIL, "retval:%d", retval);
-    if (xvec)
-        free(xvec);
     return retval;
  fail:
     retval = 0;
@@ -0,0 +1,508 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2024 Olof Hagsand
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * Read-only replica of the running datastore for local frontends
+ * The backend publishes running to a file, typically in shared memory, once per completed
+ * commit or other request that changed running, see xmldb_replica_sync.
+ * Each generation is written to a temporary file and atomically renamed, so that a file,
+ * once visible, is never modified. A reader that has opened the file thus sees a consistent
+ * generation, and detects a new generation by a changed inode.
+ * File layout: struct replica_hdr followed by XML of running as a null-terminated string.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <time.h>
+#include <syslog.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_debug.h"
+#include "clixon_options.h"
+#include "clixon_data.h"
+#include "clixon_uid.h"
+#include "clixon_yang_module.h"
+#include "clixon_netconf_lib.h"
+#include "clixon_xml_bind.h"
+#include "clixon_xml_sort.h"
+#include "clixon_xml_default.h"
+#include "clixon_xml_io.h"
+#include "clixon_datastore.h"
+
+/* Magic number of replica file: "CXRP" */
+#define REPLICA_MAGIC   0x43585250
+
+/* Version of replica file format */
+#define REPLICA_VERSION 1
+
+/*! Replica file header
+ */
+struct replica_hdr {
+    uint32_t rh_magic;   /* REPLICA_MAGIC */
+    uint32_t rh_version; /* REPLICA_VERSION */
+    uint64_t rh_gen;     /* Generation, incremented on every publish */
+    uint64_t rh_len;     /* Length of XML string including null terminator */
+};
+
+/*! Reader cache of last parsed replica
+ *
+ * Stored in handle data as "xmldb-replica"
+ */
+struct replica_cache {
+    dev_t           rc_dev;   /* Device of replica file */
+    ino_t           rc_ino;   /* Inode of replica file, new on every generation */
+    off_t           rc_size;  /* Size of replica file */
+    struct timespec rc_mtime; /* Modification time of replica file */
+    uint64_t        rc_gen;   /* Generation of replica */
+    cxobj          *rc_xt;    /* Parsed and bound config tree */
+};
+typedef struct replica_cache replica_cache;
+
+/* Generation of last published replica, written in replica header
+ * Seeded from the time of the first publish, so that generations are not reused when the
+ * backend is restarted
+ */
+static uint64_t _replica_gen = 0;
+
+/* Running is changed since replica was last published */
+static int _replica_modified = 0;
+
+/*! Write all of a buffer to a file descriptor
+ *
+ * @param[in]  fd   File descriptor
+ * @param[in]  buf  Buffer
+ * @param[in]  len  Length of buffer
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+replica_write(int         fd,
+              const char *buf,
+              size_t      len)
+{
+    ssize_t n;
+
+    while (len > 0){
+        if ((n = write(fd, buf, len)) < 0){
+            if (errno == EINTR)
+                continue;
+            clixon_err(OE_UNIX, errno, "write");
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/*! Mark running as changed since the replica was last published
+ *
+ * Called by datastore writes of running. Serializing all of running on every write would
+ * be too expensive, the replica is instead published by xmldb_replica_sync.
+ * @param[in]  h   Clixon handle
+ */
+void
+xmldb_replica_modified(clixon_handle h)
+{
+    _replica_modified = 1;
+}
+
+/*! Publish the replica if running is changed since it was last published
+ *
+ * Called by the backend once per completed commit, and after each request that may have
+ * written running, so that a frontend sees the result of a request when it has its reply.
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see xmldb_replica_modified
+ */
+int
+xmldb_replica_sync(clixon_handle h)
+{
+    if (!_replica_modified)
+        return 0;
+    return xmldb_replica_publish(h);
+}
+
+/*! Publish the running datastore cache as a new replica generation
+ *
+ * No-op unless CLICON_XMLDB_REPLICA is set
+ * The replica is readable by owner and by CLICON_SOCK_GROUP, if set
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see xmldb_replica_get  for the reader
+ */
+int
+xmldb_replica_publish(clixon_handle h)
+{
+    int                retval = -1;
+    char              *path;
+    char              *group;
+    cbuf              *cb = NULL;
+    cbuf              *cbtmp = NULL;
+    cxobj             *xt = NULL;
+    struct replica_hdr hdr = {0,};
+    gid_t              gid;
+    int                fd = -1;
+
+    _replica_modified = 0;
+    if ((path = clicon_option_str(h, "CLICON_XMLDB_REPLICA")) == NULL ||
+        strlen(path) == 0)
+        return 0;
+    if ((cb = cbuf_new()) == NULL ||
+        (cbtmp = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    /* Read running into cache if not already read */
+    if (xmldb_cache_get(h, "running") == NULL){
+        if (xmldb_get0(h, "running", YB_MODULE, NULL, "/", 1, 0, &xt, NULL, NULL) < 0)
+            goto done;
+        if (xt)
+            xml_free(xt);
+    }
+    if ((xt = xmldb_cache_get(h, "running")) != NULL){
+        if (clixon_xml2cbuf1(cb, xt, 0, 0, NULL, -1, 0, WITHDEFAULTS_EXPLICIT) < 0)
+            goto done;
+    }
+    else
+        cprintf(cb, "<%s/>", DATASTORE_TOP_SYMBOL);
+    if (_replica_gen == 0)
+        _replica_gen = (uint64_t)time(NULL) << 20;
+    hdr.rh_magic = REPLICA_MAGIC;
+    hdr.rh_version = REPLICA_VERSION;
+    hdr.rh_gen = _replica_gen + 1;
+    hdr.rh_len = cbuf_len(cb) + 1;
+    cprintf(cbtmp, "%s.%u", path, getpid());
+    if ((fd = open(cbuf_get(cbtmp), O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, S_IRUSR|S_IWUSR|S_IRGRP)) < 0){
+        clixon_err(OE_UNIX, errno, "open(%s)", cbuf_get(cbtmp));
+        goto done;
+    }
+    if ((group = clicon_sock_group(h)) != NULL &&
+        group_name2gid(group, &gid) == 0)
+        if (fchown(fd, -1, gid) < 0)
+            clixon_log(h, LOG_WARNING, "%s: fchown(%s): %s", __FUNCTION__, group, strerror(errno));
+    if (replica_write(fd, (char*)&hdr, sizeof(hdr)) < 0)
+        goto done;
+    if (replica_write(fd, cbuf_get(cb), hdr.rh_len) < 0)
+        goto done;
+    if (close(fd) < 0){
+        fd = -1;
+        clixon_err(OE_UNIX, errno, "close");
+        goto done;
+    }
+    fd = -1;
+    if (rename(cbuf_get(cbtmp), path) < 0){
+        clixon_err(OE_UNIX, errno, "rename(%s, %s)", cbuf_get(cbtmp), path);
+        goto done;
+    }
+    _replica_gen = hdr.rh_gen;
+    clixon_debug(CLIXON_DBG_DATASTORE, "%s generation %" PRIu64, path, _replica_gen);
+    retval = 0;
+ done:
+    if (fd != -1){
+        close(fd);
+        unlink(cbuf_get(cbtmp));
+    }
+    if (cbtmp)
+        cbuf_free(cbtmp);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Parse a mapped replica file to a config tree
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  buf   Mapped replica file
+ * @param[in]  size  Size of replica file
+ * @param[out] gen   Generation of replica
+ * @param[out] xtp   Config tree, free with xml_free
+ * @retval     1     OK
+ * @retval     0     Invalid replica, or not matching YANG
+ * @retval    -1    Error
+ */
+static int
+replica_parse(clixon_handle h,
+              char         *buf,
+              size_t        size,
+              uint64_t     *gen,
+              cxobj       **xtp)
+{
+    int                 retval = -1;
+    struct replica_hdr *hdr = (struct replica_hdr *)buf;
+    char               *str;
+    yang_stmt          *yspec;
+    cxobj              *xt = NULL;
+    cxobj              *x;
+    cxobj              *xerr = NULL;
+    int                 ret;
+
+    if (size < sizeof(*hdr) ||
+        hdr->rh_magic != REPLICA_MAGIC ||
+        hdr->rh_version != REPLICA_VERSION ||
+        hdr->rh_len != size - sizeof(*hdr) ||
+        hdr->rh_len == 0){
+        clixon_debug(CLIXON_DBG_DATASTORE, "Invalid replica header");
+        goto fail;
+    }
+    str = buf + sizeof(*hdr);
+    if (str[hdr->rh_len - 1] != '\0'){
+        clixon_debug(CLIXON_DBG_DATASTORE, "Replica not null-terminated");
+        goto fail;
+    }
+    yspec = clicon_dbspec_yang(h);
+    if (clixon_xml_parse_string(str, YB_NONE, yspec, &xt, NULL) < 0)
+        goto done;
+    /* Skip top-level symbol, as in xmldb_readfile */
+    if ((x = xml_child_i_type(xt, 0, CX_ELMNT)) == NULL ||
+        strcmp(xml_name(x), DATASTORE_TOP_SYMBOL) != 0){
+        clixon_debug(CLIXON_DBG_DATASTORE, "Replica top symbol not %s", DATASTORE_TOP_SYMBOL);
+        goto fail;
+    }
+    if (xml_rootchild_node(xt, x) < 0)
+        goto done;
+    xt = x;
+    xml_flag_set(xt, XML_FLAG_TOP);
+    if ((ret = xml_bind_yang(h, xt, YB_MODULE, yspec, &xerr)) < 0)
+        goto done;
+    if (ret == 0){
+        clixon_debug(CLIXON_DBG_DATASTORE, "Replica does not match YANG of frontend");
+        goto fail;
+    }
+    if (xml_sort_recurse(xt) < 0)
+        goto done;
+    /* Add default values, as in the datastore cache */
+    if (xml_global_defaults(h, xt, NULL, "/", yspec, 0) < 0)
+        goto done;
+    if (xml_default_recurse(xt, 0, 0) < 0)
+        goto done;
+    *gen = hdr->rh_gen;
+    *xtp = xt;
+    xt = NULL;
+    retval = 1;
+ done:
+    if (xerr)
+        xml_free(xerr);
+    if (xt)
+        xml_free(xt);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Get the last published replica of running
+ *
+ * The replica file is parsed only if a new generation has been published since the last call,
+ * otherwise the tree parsed in the last call is returned.
+ * @param[in]  h   Clixon handle
+ * @param[out] xtp Config tree of running. Do not modify or free, valid until next call
+ * @retval     1   OK, xtp set
+ * @retval     0   No valid replica available, get running from backend instead
+ * @retval    -1   Error
+ * @see xmldb_replica_publish  for the writer
+ */
+int
+xmldb_replica_get(clixon_handle h,
+                  cxobj       **xtp)
+{
+    int            retval = -1;
+    char          *path;
+    replica_cache *rc = NULL;
+    struct stat    st;
+    int            fd = -1;
+    char          *buf = MAP_FAILED;
+    uint64_t       gen = 0;
+    cxobj         *xt = NULL;
+    int            ret;
+
+    if ((path = clicon_option_str(h, "CLICON_XMLDB_REPLICA")) == NULL ||
+        strlen(path) == 0)
+        goto fail;
+    if (clicon_ptr_get(h, "xmldb-replica", (void**)&rc) < 0 || rc == NULL){
+        if ((rc = malloc(sizeof(*rc))) == NULL){
+            clixon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memset(rc, 0, sizeof(*rc));
+        if (clicon_ptr_set(h, "xmldb-replica", rc) < 0)
+            goto done;
+    }
+    if ((fd = open(path, O_RDONLY|O_CLOEXEC)) < 0){
+        clixon_debug(CLIXON_DBG_DATASTORE, "open(%s): %s", path, strerror(errno));
+        goto fail;
+    }
+    if (fstat(fd, &st) < 0){
+        clixon_err(OE_UNIX, errno, "fstat(%s)", path);
+        goto done;
+    }
+    /* Same generation as last call */
+    if (rc->rc_xt != NULL &&
+        rc->rc_dev == st.st_dev &&
+        rc->rc_ino == st.st_ino &&
+        rc->rc_size == st.st_size &&
+        rc->rc_mtime.tv_sec == st.st_mtim.tv_sec &&
+        rc->rc_mtime.tv_nsec == st.st_mtim.tv_nsec)
+        goto ok;
+    if (st.st_size == 0)
+        goto fail;
+    if ((buf = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED){
+        clixon_err(OE_UNIX, errno, "mmap(%s)", path);
+        goto done;
+    }
+    if ((ret = replica_parse(h, buf, st.st_size, &gen, &xt)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (rc->rc_xt)
+        xml_free(rc->rc_xt);
+    rc->rc_xt = xt;
+    xt = NULL;
+    rc->rc_dev = st.st_dev;
+    rc->rc_ino = st.st_ino;
+    rc->rc_size = st.st_size;
+    rc->rc_mtime = st.st_mtim;
+    rc->rc_gen = gen;
+    clixon_debug(CLIXON_DBG_DATASTORE, "%s generation %" PRIu64, path, gen);
+ ok:
+    *xtp = rc->rc_xt;
+    retval = 1;
+ done:
+    if (buf != MAP_FAILED)
+        munmap(buf, st.st_size);
+    if (fd != -1)
+        close(fd);
+    if (xt)
+        xml_free(xt);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Get generation of the last published replica of running
+ *
+ * Only the replica header is read, the config is not parsed. Every change of running,
+ * including NACM, gives a new generation.
+ * @param[in]  h   Clixon handle
+ * @param[out] gen Generation of replica
+ * @retval     1   OK, gen set
+ * @retval     0   No valid replica available
+ * @see xmldb_replica_publish  for the writer
+ */
+int
+xmldb_replica_gen(clixon_handle h,
+                  uint64_t     *gen)
+{
+    int                retval = 0;
+    char              *path;
+    struct replica_hdr hdr;
+    int                fd = -1;
+
+    if ((path = clicon_option_str(h, "CLICON_XMLDB_REPLICA")) == NULL ||
+        strlen(path) == 0)
+        goto done;
+    if ((fd = open(path, O_RDONLY|O_CLOEXEC)) < 0)
+        goto done;
+    if (pread(fd, &hdr, sizeof(hdr), 0) != sizeof(hdr) ||
+        hdr.rh_magic != REPLICA_MAGIC ||
+        hdr.rh_version != REPLICA_VERSION)
+        goto done;
+    *gen = hdr.rh_gen;
+    retval = 1;
+ done:
+    if (fd != -1)
+        close(fd);
+    return retval;
+}
+
+/*! Free reader cache of replica
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ */
+int
+xmldb_replica_free(clixon_handle h)
+{
+    replica_cache *rc = NULL;
+
+    if (clicon_ptr_get(h, "xmldb-replica", (void**)&rc) == 0 && rc != NULL){
+        if (rc->rc_xt)
+            xml_free(rc->rc_xt);
+        free(rc);
+        clicon_ptr_del(h, "xmldb-replica");
+    }
+    return 0;
+}
+
+/*! Remove published replica, eg on backend exit
+ *
+ * Frontends then get running from the backend
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ */
+int
+xmldb_replica_remove(clixon_handle h)
+{
+    char *path;
+
+    if ((path = clicon_option_str(h, "CLICON_XMLDB_REPLICA")) != NULL &&
+        strlen(path) != 0)
+        unlink(path);
+    return 0;
+}
@@ -62,6 +62,7 @@
 #include "clixon_yang.h"
 #include "clixon_xml.h"
 #include "clixon_err.h"
+#include "clixon_cancel.h"
 #include "clixon_log.h"
 #include "clixon_debug.h"
 #include "clixon_file.h"
@@ -1237,6 +1238,8 @@ xmldb_put(clixon_handle       h,
     cxobj      *xerr = NULL;
 
     clixon_debug(CLIXON_DBG_DATASTORE|CLIXON_DBG_DETAIL, "db %s", db);
+    /* Cache is modified in place, do not cancel in between */
+    clixon_cancel_hold(1);
     if (cbret == NULL){
         clixon_err(OE_XML, EINVAL, "cbret is NULL");
         goto done;
@@ -1319,8 +1322,11 @@ xmldb_put(clixon_handle       h,
     if (xmldb_volatile_get(h, db) == 0)
         if (xmldb_write_cache2file(h, db) < 0)
             goto done;
+    if (strcmp(db, "running") == 0)
+        xmldb_replica_modified(h);
     retval = 1;
  done:
+    clixon_cancel_hold(0);
     clixon_debug(CLIXON_DBG_DATASTORE | CLIXON_DBG_DETAIL, "retval:%d", retval);
     if (xerr)
         xml_free(xerr);
@@ -0,0 +1,765 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2024 Olof Hagsand
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * In-process diff of XML trees
+ * 1. Line diff of two strings, eg XML, JSON or TEXT renderings of two trees, using the
+ *    linear-space variant of Myers' O(ND) algorithm, with unified-style output.
+ * 2. Structural diff of two XML trees, that does not require YANG. Children are matched by
+ *    name, by list keys or leaf-list values if YANG bound, and otherwise by position among
+ *    siblings of the same name.
+ * @see clixon_xml_diff2cbuf  for YANG-based structural diff with XML output
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_debug.h"
+#include "clixon_netconf_lib.h"
+#include "clixon_xml_io.h"
+#include "clixon_json.h"
+#include "clixon_text_syntax.h"
+#include "clixon_diff.h"
+
+/*
+ * Constants
+ */
+/* Max edit distance searched for an optimal middle snake. Beyond this, split at the furthest
+ * reaching forward path, which gives a correct but not necessarily minimal diff, cf GNU diff */
+#define DIFF_MAXCOST 4096
+
+/*
+ * Line diff
+ */
+
+/*! A line in a string to diff
+ */
+struct diff_line {
+    const char *dl_str;  /* Start of line (not null-terminated) */
+    size_t      dl_len;  /* Length of line excluding newline */
+    uint64_t    dl_hash; /* FNV-1a hash of line */
+};
+
+/*! Line diff context
+ */
+struct diff_ctx {
+    struct diff_line *dc_a;   /* Lines of first string */
+    struct diff_line *dc_b;   /* Lines of second string */
+    char             *dc_dela; /* dc_dela[i] set if line i of a is deleted */
+    char             *dc_insb; /* dc_insb[j] set if line j of b is inserted */
+    int              *dc_v1;  /* Forward furthest reaching x per diagonal */
+    int              *dc_v2;  /* Backward furthest reaching x per diagonal */
+};
+
+/*! Split a string in lines
+ *
+ * @param[in]  str    String
+ * @param[out] lines  Vector of lines, free with free()
+ * @param[out] nr     Number of lines
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+diff_split(const char        *str,
+           struct diff_line **lines,
+           int               *nr)
+{
+    struct diff_line *vec = NULL;
+    const char       *s;
+    const char       *e;
+    int               n = 0;
+    int               len = 16;
+    uint64_t          h;
+
+    if ((vec = malloc(len*sizeof(*vec))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    s = str;
+    while (*s != '\0'){
+        if ((e = strchr(s, '\n')) == NULL)
+            e = s + strlen(s);
+        if (n == len){
+            len *= 2;
+            if ((vec = realloc(vec, len*sizeof(*vec))) == NULL){
+                clixon_err(OE_UNIX, errno, "realloc");
+                return -1;
+            }
+        }
+        vec[n].dl_str = s;
+        vec[n].dl_len = e - s;
+        h = 0xcbf29ce484222325ULL;
+        for (; s < e; s++){
+            h ^= (unsigned char)*s;
+            h *= 0x100000001b3ULL;
+        }
+        vec[n].dl_hash = h;
+        n++;
+        s = (*e == '\n') ? e + 1 : e;
+    }
+    *lines = vec;
+    *nr = n;
+    return 0;
+}
+
+/*! Compare two lines
+ */
+static inline int
+diff_line_eq(struct diff_line *a,
+             struct diff_line *b)
+{
+    return a->dl_hash == b->dl_hash &&
+        a->dl_len == b->dl_len &&
+        memcmp(a->dl_str, b->dl_str, a->dl_len) == 0;
+}
+
+/*! Diff lines a[alo:ahi] and b[blo:bhi] and mark deleted and inserted lines
+ *
+ * Common prefix and suffix are removed, then the middle snake of an optimal edit path is
+ * found by searching forward and backward simultaneously, and each half is diffed recursively.
+ * @param[in]  dc   Diff context
+ * @param[in]  alo  Start of a
+ * @param[in]  ahi  End of a (exclusive)
+ * @param[in]  blo  Start of b
+ * @param[in]  bhi  End of b (exclusive)
+ * @see "An O(ND) Difference Algorithm and Its Variations", E. Myers, 1986, Section 4b
+ */
+static void
+diff_seq(struct diff_ctx *dc,
+         int              alo,
+         int              ahi,
+         int              blo,
+         int              bhi)
+{
+    struct diff_line *a = dc->dc_a;
+    struct diff_line *b = dc->dc_b;
+    int              *v1 = dc->dc_v1;
+    int              *v2 = dc->dc_v2;
+    int               n;
+    int               m;
+    int               delta;
+    int               front;
+    int               maxd;
+    int               voff;
+    int               vlen;
+    int               d;
+    int               k1;
+    int               k2;
+    int               k1start = 0;
+    int               k1end = 0;
+    int               k2start = 0;
+    int               k2end = 0;
+    int               x1;
+    int               y1;
+    int               x2;
+    int               y2;
+    int               bestx = 0;
+    int               besty = 0;
+    int               i;
+
+    while (alo < ahi && blo < bhi && diff_line_eq(&a[alo], &b[blo])){
+        alo++;
+        blo++;
+    }
+    while (alo < ahi && blo < bhi && diff_line_eq(&a[ahi-1], &b[bhi-1])){
+        ahi--;
+        bhi--;
+    }
+    if (alo == ahi){
+        for (i=blo; i<bhi; i++)
+            dc->dc_insb[i] = 1;
+        return;
+    }
+    if (blo == bhi){
+        for (i=alo; i<ahi; i++)
+            dc->dc_dela[i] = 1;
+        return;
+    }
+    n = ahi - alo;
+    m = bhi - blo;
+    delta = n - m;
+    front = (delta % 2 != 0);
+    maxd = (n + m + 1) / 2;
+    voff = maxd;
+    vlen = 2 * maxd + 2;
+    for (i=0; i<vlen; i++){
+        v1[i] = -1;
+        v2[i] = -1;
+    }
+    v1[voff+1] = 0;
+    v2[voff+1] = 0;
+    for (d=0; d<maxd; d++){
+        if (d == DIFF_MAXCOST && bestx + besty > 0){
+            x1 = bestx;
+            y1 = besty;
+            goto split;
+        }
+        /* Forward path */
+        for (k1 = -d + k1start; k1 <= d - k1end; k1 += 2){
+            i = voff + k1;
+            if (k1 == -d || (k1 != d && v1[i-1] < v1[i+1]))
+                x1 = v1[i+1];
+            else
+                x1 = v1[i-1] + 1;
+            y1 = x1 - k1;
+            while (x1 < n && y1 < m && diff_line_eq(&a[alo+x1], &b[blo+y1])){
+                x1++;
+                y1++;
+            }
+            v1[i] = x1;
+            if (x1 <= n && y1 <= m && x1 + y1 > bestx + besty){
+                bestx = x1;
+                besty = y1;
+            }
+            if (x1 > n)
+                k1end += 2;
+            else if (y1 > m)
+                k1start += 2;
+            else if (front){
+                k2 = voff + delta - k1;
+                if (k2 >= 0 && k2 < vlen && v2[k2] != -1 &&
+                    x1 >= n - v2[k2])
+                    goto split;
+            }
+        }
+        /* Reverse path */
+        for (k2 = -d + k2start; k2 <= d - k2end; k2 += 2){
+            i = voff + k2;
+            if (k2 == -d || (k2 != d && v2[i-1] < v2[i+1]))
+                x2 = v2[i+1];
+            else
+                x2 = v2[i-1] + 1;
+            y2 = x2 - k2;
+            while (x2 < n && y2 < m && diff_line_eq(&a[ahi-x2-1], &b[bhi-y2-1])){
+                x2++;
+                y2++;
+            }
+            v2[i] = x2;
+            if (x2 > n)
+                k2end += 2;
+            else if (y2 > m)
+                k2start += 2;
+            else if (!front){
+                k1 = voff + delta - k2;
+                if (k1 >= 0 && k1 < vlen && v1[k1] != -1){
+                    x1 = v1[k1];
+                    y1 = voff + x1 - k1;
+                    if (x1 >= n - x2)
+                        goto split;
+                }
+            }
+        }
+    }
+    /* No common lines */
+    for (i=alo; i<ahi; i++)
+        dc->dc_dela[i] = 1;
+    for (i=blo; i<bhi; i++)
+        dc->dc_insb[i] = 1;
+    return;
+ split:
+    diff_seq(dc, alo, alo + x1, blo, blo + y1);
+    diff_seq(dc, alo + x1, ahi, blo + y1, bhi);
+}
+
+/*! An edit operation: ' ' unchanged, '-' deleted, '+' inserted
+ */
+struct diff_op {
+    char do_op; /* ' ', '-' or '+' */
+    int  do_a;  /* Line index in a before operation */
+    int  do_b;  /* Line index in b before operation */
+};
+
+/*! Line diff of two strings with unified diff output
+ *
+ * Lines only in s1 are prefixed with '-', lines only in s2 with '+', and context lines
+ * with ' '. Each group of changes has up to context unchanged lines before and after.
+ * @param[out] cb       Diff output, appended
+ * @param[in]  s1       First string
+ * @param[in]  s2       Second string
+ * @param[in]  context  Number of unchanged lines around changes
+ * @param[in]  flags    CLIXON_DIFF_HUNK: print "@@ -l,s +l,s @@" before each group of changes
+ * @retval     n        Number of changed lines, ie 0 if equal
+ * @retval    -1        Error
+ * @code
+ *   if (clixon_diff_lines(cb, "a\nb\nc\n", "a\nc\nd\n", 1, 0) < 0)
+ *      err;
+ * @endcode
+ */
+int
+clixon_diff_lines(cbuf       *cb,
+                  const char *s1,
+                  const char *s2,
+                  int         context,
+                  int         flags)
+{
+    int               retval = -1;
+    struct diff_ctx   dc = {0,};
+    struct diff_op   *ops = NULL;
+    char             *show = NULL;
+    struct diff_line *l;
+    int               n = 0;
+    int               m = 0;
+    int               nops = 0;
+    int               i;
+    int               j;
+    int               k;
+    int               k1;
+    int               dist;
+    int               acount;
+    int               bcount;
+    int               changes = 0;
+
+    if (diff_split(s1, &dc.dc_a, &n) < 0)
+        goto done;
+    if (diff_split(s2, &dc.dc_b, &m) < 0)
+        goto done;
+    if ((dc.dc_dela = calloc(n + 1, 1)) == NULL ||
+        (dc.dc_insb = calloc(m + 1, 1)) == NULL ||
+        (dc.dc_v1 = malloc((n + m + 4)*sizeof(int))) == NULL ||
+        (dc.dc_v2 = malloc((n + m + 4)*sizeof(int))) == NULL ||
+        (ops = malloc((n + m + 1)*sizeof(*ops))) == NULL ||
+        (show = calloc(n + m + 1, 1)) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    diff_seq(&dc, 0, n, 0, m);
+    /* Edit script */
+    i = j = 0;
+    while (i < n || j < m){
+        ops[nops].do_a = i;
+        ops[nops].do_b = j;
+        if (i < n && dc.dc_dela[i]){
+            ops[nops].do_op = '-';
+            i++;
+            changes++;
+        }
+        else if (j < m && dc.dc_insb[j]){
+            ops[nops].do_op = '+';
+            j++;
+            changes++;
+        }
+        else {
+            ops[nops].do_op = ' ';
+            i++;
+            j++;
+        }
+        nops++;
+    }
+    if (changes == 0)
+        goto ok;
+    /* Mark operations within context of a change */
+    dist = context + 1;
+    for (k=0; k<nops; k++){
+        dist = ops[k].do_op == ' ' ? dist + 1 : 0;
+        if (dist <= context)
+            show[k] = 1;
+    }
+    dist = context + 1;
+    for (k=nops-1; k>=0; k--){
+        dist = ops[k].do_op == ' ' ? dist + 1 : 0;
+        if (dist <= context)
+            show[k] = 1;
+    }
+    /* Print hunks */
+    for (k=0; k<nops; k++){
+        if (!show[k])
+            continue;
+        if ((flags & CLIXON_DIFF_HUNK) && (k == 0 || !show[k-1])){
+            acount = bcount = 0;
+            for (k1=k; k1<nops && show[k1]; k1++){
+                if (ops[k1].do_op != '+')
+                    acount++;
+                if (ops[k1].do_op != '-')
+                    bcount++;
+            }
+            /* Empty range starts at line before, as in diff -U */
+            cprintf(cb, "@@ -%d,%d +%d,%d @@\n",
+                    ops[k].do_a + (acount?1:0), acount,
+                    ops[k].do_b + (bcount?1:0), bcount);
+        }
+        if (ops[k].do_op == '+')
+            l = &dc.dc_b[ops[k].do_b];
+        else
+            l = &dc.dc_a[ops[k].do_a];
+        cbuf_append(cb, ops[k].do_op);
+        cbuf_append_buf(cb, (void*)l->dl_str, l->dl_len);
+        cbuf_append(cb, '\n');
+    }
+ ok:
+    retval = changes;
+ done:
+    if (dc.dc_a)
+        free(dc.dc_a);
+    if (dc.dc_b)
+        free(dc.dc_b);
+    if (dc.dc_dela)
+        free(dc.dc_dela);
+    if (dc.dc_insb)
+        free(dc.dc_insb);
+    if (dc.dc_v1)
+        free(dc.dc_v1);
+    if (dc.dc_v2)
+        free(dc.dc_v2);
+    if (ops)
+        free(ops);
+    if (show)
+        free(show);
+    return retval;
+}
+
+/*
+ * Structural diff
+ */
+
+/*! A child to be matched
+ */
+struct diff_child {
+    cxobj *dc_x;   /* XML child */
+    int    dc_ord; /* Original position, then position among unkeyed siblings with same name */
+};
+
+/*! Compare two children: name, then list keys or leaf-list value, else ordinal
+ */
+static int
+diff_child_cmp(const void *a,
+               const void *b)
+{
+    const struct diff_child *ca = (const struct diff_child *)a;
+    const struct diff_child *cb = (const struct diff_child *)b;
+    yang_stmt               *y;
+    cg_var                  *cvi = NULL;
+    char                    *ba;
+    char                    *bb;
+    int                      eq;
+
+    if ((eq = strcmp(xml_name(ca->dc_x), xml_name(cb->dc_x))) != 0)
+        return eq;
+    if ((y = xml_spec(ca->dc_x)) != NULL && y == xml_spec(cb->dc_x)){
+        switch (yang_keyword_get(y)){
+        case Y_LIST:
+            while ((cvi = cvec_each(yang_cvec_get(y), cvi)) != NULL){
+                ba = xml_find_body(ca->dc_x, cv_string_get(cvi));
+                bb = xml_find_body(cb->dc_x, cv_string_get(cvi));
+                if ((eq = strcmp(ba?ba:"", bb?bb:"")) != 0)
+                    return eq;
+            }
+            return 0;
+        case Y_LEAF_LIST:
+            ba = xml_body(ca->dc_x);
+            bb = xml_body(cb->dc_x);
+            return strcmp(ba?ba:"", bb?bb:"");
+        default:
+            break;
+        }
+    }
+    return ca->dc_ord - cb->dc_ord;
+}
+
+/*! Return 1 if x is matched by keys or value, not by position
+ */
+static int
+diff_child_keyed(cxobj *x)
+{
+    yang_stmt *y;
+
+    if ((y = xml_spec(x)) == NULL)
+        return 0;
+    return yang_keyword_get(y) == Y_LIST || yang_keyword_get(y) == Y_LEAF_LIST;
+}
+
+/*! Get element children of x sorted for matching
+ *
+ * @param[in]  x     XML node
+ * @param[out] vecp  Vector of children, free with free()
+ * @param[out] lenp  Number of children
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+diff_children(cxobj              *x,
+              struct diff_child **vecp,
+              int                *lenp)
+{
+    struct diff_child *vec = NULL;
+    cxobj             *xc = NULL;
+    int                len;
+    int                i = 0;
+    int                ord = 0;
+
+    len = xml_child_nr_type(x, CX_ELMNT);
+    if ((vec = malloc((len + 1)*sizeof(*vec))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL){
+        vec[i].dc_x = xc;
+        vec[i].dc_ord = i;
+        i++;
+    }
+    qsort(vec, len, sizeof(*vec), diff_child_cmp);
+    /* Renumber unkeyed children among siblings with same name */
+    for (i=0; i<len; i++){
+        if (i > 0 && strcmp(xml_name(vec[i].dc_x), xml_name(vec[i-1].dc_x)) == 0)
+            ord++;
+        else
+            ord = 0;
+        vec[i].dc_ord = ord;
+    }
+    *vecp = vec;
+    *lenp = len;
+    return 0;
+}
+
+/*! Append path component of x to path
+ */
+static void
+diff_path_append(cbuf  *path,
+                 cxobj *x)
+{
+    yang_stmt *y;
+    cg_var    *cvi = NULL;
+    char      *b;
+
+    cprintf(path, "/%s", xml_name(x));
+    if (diff_child_keyed(x)){
+        y = xml_spec(x);
+        if (yang_keyword_get(y) == Y_LIST){
+            while ((cvi = cvec_each(yang_cvec_get(y), cvi)) != NULL){
+                b = xml_find_body(x, cv_string_get(cvi));
+                cprintf(path, "[%s='%s']", cv_string_get(cvi), b?b:"");
+            }
+        }
+        else{
+            b = xml_body(x);
+            cprintf(path, "[.='%s']", b?b:"");
+        }
+    }
+}
+
+/*! Structural diff of two XML nodes, recursive
+ *
+ * @param[out] cb    Diff output, or NULL
+ * @param[in]  path  Path of x1 and x2
+ * @param[in]  x1    First XML node
+ * @param[in]  x2    Second XML node
+ * @retval     n     Number of differences, if cb is NULL at most 1
+ * @retval    -1     Error
+ */
+static int
+diff_tree(cbuf  *cb,
+          cbuf  *path,
+          cxobj *x1,
+          cxobj *x2)
+{
+    int                retval = -1;
+    struct diff_child *v1 = NULL;
+    struct diff_child *v2 = NULL;
+    int                n1 = 0;
+    int                n2 = 0;
+    int                i1 = 0;
+    int                i2 = 0;
+    int                eq;
+    int                ret;
+    int                count = 0;
+    size_t             len;
+    char              *b1;
+    char              *b2;
+
+    if (xml_child_nr_type(x1, CX_ELMNT) == 0 && xml_child_nr_type(x2, CX_ELMNT) == 0){
+        b1 = xml_body(x1);
+        b2 = xml_body(x2);
+        if (strcmp(b1?b1:"", b2?b2:"") != 0){
+            if (cb)
+                cprintf(cb, "~ %s: %s -> %s\n", cbuf_len(path)?cbuf_get(path):"/", b1?b1:"", b2?b2:"");
+            count++;
+        }
+        goto ok;
+    }
+    if (diff_children(x1, &v1, &n1) < 0)
+        goto done;
+    if (diff_children(x2, &v2, &n2) < 0)
+        goto done;
+    len = cbuf_len(path);
+    while (i1 < n1 || i2 < n2){
+        if (cb == NULL && count)
+            break;
+        if (i1 == n1)
+            eq = 1;
+        else if (i2 == n2)
+            eq = -1;
+        else
+            eq = diff_child_cmp(&v1[i1], &v2[i2]);
+        if (eq < 0){
+            diff_path_append(path, v1[i1++].dc_x);
+            if (cb)
+                cprintf(cb, "- %s\n", cbuf_get(path));
+            count++;
+        }
+        else if (eq > 0){
+            diff_path_append(path, v2[i2++].dc_x);
+            if (cb)
+                cprintf(cb, "+ %s\n", cbuf_get(path));
+            count++;
+        }
+        else {
+            diff_path_append(path, v1[i1].dc_x);
+            if ((ret = diff_tree(cb, path, v1[i1].dc_x, v2[i2].dc_x)) < 0)
+                goto done;
+            count += ret;
+            i1++;
+            i2++;
+        }
+        cbuf_trunc(path, len);
+    }
+ ok:
+    retval = count;
+ done:
+    if (v1)
+        free(v1);
+    if (v2)
+        free(v2);
+    return retval;
+}
+
+/*! Structural diff of two XML trees
+ *
+ * Element children are matched by name, and then by list keys or leaf-list values if bound
+ * to YANG, otherwise by position among siblings with the same name. Order of children and
+ * attributes, including namespace declarations, are ignored.
+ * Output is one line per difference:
+ *   - <path>              Node only in x1
+ *   + <path>              Node only in x2
+ *   ~ <path>: <b1> -> <b2> Leaf value changed
+ * @param[out] cb    Diff output, appended. If NULL, stop at first difference
+ * @param[in]  x1    First XML tree
+ * @param[in]  x2    Second XML tree
+ * @retval     n     Number of differences, 0 if equal. If cb is NULL, 1 if not equal
+ * @retval    -1     Error
+ * @see clixon_xml_diff2cbuf  YANG-based diff with XML output
+ */
+int
+clixon_diff_tree(cbuf  *cb,
+                 cxobj *x1,
+                 cxobj *x2)
+{
+    int   retval = -1;
+    cbuf *path = NULL;
+
+    if ((path = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    retval = diff_tree(cb, path, x1, x2);
+ done:
+    if (path)
+        cbuf_free(path);
+    return retval;
+}
+
+/*! Render two XML trees in a format and line diff the result
+ *
+ * @param[out] cb       Diff output, appended
+ * @param[in]  x1       First XML tree
+ * @param[in]  x2       Second XML tree
+ * @param[in]  format   FORMAT_XML, FORMAT_JSON or FORMAT_TEXT, others rendered as XML
+ * @param[in]  context  Number of unchanged lines around changes
+ * @param[in]  flags    CLIXON_DIFF_HUNK: print hunk headers
+ * @retval     n        Number of changed lines, ie 0 if equal
+ * @retval    -1        Error
+ * @see clixon_diff_lines
+ */
+int
+clixon_diff_xml(cbuf            *cb,
+                cxobj           *x1,
+                cxobj           *x2,
+                enum format_enum format,
+                int              context,
+                int              flags)
+{
+    int    retval = -1;
+    cbuf  *cb1 = NULL;
+    cbuf  *cb2 = NULL;
+    cxobj *x;
+    cbuf  *cbx;
+    int    i;
+
+    if ((cb1 = cbuf_new()) == NULL ||
+        (cb2 = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    for (i=0; i<2; i++){
+        x = i ? x2 : x1;
+        cbx = i ? cb2 : cb1;
+        switch (format){
+        case FORMAT_JSON:
+            if (clixon_json2cbuf(cbx, x, 1, 1, 0) < 0)
+                goto done;
+            break;
+        case FORMAT_TEXT:
+            if (clixon_text2cbuf(cbx, x, 0, 1, 1) < 0)
+                goto done;
+            break;
+        case FORMAT_XML:
+        default:
+            if (clixon_xml2cbuf(cbx, x, 0, 1, NULL, -1, 1) < 0)
+                goto done;
+            break;
+        }
+    }
+    retval = clixon_diff_lines(cb, cbuf_get(cb1), cbuf_get(cb2), context, flags);
+ done:
+    if (cb1)
+        cbuf_free(cb1);
+    if (cb2)
+        cbuf_free(cb2);
+    return retval;
+}
@@ -133,6 +133,7 @@ static struct errvec EV[] = {
     {"Routing daemon error",   OE_ROUTING},
     {"XML error",              OE_XML},
     {"JSON error",             OE_JSON},
+    {"CBOR error",             OE_CBOR},
     {"RESTCONF error",         OE_RESTCONF},
     {"Plugins",                OE_PLUGIN},
     {"Yang error",             OE_YANG},
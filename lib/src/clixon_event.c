@@ -35,6 +35,10 @@
 
  *
  * Event handling and loop
+ * Each dispatched callback is timed and accounted to the string it was registered with:
+ * number of calls, total and max time, and a histogram. Timer callbacks also account the
+ * loop lag, ie how late they fire compared to their scheduled time. A callback holding
+ * the loop longer than the watchdog threshold is logged.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -44,6 +48,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
@@ -56,6 +61,7 @@
 
 #include <cligen/cligen.h>
 
+#include "clixon_string.h"
 #include "clixon_queue.h"
 #include "clixon_hash.h"
 #include "clixon_handle.h"
@@ -73,9 +79,20 @@
  */
 #define EVENT_STRLEN 32
 
+/* Number of histogram buckets of callback time and loop lag */
+#define EVENT_HIST_NR 5
+
 /*
  * Types
  */
+/* Timing statistics of one handler, or of loop lag */
+struct event_stats{
+    uint64_t es_calls;                /* Number of dispatches */
+    uint64_t es_total;                /* Total time in usecs */
+    uint64_t es_max;                  /* Max time in usecs */
+    uint64_t es_hist[EVENT_HIST_NR];  /* Histogram, see event_hist_le */
+};
+
 struct event_data{
     struct event_data *e_next;     /* next in list */
     int (*e_fn)(int, void*);            /* function */
@@ -84,8 +101,15 @@ struct event_data{
     struct timeval e_time;         /* Timeout */
     void *e_arg;                   /* function argument */
     char e_string[EVENT_STRLEN];             /* string for debugging */
+    struct event_stats *e_stats;   /* Statistics of handlers with same string */
 };
 
+/* Upper bounds of histogram buckets in usecs, last bucket is unbounded */
+static const uint64_t event_hist_le[EVENT_HIST_NR-1] = {1000, 10000, 100000, 1000000};
+
+/* Names of histogram buckets */
+static const char *event_hist_str[EVENT_HIST_NR] = {"1ms", "10ms", "100ms", "1s", "inf"};
+
 /*
  * Internal variables
  * XXX consider use handle variables instead of global
@@ -105,6 +129,15 @@ static int _clicon_sig_child = 0;
 /* If set (eg by signal handler) ignore EINTR and continue select loop */
 static int _clicon_sig_ignore = 0;
 
+/* Handler statistics keyed by registration string, entries are never removed */
+static clicon_hash_t *ee_stats = NULL;
+
+/* Loop lag: actual minus scheduled time of timer callbacks */
+static struct event_stats ee_lag = {0,};
+
+/* Log callbacks holding the loop longer than this many msecs, 0 disables */
+static uint32_t _ee_watchdog = 0;
+
 /*! For signal handlers: instead of doing exit, set a global variable to exit
  *
  * - zero means dont exit, 
@@ -166,6 +199,196 @@ clicon_sig_ignore_get(void)
     return _clicon_sig_ignore;
 }
 
+/*! Set watchdog threshold: log callbacks holding the event loop longer than this
+ *
+ * @param[in]  ms   Threshold in milliseconds, 0 disables
+ * @retval     0    OK
+ * @see CLICON_EVENT_WATCHDOG
+ */
+int
+clixon_event_watchdog_set(uint32_t ms)
+{
+    _ee_watchdog = ms;
+    return 0;
+}
+
+/*! Find or create statistics of handlers registered with a string
+ *
+ * @param[in]  str  Registration string
+ * @retval     es   Statistics entry
+ * @retval     NULL Error
+ */
+static struct event_stats *
+event_stats_find(char *str)
+{
+    struct event_stats *es;
+    struct event_stats  es0 = {0,};
+
+    if (ee_stats == NULL &&
+        (ee_stats = clicon_hash_init()) == NULL)
+        return NULL;
+    if ((es = clicon_hash_value(ee_stats, str, NULL)) == NULL){
+        if (clicon_hash_add(ee_stats, str, &es0, sizeof(es0)) == NULL)
+            return NULL;
+        es = clicon_hash_value(ee_stats, str, NULL);
+    }
+    return es;
+}
+
+/*! Account one sample in statistics entry
+ *
+ * @param[in]  es    Statistics entry
+ * @param[in]  usec  Time in microseconds
+ */
+static void
+event_stats_add(struct event_stats *es,
+                uint64_t            usec)
+{
+    int i;
+
+    es->es_calls++;
+    es->es_total += usec;
+    if (usec > es->es_max)
+        es->es_max = usec;
+    for (i=0; i<EVENT_HIST_NR-1; i++)
+        if (usec < event_hist_le[i])
+            break;
+    es->es_hist[i]++;
+}
+
+/*! Call a callback and account its time to its handler
+ *
+ * The event may be freed by the callback, therefore statistics and name are saved before
+ * @param[in]  e    Event
+ * @param[in]  fd   First argument of callback
+ * @retval     0    OK
+ * @retval    -1    Error from callback
+ */
+static int
+event_dispatch(struct event_data *e,
+               int                fd)
+{
+    int                 retval;
+    struct event_stats *es = e->e_stats;
+    char                str[EVENT_STRLEN];
+    struct timeval      t0;
+    struct timeval      t1;
+    uint64_t            usec;
+
+    strncpy(str, e->e_string, EVENT_STRLEN);
+    gettimeofday(&t0, NULL);
+    retval = (*e->e_fn)(fd, e->e_arg);
+    gettimeofday(&t1, NULL);
+    timersub(&t1, &t0, &t1);
+    usec = (uint64_t)t1.tv_sec*1000000 + t1.tv_usec;
+    event_stats_add(es, usec);
+    if (_ee_watchdog && usec >= (uint64_t)_ee_watchdog*1000)
+        clixon_log(NULL, LOG_WARNING, "Event watchdog: %s held event loop %" PRIu64 " ms (calls:%" PRIu64 " max:%" PRIu64 " ms)",
+                   str, usec/1000, es->es_calls, es->es_max/1000);
+    return retval;
+}
+
+/*! Print timing statistics entry as XML
+ */
+static void
+event_stats_print(cbuf               *cb,
+                  struct event_stats *es)
+{
+    int i;
+
+    cprintf(cb, "<calls>%" PRIu64 "</calls>", es->es_calls);
+    cprintf(cb, "<time-total>%" PRIu64 "</time-total>", es->es_total);
+    cprintf(cb, "<time-max>%" PRIu64 "</time-max>", es->es_max);
+    for (i=0; i<EVENT_HIST_NR; i++)
+        cprintf(cb, "<bucket><le>%s</le><count>%" PRIu64 "</count></bucket>",
+                event_hist_str[i], es->es_hist[i]);
+}
+
+/*! Print event loop statistics of this process as XML
+ *
+ * @param[in]  cb       Output buffer
+ * @param[in]  ns       Namespace of <event-loop> element, or NULL
+ * @param[in]  process  Name of process, eg backend
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see clixon-lib.yang stats rpc
+ */
+int
+clixon_event_stats(cbuf       *cb,
+                   const char *ns,
+                   const char *process)
+{
+    int                 retval = -1;
+    char              **keys = NULL;
+    size_t              nkeys = 0;
+    size_t              i;
+    struct event_stats *es;
+
+    cprintf(cb, "<event-loop");
+    if (ns)
+        cprintf(cb, " xmlns=\"%s\"", ns);
+    cprintf(cb, "><process>%s</process>", process);
+    cprintf(cb, "<lag>");
+    event_stats_print(cb, &ee_lag);
+    cprintf(cb, "</lag>");
+    if (ee_stats){
+        if (clicon_hash_keys(ee_stats, &keys, &nkeys) < 0)
+            goto done;
+        for (i=0; i<nkeys; i++){
+            if ((es = clicon_hash_value(ee_stats, keys[i], NULL)) == NULL ||
+                es->es_calls == 0)
+                continue;
+            cprintf(cb, "<handler><name>");
+            if (xml_chardata_cbuf_append(cb, keys[i]) < 0)
+                goto done;
+            cprintf(cb, "</name>");
+            event_stats_print(cb, es);
+            cprintf(cb, "</handler>");
+        }
+    }
+    cprintf(cb, "</event-loop>");
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Log event loop statistics of this process, one line per handler
+ *
+ * @param[in]  level  Log level, eg LOG_INFO
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+clixon_event_stats_log(int level)
+{
+    int                 retval = -1;
+    char              **keys = NULL;
+    size_t              nkeys = 0;
+    size_t              i;
+    struct event_stats *es;
+
+    clixon_log(NULL, level, "Event loop lag: timers:%" PRIu64 " total:%" PRIu64 " us max:%" PRIu64 " us",
+               ee_lag.es_calls, ee_lag.es_total, ee_lag.es_max);
+    if (ee_stats){
+        if (clicon_hash_keys(ee_stats, &keys, &nkeys) < 0)
+            goto done;
+        for (i=0; i<nkeys; i++){
+            if ((es = clicon_hash_value(ee_stats, keys[i], NULL)) == NULL ||
+                es->es_calls == 0)
+                continue;
+            clixon_log(NULL, level, "Event handler %s: calls:%" PRIu64 " total:%" PRIu64 " us max:%" PRIu64 " us",
+                       keys[i], es->es_calls, es->es_total, es->es_max);
+        }
+    }
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
 /*! Register a callback function to be called on input on a file descriptor.
  *
  * @param[in]  fd  File descriptor
@@ -193,6 +416,10 @@ clixon_event_reg_fd(int   fd,
     }
     memset(e, 0, sizeof(struct event_data));
     strncpy(e->e_string, str, EVENT_STRLEN-1);
+    if ((e->e_stats = event_stats_find(e->e_string)) == NULL){
+        free(e);
+        return -1;
+    }
     e->e_fd = fd;
     e->e_fn = fn;
     e->e_arg = arg;
@@ -280,6 +507,10 @@ clixon_event_reg_timeout(struct timeval t,
     }
     memset(e, 0, sizeof(struct event_data));
     strncpy(e->e_string, str, EVENT_STRLEN-1);
+    if ((e->e_stats = event_stats_find(e->e_string)) == NULL){
+        free(e);
+        goto done;
+    }
     e->e_fn = fn;
     e->e_arg = arg;
     e->e_type = EVENT_TIME;
@@ -436,7 +667,14 @@ clixon_event_loop(clixon_handle h)
             e = ee_timers;
             ee_timers = ee_timers->e_next;
             clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "timeout: %s", e->e_string);
-            if ((*e->e_fn)(0, e->e_arg) < 0){
+            gettimeofday(&t0, NULL);
+            if (timercmp(&t0, &e->e_time, >)){
+                timersub(&t0, &e->e_time, &t);
+                event_stats_add(&ee_lag, (uint64_t)t.tv_sec*1000000 + t.tv_usec);
+            }
+            else
+                event_stats_add(&ee_lag, 0);
+            if (event_dispatch(e, 0) < 0){
                 free(e);
                 goto err;
             }
@@ -450,7 +688,7 @@ clixon_event_loop(clixon_handle h)
             e_next = e->e_next;
             if(e->e_type == EVENT_FD && FD_ISSET(e->e_fd, &fdset)){
                 clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "FD_ISSET: %s", e->e_string);
-                if ((*e->e_fn)(e->e_fd, e->e_arg) < 0){
+                if (event_dispatch(e, e->e_fd) < 0){
                     clixon_debug(CLIXON_DBG_EVENT, "Error in: %s", e->e_string);
                     goto err;
                 }
@@ -489,5 +727,10 @@ clixon_event_exit(void)
         free(e);
     }
     ee_timers = NULL;
+    if (ee_stats){
+        clicon_hash_free(ee_stats);
+        ee_stats = NULL;
+    }
+    memset(&ee_lag, 0, sizeof(ee_lag));
     return 0;
 }
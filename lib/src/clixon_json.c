@@ -1364,7 +1364,7 @@ xml2json_vec(FILE             *f,
  * Example: <top><module:input> --> <top><input xmlns="">
  * @see RFC7951 Sec 4
  */
-static int
+int
 json_xmlns_translate(yang_stmt *yspec,
                      cxobj     *x,
                      cxobj    **xerr)
@@ -1216,6 +1216,30 @@ nacm_access_pre(clixon_handle  h,
                 char          *peername,
                 char          *username,
                 cxobj        **xnacmp)
+{
+    return nacm_access_pre_tree(h, NULL, peername, username, xnacmp);
+}
+
+/*! NACM intial pre- access control enforcements given a config tree
+ *
+ * As nacm_access_pre but in internal mode, the NACM config is read from a given config tree
+ * instead of the running datastore, eg a replica of running read by a frontend
+ * @param[in]  h        Clixon handle
+ * @param[in]  xconfig  Config tree of running, or NULL to read running datastore
+ * @param[in]  peername Peer username if any
+ * @param[in]  username User name of requestor
+ * @param[out] xncam    NACM XML tree, set if retval=0. Free after use
+ * @retval     1        OK permitted. You do not need to do next NACM step.
+ * @retval     0        OK but not validated. Need to do NACM step using xnacm
+ * @retval    -1        Error
+ * @see nacm_access_pre
+ */
+int
+nacm_access_pre_tree(clixon_handle  h,
+                     cxobj         *xconfig,
+                     char          *peername,
+                     char          *username,
+                     cxobj        **xnacmp)
 {
     int    retval = -1;
     char  *mode;
@@ -1236,8 +1260,19 @@ nacm_access_pre(clixon_handle  h,
                 goto done;
     }
     else if (strcmp(mode, "internal")==0){
-        if (xmldb_get0(h, "running", YB_MODULE, nsc, "nacm", 1, 0, &xnacm0, NULL, NULL) < 0)
-            goto done;
+        if (xconfig == NULL){
+            if (xmldb_get0(h, "running", YB_MODULE, nsc, "nacm", 1, 0, &xnacm0, NULL, NULL) < 0)
+                goto done;
+        }
+        else if ((x = xpath_first(xconfig, NULL, "nacm")) != NULL){
+            if ((xnacm0 = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+                goto done;
+            if ((xnacm = xml_dup(x)) == NULL)
+                goto done;
+            if (xml_addsub(xnacm0, xnacm) < 0)
+                goto done;
+            xnacm = NULL;
+        }
     }
     else{
         clixon_err(OE_XML, 0, "Invalid NACM mode: %s", mode);
@@ -1619,6 +1619,9 @@ netconf_trymerge(cxobj       *x,
  *   validate (8.6)
  *   startup (8.7)
  *   xpath (8.9)
+ * If CLICON_NETCONF_NMDA also features of RFC 8526:
+ *   origin
+ *   with-defaults
  * @see netconf_module_load  that is called later
  */
 int
@@ -1641,6 +1644,14 @@ netconf_module_features(clixon_handle h)
     if (clixon_xml_parse_string("<CLICON_FEATURE>ietf-netconf:xpath</CLICON_FEATURE>",
                                 YB_PARENT, NULL, &xc, NULL) < 0)
         goto done;
+    if (clicon_option_bool(h, "CLICON_NETCONF_NMDA")){
+        if (clixon_xml_parse_string("<CLICON_FEATURE>ietf-netconf-nmda:origin</CLICON_FEATURE>",
+                                    YB_PARENT, NULL, &xc, NULL) < 0)
+            goto done;
+        if (clixon_xml_parse_string("<CLICON_FEATURE>ietf-netconf-nmda:with-defaults</CLICON_FEATURE>",
+                                    YB_PARENT, NULL, &xc, NULL) < 0)
+            goto done;
+    }
     retval = 0;
  done:
     return retval;
@@ -1701,6 +1712,10 @@ netconf_module_load(clixon_handle h)
     /* RFC6022 YANG Module for NETCONF Monitoring */
     if (yang_spec_parse_module(h, "ietf-netconf-monitoring", NULL, yspec)< 0)
         goto done;
+    /* RFC8526 NETCONF Extensions to Support NMDA */
+    if (clicon_option_bool(h, "CLICON_NETCONF_NMDA"))
+        if (yang_spec_parse_module(h, "ietf-netconf-nmda", NULL, yspec)< 0)
+            goto done;
     /* Framing: If hello protocol skipped, set framing direct, ie fix chunked framing if NETCONF-1.1
      * But start with default: RFC 4741 EOM ]]>]]>
      * For now this only applies to external protocol
@@ -135,6 +135,7 @@ static const map_str2int _FORMATS[] = {
     {"json",    FORMAT_JSON},
     {"cli",     FORMAT_CLI},
     {"netconf", FORMAT_NETCONF},
+    {"cbor",    FORMAT_CBOR},
     {"default", FORMAT_DEFAULT},
     {NULL,      -1}
 };
@@ -617,6 +617,77 @@ clixon_msg_rcv11(int         s,
     return retval;
 }
 
+/*! Receive a message using chunked framing and pass it on in parts as it is read
+ *
+ * Same as clixon_msg_rcv11 but the message is not collected in one buffer: each read from
+ * the socket is decoded and given to a callback, so that large messages can be forwarded
+ * without holding all of them in memory.
+ * @param[in]   s      Socket (unix or inet) to communicate with backend
+ * @param[in]   descr  Description of peer for logging
+ * @param[in]   fn     Callback called with each part, and with eom set on the last
+ * @param[in]   arg    Argument to callback
+ * @param[out]  eof    Set if eof encountered
+ * @retval      0      OK (check eof)
+ * @retval     -1      Error
+ * @see clixon_msg_rcv11
+ */
+int
+clixon_msg_rcv11_stream(int                 s,
+                        const char         *descr,
+                        clixon_msg_part_cb *fn,
+                        void               *arg,
+                        int                *eof)
+{
+    int            retval = -1;
+    unsigned char  buf[BUFSIZ];
+    int            frame_state = 0;
+    size_t         frame_size = 0;
+    unsigned char *p;
+    size_t         plen;
+    cbuf          *cbmsg = NULL;
+    ssize_t        len;
+    int            eom = 0;
+    size_t         total = 0;
+
+    if ((cbmsg = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    *eof = 0;
+    while (*eof == 0 && eom == 0) {
+        if ((len = netconf_input_read2(s, buf, sizeof(buf), eof)) < 0)
+            goto done;
+        p = buf;
+        plen = len;
+        while (!(*eof) && plen > 0 && eom == 0){
+            if (netconf_input_msg2(&p, &plen,
+                                   cbmsg,
+                                   NETCONF_SSH_CHUNKED,
+                                   &frame_state,
+                                   &frame_size,
+                                   &eom) < 0){
+                /* Errors from input are only framing errors, non-fatal, return eof */
+                *eof = 1;
+                break;
+            }
+        }
+        if (*eof)
+            break;
+        if (cbuf_len(cbmsg) > 0 || eom){
+            total += cbuf_len(cbmsg);
+            if (fn(arg, cbuf_get(cbmsg), cbuf_len(cbmsg), eom) < 0)
+                goto done;
+            cbuf_reset(cbmsg);
+        }
+    }
+    clixon_debug(CLIXON_DBG_MSG, "Recv [%s]: %zu bytes", descr?descr:"", total);
+    retval = 0;
+ done:
+    if (cbmsg)
+        cbuf_free(cbmsg);
+    return retval;
+}
+
 /*! Send a NETCONF message and wait for result.
  *
  * TBD: timeout, interrupt?
@@ -670,6 +741,45 @@ clicon_rpc(int                sock,
     return retval;
 }
 
+/*! Send a NETCONF message and pass the result on in parts as it is received
+ *
+ * @param[in]  sock   Socket / file descriptor
+ * @param[in]  descr  Description of peer for logging
+ * @param[in]  msg    Clixon msg data structure
+ * @param[in]  fn     Callback called with each part of the reply
+ * @param[in]  arg    Argument to callback
+ * @param[out] eof    Set if eof encountered
+ * @retval     0      OK (check eof)
+ * @retval    -1      Error
+ * @see clicon_rpc  which returns the whole reply
+ */
+int
+clicon_rpc_stream(int                 sock,
+                  const char         *descr,
+                  struct clicon_msg  *msg,
+                  clixon_msg_part_cb *fn,
+                  void               *arg,
+                  int                *eof)
+{
+    int   retval = -1;
+    cbuf *cbsend = NULL;
+
+    if ((cbsend = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cbsend, "%s", msg->op_body);
+    if (clixon_msg_send11(sock, descr, cbsend) < 0)
+        goto done;
+    if (clixon_msg_rcv11_stream(sock, descr, fn, arg, eof) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cbsend)
+        cbuf_free(cbsend);
+    return retval;
+}
+
 /*! Send a clicon_msg message as reply to a clicon rpc request
  *
  * @param[in]  s       Socket to communicate with client
@@ -82,6 +82,11 @@
 #include "clixon_xml_sort.h"
 #include "clixon_netconf_lib.h"
 #include "clixon_xml_io.h"
+#include "clixon_xml_map.h"
+#include "clixon_xml_default.h"
+#include "clixon_uid.h"
+#include "clixon_datastore.h"
+#include "clixon_nacm.h"
 #include "clixon_proto_client.h"
 
 #define PERSIST_ID_XML_FMT "<persist-id>%s</persist-id>"
@@ -183,26 +188,22 @@ clicon_rpc_msg_once(clixon_handle      h,
     return retval;
 }
 
-/*! Send internal netconf rpc from client to backend
+/*! Send internal netconf rpc from client to backend, return reply as string
  *
- * @param[in]    h      Clixon handle
- * @param[in]    msg    Encoded message. Deallocate with free
- * @param[out]   xret0  Return value from backend as xml tree. Free w xml_free
- * @retval       0      OK
- * @retval      -1      Error
- * @note xret is populated with yangspec according to standard handle yangspec
+ * @param[in]    h        Clixon handle
+ * @param[in]    msg      Encoded message. Deallocate with free
+ * @param[out]   retdata  Return value from backend as string. Free with free
+ * @retval       0        OK
+ * @retval      -1        Error
  * @note side-effect, a socket created here is cached
- * @see clicon_rpc_msg_persistent
- * @see clicon_rpc_close_session
+ * @see clicon_rpc_msg  which parses the reply
  */
 int
-clicon_rpc_msg(clixon_handle      h,
-               struct clicon_msg *msg,
-               cxobj            **xret0)
+clicon_rpc_msg_raw(clixon_handle      h,
+                   struct clicon_msg *msg,
+                   char             **retdata)
 {
     int     retval = -1;
-    char   *retdata = NULL;
-    cxobj  *xret = NULL;
     int     s = -1;
     int     eof = 0;
 
@@ -211,7 +212,7 @@ clicon_rpc_msg(clixon_handle      h,
     assert(strstr(msg->op_body, "username")!=NULL); /* XXX */
 #endif
     /* Create a socket and connect to it, either UNIX, IPv4 or IPv6 per config options */
-    if (clicon_rpc_msg_once(h, msg, 1, &retdata, &eof, &s) < 0)
+    if (clicon_rpc_msg_once(h, msg, 1, retdata, &eof, &s) < 0)
         goto done;
     if (eof){
         /* 2. check socket shutdown AFTER rpc */
@@ -220,7 +221,7 @@ clicon_rpc_msg(clixon_handle      h,
         clicon_client_socket_set(h, -1);
 #ifdef PROTO_RESTART_RECONNECT
         if (!clixon_exit_get()) { /* May be part of termination */
-            if (clicon_rpc_msg_once(h, msg, 1, &retdata, &eof, NULL) < 0)
+            if (clicon_rpc_msg_once(h, msg, 1, retdata, &eof, NULL) < 0)
                 goto done;
             if (eof){
                 close(s);
@@ -239,7 +240,35 @@ clicon_rpc_msg(clixon_handle      h,
         goto done;
 #endif
     }
+    retval = 0;
+ done:
+    clixon_debug(CLIXON_DBG_DEFAULT | CLIXON_DBG_DETAIL, "retval:%d", retval);
+    return retval;
+}
 
+/*! Send internal netconf rpc from client to backend
+ *
+ * @param[in]    h      Clixon handle
+ * @param[in]    msg    Encoded message. Deallocate with free
+ * @param[out]   xret0  Return value from backend as xml tree. Free w xml_free
+ * @retval       0      OK
+ * @retval      -1      Error
+ * @note xret is populated with yangspec according to standard handle yangspec
+ * @note side-effect, a socket created here is cached
+ * @see clicon_rpc_msg_persistent
+ * @see clicon_rpc_close_session
+ */
+int
+clicon_rpc_msg(clixon_handle      h,
+               struct clicon_msg *msg,
+               cxobj            **xret0)
+{
+    int     retval = -1;
+    char   *retdata = NULL;
+    cxobj  *xret = NULL;
+
+    if (clicon_rpc_msg_raw(h, msg, &retdata) < 0)
+        goto done;
     if (retdata){
         /* Cannot populate xret here because need to know RPC name (eg "lock") in order to associate yang
          * to reply.
@@ -253,7 +282,6 @@ clicon_rpc_msg(clixon_handle      h,
     }
     retval = 0;
  done:
-    clixon_debug(CLIXON_DBG_DEFAULT | CLIXON_DBG_DETAIL, "retval:%d", retval);
     if (retdata)
         free(retdata);
     if (xret)
@@ -409,6 +437,53 @@ clicon_rpc_netconf(clixon_handle  h,
     return retval;
 }
 
+/*! Send a netconf message to backend and pass the reply on in parts as it is received
+ *
+ * The reply is neither parsed nor collected in one buffer.
+ * @param[in]  h       Clixon handle
+ * @param[in]  xmlstr  XML netconf tree as string
+ * @param[in]  fn      Callback called with each part of the reply
+ * @param[in]  arg     Argument to callback
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @note There is no reconnect if the backend has closed the socket, since parts of a reply
+ *       may already have been passed on
+ */
+int
+clicon_rpc_netconf_stream(clixon_handle       h,
+                          char               *xmlstr,
+                          clixon_msg_part_cb *fn,
+                          void               *arg)
+{
+    int                retval = -1;
+    uint32_t           session_id;
+    struct clicon_msg *msg = NULL;
+    int                s;
+    int                eof = 0;
+
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((msg = clicon_msg_encode(session_id, "%s", xmlstr)) == NULL)
+        goto done;
+    if ((s = clicon_client_socket_get(h)) < 0){
+        if (clicon_rpc_connect(h, &s) < 0)
+            goto done;
+        clicon_client_socket_set(h, s);
+    }
+    if (clicon_rpc_stream(s, clicon_sock_str(h), msg, fn, arg, &eof) < 0 || eof){
+        close(s);
+        clicon_client_socket_set(h, -1);
+        if (eof)
+            clixon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (msg)
+        free(msg);
+    return retval;
+}
+
 /*! Generic xml netconf clicon rpc
  *
  * Want to go over to use netconf directly between client and server,...
@@ -482,6 +557,170 @@ clicon_rpc_netconf_xml(clixon_handle  h,
     return retval;
 }
 
+/*! Apply with-defaults on a config tree in report-all state, as in the backend output
+ *
+ * @param[in]  xt    Config tree, modified
+ * @param[in]  wdef  With-defaults parameter, not report-all-tagged
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xml2output_wdef  for the backend
+ */
+static int
+rpc_replica_withdefaults(cxobj            *xt,
+                         withdefaults_type wdef)
+{
+    switch (wdef){
+    case WITHDEFAULTS_TRIM:
+        /* Also remove leafs set to their default value */
+        if (xml_apply(xt, CX_ELMNT, (xml_applyfn_t*)xml_flag_default_value, (void*)XML_FLAG_DEFAULT) < 0)
+            return -1;
+        /* fall thru */
+    case WITHDEFAULTS_EXPLICIT:
+        if (xml_default_nopresence(xt, 2, 0) < 0)
+            return -1;
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
+
+/*! Get running configuration from local replica instead of from backend
+ *
+ * Same as the get-config RPC to the backend: filter, NACM read access and with-defaults
+ * The reply tree is built from the filtered replica tree directly, without serialization.
+ * Only if NACM is disabled or internal, since NACM rules are read from the replica.
+ * report-all-tagged is left to the backend.
+ * @param[in]  h         Clixon handle
+ * @param[in]  username  NACM username
+ * @param[in]  xpath     XPath (or "")
+ * @param[in]  nsc       Namespace context for filter
+ * @param[in]  defaults  With-defaults parameter, or NULL
+ * @param[out] xret      Reply as received from backend: <rpc-reply><data>...
+ * @retval     1         OK, xret set
+ * @retval     0         Replica not available, or error reply, send RPC to backend
+ * @retval    -1         Error
+ * @see CLICON_XMLDB_REPLICA
+ */
+static int
+rpc_get_config_replica(clixon_handle h,
+                       char         *username,
+                       char         *xpath,
+                       cvec         *nsc,
+                       char         *defaults,
+                       cxobj       **xret)
+{
+    int                     retval = -1;
+    char                   *mode;
+    cxobj                  *xr = NULL;
+    cxobj                  *xtop = NULL;
+    cxobj                  *xreply;
+    cxobj                  *xt = NULL;
+    cxobj                  *xnacm = NULL;
+    cxobj                 **xvec = NULL;
+    size_t                  xlen;
+    yang_stmt              *yspec;
+    char                   *xpath1 = NULL;
+    cvec                   *nsc1 = NULL;
+    char                   *peername = NULL;
+    cbuf                   *cb = NULL;
+    withdefaults_type       wdef = WITHDEFAULTS_EXPLICIT;
+    enum nacm_credentials_t creds;
+    int                     i;
+    int                     ret;
+
+    mode = clicon_option_str(h, "CLICON_NACM_MODE");
+    if (mode != NULL &&
+        strcmp(mode, "disabled") != 0 &&
+        strcmp(mode, "internal") != 0)
+        goto fail;
+    if (defaults != NULL &&
+        (wdef = withdefaults_str2int(defaults)) == WITHDEFAULTS_REPORT_ALL_TAGGED)
+        goto fail;
+    if ((ret = xmldb_replica_get(h, &xr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    yspec = clicon_dbspec_yang(h);
+    if (xpath && strlen(xpath)){
+        if ((ret = xpath2canonical(xpath, nsc, yspec, &xpath1, &nsc1, NULL)) < 0)
+            goto done;
+        if (ret == 0) /* Let backend make error reply */
+            goto fail;
+    }
+    if (xmldb_tree_get(h, xr, nsc1, xpath1?xpath1:"/", &xt) < 0)
+        goto done;
+    if (xpath_vec(xt, nsc1, "%s", &xvec, &xlen, xpath1?xpath1:"/") < 0)
+        goto done;
+    /* Remove everything that is not marked, as filter_xpath_again in backend */
+    for (i=0; i<xlen; i++)
+        xml_flag_set(xvec[i], XML_FLAG_MARK);
+    if (!xml_flag(xt, XML_FLAG_MARK))
+        if (xml_tree_prune_flagged_sub(xt, XML_FLAG_MARK, 1, NULL) < 0)
+            goto done;
+    if (xml_apply(xt, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_MARK) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if ((ret = nacm_access_pre_tree(h, xr, NULL, username, &xnacm)) < 0)
+        goto done;
+    if (ret == 0){ /* Do NACM validation */
+        if (uid2name(geteuid(), &peername) < 0)
+            goto done;
+        creds = clicon_nacm_credentials(h);
+        if ((ret = verify_nacm_user(h, creds, peername, username, "get-config", cb)) < 0)
+            goto done;
+        if (ret == 0) /* Let backend make error reply */
+            goto fail;
+        if ((ret = nacm_rpc("get-config", "ietf-netconf", username, xnacm, cb)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if (nacm_datanode_read(h, xt, xvec, xlen, username, xnacm) < 0)
+            goto done;
+    }
+    if (rpc_replica_withdefaults(xt, wdef) < 0)
+        goto done;
+    /* Same tree as parsed reply from backend: <top><rpc-reply><data> */
+    if ((xtop = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL ||
+        (xreply = xml_new("rpc-reply", xtop, CX_ELMNT)) == NULL)
+        goto done;
+    if (xmlns_set(xreply, NULL, NETCONF_BASE_NAMESPACE) < 0)
+        goto done;
+    if (xml_name_set(xt, NETCONF_OUTPUT_DATA) < 0)
+        goto done;
+    xml_flag_reset(xt, XML_FLAG_TOP);
+    if (xml_addsub(xreply, xt) < 0)
+        goto done;
+    xt = NULL;
+    *xret = xtop;
+    xtop = NULL;
+    retval = 1;
+ done:
+    if (xtop)
+        xml_free(xtop);
+    if (cb)
+        cbuf_free(cb);
+    if (peername)
+        free(peername);
+    if (xnacm)
+        xml_free(xnacm);
+    if (xvec)
+        free(xvec);
+    if (xt)
+        xml_free(xt);
+    if (nsc1)
+        xml_nsctx_free(nsc1);
+    if (xpath1)
+        free(xpath1);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Get database configuration
  *
  * Same as clicon_proto_change just with a cvec instead of lvec
@@ -531,40 +770,46 @@ clicon_rpc_get_config(clixon_handle h,
     yang_stmt         *yspec;
     cvec              *nscd = NULL;
 
-    if (session_id_check(h, &session_id) < 0)
-        goto done;
-    if ((cb = cbuf_new()) == NULL){
-        clixon_err(OE_XML, errno, "cbuf_new");
-        goto done;
-    }
-    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
     if (username == NULL)
         username = clicon_username_get(h);
-    if (username != NULL){
-        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
-        cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
-    }
-    cprintf(cb, " xmlns:%s=\"%s\"",
-            NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
-    cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
-    cprintf(cb, "><get-config><source><%s/></source>", db);
-    if (xpath && strlen(xpath)){
-        cprintf(cb, "<%s:filter %s:type=\"xpath\" %s:select=\"%s\"",
-                NETCONF_BASE_PREFIX, NETCONF_BASE_PREFIX, NETCONF_BASE_PREFIX,
-                xpath);
-        if (xml_nsctx_cbuf(cb, nsc) < 0)
+    /* Read running from local replica if available */
+    if (strcmp(db, "running") == 0 &&
+        (ret = rpc_get_config_replica(h, username, xpath, nsc, defaults, &xret)) < 0)
+        goto done;
+    if (xret == NULL){
+        if (session_id_check(h, &session_id) < 0)
+            goto done;
+        if ((cb = cbuf_new()) == NULL){
+            clixon_err(OE_XML, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+        if (username != NULL){
+            cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+            cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+        }
+        cprintf(cb, " xmlns:%s=\"%s\"",
+                NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
+        cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
+        cprintf(cb, "><get-config><source><%s/></source>", db);
+        if (xpath && strlen(xpath)){
+            cprintf(cb, "<%s:filter %s:type=\"xpath\" %s:select=\"%s\"",
+                    NETCONF_BASE_PREFIX, NETCONF_BASE_PREFIX, NETCONF_BASE_PREFIX,
+                    xpath);
+            if (xml_nsctx_cbuf(cb, nsc) < 0)
+                goto done;
+            cprintf(cb, "/>");
+        }
+        if (defaults != NULL)
+            cprintf(cb, "<with-defaults xmlns=\"%s\">%s</with-defaults>",
+                    IETF_NETCONF_WITH_DEFAULTS_YANG_NAMESPACE,
+                    defaults);
+        cprintf(cb, "</get-config></rpc>");
+        if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
+            goto done;
+        if (clicon_rpc_msg(h, msg, &xret) < 0)
             goto done;
-        cprintf(cb, "/>");
     }
-    if (defaults != NULL)
-        cprintf(cb, "<with-defaults xmlns=\"%s\">%s</with-defaults>",
-                IETF_NETCONF_WITH_DEFAULTS_YANG_NAMESPACE,
-                defaults);
-    cprintf(cb, "</get-config></rpc>");
-    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
-        goto done;
-    if (clicon_rpc_msg(h, msg, &xret) < 0)
-        goto done;
     yspec = clicon_dbspec_yang(h);
     /* Send xml error back: first check error, then ok */
     if ((xd = xpath_first(xret, NULL, "/rpc-reply/rpc-error")) != NULL)
@@ -0,0 +1,227 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2024 Olof Hagsand
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * SHA-256 message digest, FIPS 180-4
+ * A small self-contained implementation so that the backend and all restconf modes can
+ * use it without depending on a crypto library.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_sha256.h"
+
+/* Round constants, FIPS 180-4 Sec 4.2.2 */
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+/*! Process one 64-byte block
+ */
+static void
+sha256_block(clixon_sha256_ctx *ctx,
+             const uint8_t     *p)
+{
+    uint32_t w[64];
+    uint32_t a, b, c, d, e, f, g, h;
+    uint32_t s0, s1, t1, t2;
+    int      i;
+
+    for (i = 0; i < 16; i++)
+        w[i] = ((uint32_t)p[4*i] << 24) | ((uint32_t)p[4*i+1] << 16) |
+            ((uint32_t)p[4*i+2] << 8) | (uint32_t)p[4*i+3];
+    for (i = 16; i < 64; i++){
+        s0 = ROTR(w[i-15], 7) ^ ROTR(w[i-15], 18) ^ (w[i-15] >> 3);
+        s1 = ROTR(w[i-2], 17) ^ ROTR(w[i-2], 19) ^ (w[i-2] >> 10);
+        w[i] = w[i-16] + s0 + w[i-7] + s1;
+    }
+    a = ctx->sh_state[0]; b = ctx->sh_state[1]; c = ctx->sh_state[2]; d = ctx->sh_state[3];
+    e = ctx->sh_state[4]; f = ctx->sh_state[5]; g = ctx->sh_state[6]; h = ctx->sh_state[7];
+    for (i = 0; i < 64; i++){
+        s1 = ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25);
+        t1 = h + s1 + ((e & f) ^ (~e & g)) + sha256_k[i] + w[i];
+        s0 = ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22);
+        t2 = s0 + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    ctx->sh_state[0] += a; ctx->sh_state[1] += b; ctx->sh_state[2] += c; ctx->sh_state[3] += d;
+    ctx->sh_state[4] += e; ctx->sh_state[5] += f; ctx->sh_state[6] += g; ctx->sh_state[7] += h;
+}
+
+/*! Initialize SHA-256 state
+ *
+ * @param[out] ctx  SHA-256 state
+ */
+void
+clixon_sha256_init(clixon_sha256_ctx *ctx)
+{
+    static const uint32_t h0[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    memcpy(ctx->sh_state, h0, sizeof(h0));
+    ctx->sh_len = 0;
+    ctx->sh_buflen = 0;
+}
+
+/*! Add data to SHA-256 state
+ *
+ * @param[in]  ctx   SHA-256 state
+ * @param[in]  data  Data
+ * @param[in]  len   Length of data in bytes
+ */
+void
+clixon_sha256_update(clixon_sha256_ctx *ctx,
+                     const void        *data,
+                     size_t             len)
+{
+    const uint8_t *p = data;
+    size_t         n;
+
+    ctx->sh_len += len;
+    if (ctx->sh_buflen){
+        n = SHA256_BLOCK_LEN - ctx->sh_buflen;
+        if (n > len)
+            n = len;
+        memcpy(ctx->sh_buf + ctx->sh_buflen, p, n);
+        ctx->sh_buflen += n;
+        p += n;
+        len -= n;
+        if (ctx->sh_buflen < SHA256_BLOCK_LEN)
+            return;
+        sha256_block(ctx, ctx->sh_buf);
+        ctx->sh_buflen = 0;
+    }
+    while (len >= SHA256_BLOCK_LEN){
+        sha256_block(ctx, p);
+        p += SHA256_BLOCK_LEN;
+        len -= SHA256_BLOCK_LEN;
+    }
+    if (len){
+        memcpy(ctx->sh_buf, p, len);
+        ctx->sh_buflen = len;
+    }
+}
+
+/*! Add a length-prefixed field to SHA-256 state
+ *
+ * The length is added as a 64-bit big-endian integer before the data, so that a
+ * sequence of fields has an unambiguous encoding regardless of their content.
+ * @param[in]  ctx   SHA-256 state
+ * @param[in]  data  Data, may be NULL if len is 0
+ * @param[in]  len   Length of data in bytes
+ */
+void
+clixon_sha256_field(clixon_sha256_ctx *ctx,
+                    const void        *data,
+                    size_t             len)
+{
+    uint8_t  lb[8];
+    uint64_t l = len;
+    int      i;
+
+    for (i = 7; i >= 0; i--){
+        lb[i] = l & 0xff;
+        l >>= 8;
+    }
+    clixon_sha256_update(ctx, lb, sizeof(lb));
+    if (len)
+        clixon_sha256_update(ctx, data, len);
+}
+
+/*! Finish SHA-256 computation and return digest
+ *
+ * @param[in]  ctx     SHA-256 state, needs re-initialization after this call
+ * @param[out] digest  Message digest
+ */
+void
+clixon_sha256_final(clixon_sha256_ctx *ctx,
+                    uint8_t            digest[SHA256_DIGEST_LEN])
+{
+    uint64_t bits = ctx->sh_len * 8;
+    uint8_t  pad[SHA256_BLOCK_LEN + 8];
+    size_t   padlen;
+    int      i;
+
+    padlen = (ctx->sh_buflen < 56) ? (56 - ctx->sh_buflen) : (120 - ctx->sh_buflen);
+    memset(pad, 0, sizeof(pad));
+    pad[0] = 0x80;
+    for (i = 0; i < 8; i++)
+        pad[padlen + i] = (bits >> (56 - 8*i)) & 0xff;
+    clixon_sha256_update(ctx, pad, padlen + 8);
+    for (i = 0; i < 8; i++){
+        digest[4*i]   = (ctx->sh_state[i] >> 24) & 0xff;
+        digest[4*i+1] = (ctx->sh_state[i] >> 16) & 0xff;
+        digest[4*i+2] = (ctx->sh_state[i] >> 8) & 0xff;
+        digest[4*i+3] = ctx->sh_state[i] & 0xff;
+    }
+}
+
+/*! Print digest as lowercase hex string
+ *
+ * @param[in]  digest  Message digest
+ * @param[out] cb      Hex string (64 characters) is appended here
+ * @retval     0       OK
+ */
+int
+clixon_sha256_hex(const uint8_t digest[SHA256_DIGEST_LEN],
+                  cbuf         *cb)
+{
+    int i;
+
+    for (i = 0; i < SHA256_DIGEST_LEN; i++)
+        cprintf(cb, "%02x", digest[i]);
+    return 0;
+}
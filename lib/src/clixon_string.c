@@ -44,6 +44,11 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <ctype.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 #include <cligen/cligen.h>
 
@@ -332,6 +337,230 @@ uri_unreserved(unsigned char in)
     return 0;
 }
 
+/* Size of stack buffer used when expanding format strings, longer strings are malloced */
+#define STRING_FMT_BUFLEN 256
+
+/* Word-at-a-time (SWAR) byte search in a 64-bit word.
+ * SWAR_HASZERO is non-zero iff some byte of w is zero, SWAR_HAS iff some byte is c
+ */
+#define SWAR_ONES         0x0101010101010101ULL
+#define SWAR_HIGHS        0x8080808080808080ULL
+#define SWAR_HASZERO(w)   (((w) - SWAR_ONES) & ~(w) & SWAR_HIGHS)
+#define SWAR_HAS(w, c)    SWAR_HASZERO((w) ^ (SWAR_ONES * (uint8_t)(c)))
+
+/*! Expand a stdarg format string, use a caller buffer if the result fits
+ *
+ * @param[in]  buf    Caller buffer, typically on stack
+ * @param[in]  buflen Size of buf
+ * @param[out] strp   Expanded string, either buf or malloced. Free if not buf
+ * @param[out] lenp   Length of expanded string
+ * @param[in]  fmt    Format string
+ * @param[in]  ap     Variable argument list
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+string_vexpand(char       *buf,
+               size_t      buflen,
+               char      **strp,
+               size_t     *lenp,
+               const char *fmt,
+               va_list     ap)
+{
+    va_list ap2;
+    int     len;
+    char   *str;
+
+    va_copy(ap2, ap);
+    len = vsnprintf(buf, buflen, fmt, ap2);
+    va_end(ap2);
+    if (len < 0){
+        clixon_err(OE_UNIX, errno, "vsnprintf");
+        return -1;
+    }
+    if (len < buflen){
+        *strp = buf;
+        *lenp = len;
+        return 0;
+    }
+    if ((str = malloc(len+1)) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    vsnprintf(str, len+1, fmt, ap);
+    *strp = str;
+    *lenp = len;
+    return 0;
+}
+
+/*! Length of initial part of str with only unreserved URI characters
+ *
+ * Scans 16 bytes at a time with SSE2 or NEON if available, the remainder one byte
+ * at a time.
+ * @param[in]  str  String
+ * @param[in]  len  Length of str
+ * @retval     n    Index of first reserved character, or len
+ */
+static inline size_t
+uri_unreserved_span(const char *str,
+                    size_t      len)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    __m128i v;
+    __m128i ok;
+    int     mask;
+
+    /* Signed compares: bytes >= 0x80 are negative and fall outside all ranges */
+    for (; i + 16 <= len; i += 16){
+        v = _mm_loadu_si128((const __m128i *)(str + i));
+        ok = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('a'-1)),
+                           _mm_cmplt_epi8(v, _mm_set1_epi8('z'+1)));
+        ok = _mm_or_si128(ok, _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A'-1)),
+                                            _mm_cmplt_epi8(v, _mm_set1_epi8('Z'+1))));
+        ok = _mm_or_si128(ok, _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0'-1)),
+                                            _mm_cmplt_epi8(v, _mm_set1_epi8('9'+1))));
+        ok = _mm_or_si128(ok, _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('-'-1)),
+                                            _mm_cmplt_epi8(v, _mm_set1_epi8('.'+1))));
+        ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+        ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, _mm_set1_epi8('~')));
+        if ((mask = _mm_movemask_epi8(ok)) != 0xffff)
+            return i + __builtin_ctz(~mask & 0xffff);
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    uint8x16_t v;
+    uint8x16_t ok;
+
+    for (; i + 16 <= len; i += 16){
+        v = vld1q_u8((const uint8_t *)str + i);
+        ok = vandq_u8(vcgeq_u8(v, vdupq_n_u8('a')), vcleq_u8(v, vdupq_n_u8('z')));
+        ok = vorrq_u8(ok, vandq_u8(vcgeq_u8(v, vdupq_n_u8('A')), vcleq_u8(v, vdupq_n_u8('Z'))));
+        ok = vorrq_u8(ok, vandq_u8(vcgeq_u8(v, vdupq_n_u8('0')), vcleq_u8(v, vdupq_n_u8('9'))));
+        ok = vorrq_u8(ok, vandq_u8(vcgeq_u8(v, vdupq_n_u8('-')), vcleq_u8(v, vdupq_n_u8('.'))));
+        ok = vorrq_u8(ok, vceqq_u8(v, vdupq_n_u8('_')));
+        ok = vorrq_u8(ok, vceqq_u8(v, vdupq_n_u8('~')));
+        if (vminvq_u8(ok) == 0)
+            break;
+    }
+#endif
+    while (i < len && uri_unreserved(str[i]))
+        i++;
+    return i;
+}
+
+/*! Length of initial part of str without characters escaped in XML: & < >
+ *
+ * Scans 16 bytes at a time with SSE2 or NEON if available, otherwise 8 bytes at a
+ * time in a 64-bit word. The remainder is scanned one byte at a time.
+ * @param[in]  str  String
+ * @param[in]  len  Length of str
+ * @retval     n    Index of first special character, or len
+ */
+static inline size_t
+xml_chardata_span(const char *str,
+                  size_t      len)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    __m128i v;
+    __m128i m;
+    int     mask;
+
+    for (; i + 16 <= len; i += 16){
+        v = _mm_loadu_si128((const __m128i *)(str + i));
+        m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('&')),
+                                      _mm_cmpeq_epi8(v, _mm_set1_epi8('<'))),
+                         _mm_cmpeq_epi8(v, _mm_set1_epi8('>')));
+        if ((mask = _mm_movemask_epi8(m)) != 0)
+            return i + __builtin_ctz(mask);
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    uint8x16_t v;
+    uint8x16_t m;
+
+    for (; i + 16 <= len; i += 16){
+        v = vld1q_u8((const uint8_t *)str + i);
+        m = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8('&')),
+                              vceqq_u8(v, vdupq_n_u8('<'))),
+                     vceqq_u8(v, vdupq_n_u8('>')));
+        if (vmaxvq_u8(m) != 0)
+            break;
+    }
+#else
+    uint64_t w;
+
+    for (; i + 8 <= len; i += 8){
+        memcpy(&w, str + i, sizeof(w));
+        if (SWAR_HAS(w, '&') | SWAR_HAS(w, '<') | SWAR_HAS(w, '>'))
+            break;
+    }
+#endif
+    while (i < len && str[i] != '&' && str[i] != '<' && str[i] != '>')
+        i++;
+    return i;
+}
+
+/*! Escape XML special characters into a buffer, or only compute the length
+ *
+ * Runs of characters that need no escaping are copied in bulk, CDATA sections as is.
+ * @param[in]  str   Not-encoded string, NULL-terminated
+ * @param[in]  slen  Length of str
+ * @param[out] esc   Encoded string of at least returned length, or NULL
+ * @retval     len   Length of encoded string, excluding trailing NULL
+ * @see xml_chardata_cbuf_append  Same encoding appended to a cbuf
+ */
+static size_t
+xml_chardata_escape(const char *str,
+                    size_t      slen,
+                    char       *esc)
+{
+    const char *p = str;
+    const char *end = str + slen;
+    const char *q;
+    const char *rep;
+    size_t      n;
+    size_t      len = 0;
+
+    while (p < end){
+        if ((n = xml_chardata_span(p, end - p)) > 0){
+            if (esc)
+                memcpy(esc + len, p, n);
+            len += n;
+            p += n;
+            if (p == end)
+                break;
+        }
+        switch (*p){
+        case '&':
+            rep = "&amp;";
+            break;
+        case '>':
+            rep = "&gt;";
+            break;
+        default: /* '<' */
+            if (strncmp(p, "<![CDATA[", strlen("<![CDATA[")) == 0){
+                if ((q = strstr(p + 1, "]]>")) != NULL)
+                    q += strlen("]]>");
+                else
+                    q = end;
+                if (esc)
+                    memcpy(esc + len, p, q - p);
+                len += q - p;
+                p = q;
+                continue;
+            }
+            rep = "&lt;";
+            break;
+        }
+        n = strlen(rep);
+        if (esc)
+            memcpy(esc + len, rep, n);
+        len += n;
+        p++;
+    }
+    return len;
+}
+
 /*! Percent encoding according to RFC 3986 URI Syntax
  *
  * @param[out]  encp   Encoded malloced output string
@@ -354,56 +583,65 @@ int
 uri_percent_encode(char **encp,
                    const char *fmt, ...)
 {
-    int     retval = -1;
-    char   *str = NULL;  /* Expanded format string w stdarg */
-    char   *enc = NULL;
-    int     fmtlen;
-    size_t  len;
-    int     i, j;
-    va_list args;
-
-    /* Two steps: (1) read in the complete format string */
-    va_start(args, fmt); /* dryrun */
-    fmtlen = vsnprintf(NULL, 0, fmt, args) + 1;
+    int         retval = -1;
+    char        buf[STRING_FMT_BUFLEN];
+    char       *str = NULL;  /* Expanded format string w stdarg */
+    char       *enc = NULL;
+    size_t      slen;
+    size_t      len;
+    size_t      n;
+    const char *p;
+    const char *end;
+    va_list     args;
+    static const char hex[] = "0123456789ABCDEF";
+
+    va_start(args, fmt);
+    retval = string_vexpand(buf, sizeof(buf), &str, &slen, fmt, args);
     va_end(args);
-    if ((str = malloc(fmtlen)) == NULL){
-        clixon_err(OE_UNIX, errno, "malloc");
+    if (retval < 0)
         goto done;
-    }
-    memset(str, 0, fmtlen);
-    va_start(args, fmt); /* real */
-    fmtlen = vsnprintf(str, fmtlen, fmt, args) + 1;
-    va_end(args);
-    /* Now str is the combined fmt + ... */
-
-    /* Step (2) encode and expand str --> enc */
-    /* This is max */
-    len = strlen(str)*3+1;
-    if ((enc = malloc(len)) == NULL){
+    retval = -1;
+    /* Compute exact length: each reserved character expands to three */
+    end = str + slen;
+    len = slen;
+    for (p = str; (p += uri_unreserved_span(p, end - p)) < end; p++)
+        len += 2;
+    if ((enc = malloc(len+1)) == NULL){
         clixon_err(OE_UNIX, errno, "malloc");
         goto done;
     }
-    memset(enc, 0, len);
-    len = strlen(str);
-    j = 0;
-    for (i=0; i<len; i++){
-        if (uri_unreserved(str[i]))
-            enc[j++] = str[i];
-        else{
-            snprintf(&enc[j], 4, "%%%02X", str[i]&0xff);
-            j += 3;
-        }
+    len = 0;
+    for (p = str; p < end; p++){
+        n = uri_unreserved_span(p, end - p);
+        memcpy(enc + len, p, n);
+        len += n;
+        if ((p += n) == end)
+            break;
+        enc[len++] = '%';
+        enc[len++] = hex[(*p >> 4) & 0x0f];
+        enc[len++] = hex[*p & 0x0f];
     }
+    enc[len] = '\0';
     *encp = enc;
     retval = 0;
  done:
-    if (str)
+    if (str && str != buf)
         free(str);
     if (retval < 0 && enc)
         free(enc);
     return retval;
 }
 
+/*! Value of hex digit, caller checks isxdigit
+ */
+static inline int
+hexval(char c)
+{
+    if (c <= '9')
+        return c - '0';
+    return (c | 0x20) - 'a' + 10;
+}
+
 /*! Percent decoding according to RFC 3986 URI Syntax
  *
  * @param[in]   enc    Encoded input string     
@@ -417,40 +655,44 @@ int
 uri_percent_decode(char  *enc,
                    char **strp)
 {
-    int   retval = -1;
-    char *str = NULL;
-    int   i, j;
-    char  hstr[3];
+    int    retval = -1;
+    char  *str = NULL;
+    size_t i, j;
     size_t len;
-    char *ptr;
+    size_t n;
+    char  *p;
 
     if (enc == NULL){
         clixon_err(OE_UNIX, EINVAL, "enc is NULL");
         goto done;
     }
     /* This is max */
-    len = strlen(enc)+1;
-    if ((str = malloc(len)) == NULL){
+    len = strlen(enc);
+    if ((str = malloc(len+1)) == NULL){
         clixon_err(OE_UNIX, errno, "malloc");
         goto done;
     }
-    memset(str, 0, len);
-    len = strlen(enc);
-    j = 0;
-    for (i=0; i<len; i++){
-        if (enc[i] == '%' && strlen(enc)-i > 2 &&
-            isxdigit(enc[i+1]) && isxdigit(enc[i+2])){
-            hstr[0] = enc[i+1];
-            hstr[1] = enc[i+2];
-            hstr[2] = 0;
-            str[j] = strtoul(hstr, &ptr, 16);
-            i += 2;
+    i = j = 0;
+    while (i < len){
+        /* Copy run up to next '%' */
+        if ((p = memchr(enc + i, '%', len - i)) != NULL)
+            n = p - (enc + i);
+        else
+            n = len - i;
+        memcpy(str + j, enc + i, n);
+        i += n;
+        j += n;
+        if (i == len)
+            break;
+        if (len - i > 2 &&
+            isxdigit((unsigned char)enc[i+1]) && isxdigit((unsigned char)enc[i+2])){
+            str[j++] = (hexval(enc[i+1]) << 4) | hexval(enc[i+2]);
+            i += 3;
         }
         else
-            str[j] = enc[i];
-        j++;
+            str[j++] = enc[i++];
     }
-    str[j++] = '\0';
+    str[j] = '\0';
     *strp = str;
     retval = 0;
  done:
@@ -490,116 +732,31 @@ xml_chardata_encode(char      **escp,
                     const char *fmt,...)
 {
     int     retval = -1;
+    char    buf[STRING_FMT_BUFLEN];
     char   *str = NULL;  /* Expanded format string w stdarg */
-    int     fmtlen;
     char   *esc = NULL;
-    int     l;
-    int     len;
-    int     i, j;
-    int     cdata; /* when set, skip encoding */
-    va_list args;
     size_t  slen;
+    size_t  len;
+    va_list args;
 
-    /* Two steps: (1) read in the complete format string */
-    va_start(args, fmt); /* dryrun */
-    fmtlen = vsnprintf(NULL, 0, fmt, args) + 1;
+    va_start(args, fmt);
+    retval = string_vexpand(buf, sizeof(buf), &str, &slen, fmt, args);
     va_end(args);
-    if ((str = malloc(fmtlen)) == NULL){
-        clixon_err(OE_UNIX, errno, "malloc");
+    if (retval < 0)
         goto done;
-    }
-    memset(str, 0, fmtlen);
-    va_start(args, fmt); /* real */
-    fmtlen = vsnprintf(str, fmtlen, fmt, args) + 1;
-    va_end(args);
-    /* Now str is the combined fmt + ... */
-
-    /* Step (2) encode and expand str --> enc */
-    /* First compute length (do nothing) */
-    len = 0; cdata = 0;
-    slen = strlen(str);
-    for (i=0; i<slen; i++){
-        if (cdata){
-            if (strncmp(&str[i], "]]>", strlen("]]>")) == 0)
-                cdata = 0;
-            len++;
-        }
-        else
-            switch (str[i]){
-            case '&':
-                len += strlen("&amp;");
-                break;
-            case '<':
-                if (strncmp(&str[i], "<![CDATA[", strlen("<![CDATA[")) == 0){
-                    len++;
-                    cdata++;
-                }
-                else
-                    len += strlen("&lt;");
-                break;
-            case '>':
-                len += strlen("&gt;");
-                break;
-            default:
-                len++;
-            }
-    }
-    len++; /* trailing \0 */
-    /* We know length, allocate encoding buffer  */
-    if ((esc = malloc(len)) == NULL){
+    retval = -1;
+    /* First compute length, then encode into exactly allocated buffer */
+    len = xml_chardata_escape(str, slen, NULL);
+    if ((esc = malloc(len+1)) == NULL){
         clixon_err(OE_UNIX, errno, "malloc");
         goto done;
     }
-    memset(esc, 0, len);
-
-    /* Same code again, but now actually encode into output buffer */
-    j = 0; cdata = 0;
-    slen = strlen(str);
-    for (i=0; i<slen; i++){
-        if (cdata){
-            if (strncmp(&str[i], "]]>", strlen("]]>")) == 0){
-                cdata = 0;
-                esc[j++] = str[i++];
-                esc[j++] = str[i++];
-            }
-            esc[j++] = str[i];
-        }
-        else
-        switch (str[i]){
-        case '&':
-            if ((l=snprintf(&esc[j], 6, "&amp;")) < 0){
-                clixon_err(OE_UNIX, errno, "snprintf");
-                goto done;
-            }
-            j += l;
-            break;
-        case '<':
-            if (strncmp(&str[i], "<![CDATA[", strlen("<![CDATA[")) == 0){
-                esc[j++] = str[i];
-                cdata++;
-                break;
-            }
-            if ((l=snprintf(&esc[j], 5, "&lt;")) < 0){
-                clixon_err(OE_UNIX, errno, "snprintf");
-                goto done;
-            }
-            j += l;
-            break;
-        case '>':
-            if ((l=snprintf(&esc[j], 5, "&gt;")) < 0){
-                clixon_err(OE_UNIX, errno, "snprintf");
-                goto done;
-            }
-            j += l;
-            break;
-        default:
-            esc[j++] = str[i];
-        }
-    }
+    xml_chardata_escape(str, slen, esc);
+    esc[len] = '\0';
     *escp = esc;
     retval = 0;
  done:
-    if (str)
+    if (str && str != buf)
         free(str);
     if (retval < 0 && esc)
         free(esc);
@@ -608,6 +765,7 @@ xml_chardata_encode(char      **escp,
 
 /*! Escape characters according to XML definition and append to cbuf
  *
+ * Runs of characters that need no escaping are appended in bulk.
  * @param[in]   cb     CLIgen buf
  * @param[in]   str    Not-encoded input string
  * @retdata     0      OK
@@ -617,48 +775,51 @@ int
 xml_chardata_cbuf_append(cbuf *cb,
                          char *str)
 {
-    int  retval = -1;
-    int  i;
-    int  cdata; /* when set, skip encoding */
-    size_t len;
-
-    /* The orignal of this code is in xml_chardata_encode */
-    /* Step: encode and expand str --> enc */
-    /* Same code again, but now actually encode into output buffer */
-    cdata = 0;
-
-    len = strlen(str);
-    for (i=0; i<len; i++){
-        if (cdata){
-            if (strncmp(&str[i], "]]>", strlen("]]>")) == 0){
-                cdata = 0;
-                cbuf_append(cb, str[i++]);
-                cbuf_append(cb, str[i++]);
+    int         retval = -1;
+    const char *p = str;
+    const char *end;
+    const char *q;
+    size_t      n;
+
+    /* The original of this code is in xml_chardata_escape */
+    end = str + strlen(str);
+    while (p < end){
+        if ((n = xml_chardata_span(p, end - p)) > 0){
+            if (cbuf_append_buf(cb, (void*)p, n) < 0){
+                clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+                goto done;
             }
-            cbuf_append(cb, str[i]);
+            if ((p += n) == end)
+                break;
         }
-        else
-        switch (str[i]){
+        switch (*p){
         case '&':
             cbuf_append_str(cb, "&amp;");
             break;
-        case '<':
-            if (strncmp(&str[i], "<![CDATA[", strlen("<![CDATA[")) == 0){
-                cbuf_append(cb, str[i]);
-                cdata++;
-                break;
-            }
-            cbuf_append_str(cb, "&lt;");
-            break;
         case '>':
             cbuf_append_str(cb, "&gt;");
             break;
-        default:
-            cbuf_append(cb, str[i]);
+        default: /* '<' */
+            if (strncmp(p, "<![CDATA[", strlen("<![CDATA[")) == 0){
+                /* Skip encoding of CDATA section */
+                if ((q = strstr(p + 1, "]]>")) != NULL)
+                    q += strlen("]]>");
+                else
+                    q = end;
+                if (cbuf_append_buf(cb, (void*)p, q - p) < 0){
+                    clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+                    goto done;
+                }
+                p = q;
+                continue;
+            }
+            cbuf_append_str(cb, "&lt;");
+            break;
         }
+        p++;
     }
     retval = 0;
-    // done:
+ done:
     return retval;
 }
 
@@ -747,58 +908,54 @@ xml_chardata_decode(char      **decp,
                     const char *fmt,...)
 {
     int     retval = -1;
+    char    buf[STRING_FMT_BUFLEN];
     char   *str = NULL;  /* Expanded encoded format string w stdarg */
     char   *dec = NULL;
-    int     fmtlen;
     va_list args;
     size_t  slen;
     int     i;
     int     j;
+    size_t  n;
+    char   *p;
     char    ch;
     int     ret;
 
-    /* Two steps: (1) read in the complete format string */
-    va_start(args, fmt); /* dryrun */
-    fmtlen = vsnprintf(NULL, 0, fmt, args) + 1;
+    va_start(args, fmt);
+    retval = string_vexpand(buf, sizeof(buf), &str, &slen, fmt, args);
     va_end(args);
-    if ((str = malloc(fmtlen)) == NULL){
-        clixon_err(OE_UNIX, errno, "malloc");
+    if (retval < 0)
         goto done;
-    }
-    memset(str, 0, fmtlen);
-    va_start(args, fmt); /* real */
-    fmtlen = vsnprintf(str, fmtlen, fmt, args) + 1;
-    va_end(args);
-    /* Now str is the combined fmt + ... */
-
-    /* Step (2) decode str --> dec 
-     * First allocate decoded string, encoded is always >= larger */
-    slen = strlen(str);
+    retval = -1;
+    /* Allocate decoded string, encoded is always >= larger */
     if ((dec = malloc(slen+1)) == NULL){
         clixon_err(OE_UNIX, errno, "malloc");
         goto done;
     }
-    j = 0;
-    memset(dec, 0, slen+1);
-    for (i=0; i<slen; i++){
-        ch = str[i];
-        switch (ch){
-        case '&':
-            if ((ret = xml_chardata_decode_ampersand(&str[i+1], &ch, &i)) < 0)
-                goto done;
-            if (ret == 0)
-                dec[j++] = str[i];
-            else
-                dec[j++] = ch;
+    i = j = 0;
+    while (i < slen){
+        /* Copy run up to next '&' */
+        if ((p = memchr(str + i, '&', slen - i)) != NULL)
+            n = p - (str + i);
+        else
+            n = slen - i;
+        memcpy(dec + j, str + i, n);
+        i += n;
+        j += n;
+        if (i == slen)
             break;
-        default:
+        if ((ret = xml_chardata_decode_ampersand(&str[i+1], &ch, &i)) < 0)
+            goto done;
+        if (ret == 0)
             dec[j++] = str[i];
-        }
+        else
+            dec[j++] = ch;
+        i++;
     }
+    dec[j] = '\0';
     *decp = dec;
     retval = 0;
  done:
-    if (str)
+    if (str && str != buf)
         free(str);
     if (retval < 0 && dec)
         free(dec);
@@ -64,6 +64,7 @@
 #include "clixon_yang.h"
 #include "clixon_xml.h"
 #include "clixon_err.h"
+#include "clixon_cancel.h"
 #include "clixon_log.h"
 #include "clixon_debug.h"
 #include "clixon_data.h"
@@ -222,7 +223,7 @@ validate_leafref(cxobj     *xt,
  * @retval     1     Validation OK
  * @retval     0     Validation failed
  * @retval    -1     Error
- * @see ys_populate_identity where the derived types are set
+ * @see yang_identity_index_build where the derived types are indexed
  * @see yang_augment_node
  * @see RFC7950 Sec 9.10.2:
  * @see xp_function_derived_from  similar code other context
@@ -235,24 +236,11 @@ validate_identityref(cxobj     *xt,
 {
     int         retval = -1;
     char       *node = NULL;
-    char       *idref = NULL;
     yang_stmt  *ybaseref; /* This is the type's base reference */
     yang_stmt  *ybaseid;
-    char       *prefix = NULL;
-    char       *id = NULL;
+    yang_stmt  *yid;
     cbuf       *cberr = NULL;
-    cbuf       *cb = NULL;
-    cvec       *idrefvec; /* Derived identityref list: (module:id)**/
-    yang_stmt  *ymod;
 
-    if ((cb = cbuf_new()) == NULL){
-        clixon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
-    if ((cberr = cbuf_new()) == NULL){
-        clixon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
     /* Get idref value. Then see if this value is derived from ytype.
      */
     if ((node = xml_body(xt)) == NULL){ /* It may not be empty */
@@ -260,8 +248,6 @@ validate_identityref(cxobj     *xt,
             goto done;
         goto fail;
     }
-    if (nodeid_split(node, &prefix, &id) < 0)
-        goto done;
     /* This is the type's base reference */
     if ((ybaseref = yang_find(ytype, Y_BASE, NULL)) == NULL){
         if (xret && netconf_missing_element_xml(xret, "application", yang_argument_get(ytype), "Identityref validation failed, no base") < 0)
@@ -269,35 +255,20 @@ validate_identityref(cxobj     *xt,
         goto fail;
     }
     /* This is the actual base identity */
-    if ((ybaseid = yang_find_identity(ybaseref, yang_argument_get(ybaseref))) == NULL){
+    if ((ybaseid = yang_identity_base(ybaseref)) == NULL){
         if (xret && netconf_missing_element_xml(xret, "application", yang_argument_get(ybaseref), "Identityref validation failed, no base identity") < 0)
             goto done;
         goto fail;
     }
-
-    /* idref from prefix:id to module:id */
-    if (prefix == NULL)
-        ymod = ys_module(ys);
-    else{ /* from prefix to name */
-        ymod = yang_find_module_by_prefix_yspec(ys_spec(ys), prefix);
-    }
-    if (ymod == NULL){
-        cprintf(cberr, "Identityref validation failed, %s not derived from %s in %s.yang:%d",
-                node,
-                yang_argument_get(ybaseid),
-                yang_argument_get(ys_module(ybaseid)),
-                yang_linenum_get(ybaseid));
-        if (xret && netconf_operation_failed_xml(xret, "application", cbuf_get(cberr)) < 0)
-            goto done;
-        goto fail;
-    }
-    cprintf(cb, "%s:%s", yang_argument_get(ymod), id);
-    idref = cbuf_get(cb);
-    /* Here check if node is in the derived node list of the base identity
-     * The derived node list is a cvec computed XXX
+    /* Here check if node is an identity derived from the base identity
+     * using the identity index, see yang_identity_index_build
      */
-    idrefvec = yang_cvec_get(ybaseid);
-    if (cvec_find(idrefvec, idref) == NULL){
+    if ((yid = yang_identity_value(ys, node)) == NULL ||
+        yang_identity_derived(yid, ybaseid, 0) == 0){
+        if ((cberr = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
         cprintf(cberr, "Identityref validation failed, %s not derived from %s in %s.yang:%d",
                 node,
                 yang_argument_get(ybaseid),
@@ -311,12 +282,6 @@ validate_identityref(cxobj     *xt,
  done:
     if (cberr)
         cbuf_free(cberr);
-    if (cb)
-        cbuf_free(cb);
-    if (id)
-        free(id);
-    if (prefix)
-        free(prefix);
     return retval;
  fail:
     retval = 0;
@@ -980,31 +945,22 @@ check_mandatory(cxobj     *xt,
     goto done;
 }
 
-/*! Validate a single XML node with yang specification for added entry
+/*! Validate a single XML node with yang specification for added entry, not its children
  *
- * 1. Check if mandatory leafs present as subs.
- * 2. Check leaf values, eg int ranges and string regexps.
+ * @param[in]  h     Clixon handle
  * @param[in]  xt    XML node to be validated
  * @param[out] xret  Error XML tree, as rpc-reply/rpc-error. Free with xml_free after use
+ * @param[out] skip  Set to 1 if children should not be validated
  * @retval     1     Validation OK
  * @retval     0     Validation failed (cbret set)
  * @retval    -1     Error
- * @code
- *   cxobj *x;
- *   cbuf *xret = NULL;
- *   if ((ret = xml_yang_validate_add(h, x, &xret)) < 0)
- *      err;
- *   if (ret == 0)
- *      fail;
- * @endcode
- * @see xml_yang_validate_all
- * @see xml_yang_validate_rpc
- * @note Should need a variant accepting cxobj **xret
+ * @see xml_yang_validate_add  Validate node and all its children
  */
 int
-xml_yang_validate_add(clixon_handle h,
-                      cxobj        *xt,
-                      cxobj       **xret)
+xml_yang_validate_add_node(clixon_handle h,
+                           cxobj        *xt,
+                           cxobj       **xret,
+                           int          *skip)
 {
     int          retval = -1;
     cg_var      *cv = NULL;
@@ -1012,17 +968,19 @@ xml_yang_validate_add(clixon_handle h,
     yang_stmt   *yt;   /* yang spec of xt going in */
     char        *body;
     int          ret;
-    cxobj       *x;
     cg_var      *cv0;
     enum cv_type cvtype;
     validate_level vl = VL_NONE;
 
+    *skip = 0;
     if (clicon_option_bool(h, "CLICON_YANG_SCHEMA_MOUNT")){
         if ((ret = xml_yang_mount_get(h, xt, &vl, NULL)) < 0)
             goto done;
         /* Check if validate beyond mountpoints */
-        if (ret == 1 && vl == VL_NONE)
+        if (ret == 1 && vl == VL_NONE){
+            *skip = 1;
             goto ok;
+        }
     }
     /* if not given by argument (overide) use default link 
        and !Node has a config sub-statement and it is false */
@@ -1076,13 +1034,6 @@ xml_yang_validate_add(clixon_handle h,
             break;
         }
     }
-    x = NULL;
-    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
-        if ((ret = xml_yang_validate_add(h, x, xret)) < 0)
-            goto done;
-        if (ret == 0)
-            goto fail;
-    }
   ok:
     retval = 1;
  done:
@@ -1096,6 +1047,48 @@ xml_yang_validate_add(clixon_handle h,
     goto done;
 }
 
+/*! Validate a single XML node with yang specification for added entry
+ *
+ * 1. Check if mandatory leafs present as subs.
+ * 2. Check leaf values, eg int ranges and string regexps.
+ * @param[in]  xt    XML node to be validated
+ * @param[out] xret  Error XML tree, as rpc-reply/rpc-error. Free with xml_free after use
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (cbret set)
+ * @retval    -1     Error
+ * @code
+ *   cxobj *x;
+ *   cbuf *xret = NULL;
+ *   if ((ret = xml_yang_validate_add(h, x, &xret)) < 0)
+ *      err;
+ *   if (ret == 0)
+ *      fail;
+ * @endcode
+ * @see xml_yang_validate_all
+ * @see xml_yang_validate_rpc
+ * @note Should need a variant accepting cxobj **xret
+ */
+int
+xml_yang_validate_add(clixon_handle h,
+                      cxobj        *xt,
+                      cxobj       **xret)
+{
+    int    ret;
+    int    skip = 0;
+    cxobj *x;
+
+    if ((ret = xml_yang_validate_add_node(h, xt, xret, &skip)) < 1)
+        return ret;
+    if (skip)
+        return 1;
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+        if ((ret = xml_yang_validate_add(h, x, xret)) < 1)
+            return ret;
+    }
+    return 1;
+}
+
 /*! Some checks done only at edit_config, eg keys in lists
  *
  * @param[in]  xt     XML tree
@@ -1198,30 +1191,22 @@ xml_yang_validate_leaf_union(clixon_handle h,
     goto done;
 }
 
-/*! Validate a single XML node with yang specification for all (not only added) entries
+/*! Validate a single XML node with yang specification for all entries, not its children
  *
- * 1. Check leafrefs. Eg you delete a leaf and a leafref references it.
- * @param[in]  xt  XML node to be validated
+ * @param[in]  h     Clixon handle
+ * @param[in]  xt    XML node to be validated
  * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
+ * @param[out] skip  Set to 1 if children should not be validated
  * @retval     1     Validation OK
  * @retval     0     Validation failed (cbret set)
  * @retval    -1     Error
- * @code
- *   cxobj *x;
- *   cbuf *xret = NULL;
- *   if ((ret = xml_yang_validate_all(h, x, &xret)) < 0)
- *      err;
- *   if (ret == 0)
- *      fail;
- *   xml_free(xret);
- * @endcode
- * @see xml_yang_validate_add
- * @see xml_yang_validate_rpc
+ * @see xml_yang_validate_all  Validate node and all its children
  */
 int
-xml_yang_validate_all(clixon_handle h,
-                      cxobj        *xt,
-                      cxobj       **xret)
+xml_yang_validate_all_node(clixon_handle h,
+                           cxobj        *xt,
+                           cxobj       **xret,
+                           int          *skip)
 {
     int        retval = -1;
     yang_stmt *yt;  /* yang node associated with xt */
@@ -1230,7 +1215,6 @@ xml_yang_validate_all(clixon_handle h,
     char      *xpath;
     int        nr;
     int        ret;
-    cxobj     *x;
     cxobj     *xp;
     char      *ns = NULL;
     cbuf      *cb = NULL;
@@ -1239,12 +1223,15 @@ xml_yang_validate_all(clixon_handle h,
     validate_level vl = VL_NONE;
     int        saw_node = 0;
 
+    *skip = 0;
     if (clicon_option_bool(h, "CLICON_YANG_SCHEMA_MOUNT")){
         if ((ret = xml_yang_mount_get(h, xt, &vl, NULL)) < 0)
             goto done;
         /* Check if validate beyond mountpoints */
-        if (ret == 1 && vl == VL_NONE)
+        if (ret == 1 && vl == VL_NONE){
+            *skip = 1;
             goto ok;
+        }
     }
     /* if not given by argument (overide) use default link 
        and !Node has a config sub-statement and it is false */
@@ -1253,6 +1240,7 @@ xml_yang_validate_all(clixon_handle h,
             clixon_log(h, LOG_WARNING,
                        "%s: %d: No YANG spec for %s, validation skipped",
                        __FUNCTION__, __LINE__, xml_name(xt));
+            *skip = 1;
             goto ok;
         }
         if ((cb = cbuf_new()) == NULL){
@@ -1298,6 +1286,7 @@ xml_yang_validate_all(clixon_handle h,
         switch (yang_keyword_get(yt)){
         case Y_ANYXML:
         case Y_ANYDATA:
+            *skip = 1;
             goto ok;
             break;
         case Y_LEAF:
@@ -1373,21 +1362,6 @@ xml_yang_validate_all(clixon_handle h,
             }
         }
     }
-    x = NULL;
-    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
-        if ((ret = xml_yang_validate_all(h, x, xret)) < 0)
-            goto done;
-        if (ret == 0)
-            goto fail;
-    }
-    /* Check unique and min-max after choice test for example*/
-    if (yang_config(yt) != 0){
-        /* Checks if next level contains any unique list constraints */
-        if ((ret = xml_yang_validate_minmax(xt, 1, xret)) < 0)
-            goto done;
-        if (ret == 0)
-            goto fail;
-    }
  ok:
     retval = 1;
  done:
@@ -1401,6 +1375,55 @@ xml_yang_validate_all(clixon_handle h,
     goto done;
 }
 
+/*! Validate a single XML node with yang specification for all (not only added) entries
+ *
+ * 1. Check leafrefs. Eg you delete a leaf and a leafref references it.
+ * @param[in]  xt  XML node to be validated
+ * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (cbret set)
+ * @retval    -1     Error
+ * @code
+ *   cxobj *x;
+ *   cbuf *xret = NULL;
+ *   if ((ret = xml_yang_validate_all(h, x, &xret)) < 0)
+ *      err;
+ *   if (ret == 0)
+ *      fail;
+ *   xml_free(xret);
+ * @endcode
+ * @see xml_yang_validate_add
+ * @see xml_yang_validate_rpc
+ */
+int
+xml_yang_validate_all(clixon_handle h,
+                      cxobj        *xt,
+                      cxobj       **xret)
+{
+    int    ret;
+    int    skip = 0;
+    cxobj *x;
+
+    if (clixon_cancel_check(0) < 0)
+        return -1;
+    if ((ret = xml_yang_validate_all_node(h, xt, xret, &skip)) < 1)
+        return ret;
+    if (skip)
+        return 1;
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+        if ((ret = xml_yang_validate_all(h, x, xret)) < 1)
+            return ret;
+    }
+    /* Check unique and min-max after choice test for example*/
+    if (yang_config(xml_spec(xt)) != 0){
+        /* Checks if next level contains any unique list constraints */
+        if ((ret = xml_yang_validate_minmax(xt, 1, xret)) < 1)
+            return ret;
+    }
+    return 1;
+}
+
 /*! Validate a single XML node with yang specification
  *
  * @param[in]  h     Clixon handle
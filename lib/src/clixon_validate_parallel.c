@@ -0,0 +1,636 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2024 Olof Hagsand
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * Parallel generic validation
+ * The tree is partitioned into a sequence of units in the order sequential validation
+ * visits them: whole subtrees, single nodes without children, and post-checks (min/max,
+ * unique) of nodes whose children were split. Contiguous ranges of units are validated by
+ * forked worker processes on their copy-on-write snapshot of the tree, the first range by
+ * the calling process itself. Since ranges are ordered, the first failing unit of the
+ * lowest failing range gives the same error as sequential validation.
+ */
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <signal.h>
+#include <syslog.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_string.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_debug.h"
+#include "clixon_netconf_lib.h"
+#include "clixon_options.h"
+#include "clixon_xml_io.h"
+#include "clixon_validate.h"
+#include "clixon_validate_minmax.h"
+#include "clixon_validate_parallel.h"
+
+/* Trees with fewer nodes than this are always validated sequentially */
+#define VALIDATE_PARALLEL_MIN 4096
+
+/* Split subtrees larger than total size / (workers * VALIDATE_GRAIN) */
+#define VALIDATE_GRAIN        8
+
+/* Kind of validation unit, in the order they are made in sequential validation
+ */
+enum validate_unit_type{
+    VU_ALL,       /* xml_yang_validate_all of subtree */
+    VU_ALL_NODE,  /* xml_yang_validate_all of node only, children are separate units */
+    VU_ALL_POST,  /* Min/max and unique of children after VU_ALL_NODE */
+    VU_TOP_POST,  /* Min/max and unique of top-level */
+    VU_ADD,       /* xml_yang_validate_add of subtree */
+    VU_ADD_NODE,  /* xml_yang_validate_add of node only, children are separate units */
+};
+
+/* Validation unit */
+struct validate_unit{
+    enum validate_unit_type vu_type;
+    cxobj                  *vu_x;
+    size_t                  vu_weight; /* Estimated cost: number of nodes */
+};
+
+/* Validation job: a sequence of validation units */
+struct validate_job{
+    clixon_handle         vj_h;
+    int                   vj_workers; /* Max number of processes, including caller */
+    struct validate_unit *vj_vec;
+    int                   vj_len;
+    int                   vj_max;
+    size_t                vj_weight;  /* Sum of unit weights */
+};
+
+/* Message from worker to parent */
+struct validate_msg{
+    int32_t  vm_ret;      /* 1: OK, 0: validation failed, -1: error */
+    int32_t  vm_category; /* Error category if -1 */
+    int32_t  vm_suberr;   /* Error sub-number if -1 */
+    uint32_t vm_len;      /* Length of payload: error XML if 0, error reason if -1 */
+};
+
+/*! Number of element nodes in XML tree
+ */
+static size_t
+xml_tree_size(cxobj *xt)
+{
+    size_t n = 1;
+    cxobj *x = NULL;
+
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL)
+        n += xml_tree_size(x);
+    return n;
+}
+
+/*! Append a unit to a vector of units
+ */
+static int
+validate_unit_push(struct validate_unit **vecp,
+                   int                   *lenp,
+                   int                   *maxp,
+                   enum validate_unit_type type,
+                   cxobj                 *x,
+                   size_t                 weight)
+{
+    struct validate_unit *vec;
+    int                   max;
+
+    if (*lenp == *maxp){
+        max = *maxp ? 2 * *maxp : 64;
+        if ((vec = realloc(*vecp, max * sizeof(*vec))) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+        *vecp = vec;
+        *maxp = max;
+    }
+    (*vecp)[*lenp].vu_type = type;
+    (*vecp)[*lenp].vu_x = x;
+    (*vecp)[*lenp].vu_weight = weight;
+    (*lenp)++;
+    return 0;
+}
+
+/*! Create a validation job
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     vj  Validation job, free with validate_job_free
+ * @retval     NULL Error
+ * @code
+ *   validate_job *vj;
+ *   if ((vj = validate_job_new(h)) == NULL)
+ *      err;
+ *   if (validate_job_all_top(vj, xt) < 0)
+ *      err;
+ *   if ((ret = validate_job_run(vj, &xret)) < 0)
+ *      err;
+ *   validate_job_free(vj);
+ * @endcode
+ */
+validate_job *
+validate_job_new(clixon_handle h)
+{
+    validate_job *vj;
+
+    if ((vj = malloc(sizeof(*vj))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memset(vj, 0, sizeof(*vj));
+    vj->vj_h = h;
+    vj->vj_workers = clicon_option_int(h, "CLICON_VALIDATE_WORKERS");
+    return vj;
+}
+
+/*! Free a validation job
+ */
+int
+validate_job_free(validate_job *vj)
+{
+    if (vj->vj_vec)
+        free(vj->vj_vec);
+    free(vj);
+    return 0;
+}
+
+/*! Add full validation of all top-level children of a tree to a validation job
+ *
+ * Same as xml_yang_validate_all_top
+ * @param[in]  vj  Validation job
+ * @param[in]  xt  Top-level XML tree, not modified until job is run
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+validate_job_all_top(validate_job *vj,
+                     cxobj        *xt)
+{
+    cxobj *x = NULL;
+    size_t weight = 0;
+
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL){
+        if (vj->vj_workers > 1)
+            weight = xml_tree_size(x);
+        if (validate_unit_push(&vj->vj_vec, &vj->vj_len, &vj->vj_max, VU_ALL, x, weight) < 0)
+            return -1;
+        vj->vj_weight += weight;
+    }
+    weight = xml_child_nr_type(xt, CX_ELMNT);
+    if (validate_unit_push(&vj->vj_vec, &vj->vj_len, &vj->vj_max, VU_TOP_POST, xt, weight) < 0)
+        return -1;
+    vj->vj_weight += weight;
+    return 0;
+}
+
+/*! Add validation of an added or changed subtree to a validation job
+ *
+ * Same as xml_yang_validate_add
+ * @param[in]  vj  Validation job
+ * @param[in]  xt  XML subtree, not modified until job is run
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+validate_job_add(validate_job *vj,
+                 cxobj        *xt)
+{
+    size_t weight = 0;
+
+    if (vj->vj_workers > 1)
+        weight = xml_tree_size(xt);
+    if (validate_unit_push(&vj->vj_vec, &vj->vj_len, &vj->vj_max, VU_ADD, xt, weight) < 0)
+        return -1;
+    vj->vj_weight += weight;
+    return 0;
+}
+
+/*! Check if subtree of a unit can be split into node and children units
+ *
+ * Only containers and lists, and not with schema mount, where a node may stop the
+ * validation of its children.
+ */
+static int
+validate_unit_splittable(clixon_handle h,
+                         cxobj        *x)
+{
+    yang_stmt *y;
+
+    if (clicon_option_bool(h, "CLICON_YANG_SCHEMA_MOUNT"))
+        return 0;
+    if ((y = xml_spec(x)) == NULL)
+        return 0;
+    switch (yang_keyword_get(y)){
+    case Y_CONTAINER:
+    case Y_LIST:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/*! Split units larger than grain recursively into node, children and post units
+ *
+ * @param[in]     h      Clixon handle
+ * @param[in]     vu     Unit to split
+ * @param[in]     grain  Split units with larger weight than this
+ * @param[in,out] vecp   Vector of split units
+ * @param[in,out] lenp   Length of vector
+ * @param[in,out] maxp   Allocated length of vector
+ * @retval        0      OK
+ * @retval       -1      Error
+ */
+static int
+validate_unit_split(clixon_handle         h,
+                    struct validate_unit *vu,
+                    size_t                grain,
+                    struct validate_unit **vecp,
+                    int                  *lenp,
+                    int                  *maxp)
+{
+    struct validate_unit    vc;
+    enum validate_unit_type type;
+    cxobj                  *x;
+
+    if ((vu->vu_type != VU_ALL && vu->vu_type != VU_ADD) ||
+        vu->vu_weight <= grain ||
+        !validate_unit_splittable(h, vu->vu_x))
+        return validate_unit_push(vecp, lenp, maxp, vu->vu_type, vu->vu_x, vu->vu_weight);
+    type = vu->vu_type == VU_ALL ? VU_ALL_NODE : VU_ADD_NODE;
+    if (validate_unit_push(vecp, lenp, maxp, type, vu->vu_x, 1) < 0)
+        return -1;
+    x = NULL;
+    while ((x = xml_child_each(vu->vu_x, x, CX_ELMNT)) != NULL){
+        vc.vu_type = vu->vu_type;
+        vc.vu_x = x;
+        vc.vu_weight = xml_tree_size(x);
+        if (validate_unit_split(h, &vc, grain, vecp, lenp, maxp) < 0)
+            return -1;
+    }
+    if (vu->vu_type == VU_ALL)
+        if (validate_unit_push(vecp, lenp, maxp, VU_ALL_POST, vu->vu_x,
+                               xml_child_nr_type(vu->vu_x, CX_ELMNT)) < 0)
+            return -1;
+    return 0;
+}
+
+/*! Validate a single unit
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  vu    Validation unit
+ * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (xret set)
+ * @retval    -1     Error
+ */
+static int
+validate_unit(clixon_handle         h,
+              struct validate_unit *vu,
+              cxobj               **xret)
+{
+    int skip = 0;
+
+    switch (vu->vu_type){
+    case VU_ALL:
+        return xml_yang_validate_all(h, vu->vu_x, xret);
+    case VU_ALL_NODE:
+        return xml_yang_validate_all_node(h, vu->vu_x, xret, &skip);
+    case VU_ALL_POST:
+        if (yang_config(xml_spec(vu->vu_x)) == 0)
+            return 1;
+        return xml_yang_validate_minmax(vu->vu_x, 1, xret);
+    case VU_TOP_POST:
+        return xml_yang_validate_minmax(vu->vu_x, 0, xret);
+    case VU_ADD:
+        return xml_yang_validate_add(h, vu->vu_x, xret);
+    case VU_ADD_NODE:
+        return xml_yang_validate_add_node(h, vu->vu_x, xret, &skip);
+    }
+    return 1;
+}
+
+/*! Validate a range of units in order, stop at first failure
+ */
+static int
+validate_range(clixon_handle         h,
+               struct validate_unit *vec,
+               int                   lo,
+               int                   hi,
+               cxobj               **xret)
+{
+    int i;
+    int ret;
+
+    for (i=lo; i<hi; i++)
+        if ((ret = validate_unit(h, &vec[i], xret)) < 1)
+            return ret;
+    return 1;
+}
+
+/*! Write all of buffer to file descriptor
+ */
+static int
+validate_write(int   s,
+               void *buf,
+               size_t len)
+{
+    ssize_t n;
+
+    while (len > 0){
+        if ((n = write(s, buf, len)) < 0){
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        buf = (char*)buf + n;
+        len -= n;
+    }
+    return 0;
+}
+
+/*! Read len bytes from file descriptor
+ *
+ * @retval  1  OK
+ * @retval  0  Premature end-of-file
+ * @retval -1  Error
+ */
+static int
+validate_read(int    s,
+              void  *buf,
+              size_t len)
+{
+    ssize_t n;
+
+    while (len > 0){
+        if ((n = read(s, buf, len)) < 0){
+            if (errno == EINTR)
+                continue;
+            clixon_err(OE_UNIX, errno, "read");
+            return -1;
+        }
+        if (n == 0)
+            return 0;
+        buf = (char*)buf + n;
+        len -= n;
+    }
+    return 1;
+}
+
+/*! Validation worker process: validate a range and write result to parent, then exit
+ */
+static void
+validate_worker(clixon_handle         h,
+                struct validate_unit *vec,
+                int                   lo,
+                int                   hi,
+                int                   s,
+                int                   witherr)
+{
+    struct validate_msg vm = {0,};
+    cxobj              *xerr = NULL;
+    cbuf               *cb = NULL;
+    char               *payload = NULL;
+    int                 ret;
+
+    if ((ret = validate_range(h, vec, lo, hi, witherr?&xerr:NULL)) == 0 && xerr){
+        if ((cb = cbuf_new()) == NULL)
+            ret = -1;
+        else if (clixon_xml2cbuf(cb, xerr, 0, 0, NULL, -1, 0) < 0)
+            ret = -1;
+        else
+            payload = cbuf_get(cb);
+    }
+    if (ret < 0){
+        vm.vm_category = clixon_err_category();
+        vm.vm_suberr = clixon_err_subnr();
+        payload = clixon_err_reason();
+    }
+    vm.vm_ret = ret;
+    vm.vm_len = payload ? strlen(payload) : 0;
+    if (validate_write(s, &vm, sizeof(vm)) == 0 && vm.vm_len)
+        validate_write(s, payload, vm.vm_len);
+    close(s);
+    /* Do not run exit handlers or flush stdio buffers of parent */
+    _exit(0);
+}
+
+/*! Add error rpc-reply from a worker to xret
+ *
+ * @param[in]     str   Error rpc-reply as XML string
+ * @param[in,out] xret  Error XML tree, created if NULL
+ */
+static int
+validate_merge_error(char   *str,
+                     cxobj **xret)
+{
+    int    retval = -1;
+    cxobj *xt = NULL;
+    cxobj *xr;
+    cxobj *xe;
+
+    if (clixon_xml_parse_string(str, YB_NONE, NULL, &xt, NULL) < 0)
+        goto done;
+    if ((xr = xml_find_type(xt, NULL, "rpc-reply", CX_ELMNT)) == NULL){
+        clixon_err(OE_XML, 0, "No rpc-reply in validation worker error: %s", str);
+        goto done;
+    }
+    if (*xret == NULL){
+        if (xml_rm(xr) < 0)
+            goto done;
+        *xret = xr;
+    }
+    else {
+        while ((xe = xml_find_type(xr, NULL, "rpc-error", CX_ELMNT)) != NULL){
+            if (xml_rm(xe) < 0)
+                goto done;
+            if (xml_addsub(*xret, xe) < 0)
+                goto done;
+        }
+    }
+    retval = 0;
+ done:
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
+/*! Run a validation job, in parallel if configured and large enough
+ *
+ * The trees of the job are not modified.
+ * @param[in]  vj    Validation job
+ * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (xret set)
+ * @retval    -1     Error
+ * @see CLICON_VALIDATE_WORKERS
+ */
+int
+validate_job_run(validate_job *vj,
+                 cxobj       **xret)
+{
+    int                   retval = -1;
+    clixon_handle         h = vj->vj_h;
+    struct validate_unit *vec = NULL;
+    int                   len = 0;
+    int                   max = 0;
+    int                   workers;
+    int                   nw = 0;   /* Number of forked workers */
+    int                  *bounds = NULL; /* Range k is [bounds[k], bounds[k+1]) */
+    pid_t                *pids = NULL;
+    int                  *socks = NULL;
+    int                   fd[2];
+    struct validate_msg   vm;
+    char                 *payload = NULL;
+    size_t                grain;
+    size_t                acc;
+    int                   i;
+    int                   k;
+    int                   ret;
+
+    workers = vj->vj_workers;
+    if (workers <= 1 || vj->vj_weight < VALIDATE_PARALLEL_MIN)
+        return validate_range(h, vj->vj_vec, 0, vj->vj_len, xret);
+    /* Partition into units, then into contiguous ranges of about equal weight */
+    grain = vj->vj_weight / (workers * VALIDATE_GRAIN);
+    for (i=0; i<vj->vj_len; i++)
+        if (validate_unit_split(h, &vj->vj_vec[i], grain, &vec, &len, &max) < 0)
+            goto done;
+    if ((bounds = calloc(workers + 1, sizeof(int))) == NULL ||
+        (pids = calloc(workers, sizeof(pid_t))) == NULL ||
+        (socks = calloc(workers, sizeof(int))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    acc = 0;
+    k = 1;
+    for (i=0; i<len && k<workers; i++){
+        acc += vec[i].vu_weight;
+        if (acc >= k * (vj->vj_weight / workers))
+            bounds[k++] = i + 1;
+    }
+    while (k <= workers)
+        bounds[k++] = len;
+    clixon_debug(CLIXON_DBG_DEFAULT, "%d units, %zu nodes, %d workers", len, vj->vj_weight, workers);
+    /* Fork workers for ranges 1..workers-1 */
+    for (k=1; k<workers; k++){
+        if (bounds[k] == bounds[k+1])
+            continue;
+        if (pipe(fd) < 0){
+            clixon_err(OE_UNIX, errno, "pipe");
+            goto done;
+        }
+        if ((pids[nw] = fork()) < 0){
+            clixon_err(OE_UNIX, errno, "fork");
+            close(fd[0]);
+            close(fd[1]);
+            goto done;
+        }
+        if (pids[nw] == 0){ /* child */
+            close(fd[0]);
+            validate_worker(h, vec, bounds[k], bounds[k+1], fd[1], xret != NULL);
+        }
+        close(fd[1]);
+        socks[nw++] = fd[0];
+    }
+    /* Validate range 0 in this process, failure here precedes any worker failure */
+    if ((ret = validate_range(h, vec, bounds[0], bounds[1], xret)) < 1){
+        retval = ret;
+        goto done;
+    }
+    /* Collect worker results in range order, first failure is the result */
+    for (k=0; k<nw; k++){
+        if ((ret = validate_read(socks[k], &vm, sizeof(vm))) < 0)
+            goto done;
+        if (ret == 0){
+            clixon_err(OE_CFG, 0, "Validation worker %d exited prematurely", pids[k]);
+            goto done;
+        }
+        if (vm.vm_ret == 1)
+            continue;
+        if ((payload = malloc(vm.vm_len + 1)) == NULL){
+            clixon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        if ((ret = validate_read(socks[k], payload, vm.vm_len)) < 0)
+            goto done;
+        if (ret == 0){
+            clixon_err(OE_CFG, 0, "Validation worker %d exited prematurely", pids[k]);
+            goto done;
+        }
+        payload[vm.vm_len] = '\0';
+        if (vm.vm_ret < 0){
+            clixon_err(vm.vm_category, vm.vm_suberr, "%s", payload);
+            goto done;
+        }
+        if (xret && vm.vm_len && validate_merge_error(payload, xret) < 0)
+            goto done;
+        retval = 0;
+        goto done;
+    }
+    retval = 1;
+ done:
+    /* Reap workers, those not read are no longer needed */
+    for (k=0; k<nw; k++){
+        kill(pids[k], SIGKILL);
+        close(socks[k]);
+        waitpid(pids[k], NULL, 0);
+    }
+    if (payload)
+        free(payload);
+    if (socks)
+        free(socks);
+    if (pids)
+        free(pids);
+    if (bounds)
+        free(bounds);
+    if (vec)
+        free(vec);
+    return retval;
+}
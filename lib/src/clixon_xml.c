@@ -65,6 +65,7 @@
 #include "clixon_yang.h"
 #include "clixon_xml.h"
 #include "clixon_err.h"
+#include "clixon_cancel.h"
 #include "clixon_log.h"
 #include "clixon_debug.h"
 #include "clixon_options.h" /* xml_bind_yang */
@@ -101,6 +102,8 @@
 
 #ifdef XML_EXPLICIT_INDEX
 static int xml_search_index_free(cxobj *x);
+static cxobj *xml_search_index_target(cxobj *xp, cxobj *xc);
+static int xml_search_index_link(cxobj *xe);
 
 /* A search index pair consisting of a name of an (index) variable and a vector of xml children
  * the variable should be a potential child of the XML node
@@ -120,10 +123,14 @@ static int xml_search_index_free(cxobj *x);
  * value of "i"   | 5 | | 0 | | 2 |
  *                +---+ +---+ +---+
 
+ * A composite index is named by its leafs separated by space, eg "i j", and is sorted on i
+ * first, then j. Entries with equal values are adjacent (non-unique index).
+ * The vector is maintained when index leafs, their bodies or list entries are added, removed or
+ * changed, see xml_search_index_pre and xml_search_index_post
  */
 struct search_index{
     qelem_t      si_q;    /* Queue header */
-    char        *si_name; /* Name of index variable (must be (potential) child of xml node at hand */
+    char        *si_name; /* Name of index variable(s) (must be (potential) child of xml node at hand */
     clixon_xvec *si_xvec; /* Sorted vector of xml object pointers (should be of YANG type LIST) */
 };
 #endif
@@ -666,12 +673,22 @@ xml_value_set(cxobj *xn,
     int    retval = -1;
     size_t sz;
 
+#ifdef XML_EXPLICIT_INDEX
+    cxobj *xe;
+#endif
+
     if (!is_bodyattr(xn))
         return 0;
     if (val == NULL){
         clixon_err(OE_XML, EINVAL, "value is NULL");
         goto done;
     }
+    if (clixon_cancel_alloc(strlen(val)+1) < 0)
+        goto done;
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_search_index_pre(xml_parent(xn), xn, &xe) < 0)
+        goto done;
+#endif
     sz = strlen(val)+1;
     if (xn->x_value_cb == NULL){
         if ((xn->x_value_cb = cbuf_new_alloc(sz)) == NULL){
@@ -682,6 +699,13 @@ xml_value_set(cxobj *xn,
     else
         cbuf_reset(xn->x_value_cb);
     cbuf_append_str(xn->x_value_cb, val);
+#ifdef XML_EXPLICIT_INDEX
+    if (xe){ /* Cached value of index leaf is stale */
+        xml_cv_set(xml_parent(xn), NULL);
+        if (xml_search_index_post(xe) < 0)
+            goto done;
+    }
+#endif
     retval = 0;
  done:
     return retval;
@@ -701,12 +725,20 @@ xml_value_append(cxobj *xn,
     int    retval = -1;
     size_t sz;
 
+#ifdef XML_EXPLICIT_INDEX
+    cxobj *xe;
+#endif
+
     if (!is_bodyattr(xn))
         return 0;
     if (val == NULL){
         clixon_err(OE_XML, EINVAL, "value is NULL");
         goto done;
     }
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_search_index_pre(xml_parent(xn), xn, &xe) < 0)
+        goto done;
+#endif
     sz = strlen(val)+1;
     if (xn->x_value_cb == NULL){
         if ((xn->x_value_cb = cbuf_new_alloc(sz)) == NULL){
@@ -718,6 +750,13 @@ xml_value_append(cxobj *xn,
         clixon_err(OE_XML, errno, "cprintf");
         goto done;
     }
+#ifdef XML_EXPLICIT_INDEX
+    if (xe){ /* Cached value of index leaf is stale */
+        xml_cv_set(xml_parent(xn), NULL);
+        if (xml_search_index_post(xe) < 0)
+            goto done;
+    }
+#endif
     retval = 0;
  done:
     return retval;
@@ -1184,15 +1223,30 @@ xml_new(char           *name,
         clixon_err(OE_XML, errno, "malloc");
         return NULL;
     }
+    /* Memory budget of current operation, if any */
+    if (clixon_cancel_alloc(sz) < 0){
+        free(x);
+        return NULL;
+    }
     memset(x, 0, sz);
     xml_type_set(x, type);
     if (name && (xml_name_set(x, name)) < 0)
         return NULL;
     if (xp){
+#ifdef XML_EXPLICIT_INDEX
+        cxobj *xe;
+
+        if (xml_search_index_pre(xp, x, &xe) < 0)
+            return NULL;
+#endif
         xml_parent_set(x, xp);
         if (xml_child_append(xp, x) < 0)
             return NULL;
         x->_x_i = xml_child_nr(xp)-1;
+#ifdef XML_EXPLICIT_INDEX
+        if (xml_search_index_post(xe) < 0)
+            return NULL;
+#endif
     }
     _stats_xml_nr++;
     return x;
@@ -1251,9 +1305,25 @@ int
 xml_spec_set(cxobj     *x,
              yang_stmt *spec)
 {
+#ifdef XML_EXPLICIT_INDEX
+    cxobj *xe;
+#endif
+
     if (!is_element(x))
         return 0;
+#ifdef XML_EXPLICIT_INDEX
+    if (x->x_spec == spec)
+        return 0;
+    if (xml_search_index_pre(xml_parent(x), x, &xe) < 0)
+        return -1;
+    if (xe != NULL)
+        xml_cv_set(x, NULL);
+    x->x_spec = spec;
+    if ((xe = xml_search_index_target(xml_parent(x), x)) != NULL)
+        return xml_search_index_link(xe);
+#else
     x->x_spec = spec;
+#endif
     return 0;
 }
 
@@ -1329,6 +1399,37 @@ xml_find(cxobj *xp,
     return x;
 }
 
+/*! Find first XML element child matching a name given by pointer and length
+ *
+ * @param[in]  xp    Base XML object
+ * @param[in]  name  Node name, not necessarily null-terminated
+ * @param[in]  len   Length of name
+ * @retval     x     XML element if found
+ * @retval     NULL  Not found
+ * Unlike xml_find, does not use xml_child_each, and may be used while xp is iterated
+ * @see xml_find
+ */
+cxobj *
+xml_find_len(cxobj      *xp,
+             const char *name,
+             size_t      len)
+{
+    cxobj *x;
+    char  *n;
+    int    i;
+
+    if (xp == NULL || name == NULL || !is_element(xp))
+        return NULL;
+    for (i=0; i<xp->x_childvec_len; i++){
+        x = xp->x_childvec[i];
+        if (xml_type(x) == CX_ELMNT &&
+            (n = xml_name(x)) != NULL &&
+            strncmp(n, name, len) == 0 && n[len] == '\0')
+            return x;
+    }
+    return NULL;
+}
+
 /*! Append xc as child to xp. Remove xc from previous parent.
  *
  * @param[in] xp  Parent xml node. If NULL just remove from old parent.
@@ -1350,6 +1451,9 @@ xml_addsub(cxobj *xp,
     char  *pns = NULL; /* parent namespace */
     char  *cns = NULL; /* child namespace */
     cxobj *xa;
+#ifdef XML_EXPLICIT_INDEX
+    cxobj *xe;
+#endif
 
     if ((oldp = xml_parent(xc)) != NULL){
         /* Find child order i in old parent*/
@@ -1362,6 +1466,10 @@ xml_addsub(cxobj *xp,
     }
     /* Add xc to new parent */
     if (xp){
+#ifdef XML_EXPLICIT_INDEX
+        if (xml_search_index_pre(xp, xc, &xe) < 0)
+            goto done;
+#endif
         if (xml_child_append(xp, xc) < 0)
             goto done;
         /* Set new parent in child */
@@ -1383,8 +1491,8 @@ xml_addsub(cxobj *xp,
         /* clear namespace context cache of child */
         nscache_clear(xc);
 #ifdef XML_EXPLICIT_INDEX
-    if (xml_search_index_p(xc))
-            xml_search_child_insert(xp, xc);
+        if (xml_search_index_post(xe) < 0)
+            goto done;
 #endif
     }
     retval = 0;
@@ -1498,6 +1606,9 @@ xml_child_rm(cxobj *xp,
 {
     int    retval = -1;
     cxobj *xc = NULL;
+#ifdef XML_EXPLICIT_INDEX
+    cxobj *xe;
+#endif
 
     if (!is_element(xp))
         return 0;
@@ -1505,17 +1616,20 @@ xml_child_rm(cxobj *xp,
         clixon_err(OE_XML, 0, "Child not found");
         goto done;
     }
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_search_index_pre(xp, xc, &xe) < 0)
+        goto done;
+#endif
     xml_parent_set(xc, NULL);
     xp->x_childvec[i] = NULL;
     xp->x_childvec_len--;
     if (i<xp->x_childvec_len)
         memmove(&xp->x_childvec[i], &xp->x_childvec[i+1], (xp->x_childvec_len-i)*sizeof(cxobj*));
 #ifdef XML_EXPLICIT_INDEX
-    if (xml_type(xc) == CX_ELMNT){
-        if (xml_search_index_p(xc))
-            xml_search_child_rm(xp, xc);
-
-    }
+    if (xe == xc) /* Removed list entry is not reinserted */
+        xe = NULL;
+    if (xml_search_index_post(xe) < 0)
+        goto done;
 #endif
     retval = 0;
  done:
@@ -2054,6 +2168,8 @@ xml_copy(cxobj *x0,
     cxobj *x;
     cxobj *xcopy;
 
+    if (clixon_cancel_check(0) < 0)
+        goto done;
     if (xml_copy_one(x0, x1) <0)
         goto done;
     x = NULL;
@@ -2117,6 +2233,8 @@ cxvec_append(cxobj   *x,
 {
     int retval = -1;
 
+    if (clixon_cancel_alloc(sizeof(cxobj *)) < 0)
+        goto done;
     if ((*vec = realloc(*vec, sizeof(cxobj *) * (*len+1))) == NULL){
         clixon_err(OE_XML, errno, "realloc");
         goto done;
@@ -2501,7 +2619,7 @@ xml_search_index_p(cxobj *x)
     /* The index variable has a yang spec */
     if ((y = xml_spec(x)) == NULL)
         return 0;
-    /* The index variable is a registered search index */
+    /* The index variable is a registered search index, single or part of composite */
     if (yang_flag_get(y, YANG_FLAG_INDEX) == 0)
         return 0;
     /* The index variable has a parent which has a LIST yang spec  */
@@ -2629,86 +2747,215 @@ xml_search_vector_get(cxobj        *xp,
     return 0;
 }
 
-/*! Insert a new cxobj into search index vector for list for variable "name"
+/*! Check if list entry has values for explicit search index and may be part of its vector
+ *
+ * The entry has at least one of the leafs of the index, and all present leafs are bound to yang.
+ * @param[in] xe    XML list entry
+ * @param[in] name  Index name, leaf names separated by single space
+ * @retval    1     Yes, entry is part of index vector
+ * @retval    0     No
+ */
+static int
+xml_search_index_entry_p(cxobj *xe,
+                         char  *name)
+{
+    char   *p;
+    size_t  len;
+    cxobj  *x;
+    int     n = 0;
+
+    for (p = name; *p != '\0'; p += len){
+        if (*p == ' ')
+            p++;
+        for (len=0; p[len] != '\0' && p[len] != ' '; len++);
+        if ((x = xml_find_len(xe, p, len)) != NULL){
+            if (xml_spec(x) == NULL)
+                return 0;
+            n++;
+        }
+    }
+    return n>0;
+}
+
+/*! Remove list entry from all search index vectors of its parent
  *
- * @param[in] xp  XML parent object (the list element)
- * @param[in] xi  XML index object (that should be added)
+ * The position is found using binary search on the current values of the entry, which is the
+ * same position as where it was inserted, since every change is preceded by this call.
+ * @param[in] xe  XML list entry
  * @retval    0   OK
  * @retval   -1   Error
+ * @see xml_search_index_link
  */
-int
-xml_search_child_insert(cxobj *xp,
-                        cxobj *xi)
+static int
+xml_search_index_unlink(cxobj *xe)
 {
     int                  retval = -1;
-    char                *indexvar;
-    struct search_index *si;
     cxobj               *xpp;
-    int                  i;
+    struct search_index *si;
+    char                *name;
+    int                  i = 0;
+    int                  pos;
+    int                  j;
     int                  len;
+    int                  eq;
 
-    indexvar = xml_name(xi);
-    if ((xpp = xml_parent(xp)) == NULL)
+    if ((xpp = xml_parent(xe)) == NULL)
         goto ok;
-    /* Find base vector in grandparent */
-    if ((si = xml_search_index_get(xpp, indexvar)) == NULL){
-        /* If not found add base vector in grand-parent */
-        if ((si = xml_search_index_add(xpp, indexvar)) == NULL)
+    while ((name = yang_list_index_each(xml_spec(xe), &i)) != NULL){
+        if (!xml_search_index_entry_p(xe, name))
+            continue;
+        if ((si = xml_search_index_get(xpp, name)) == NULL)
+            continue;
+        len = clixon_xvec_len(si->si_xvec);
+        eq = 0;
+        if ((pos = xml_search_indexvar_binary_pos(xe, name, si->si_xvec, 0, len, len, &eq)) < 0)
             goto done;
+        if (!eq)
+            continue;
+        /* Non-unique index: find entry among equal values */
+        for (j=pos; j>=0 && xml_cmp(xe, clixon_xvec_i(si->si_xvec, j), 0, 0, name) == 0; j--)
+            if (clixon_xvec_i(si->si_xvec, j) == xe)
+                break;
+        if (j < 0 || clixon_xvec_i(si->si_xvec, j) != xe)
+            for (j=pos+1; j<len && xml_cmp(xe, clixon_xvec_i(si->si_xvec, j), 0, 0, name) == 0; j++)
+                if (clixon_xvec_i(si->si_xvec, j) == xe)
+                    break;
+        if (j >= 0 && j < len && clixon_xvec_i(si->si_xvec, j) == xe)
+            if (clixon_xvec_rm_pos(si->si_xvec, j) < 0)
+                goto done;
     }
-    /* Find element position using binary search and then remove */
-    len = clixon_xvec_len(si->si_xvec);
-    if ((i = xml_search_indexvar_binary_pos(xp, indexvar, si->si_xvec, 0, len, len, NULL)) < 0)
-        goto done;
-    assert(clixon_xvec_i(si->si_xvec, i) != xp);
-    if (clixon_xvec_insert_pos(si->si_xvec, xp, i) < 0)
-        goto done;
  ok:
     retval = 0;
  done:
     return retval;
 }
 
-/*! Remove a single cxobj from search vector 
+/*! Insert list entry in all search index vectors of its parent
  *
- * @param[in] xp    XML parent object (the list element)
- * @param[in] xi    XML index object (that should be added)
- * @retval    0     OK
- * @retval   -1     Error
+ * @param[in] xe  XML list entry
+ * @retval    0   OK
+ * @retval   -1   Error
+ * @see xml_search_index_unlink
  */
-int
-xml_search_child_rm(cxobj *xp,
-                    cxobj *xi)
-{
-    int                 retval = -1;
-    cxobj              *xpp;
-    char               *indexvar;
-    int                 i;
-    int                 len;
+static int
+xml_search_index_link(cxobj *xe)
+{
+    int                  retval = -1;
+    cxobj               *xpp;
     struct search_index *si;
-    int                  eq = 0;
+    char                *name;
+    int                  i = 0;
+    int                  pos;
+    int                  len;
 
-    indexvar = xml_name(xi);
-    if ((xpp = xml_parent(xp)) == NULL)
-        goto ok;
-    /* Find base vector in grandparent */
-    if ((si = xml_search_index_get(xpp, indexvar)) == NULL)
+    if ((xpp = xml_parent(xe)) == NULL)
         goto ok;
-
-    /* Find element using binary search and then remove */
-    len = clixon_xvec_len(si->si_xvec);
-    if ((i = xml_search_indexvar_binary_pos(xp, indexvar, si->si_xvec, 0, len, len, &eq)) < 0)
-        goto done;
-        //    if (clixon_xvec_i(si->si_xvec, i) == xp)
-    if (eq)
-        if (clixon_xvec_rm_pos(si->si_xvec, i) < 0)
+    while ((name = yang_list_index_each(xml_spec(xe), &i)) != NULL){
+        if (!xml_search_index_entry_p(xe, name))
+            continue;
+        /* Find base vector in grandparent, if not found add it */
+        if ((si = xml_search_index_get(xpp, name)) == NULL &&
+            (si = xml_search_index_add(xpp, name)) == NULL)
+            goto done;
+        len = clixon_xvec_len(si->si_xvec);
+        if ((pos = xml_search_indexvar_binary_pos(xe, name, si->si_xvec, 0, len, len, NULL)) < 0)
             goto done;
+        if (clixon_xvec_insert_pos(si->si_xvec, xe, pos) < 0)
+            goto done;
+    }
  ok:
     retval = 0;
  done:
     return retval;
 }
 
+/*! Get list entry whose search index positions depend on a child being added or removed
+ *
+ * The cases are:
+ * 1. xc is a list entry with explicit indexes: the entry itself
+ * 2. xc is an index leaf of list entry xp: xp
+ * 3. xc is the body of an index leaf xp: the parent of xp
+ * @param[in] xp  XML parent, or NULL
+ * @param[in] xc  XML child
+ * @retval    xe  XML list entry
+ * @retval    NULL  Not index related
+ */
+static cxobj *
+xml_search_index_target(cxobj *xp,
+                        cxobj *xc)
+{
+    yang_stmt *y;
+    yang_stmt *yp;
+
+    if (xml_type(xc) == CX_BODY){
+        if ((xc = xp) == NULL)
+            return NULL;
+        xp = xml_parent(xc);
+    }
+    else if (xml_type(xc) != CX_ELMNT)
+        return NULL;
+    if ((y = xml_spec(xc)) != NULL && yang_keyword_get(y) == Y_LIST)
+        return yang_flag_get(y, YANG_FLAG_INDEX) ? xc : NULL;
+    if (xp == NULL ||
+        (yp = xml_spec(xp)) == NULL ||
+        yang_keyword_get(yp) != Y_LIST ||
+        yang_flag_get(yp, YANG_FLAG_INDEX) == 0)
+        return NULL;
+    /* An unbound leaf also affects the index, see xml_search_index_entry_p */
+    if (y == NULL)
+        y = yang_find(yp, Y_LEAF, xml_name(xc));
+    if (y == NULL ||
+        yang_keyword_get(y) != Y_LEAF ||
+        yang_flag_get(y, YANG_FLAG_INDEX) == 0)
+        return NULL;
+    return xp;
+}
+
+/*! Prepare explicit search indexes for a child being added, removed or changed
+ *
+ * Must be called before the change, and followed by xml_search_index_post after.
+ * @param[in]  xp  XML parent, or NULL
+ * @param[in]  xc  XML child
+ * @param[out] xep List entry to give to xml_search_index_post, NULL if not index related
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @code
+ *   if (xml_search_index_pre(xp, xc, &xe) < 0)
+ *      err;
+ *   <add, remove or change xc>
+ *   if (xml_search_index_post(xe) < 0)
+ *      err;
+ * @endcode
+ */
+int
+xml_search_index_pre(cxobj  *xp,
+                     cxobj  *xc,
+                     cxobj **xep)
+{
+    cxobj *xe;
+
+    *xep = NULL;
+    if ((xe = xml_search_index_target(xp, xc)) != NULL)
+        if (xml_search_index_unlink(xe) < 0)
+            return -1;
+    *xep = xe;
+    return 0;
+}
+
+/*! Update explicit search indexes after a child has been added, removed or changed
+ *
+ * @param[in] xe  List entry returned by xml_search_index_pre, or NULL
+ * @retval    0   OK
+ * @retval   -1   Error
+ */
+int
+xml_search_index_post(cxobj *xe)
+{
+    if (xe == NULL)
+        return 0;
+    return xml_search_index_link(xe);
+}
+
 /*! Iterator over xml children objects using (explicit) index variable
  *
  * @param[in] xparent xml tree node whose children should be iterated
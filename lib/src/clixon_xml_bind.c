@@ -239,11 +239,7 @@ populate_self_parent(clixon_handle h,
         goto fail;
     }
  set:
-    xml_spec_set(xt, y);
-#ifdef XML_EXPLICIT_INDEX
-    if (xml_search_index_p(xt))
-        xml_search_child_insert(xp, xt);
-#endif
+    xml_spec_set(xt, y); /* Also updates explicit search indexes */
     retval = 1;
  done:
     if (cb)
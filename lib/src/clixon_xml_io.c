@@ -64,6 +64,7 @@
 #include "clixon_yang.h"
 #include "clixon_xml.h"
 #include "clixon_err.h"
+#include "clixon_cancel.h"
 #include "clixon_log.h"
 #include "clixon_debug.h"
 #include "clixon_options.h"
@@ -531,6 +532,10 @@ xml2cbuf_recurse(cbuf             *cb,
 
     if (depth == 0)
         goto ok;
+    if (clixon_cancel_check(0) < 0)
+        goto done;
+    if (clixon_cancel_mem(cbuf_len(cb)) < 0)
+        goto done;
     if ((y = xml_spec(x)) != NULL){
         /* with-defaults: if object should be printed or not */
         if ((ret = xml2output_wdef(x, wdef, &tag)) < 0)
@@ -80,6 +80,7 @@
 #include "clixon_text_syntax.h"
 #include "clixon_xml_io.h"
 #include "clixon_xml_map.h"
+#include "clixon_diff.h"
 
 /* Local types 
  */
@@ -2201,14 +2202,16 @@ purge_tagged_nodes(cxobj *xn,
     return retval;
 }
 
-/*! Compare two dbs using XML. Write to file and run diff. Independent of YANG
+/*! Compare two dbs using XML. Render and print line diff. Independent of YANG
  *
+ * Output is unified diff with one line of context and no headers
  * @param[in]  xc1     XML tree 1
  * @param[in]  xc2     XML tree 2
  * @param[in]  format  "text"|"xml"|"json"|"cli"|"netconf" (see format_enum)
  * @retval     0       OK
  * @retval    -1       Error
  * @see clixon_xml_diff2cbuf with better XML in-mem comparison but is YANG dependent
+ * @see clixon_diff_xml
  */
 int
 clixon_compare_xmls(cxobj            *xc1,
@@ -2216,70 +2219,20 @@ clixon_compare_xmls(cxobj            *xc1,
                     enum format_enum  format)
 {
     int    retval = -1;
-    int    fd;
-    FILE  *f;
-    char   filename1[MAXPATHLEN];
-    char   filename2[MAXPATHLEN];
     cbuf  *cb = NULL;
 
-    snprintf(filename1, sizeof(filename1), "/tmp/cliconXXXXXX");
-    snprintf(filename2, sizeof(filename2), "/tmp/cliconXXXXXX");
-    if ((fd = mkstemp(filename1)) < 0){
-        clixon_err(OE_UNDEF, errno, "tmpfile");
-        goto done;
-    }
-    if ((f = fdopen(fd, "w")) == NULL)
-        goto done;
-    switch(format){
-    case FORMAT_TEXT:
-        if (clixon_text2file(f, xc1, 0, cligen_output, 1, 1) < 0)
-            goto done;
-        break;
-    case FORMAT_XML:
-    default:
-        if (clixon_xml2file(f, xc1, 0, 1, NULL, cligen_output, 1, 1) < 0)
-            goto done;
-        break;
-    }
-    fclose(f);
-    close(fd);
-
-    if ((fd = mkstemp(filename2)) < 0){
-        clixon_err(OE_UNDEF, errno, "mkstemp: %s", strerror(errno));
-        goto done;
-    }
-    if ((f = fdopen(fd, "w")) == NULL)
-        goto done;
-
-    switch(format){
-    case FORMAT_TEXT:
-        if (clixon_text2file(f, xc2, 0, cligen_output, 1, 1) < 0)
-            goto done;
-        break;
-    case FORMAT_XML:
-    default:
-        if (clixon_xml2file(f, xc2, 0, 1, NULL, cligen_output, 1, 1) < 0)
-            goto done;
-        break;
-    }
-    fclose(f);
-    close(fd);
-
     if ((cb = cbuf_new()) == NULL){
         clixon_err(OE_CFG, errno, "cbuf_new");
         goto done;
     }
-    cprintf(cb, "diff -dU 1 %s %s |  grep -v @@ | sed 1,2d",
-            filename1, filename2);
-    if (system(cbuf_get(cb)) < 0)
+    if (clixon_diff_xml(cb, xc1, xc2, format, 1, 0) < 0)
         goto done;
-
+    if (cbuf_len(cb))
+        cligen_output(stdout, "%s", cbuf_get(cb));
     retval = 0;
   done:
     if (cb)
         cbuf_free(cb);
-    unlink(filename1);
-    unlink(filename2);
     return retval;
 }
 
@@ -2295,6 +2248,7 @@ clixon_compare_xmls(cxobj            *xc1,
  * @code
  *     xml_apply(xtmpl, CX_ELMNT, xml_template_apply, cvv);
  * @endcode
+ * @see xml_template_compile  For templates instantiated many times
  */
 int
 xml_template_apply(cxobj *x,
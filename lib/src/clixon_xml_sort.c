@@ -223,6 +223,10 @@ xml_cmp(cxobj  *x1,
     cxobj      *x2b;
     enum cxobj_type xt1;
     enum cxobj_type xt2;
+#ifdef XML_EXPLICIT_INDEX
+    char       *p;
+    size_t      len;
+#endif
 
     if (x1==NULL || x2==NULL)
         goto done; /* shouldnt happen */
@@ -309,30 +313,36 @@ xml_cmp(cxobj  *x1,
     case Y_LIST: /* Match with key values  */
         if (indexvar != NULL){
 #ifdef XML_EXPLICIT_INDEX
-            x1b = xml_find(x1, indexvar);
-            x2b = xml_find(x2, indexvar);
-            if (x1b == NULL && x2b == NULL)
-                ;
-            else if (x1b == NULL)
-                equal = -1;
-            else if (x2b == NULL)
-                equal = 1;
-            else{
-                b1 = xml_body(x1b);
-                b2 = xml_body(x2b);
-                if (b1 == NULL && b2 == NULL)
+            /* Index is one or several (composite) leafs separated by space */
+            for (p = indexvar; *p != '\0' && equal == 0; p += len){
+                if (*p == ' ')
+                    p++;
+                for (len=0; p[len] != '\0' && p[len] != ' '; len++);
+                x1b = xml_find_len(x1, p, len);
+                x2b = xml_find_len(x2, p, len);
+                if (x1b == NULL && x2b == NULL)
                     ;
-                else if (b1 == NULL)
+                else if (x1b == NULL)
                     equal = -1;
-                else if (b2 == NULL)
+                else if (x2b == NULL)
                     equal = 1;
                 else{
-                    if (xml_cv_cache(x1b, &cv1) < 0) /* error case */
-                        goto done;
-                    if (xml_cv_cache(x2b, &cv2) < 0) /* error case */
-                        goto done;
-                    assert(cv1 && cv2);
-                    equal = cv_cmp(cv1, cv2);
+                    b1 = xml_body(x1b);
+                    b2 = xml_body(x2b);
+                    if (b1 == NULL && b2 == NULL)
+                        ;
+                    else if (b1 == NULL)
+                        equal = -1;
+                    else if (b2 == NULL)
+                        equal = 1;
+                    else{
+                        if (xml_cv_cache(x1b, &cv1) < 0) /* error case */
+                            goto done;
+                        if (xml_cv_cache(x2b, &cv2) < 0) /* error case */
+                            goto done;
+                        assert(cv1 && cv2);
+                        equal = cv_cmp(cv1, cv2);
+                    }
                 }
             }
             if (equal)
@@ -577,13 +587,16 @@ search_multi_equals(cxobj  **childvec,
 }
 
 #ifdef XML_EXPLICIT_INDEX
-/* XXX unify with search_multi_equals */
+/* XXX unify with search_multi_equals
+ * @param[in]  indexvar  Compare using explicit index, entries with same index values are adjacent
+ */
 static int
 search_multi_equals_xvec(clixon_xvec  *childvec,
                          cxobj        *x1,
                          int           yangi,
                          int           mid,
                          int           skip1,
+                         char         *indexvar,
                          clixon_xvec  *xvec)
 {
     int        retval = -1;
@@ -599,7 +612,7 @@ search_multi_equals_xvec(clixon_xvec  *childvec,
             goto done;
         if (yangi != yi) /* wrong yang */
             break;
-        if (xml_cmp(x1, xc, 0, skip1, NULL) != 0)
+        if (xml_cmp(x1, xc, 0, skip1, indexvar) != 0)
             break;
         if (clixon_xvec_prepend(xvec, xc) < 0)
             goto done;
@@ -611,7 +624,7 @@ search_multi_equals_xvec(clixon_xvec  *childvec,
             goto done;
         if (yangi != yi) /* wrong yang */
             break;
-        if (xml_cmp(x1, xc, 0, skip1, NULL) != 0)
+        if (xml_cmp(x1, xc, 0, skip1, indexvar) != 0)
             break;
         if (clixon_xvec_append(xvec, xc) < 0)
             goto done;
@@ -722,7 +735,7 @@ xml_search_indexvar(cxobj   *xp,
                 goto done;
             /* there may be more? */
             if (search_multi_equals_xvec(ivec, x1, yangi, pos,
-                                         0, xvec) < 0)
+                                         0, indexvar, xvec) < 0)
                 goto done;
         }
     }
@@ -730,6 +743,25 @@ xml_search_indexvar(cxobj   *xp,
  done:
     return retval;
 }
+
+/*! Check if XML list entry has all keys of its list
+ *
+ * @param[in]  x1  XML list entry
+ * @param[in]  y   Yang list
+ * @retval     1   Yes
+ * @retval     0   No
+ */
+static int
+xml_keys_all(cxobj     *x1,
+             yang_stmt *y)
+{
+    cg_var *cvi = NULL;
+
+    while ((cvi = cvec_each(yang_cvec_get(y), cvi)) != NULL)
+        if (xml_find(x1, cv_string_get(cvi)) == NULL)
+            return 0;
+    return 1;
+}
 #endif /* XML_EXPLICIT_INDEX */
 
 /*! Find XML child under xp matching x1 using binary search
@@ -763,6 +795,9 @@ xml_search_binary(cxobj   *xp,
     cxobj     *xc;
     yang_stmt *y;
     int        yi;
+#ifdef XML_EXPLICIT_INDEX
+    char      *keyindex;
+#endif
 
     if (upper < low)
         goto ok;
@@ -787,6 +822,15 @@ xml_search_binary(cxobj   *xp,
         /* >0 means search upper interval, <0 lower interval, = 0 is equal */
         cmp = xml_cmp(x1, xc, 0, skip1, NULL);
         if (cmp && !sorted){ /* Ordered by user (if not equal) */
+#ifdef XML_EXPLICIT_INDEX
+            /* Use implicit key index instead of linear search, see yang_list_index_key_add */
+            if (yang_keyword_get(y) == Y_LIST &&
+                (keyindex = yang_list_index_key(y)) != NULL &&
+                xml_keys_all(x1, y)){
+                retval = xml_search_indexvar(xp, x1, yangi, low, upper, keyindex, xvec);
+                goto done;
+            }
+#endif
             retval = xml_find_keys_notsorted(xp, x1, yangi, mid, skip1, xvec);
             goto done;
         }
@@ -1079,6 +1123,9 @@ xml_insert(cxobj           *xp,
     int        userorder= 0;
     int        yi; /* Global yang-stmt order */
     int        i;
+#ifdef XML_EXPLICIT_INDEX
+    cxobj     *xe;
+#endif
 
     /* Ensure the intermediate state that xp is parent of x but has not yet been
      * added as a child
@@ -1111,11 +1158,19 @@ xml_insert(cxobj           *xp,
                          userorder, ins, key_val, nsc_key,
                          low, upper)) < 0)
         goto done;
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_search_index_pre(xp, xi, &xe) < 0)
+        goto done;
+#endif
     if (xml_child_insert_pos(xp, xi, i) < 0)
         goto done;
     xml_parent_set(xi, xp);
     /* clear namespace context cache of child */
     nscache_clear(xi);
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_search_index_post(xe) < 0)
+        goto done;
+#endif
 
     retval = 0;
  done:
@@ -1424,20 +1479,21 @@ xml_find_index_yang(cxobj       *xp,
     }
 #ifdef XML_EXPLICIT_INDEX
     if (revert){
-        char      *iname;
-        yang_stmt *yi;
-        if (cvec_len(cvk) != 1 ||
-            (cvi = cvec_i(cvk, 0)) == NULL ||
-            (iname = cv_name_get(cvi)) == NULL ||
-            (yi = yang_find_datanode(yc, iname)) == NULL ||
-            yang_flag_get(yi, YANG_FLAG_INDEX) == 0)
+        /* Not list keys, try explicit single or composite search index on the same leafs */
+        if (yang_keyword_get(yc) != Y_LIST ||
+            (indexvar = yang_list_index_match(yc, cvk)) == NULL)
             goto revert;
         cbuf_reset(cb);
-        if (xml_chardata_encode(&encstr, "%s", cv_string_get(cvi)) < 0)
-            goto done;
-        cprintf(cb, "<%s><%s>%s</%s></%s>", name, iname, encstr, iname, name);
-        free(encstr);
-        indexvar = iname;
+        cprintf(cb, "<%s>", name);
+        cvi = NULL;
+        while ((cvi = cvec_each(cvk, cvi)) != NULL) {
+            kname = cv_name_get(cvi);
+            if (xml_chardata_encode(&encstr, "%s", cv_string_get(cvi)) < 0)
+                goto done;
+            cprintf(cb, "<%s>%s</%s>", kname, encstr, kname);
+            free(encstr);
+        }
+        cprintf(cb, "</%s>", name);
     }
 #else
     if (revert)
@@ -0,0 +1,814 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2024 Olof Hagsand
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+
+ *
+ * Compiled XML templates
+ * A YANG-bound template tree is compiled once into a list of instructions with variable
+ * slots. Each instantiation then emits bound and sorted XML directly into an edit tree,
+ * without string rebuilding, re-parsing or re-binding of the template.
+ * Template syntax:
+ *   ${var}                     In leaf and leaf-list bodies: substituted by value of var
+ *   cl:if="var"                Element is emitted only if var is set, not empty and not "false"
+ *   cl:foreach="var"           Element is emitted once per value of var, where ${var} is
+ *                              the current value
+ * where cl is a prefix of the clixon-lib namespace.
+ * Variables are given as a cligen variable vector where a variable may occur several times,
+ * a list input. Outside a foreach, the first value is used.
+ * @see xml_template_apply  Non-compiled in-place variant of ${var} substitution
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <syslog.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_string.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_debug.h"
+#include "clixon_options.h"
+#include "clixon_xml_nsctx.h"
+#include "clixon_xml_sort.h"
+#include "clixon_xml_map.h"
+#include "clixon_xml_template.h"
+
+/*! Template instruction operation
+ */
+enum tmpl_op {
+    TI_ELEMENT,  /* Emit element, children follow until matching TI_END */
+    TI_END,      /* End of element */
+    TI_BODY,     /* Emit body of enclosing element */
+    TI_IF,       /* Emit following construct if variable is true */
+    TI_FOREACH,  /* Emit following construct once per value of variable */
+};
+
+/*! Template instruction
+ */
+struct tmpl_instr {
+    enum tmpl_op ti_op;
+    int          ti_jump;   /* ELEMENT, IF, FOREACH: index of instruction after element end */
+    int          ti_slot;   /* IF, FOREACH: variable slot */
+    char        *ti_name;   /* ELEMENT: name */
+    char        *ti_prefix; /* ELEMENT: prefix or NULL */
+    yang_stmt   *ti_spec;   /* ELEMENT: yang spec */
+    cvec        *ti_nsc;    /* ELEMENT: namespace declarations or NULL */
+    int          ti_merge;  /* ELEMENT: merge with existing element (container) */
+    int          ti_sort;   /* ELEMENT: sort children after instantiation */
+    char       **ti_strs;   /* BODY: constant strings, ti_nslots+1 */
+    int         *ti_slots;  /* BODY: variable slots in between constant strings */
+    int          ti_nslots; /* BODY: number of variable references */
+};
+typedef struct tmpl_instr tmpl_instr;
+
+/*! Compiled template
+ *
+ * Variable values are only valid during instantiation, a template is not reentrant
+ */
+struct clixon_template {
+    tmpl_instr *tm_vec;     /* Instruction vector */
+    int         tm_len;     /* Length of instruction vector */
+    int         tm_max;     /* Allocated length of instruction vector */
+    char      **tm_vars;    /* Variable names, index is slot */
+    int         tm_nvars;   /* Number of variables */
+    char     ***tm_vals;    /* Per slot: values of variable */
+    int        *tm_nvals;   /* Per slot: number of values */
+    int        *tm_maxvals; /* Per slot: allocated number of values */
+    char      **tm_cur;     /* Per slot: current value, or NULL */
+    cbuf       *tm_cb;      /* Assist buffer for body substitution */
+};
+
+/*! Add a new instruction to a template
+ *
+ * @param[in]  tm   Template
+ * @param[in]  op   Operation
+ * @retval     i    Index of new instruction
+ * @retval    -1    Error
+ */
+static int
+tmpl_instr_add(clixon_template *tm,
+               enum tmpl_op     op)
+{
+    tmpl_instr *ti;
+
+    if (tm->tm_len == tm->tm_max){
+        tm->tm_max = tm->tm_max ? 2*tm->tm_max : 16;
+        if ((tm->tm_vec = realloc(tm->tm_vec, tm->tm_max*sizeof(tmpl_instr))) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+    }
+    ti = &tm->tm_vec[tm->tm_len];
+    memset(ti, 0, sizeof(*ti));
+    ti->ti_op = op;
+    ti->ti_slot = -1;
+    return tm->tm_len++;
+}
+
+/*! Get slot of variable, add if not found
+ *
+ * @param[in]  tm    Template
+ * @param[in]  name  Variable name
+ * @retval     slot  Variable slot
+ * @retval    -1     Error
+ */
+static int
+tmpl_slot(clixon_template *tm,
+          char            *name)
+{
+    int i;
+
+    for (i=0; i<tm->tm_nvars; i++)
+        if (strcmp(tm->tm_vars[i], name) == 0)
+            return i;
+    if ((tm->tm_vars = realloc(tm->tm_vars, (i+1)*sizeof(char*))) == NULL ||
+        (tm->tm_vals = realloc(tm->tm_vals, (i+1)*sizeof(char**))) == NULL ||
+        (tm->tm_nvals = realloc(tm->tm_nvals, (i+1)*sizeof(int))) == NULL ||
+        (tm->tm_maxvals = realloc(tm->tm_maxvals, (i+1)*sizeof(int))) == NULL ||
+        (tm->tm_cur = realloc(tm->tm_cur, (i+1)*sizeof(char*))) == NULL){
+        clixon_err(OE_UNIX, errno, "realloc");
+        return -1;
+    }
+    if ((tm->tm_vars[i] = strdup(name)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        return -1;
+    }
+    tm->tm_vals[i] = NULL;
+    tm->tm_nvals[i] = 0;
+    tm->tm_maxvals[i] = 0;
+    tm->tm_cur[i] = NULL;
+    tm->tm_nvars++;
+    return i;
+}
+
+/*! Compile body of leaf or leaf-list into a body instruction
+ *
+ * @param[in]  tm    Template
+ * @param[in]  str   Body string, may contain ${var}
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see clixon_str_subst  for the non-compiled variant
+ */
+static int
+tmpl_compile_body(clixon_template *tm,
+                  char            *str)
+{
+    int         retval = -1;
+    char      **vec = NULL;
+    int         nvec = 0;
+    int         i;
+    int         j;
+    int         slot;
+    char       *s;
+    char       *s2;
+    tmpl_instr *ti;
+
+    if ((i = tmpl_instr_add(tm, TI_BODY)) < 0)
+        goto done;
+    ti = &tm->tm_vec[i];
+    /* clixon_strsep2 requires terminated variables */
+    for (s = str; (s = strstr(s, "${")) != NULL; s = s2 + 1)
+        if ((s2 = strchr(s, '}')) == NULL){
+            clixon_err(OE_XML, 0, "Unterminated template variable in: %s", str);
+            goto done;
+        }
+    if (clixon_strsep2(str, "${", "}", &vec, &nvec) < 0)
+        goto done;
+    ti->ti_nslots = nvec/2;
+    if ((ti->ti_strs = calloc(ti->ti_nslots+1, sizeof(char*))) == NULL ||
+        (ti->ti_slots = calloc(ti->ti_nslots+1, sizeof(int))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    /* vec is on the form: str, var, str, ..., var, str */
+    for (i=0, j=0; i<nvec; i++){
+        if (i%2 == 0){
+            if ((ti->ti_strs[j] = strdup(vec[i])) == NULL){
+                clixon_err(OE_UNIX, errno, "strdup");
+                goto done;
+            }
+        }
+        else {
+            /* Slot may realloc variable vectors but not instructions */
+            if ((slot = tmpl_slot(tm, vec[i])) < 0)
+                goto done;
+            ti->ti_slots[j++] = slot;
+        }
+    }
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Get namespace declarations of an element to emit
+ *
+ * For a top-level element all inherited declarations are used, otherwise only the local.
+ * Declarations of the clixon-lib namespace are skipped.
+ * @param[in]  x     Template element
+ * @param[in]  top   Top-level element of template
+ * @param[out] nscp  Namespace context, or NULL if no declarations. Free with xml_nsctx_free
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+tmpl_compile_nsc(cxobj *x,
+                 int    top,
+                 cvec **nscp)
+{
+    int     retval = -1;
+    cvec   *nsc0 = NULL;
+    cvec   *nsc = NULL;
+    cg_var *cv = NULL;
+    cxobj  *xa = NULL;
+    char   *ns;
+
+    if (top){
+        if (xml_nsctx_node(x, &nsc0) < 0)
+            goto done;
+        while ((cv = cvec_each(nsc0, cv)) != NULL){
+            if ((ns = cv_string_get(cv)) == NULL || strcmp(ns, CLIXON_LIB_NS) == 0)
+                continue;
+            if (nsc == NULL && (nsc = xml_nsctx_init(NULL, NULL)) == NULL)
+                goto done;
+            if (xml_nsctx_add(nsc, cv_name_get(cv), ns) < 0)
+                goto done;
+        }
+    }
+    else {
+        while ((xa = xml_child_each_attr(x, xa)) != NULL){
+            if (!isxmlns(xa))
+                continue;
+            if ((ns = xml_value(xa)) == NULL || strcmp(ns, CLIXON_LIB_NS) == 0)
+                continue;
+            if (nsc == NULL && (nsc = xml_nsctx_init(NULL, NULL)) == NULL)
+                goto done;
+            /* xmlns:<prefix>="ns" or xmlns="ns" */
+            if (xml_nsctx_add(nsc, xml_prefix(xa) ? xml_name(xa) : NULL, ns) < 0)
+                goto done;
+        }
+    }
+    *nscp = nsc;
+    nsc = NULL;
+    retval = 0;
+ done:
+    if (nsc0)
+        xml_nsctx_free(nsc0);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    return retval;
+}
+
+/*! Get element children of template node in YANG order
+ *
+ * Template lists are not sorted on keys since they may contain variables, instead
+ * instantiated siblings are sorted if needed.
+ * @param[in]  x      Template node
+ * @param[out] vecp   Vector of element children, free after use
+ * @param[out] lenp   Length of vector
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+tmpl_children(cxobj   *x,
+              cxobj ***vecp,
+              int     *lenp)
+{
+    int     retval = -1;
+    cxobj **vec = NULL;
+    int    *order = NULL;
+    cxobj  *xc = NULL;
+    int     len = 0;
+    int     i;
+    int     j;
+    int     o;
+
+    if ((vec = calloc(xml_child_nr(x)+1, sizeof(cxobj*))) == NULL ||
+        (order = calloc(xml_child_nr(x)+1, sizeof(int))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    /* Stable insertion sort on yang order */
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL){
+        if ((o = yang_order(xml_spec(xc))) < -1)
+            goto done;
+        for (i = len; i > 0 && order[i-1] > o; i--)
+            ;
+        for (j = len; j > i; j--){
+            vec[j] = vec[j-1];
+            order[j] = order[j-1];
+        }
+        vec[i] = xc;
+        order[i] = o;
+        len++;
+    }
+    *vecp = vec;
+    vec = NULL;
+    *lenp = len;
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    if (order)
+        free(order);
+    return retval;
+}
+
+/*! Compile template element and its children recursively
+ *
+ * Emitted as: [TI_IF] [TI_FOREACH] TI_ELEMENT <children> TI_END
+ * @param[in]  tm    Template
+ * @param[in]  x     Template element, bound to YANG
+ * @param[in]  top   Top-level element of template
+ * @param[out] loop  Element is (also) a loop
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+tmpl_compile_element(clixon_template *tm,
+                     cxobj           *x,
+                     int              top,
+                     int             *loop)
+{
+    int        retval = -1;
+    yang_stmt *y;
+    cxobj     *xa = NULL;
+    cxobj     *xc;
+    cxobj    **vec = NULL;
+    int        veclen = 0;
+    char      *ns;
+    int        ictl[2];
+    int        nctl = 0;
+    int        ie;
+    int        i;
+    int        cloop;
+    int        nlist = 0;
+    enum rfc_6020 keyw;
+
+    if ((y = xml_spec(x)) == NULL){
+        clixon_err(OE_XML, 0, "Template element %s is not bound to YANG", xml_name(x));
+        goto done;
+    }
+    keyw = yang_keyword_get(y);
+    /* Template directives are attributes in clixon-lib namespace */
+    while ((xa = xml_child_each_attr(x, xa)) != NULL){
+        if (isxmlns(xa) || xml_prefix(xa) == NULL)
+            continue;
+        if (xml2ns(x, xml_prefix(xa), &ns) < 0)
+            goto done;
+        if (ns == NULL || strcmp(ns, CLIXON_LIB_NS) != 0)
+            continue;
+        if (strcmp(xml_name(xa), "if") == 0){
+            if ((ictl[nctl] = tmpl_instr_add(tm, TI_IF)) < 0)
+                goto done;
+        }
+        else if (strcmp(xml_name(xa), "foreach") == 0){
+            if ((ictl[nctl] = tmpl_instr_add(tm, TI_FOREACH)) < 0)
+                goto done;
+            *loop = 1;
+        }
+        else {
+            clixon_err(OE_XML, 0, "Unknown template directive %s of element %s",
+                       xml_name(xa), xml_name(x));
+            goto done;
+        }
+        if ((i = tmpl_slot(tm, xml_value(xa))) < 0)
+            goto done;
+        tm->tm_vec[ictl[nctl++]].ti_slot = i;
+        if (nctl == 2)
+            break;
+    }
+    if (nctl == 2 && tm->tm_vec[ictl[0]].ti_op == tm->tm_vec[ictl[1]].ti_op){
+        clixon_err(OE_XML, 0, "Duplicate template directive of element %s", xml_name(x));
+        goto done;
+    }
+    if ((ie = tmpl_instr_add(tm, TI_ELEMENT)) < 0)
+        goto done;
+    if ((tm->tm_vec[ie].ti_name = strdup(xml_name(x))) == NULL ||
+        (xml_prefix(x) && (tm->tm_vec[ie].ti_prefix = strdup(xml_prefix(x))) == NULL)){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    tm->tm_vec[ie].ti_spec = y;
+    tm->tm_vec[ie].ti_merge = (keyw == Y_CONTAINER);
+    if (tmpl_compile_nsc(x, top, &tm->tm_vec[ie].ti_nsc) < 0)
+        goto done;
+    if (keyw == Y_LEAF || keyw == Y_LEAF_LIST){
+        if (xml_body(x) && tmpl_compile_body(tm, xml_body(x)) < 0)
+            goto done;
+    }
+    else {
+        if (tmpl_children(x, &vec, &veclen) < 0)
+            goto done;
+        for (i=0; i<veclen; i++){
+            xc = vec[i];
+            cloop = 0;
+            if (tmpl_compile_element(tm, xc, 0, &cloop) < 0)
+                goto done;
+            /* Siblings whose order depends on variables need sorting */
+            if (cloop)
+                tm->tm_vec[ie].ti_sort = 1;
+            else if (xml_spec(xc) &&
+                     (yang_keyword_get(xml_spec(xc)) == Y_LIST ||
+                      yang_keyword_get(xml_spec(xc)) == Y_LEAF_LIST) &&
+                     ++nlist > 1)
+                tm->tm_vec[ie].ti_sort = 1;
+        }
+    }
+    if (tmpl_instr_add(tm, TI_END) < 0)
+        goto done;
+    tm->tm_vec[ie].ti_jump = tm->tm_len;
+    for (i=0; i<nctl; i++)
+        tm->tm_vec[ictl[i]].ti_jump = tm->tm_len;
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Compile a YANG-bound XML template
+ *
+ * @param[in]  xt     XML template top node. Element children are the template data and
+ *                    must be bound to YANG
+ * @param[out] tmplp  Compiled template, free with xml_template_free
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @code
+ *   clixon_template *tmpl = NULL;
+ *   if (xml_bind_yang(h, xt, YB_MODULE, yspec, &xerr) < 0)
+ *      err;
+ *   if (xml_template_compile(xt, &tmpl) < 0)
+ *      err;
+ *   if (xml_template_instantiate(tmpl, cvv, xedit) < 0)
+ *      err;
+ *   xml_template_free(tmpl);
+ * @endcode
+ */
+int
+xml_template_compile(cxobj            *xt,
+                     clixon_template **tmplp)
+{
+    int              retval = -1;
+    clixon_template *tm = NULL;
+    cxobj          **vec = NULL;
+    int              veclen = 0;
+    int              i;
+    int              loop;
+
+    if (tmplp == NULL){
+        clixon_err(OE_XML, EINVAL, "tmplp is NULL");
+        goto done;
+    }
+    if ((tm = calloc(1, sizeof(*tm))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    if ((tm->tm_cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (tmpl_children(xt, &vec, &veclen) < 0)
+        goto done;
+    for (i=0; i<veclen; i++){
+        loop = 0;
+        if (tmpl_compile_element(tm, vec[i], 1, &loop) < 0)
+            goto done;
+    }
+    clixon_debug(CLIXON_DBG_XML, "%d instructions, %d variables", tm->tm_len, tm->tm_nvars);
+    *tmplp = tm;
+    tm = NULL;
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    if (tm)
+        xml_template_free(tm);
+    return retval;
+}
+
+/*! Free compiled template
+ *
+ * @param[in]  tmpl  Compiled template
+ * @retval     0     OK
+ */
+int
+xml_template_free(clixon_template *tm)
+{
+    tmpl_instr *ti;
+    int         i;
+    int         j;
+
+    if (tm == NULL)
+        return 0;
+    for (i=0; i<tm->tm_len; i++){
+        ti = &tm->tm_vec[i];
+        if (ti->ti_name)
+            free(ti->ti_name);
+        if (ti->ti_prefix)
+            free(ti->ti_prefix);
+        if (ti->ti_nsc)
+            xml_nsctx_free(ti->ti_nsc);
+        if (ti->ti_strs){
+            for (j=0; j<ti->ti_nslots+1; j++)
+                if (ti->ti_strs[j])
+                    free(ti->ti_strs[j]);
+            free(ti->ti_strs);
+        }
+        if (ti->ti_slots)
+            free(ti->ti_slots);
+    }
+    if (tm->tm_vec)
+        free(tm->tm_vec);
+    for (i=0; i<tm->tm_nvars; i++){
+        free(tm->tm_vars[i]);
+        if (tm->tm_vals[i])
+            free(tm->tm_vals[i]);
+    }
+    if (tm->tm_vars)
+        free(tm->tm_vars);
+    if (tm->tm_vals)
+        free(tm->tm_vals);
+    if (tm->tm_nvals)
+        free(tm->tm_nvals);
+    if (tm->tm_maxvals)
+        free(tm->tm_maxvals);
+    if (tm->tm_cur)
+        free(tm->tm_cur);
+    if (tm->tm_cb)
+        cbuf_free(tm->tm_cb);
+    free(tm);
+    return 0;
+}
+
+/*! Assign variable slots from a variable vector
+ *
+ * @param[in]  tm    Template
+ * @param[in]  cvv   Variable vector, a name may occur several times
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+tmpl_vars_set(clixon_template *tm,
+              cvec            *cvv)
+{
+    cg_var *cv = NULL;
+    char   *name;
+    int     i;
+
+    for (i=0; i<tm->tm_nvars; i++)
+        tm->tm_nvals[i] = 0;
+    while ((cv = cvec_each(cvv, cv)) != NULL){
+        if ((name = cv_name_get(cv)) == NULL)
+            continue;
+        for (i=0; i<tm->tm_nvars; i++)
+            if (strcmp(tm->tm_vars[i], name) == 0)
+                break;
+        if (i == tm->tm_nvars) /* Not used in template */
+            continue;
+        if (tm->tm_nvals[i] == tm->tm_maxvals[i]){
+            tm->tm_maxvals[i] = tm->tm_maxvals[i] ? 2*tm->tm_maxvals[i] : 4;
+            if ((tm->tm_vals[i] = realloc(tm->tm_vals[i], tm->tm_maxvals[i]*sizeof(char*))) == NULL){
+                clixon_err(OE_UNIX, errno, "realloc");
+                return -1;
+            }
+        }
+        tm->tm_vals[i][tm->tm_nvals[i]++] = cv_string_get(cv);
+    }
+    for (i=0; i<tm->tm_nvars; i++)
+        tm->tm_cur[i] = tm->tm_nvals[i] ? tm->tm_vals[i][0] : NULL;
+    return 0;
+}
+
+/*! Emit body with variables substituted
+ *
+ * @param[in]  tm    Template
+ * @param[in]  ti    Body instruction
+ * @param[in]  x     Element to add body to
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+tmpl_exec_body(clixon_template *tm,
+               tmpl_instr      *ti,
+               cxobj           *x)
+{
+    cxobj *xb;
+    char  *str;
+    int    i;
+
+    if (ti->ti_nslots == 0)
+        str = ti->ti_strs[0];
+    else {
+        cbuf_reset(tm->tm_cb);
+        for (i=0; i<ti->ti_nslots; i++){
+            cprintf(tm->tm_cb, "%s", ti->ti_strs[i]);
+            if ((str = tm->tm_cur[ti->ti_slots[i]]) != NULL)
+                cprintf(tm->tm_cb, "%s", str);
+        }
+        cprintf(tm->tm_cb, "%s", ti->ti_strs[i]);
+        str = cbuf_get(tm->tm_cb);
+    }
+    if ((xb = xml_new("body", x, CX_BODY)) == NULL)
+        return -1;
+    if (xml_value_set(xb, str) < 0)
+        return -1;
+    return 0;
+}
+
+static int tmpl_exec(clixon_template *tm, int pc, cxobj *xp, int merge);
+
+/*! Emit element and its children
+ *
+ * If merge is set, xp is an existing node: a container is merged with an existing
+ * container, and new elements are inserted in sorted order.
+ * Otherwise, xp is created by the template and elements are appended in template order,
+ * which is the YANG order, and sorted afterwards only if needed.
+ * @param[in]  tm     Template
+ * @param[in]  pc     Index of element instruction
+ * @param[in]  xp     XML parent
+ * @param[in]  merge  xp is an existing node
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+tmpl_exec_element(clixon_template *tm,
+                  int              pc,
+                  cxobj           *xp,
+                  int              merge)
+{
+    int         retval = -1;
+    tmpl_instr *ti = &tm->tm_vec[pc];
+    tmpl_instr *tc;
+    cxobj      *x = NULL;
+    cxobj      *xnew = NULL;
+    cg_var     *cv = NULL;
+    int         i;
+
+    if (!merge || !ti->ti_merge ||
+        (x = xml_find_type(xp, ti->ti_prefix, ti->ti_name, CX_ELMNT)) == NULL){
+        /* A new element to an existing parent is inserted when complete */
+        if ((x = xml_new(ti->ti_name, merge?NULL:xp, CX_ELMNT)) == NULL)
+            goto done;
+        if (merge)
+            xnew = x;
+        xml_spec_set(x, ti->ti_spec);
+        if (ti->ti_prefix && xml_prefix_set(x, ti->ti_prefix) < 0)
+            goto done;
+        if (ti->ti_nsc)
+            while ((cv = cvec_each(ti->ti_nsc, cv)) != NULL)
+                if (xmlns_set(x, cv_name_get(cv), cv_string_get(cv)) < 0)
+                    goto done;
+        merge = 0;
+    }
+    i = pc + 1;
+    while ((tc = &tm->tm_vec[i])->ti_op != TI_END){
+        if (tc->ti_op == TI_BODY){
+            if (tmpl_exec_body(tm, tc, x) < 0)
+                goto done;
+            i++;
+        }
+        else {
+            if (tmpl_exec(tm, i, x, merge) < 0)
+                goto done;
+            i = tc->ti_jump;
+        }
+    }
+    if (!merge && ti->ti_sort && xml_sort(x) < 0)
+        goto done;
+    if (xnew){
+        if (xml_insert(xp, xnew, INS_LAST, NULL, NULL) < 0)
+            goto done;
+        xnew = NULL;
+    }
+    retval = 0;
+ done:
+    if (xnew)
+        xml_free(xnew);
+    return retval;
+}
+
+/*! Execute one template construct: element, possibly conditional or in a loop
+ *
+ * @param[in]  tm     Template
+ * @param[in]  pc     Index of first instruction of construct
+ * @param[in]  xp     XML parent
+ * @param[in]  merge  xp is an existing node
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+tmpl_exec(clixon_template *tm,
+          int              pc,
+          cxobj           *xp,
+          int              merge)
+{
+    tmpl_instr *ti = &tm->tm_vec[pc];
+    char       *val;
+    char       *cur;
+    int         i;
+
+    switch (ti->ti_op){
+    case TI_IF:
+        val = tm->tm_cur[ti->ti_slot];
+        if (val != NULL && *val != '\0' && strcmp(val, "false") != 0)
+            return tmpl_exec(tm, pc+1, xp, merge);
+        break;
+    case TI_FOREACH:
+        cur = tm->tm_cur[ti->ti_slot];
+        for (i=0; i<tm->tm_nvals[ti->ti_slot]; i++){
+            tm->tm_cur[ti->ti_slot] = tm->tm_vals[ti->ti_slot][i];
+            if (tmpl_exec(tm, pc+1, xp, merge) < 0)
+                return -1;
+        }
+        tm->tm_cur[ti->ti_slot] = cur;
+        break;
+    case TI_ELEMENT:
+        return tmpl_exec_element(tm, pc, xp, merge);
+    default:
+        clixon_err(OE_XML, 0, "Unexpected template instruction %d", ti->ti_op);
+        return -1;
+    }
+    return 0;
+}
+
+/*! Instantiate a compiled template with a set of variables into an edit tree
+ *
+ * Emitted elements are YANG bound and sorted. Containers already present in xt are merged,
+ * other elements are inserted in sorted order.
+ * @param[in]  tmpl  Compiled template
+ * @param[in]  cvv   Variables. A name may occur several times, a list used by cl:foreach
+ * @param[in]  xt    Edit tree top, eg <config>
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @note Values of cvv are referenced during instantiation, a template is not reentrant
+ */
+int
+xml_template_instantiate(clixon_template *tm,
+                         cvec            *cvv,
+                         cxobj           *xt)
+{
+    int retval = -1;
+    int i;
+
+    if (tm == NULL || xt == NULL){
+        clixon_err(OE_XML, EINVAL, "tmpl or xt is NULL");
+        goto done;
+    }
+    if (tmpl_vars_set(tm, cvv) < 0)
+        goto done;
+    i = 0;
+    while (i < tm->tm_len){
+        if (tmpl_exec(tm, i, xt, 1) < 0)
+            goto done;
+        i = tm->tm_vec[i].ti_jump;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
@@ -76,6 +76,7 @@
 #include <syslog.h>
 #include <fcntl.h>
 #include <math.h>  /* NaN */
+#include <sys/time.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -98,6 +99,7 @@
 #include "clixon_xpath.h"
 #include "clixon_xpath_parse.h"
 #include "clixon_xpath_eval.h"
+#include "clixon_xpath_profile.h"
 
 /* Use apostrophe(') in xpath literals, eg a/[x='foo'], not double-quotes(")
  * If not set, use ": a/[x="foo"]
@@ -600,6 +602,75 @@ xpath_parse(const char  *xpath,
     return retval;
 }
 
+/*! Given XML tree and xpath, parse xpath, eval it and return xpath context, internal
+ *
+ * @param[in]  xcur      XML-tree where to search
+ * @param[in]  nsc       External XML namespace context, or NULL
+ * @param[in]  xpath     String with XPath 1.0 syntax
+ * @param[in]  localonly Skip prefix and namespace tests (non-standard)
+ * @param[in]  key       Expression for profiling, format string if xpath is formatted
+ * @param[in]  caller    Return address of call site of public xpath function, for profiling
+ * @param[out] xrp       Return XPath context
+ * @retval     0         OK
+ * @retval    -1         Error
+ * @see xpath_vec_ctx
+ * @see xpath_profile_add
+ */
+static int
+xpath_vec_ctx1(cxobj      *xcur, 
+               cvec       *nsc,
+               const char *xpath,
+               int         localonly,
+               const char *key,
+               void       *caller,
+               xp_ctx    **xrp)
+{
+    int             retval = -1;
+    xpath_tree     *xptree = NULL;
+    xp_ctx          xc = {0,};
+    int             profile;
+    struct timeval  t0;
+    struct timeval  t1;
+    uint64_t        visits0 = 0;
+    size_t          results;
+    
+    clixon_debug(CLIXON_DBG_XPATH | CLIXON_DBG_DETAIL, "%s", xpath);
+    if ((profile = xpath_profile_enabled()) != 0){
+        gettimeofday(&t0, NULL);
+        visits0 = xp_visits;
+    }
+    if (xpath_parse(xpath, &xptree) < 0)
+        goto done;
+    xc.xc_type = XT_NODESET;
+    xc.xc_node = xcur;
+    xc.xc_initial = xcur;
+    if (cxvec_append(xcur, &xc.xc_nodeset, &xc.xc_size) < 0)
+        goto done;
+    if (xp_eval(&xc, xptree, nsc, localonly, xrp) < 0)
+        goto done;
+    if (profile){
+        gettimeofday(&t1, NULL);
+        timersub(&t1, &t0, &t1);
+        if (*xrp && (*xrp)->xc_type == XT_NODESET)
+            results = (*xrp)->xc_size;
+        else
+            results = 1;
+        if (xpath_profile_add(xpath, key, caller,
+                              (uint64_t)t1.tv_sec*1000000 + t1.tv_usec,
+                              xp_visits - visits0, results) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (xc.xc_nodeset){
+        free(xc.xc_nodeset);
+        xc.xc_nodeset = NULL;
+    }
+    if (xptree)
+        xpath_tree_free(xptree);
+    return retval;
+}
+
 /*! Given XML tree and xpath, parse xpath, eval it and return xpath context, 
  *
  * This is a raw form of xpath where you can do type conversion of the return
@@ -626,29 +697,7 @@ xpath_vec_ctx(cxobj      *xcur,
               int         localonly,
               xp_ctx    **xrp)
 {
-    int         retval = -1;
-    xpath_tree *xptree = NULL;
-    xp_ctx      xc = {0,};
-    
-    clixon_debug(CLIXON_DBG_XPATH | CLIXON_DBG_DETAIL, "%s", xpath);
-    if (xpath_parse(xpath, &xptree) < 0)
-        goto done;
-    xc.xc_type = XT_NODESET;
-    xc.xc_node = xcur;
-    xc.xc_initial = xcur;
-    if (cxvec_append(xcur, &xc.xc_nodeset, &xc.xc_size) < 0)
-        goto done;
-    if (xp_eval(&xc, xptree, nsc, localonly, xrp) < 0)
-        goto done;
-    retval = 0;
- done:
-    if (xc.xc_nodeset){
-        free(xc.xc_nodeset);
-        xc.xc_nodeset = NULL;
-    }
-    if (xptree)
-        xpath_tree_free(xptree);
-    return retval;
+    return xpath_vec_ctx1(xcur, nsc, xpath, localonly, xpath, __builtin_return_address(0), xrp);
 }
 
 /*! XPath nodeset function where only the first matching entry is returned
@@ -700,7 +749,7 @@ xpath_first(cxobj      *xcur,
         goto done;
     }
     va_end(ap);
-    if (xpath_vec_ctx(xcur, nsc, xpath, 0, &xr) < 0)
+    if (xpath_vec_ctx1(xcur, nsc, xpath, 0, xpformat, __builtin_return_address(0), &xr) < 0)
         goto done;
     if (xr && xr->xc_type == XT_NODESET && xr->xc_size)
         cx = xr->xc_nodeset[0];
@@ -759,7 +808,7 @@ xpath_first_localonly(cxobj      *xcur,
         goto done;
     }
     va_end(ap);
-    if (xpath_vec_ctx(xcur, NULL, xpath, 1, &xr) < 0)
+    if (xpath_vec_ctx1(xcur, NULL, xpath, 1, xpformat, __builtin_return_address(0), &xr) < 0)
         goto done;
     if (xr && xr->xc_type == XT_NODESET && xr->xc_size)
         cx = xr->xc_nodeset[0];
@@ -826,7 +875,7 @@ xpath_vec(cxobj      *xcur,
     va_end(ap);
     *vec = NULL;
     *veclen = 0;
-    if (xpath_vec_ctx(xcur, nsc, xpath, 0, &xr) < 0)
+    if (xpath_vec_ctx1(xcur, nsc, xpath, 0, xpformat, __builtin_return_address(0), &xr) < 0)
         goto done;
     if (xr && xr->xc_type == XT_NODESET){
         *vec    = xr->xc_nodeset;
@@ -902,7 +951,7 @@ xpath_vec_flag(cxobj      *xcur,
     }
     va_end(ap);
     *vec=NULL;
-    if (xpath_vec_ctx(xcur, nsc, xpath, 0, &xr) < 0)
+    if (xpath_vec_ctx1(xcur, nsc, xpath, 0, xpformat, __builtin_return_address(0), &xr) < 0)
         goto done;
     if (xr && xr->xc_type == XT_NODESET){
         for (i=0; i<xr->xc_size; i++){
@@ -960,7 +1009,7 @@ xpath_vec_bool(cxobj      *xcur,
         goto done;
     }
     va_end(ap);
-    if (xpath_vec_ctx(xcur, nsc, xpath, 0, &xr) < 0)
+    if (xpath_vec_ctx1(xcur, nsc, xpath, 0, xpformat, __builtin_return_address(0), &xr) < 0)
         goto done;
     if (xr)
         retval = ctx2boolean(xr);
@@ -1197,7 +1246,7 @@ xpath_count(cxobj      *xcur,
         goto done;
     }
     cprintf(cb, "count(%s)", xpath);
-    if (xpath_vec_ctx(xcur, nsc, cbuf_get(cb), 0, &xc) < 0)
+    if (xpath_vec_ctx1(xcur, nsc, cbuf_get(cb), 0, xpath, __builtin_return_address(0), &xc) < 0)
         goto done;
     if (xc && xc->xc_type == XT_NUMBER && xc->xc_number != NAN)
         *count = (uint32_t)xc->xc_number;
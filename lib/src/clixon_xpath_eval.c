@@ -80,6 +80,7 @@
 #include "clixon_yang.h"
 #include "clixon_xml.h"
 #include "clixon_err.h"
+#include "clixon_cancel.h"
 #include "clixon_log.h"
 #include "clixon_debug.h"
 #include "clixon_yang_type.h"
@@ -110,6 +111,9 @@ const map_str2int xpopmap[] = {
     {NULL,               -1}
 };
 
+/* Number of nodes visited by child and descendant steps, for xpath profiling */
+uint64_t xp_visits = 0;
+
 /*! Eval an XPath nodetest
  *
  * @retval    1     Match 
@@ -282,6 +286,7 @@ nodetest_recursive(cxobj      *xn,
 
     xsub = NULL;
     while ((xsub = xml_child_each(xn, xsub, node_type)) != NULL) {
+        xp_visits++;
         if (nodetest_eval(xsub, nodetest, nsc, localonly) == 1){
             clixon_debug(CLIXON_DBG_XPATH | CLIXON_DBG_DETAIL, "%x %x", flags, xml_flag(xsub, flags));
             if (flags==0x0 || xml_flag(xsub, flags))
@@ -360,6 +365,7 @@ xp_eval_step(xp_ctx     *xc0,
                     goto done;
                 if (ret == 0){/* regular code, no optimization made */
                     while ((x = xml_child_each(xv, x, CX_ELMNT)) != NULL) {
+                        xp_visits++;
                         /* xs->xs_c0 is nodetest */
                         if (nodetest == NULL ||
                             nodetest_eval(x, nodetest, nsc, localonly) == 1){
@@ -1151,6 +1157,8 @@ xp_eval(xp_ctx     *xc,
     xp_ctx    *xr2 = NULL;
     int        use_xr0 = 0; /* In 2nd child use transitively result of 1st child */
 
+    if (clixon_cancel_check(0) < 0)
+        goto done;
     // ctx_print(stderr, xc, xpath_tree_int2str(xs->xs_type));
     /* Pre-actions before check first child c0
      */
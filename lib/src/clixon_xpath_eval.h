@@ -41,6 +41,7 @@
  * Variables
  */
 extern const map_str2int xpopmap[];
+extern uint64_t xp_visits;
 
 /*
  * Prototypes
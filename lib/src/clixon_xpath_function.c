@@ -229,17 +229,9 @@ derived_from_one(char  *baseidentity,
     yang_stmt *yleaf;
     yang_stmt *ytype;
     yang_stmt *ybaseid;
-    yang_stmt *ymod;
-    cvec      *idrefvec; /* Derived identityref list: (module:id)**/
-    char      *node = NULL;
-    char      *prefix = NULL;
-    char      *id = NULL;
-    cbuf      *cb = NULL;
-    char      *baseid = NULL;
+    yang_stmt *yid;
+    char      *node;
 
-    /* Split baseidentity to get its id (w/o prefix) */
-    if (nodeid_split(baseidentity, NULL, &baseid) < 0)
-        goto done;
     if ((yleaf = xml_spec(xleaf)) == NULL)
         goto nomatch;
     if (yang_keyword_get(yleaf) != Y_LEAF && yang_keyword_get(yleaf) != Y_LEAF_LIST)
@@ -258,47 +250,16 @@ derived_from_one(char  *baseidentity,
     /* Just get the object corresponding to the base identity */
     if ((ybaseid = yang_find_identity_nsc(ys_spec(yleaf), baseidentity, nsc)) == NULL)
         goto nomatch;
-    /* Get its list of derived identities  */
-    idrefvec = yang_cvec_get(ybaseid);
-    /* Get and split the leaf id reference */
+    /* Get the leaf identity reference */
     if ((node = xml_body(xleaf)) == NULL) /* It may not be empty */
         goto nomatch;
-    if (nodeid_split(node, &prefix, &id) < 0)
-        goto done;
-    /* Get its module (prefixes are not used here) */
-    if (prefix == NULL)
-        ymod = ys_module(yleaf);
-    else{ /* from prefix to name */
-        ymod = yang_find_module_by_prefix_yspec(ys_spec(yleaf), prefix);
-    }
-    if (ymod == NULL)
+    if ((yid = yang_identity_value(yleaf, node)) == NULL)
+        goto nomatch;
+    /* Check derivation, self special case is that the xleaf has a ref to itself */
+    if (yang_identity_derived(yid, ybaseid, self) == 0)
         goto nomatch;
-    /* self special case, ie that the xleaf has a ref to itself */
-    if (self &&
-        ymod == ys_module(ybaseid) &&
-        strcmp(baseid, id) == 0){
-        ; /* match */
-    }
-    else {
-        /* Allocate cbuf */
-        if ((cb = cbuf_new()) == NULL){
-            clixon_err(OE_UNIX, errno, "cbuf_new");
-            goto done;
-        }
-        cprintf(cb, "%s:%s", yang_argument_get(ymod), id);
-        if (cvec_find(idrefvec, cbuf_get(cb)) == NULL)
-            goto nomatch;
-    }
     retval = 1;
  done:
-    if (baseid)
-        free(baseid);
-    if (cb)
-        cbuf_free(cb);
-    if (id)
-        free(id);
-    if (prefix)
-        free(prefix);
     return retval;
  nomatch:
     retval = 0;
@@ -294,14 +294,26 @@ xpath_list_optimize_fn(xpath_tree  *xt,
     if (ret == 0)
         goto ok;
 
-    if (cvec_len(cvv) != cvec_len(cvk))
+    if (cvec_len(cvk) == 0)
         goto ok;
-    i = 0;
-    cvi = NULL;
-    while ((cvi = cvec_each(cvk, cvi)) != NULL) {
-        if (strcmp(cv_name_get(cvi), cv_string_get(cvec_i(cvv,i))))
+    /* Predicates are exactly the list keys in order */
+    if (cvec_len(cvv) == cvec_len(cvk)){
+        i = 0;
+        cvi = NULL;
+        while ((cvi = cvec_each(cvk, cvi)) != NULL) {
+            if (strcmp(cv_name_get(cvi), cv_string_get(cvec_i(cvv,i))))
+                break;
+            i++;
+        }
+    }
+    else
+        cvi = cvec_i(cvk, 0);
+    if (cvi != NULL){ /* Not keys */
+#ifdef XML_EXPLICIT_INDEX
+        /* Predicates are exactly the leafs of an explicit search index */
+        if (yang_list_index_match(yc, cvk) == NULL)
+#endif
             goto ok;
-        i++;
     }
     /* Use 2a form since yc allready given to compute cvk */
     if (clixon_xml_find_index(xv, yp, NULL, name, cvk, xvec) < 0)
@@ -0,0 +1,320 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2024 Olof Hagsand
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * XPath profiling: per-expression statistics and slow-query log
+ * Evaluations via xpath_vec_ctx and its wrappers (xpath_first, xpath_vec, etc) are
+ * accounted per expression and call site: number of calls, cumulative and max evaluation
+ * time, nodes visited and result size.
+ * The expression is the format string of the variadic functions, not the formatted xpath,
+ * so that the number of entries is bounded by the number of call sites. A "%s" format, where
+ * the whole expression is given by the caller, eg from YANG or a filter, is accounted on the
+ * expression. Entries are limited to XPATH_PROFILE_MAX for such expressions.
+ * Evaluations taking longer than a threshold are logged.
+ * Both are disabled by default, then only a flag is tested per evaluation.
+ * Set with options CLICON_XPATH_PROFILE and CLICON_XPATH_SLOW_THRESHOLD
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#define _GNU_SOURCE /* for dladdr */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include <syslog.h>
+#include <dlfcn.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_string.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_debug.h"
+#include "clixon_xpath_profile.h"
+
+/* Max number of expression and call site entries */
+#define XPATH_PROFILE_MAX 4096
+
+/*! Statistics of one xpath expression and call site
+ */
+struct xpath_profile {
+    void    *xp_caller;     /* Return address of call site */
+    uint64_t xp_calls;      /* Number of evaluations */
+    uint64_t xp_total;      /* Cumulative evaluation time in usecs */
+    uint64_t xp_max;        /* Max evaluation time in usecs */
+    uint64_t xp_nodes;      /* Cumulative number of nodes visited */
+    uint64_t xp_results;    /* Cumulative result size */
+};
+typedef struct xpath_profile xpath_profile;
+
+/* Profiling enabled */
+static int            _profile_enable = 0;
+
+/* Slow-query threshold in usecs, 0 if disabled */
+static uint64_t       _profile_slow = 0;
+
+/* Statistics keyed by "<caller> <expression>" */
+static clicon_hash_t *_profile_hash = NULL;
+
+/* Number of entries in _profile_hash */
+static int            _profile_len = 0;
+
+/*! Enable xpath profiling and slow-query log
+ *
+ * There is no handle in xpath functions, therefore global settings
+ * @param[in]  enable   Collect per-expression statistics
+ * @param[in]  slow_ms  Log evaluations taking longer than this many milliseconds, 0 disables
+ * @retval     0        OK
+ */
+int
+xpath_profile_set(int      enable,
+                  uint32_t slow_ms)
+{
+    _profile_enable = enable;
+    _profile_slow = (uint64_t)slow_ms*1000;
+    return 0;
+}
+
+/*! Return true if evaluations should be timed, ie profiling or slow-query log is enabled
+ */
+int
+xpath_profile_enabled(void)
+{
+    return _profile_enable || _profile_slow;
+}
+
+/*! Print call site of return address as symbol+offset, object+offset or address
+ *
+ * @param[in]  cb      Output buffer
+ * @param[in]  caller  Return address of call site
+ */
+static void
+xpath_profile_caller(cbuf *cb,
+                     void *caller)
+{
+    Dl_info info = {0,};
+
+    if (dladdr(caller, &info) != 0 && info.dli_sname != NULL)
+        cprintf(cb, "%s+0x%lx", info.dli_sname,
+                (unsigned long)((char*)caller - (char*)info.dli_saddr));
+    else if (info.dli_fname != NULL)
+        cprintf(cb, "%s+0x%lx", info.dli_fname,
+                (unsigned long)((char*)caller - (char*)info.dli_fbase));
+    else
+        cprintf(cb, "%p", caller);
+}
+
+/*! Account one xpath evaluation
+ *
+ * Evaluations of new expressions are not accounted when there are XPATH_PROFILE_MAX entries
+ * @param[in]  xpath    XPath expression, for slow-query log
+ * @param[in]  key      Expression to account evaluation on, format string of xpath if any
+ * @param[in]  caller   Return address of call site
+ * @param[in]  usec     Evaluation time in microseconds
+ * @param[in]  nodes    Number of nodes visited
+ * @param[in]  results  Result size, nr of nodes in nodeset, otherwise 1
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+int
+xpath_profile_add(const char *xpath,
+                  const char *key,
+                  void       *caller,
+                  uint64_t    usec,
+                  uint64_t    nodes,
+                  size_t      results)
+{
+    int            retval = -1;
+    cbuf          *cb = NULL;
+    xpath_profile *xp;
+    xpath_profile  xp0 = {0,};
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (_profile_slow && usec >= _profile_slow){
+        xpath_profile_caller(cb, caller);
+        clixon_log(NULL, LOG_WARNING, "Slow xpath: %" PRIu64 " ms %s caller:%s nodes:%" PRIu64 " results:%zu",
+                   usec/1000, xpath, cbuf_get(cb), nodes, results);
+        cbuf_reset(cb);
+    }
+    if (!_profile_enable)
+        goto ok;
+    if (_profile_hash == NULL &&
+        (_profile_hash = clicon_hash_init()) == NULL)
+        goto done;
+    if (strcmp(key, "%s") == 0)
+        key = xpath;
+    cprintf(cb, "%p %s", caller, key);
+    if ((xp = clicon_hash_value(_profile_hash, cbuf_get(cb), NULL)) == NULL){
+        if (_profile_len >= XPATH_PROFILE_MAX){
+            if (_profile_len == XPATH_PROFILE_MAX){ /* Log once */
+                clixon_log(NULL, LOG_WARNING, "xpath profile: more than %d expressions, new are not accounted",
+                           XPATH_PROFILE_MAX);
+                _profile_len++;
+            }
+            goto ok;
+        }
+        _profile_len++;
+        xp0.xp_caller = caller;
+        if (clicon_hash_add(_profile_hash, cbuf_get(cb), &xp0, sizeof(xp0)) == NULL)
+            goto done;
+        if ((xp = clicon_hash_value(_profile_hash, cbuf_get(cb), NULL)) == NULL){
+            clixon_err(OE_XML, 0, "xpath profile entry not found");
+            goto done;
+        }
+    }
+    xp->xp_calls++;
+    xp->xp_total += usec;
+    if (usec > xp->xp_max)
+        xp->xp_max = usec;
+    xp->xp_nodes += nodes;
+    xp->xp_results += results;
+ ok:
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Sort keys on cumulative time, descending
+ */
+static int
+xpath_profile_cmp(const void *a,
+                  const void *b)
+{
+    xpath_profile *xa;
+    xpath_profile *xb;
+
+    xa = clicon_hash_value(_profile_hash, *(char**)a, NULL);
+    xb = clicon_hash_value(_profile_hash, *(char**)b, NULL);
+    if (xa->xp_total < xb->xp_total)
+        return 1;
+    if (xa->xp_total > xb->xp_total)
+        return -1;
+    return 0;
+}
+
+/*! Dump xpath statistics as XML, one <xpath> element per expression and call site
+ *
+ * Sorted on cumulative evaluation time, most expensive first
+ * @param[in]  cb   Output buffer
+ * @param[in]  ns   Namespace of <xpath> elements, or NULL
+ * @param[in]  max  Max nr of entries, 0 means all
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see clixon-lib.yang xpath-profile rpc
+ */
+int
+xpath_profile_dump(cbuf       *cb,
+                   const char *ns,
+                   uint32_t    max)
+{
+    int            retval = -1;
+    char         **keys = NULL;
+    size_t         nkeys = 0;
+    size_t         i;
+    char          *xpath;
+    xpath_profile *xp;
+
+    if (_profile_hash == NULL)
+        goto ok;
+    if (clicon_hash_keys(_profile_hash, &keys, &nkeys) < 0)
+        goto done;
+    qsort(keys, nkeys, sizeof(char*), xpath_profile_cmp);
+    for (i=0; i<nkeys; i++){
+        if (max && i == max)
+            break;
+        if ((xp = clicon_hash_value(_profile_hash, keys[i], NULL)) == NULL)
+            continue;
+        if ((xpath = strchr(keys[i], ' ')) == NULL)
+            continue;
+        xpath++;
+        cprintf(cb, "<xpath");
+        if (ns)
+            cprintf(cb, " xmlns=\"%s\"", ns);
+        cprintf(cb, ">");
+        cprintf(cb, "<expression>");
+        if (xml_chardata_cbuf_append(cb, xpath) < 0)
+            goto done;
+        cprintf(cb, "</expression>");
+        cprintf(cb, "<call-site>");
+        xpath_profile_caller(cb, xp->xp_caller);
+        cprintf(cb, "</call-site>");
+        cprintf(cb, "<calls>%" PRIu64 "</calls>", xp->xp_calls);
+        cprintf(cb, "<time-total>%" PRIu64 "</time-total>", xp->xp_total);
+        cprintf(cb, "<time-max>%" PRIu64 "</time-max>", xp->xp_max);
+        cprintf(cb, "<nodes>%" PRIu64 "</nodes>", xp->xp_nodes);
+        cprintf(cb, "<results>%" PRIu64 "</results>", xp->xp_results);
+        cprintf(cb, "</xpath>");
+    }
+ ok:
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Clear all xpath statistics
+ */
+int
+xpath_profile_reset(void)
+{
+    if (_profile_hash){
+        clicon_hash_free(_profile_hash);
+        _profile_hash = NULL;
+    }
+    _profile_len = 0;
+    return 0;
+}
+
+/*! Free xpath profiling state on exit
+ */
+void
+xpath_profile_exit(void)
+{
+    xpath_profile_reset();
+}
@@ -90,6 +90,8 @@
 
 #ifdef XML_EXPLICIT_INDEX
 static int yang_search_index_extension(clixon_handle h, yang_stmt *yext, yang_stmt *ys);
+static int yang_list_index_composite_leafs(yang_stmt *ys);
+static int yang_list_index_key_add(yang_stmt *ys);
 #endif
 
 /*
@@ -176,6 +178,7 @@ static const map_str2int ykmap[] = {
 /* Forward static */
 static int yang_type_cache_free(yang_type_cache *ycache);
 static int yang_type_cache_cp(yang_stmt *ynew, yang_stmt *yold);
+static void yang_identity_index_free(struct yang_identity_index *yx);
 
 /* Access functions
  */
@@ -740,6 +743,10 @@ ys_free1(yang_stmt *ys,
         yang_type_cache_free(ys->ys_typecache);
         ys->ys_typecache = NULL;
     }
+    if (ys->ys_identities){
+        yang_identity_index_free(ys->ys_identities);
+        ys->ys_identities = NULL;
+    }
     if (ys->ys_when_xpath)
         free(ys->ys_when_xpath);
     if (ys->ys_when_nsc)
@@ -915,6 +922,7 @@ ys_cp(yang_stmt *ynew,
 
     memcpy(ynew, yold, sizeof(*yold));
     ynew->ys_parent = NULL;
+    ynew->ys_identities = NULL;
     if (yold->ys_stmt)
         if ((ynew->ys_stmt = calloc(yold->ys_len, sizeof(yang_stmt *))) == NULL){
             clixon_err(OE_YANG, errno, "calloc");
@@ -2723,6 +2731,330 @@ ys_populate_identity(clixon_handle h,
     return retval;
 }
 
+/*! Free identity derivation index
+ *
+ * @param[in] yx  Identity index
+ */
+static void
+yang_identity_index_free(struct yang_identity_index *yx)
+{
+    uint32_t i;
+
+    if (yx->yx_hash)
+        clicon_hash_free(yx->yx_hash);
+    for (i=0; i<yx->yx_len; i++)
+        if (yx->yx_ancestors[i])
+            free(yx->yx_ancestors[i]);
+    if (yx->yx_ancestors)
+        free(yx->yx_ancestors);
+    if (yx->yx_vec)
+        free(yx->yx_vec);
+    free(yx);
+}
+
+/*! Get number of identity in identity index
+ *
+ * @param[in]  yid  Yang identity statement
+ * @param[out] nr   Identity number
+ * @retval     1    OK
+ * @retval     0    Not indexed
+ */
+static inline int
+yang_identity_nr(yang_stmt *yid,
+                 uint32_t  *nr)
+{
+    cg_var *cv;
+
+    if ((cv = yang_cv_get(yid)) == NULL)
+        return 0;
+    *nr = cv_uint32_get(cv);
+    return 1;
+}
+
+/*! Number identity and its base identities recursively, and compute derivation closure
+ *
+ * Base identities are numbered before the identity, and the bitset of an identity is the
+ * union of the bitsets of its base identities and itself
+ * @param[in]  yx   Identity index
+ * @param[in]  yid  Yang identity statement
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+yang_identity_number(struct yang_identity_index *yx,
+                     yang_stmt                  *yid)
+{
+    int        retval = -1;
+    yang_stmt *yc = NULL;
+    yang_stmt *ybaseid;
+    yang_stmt *ymod = NULL;
+    cg_var    *cv = NULL;
+    cbuf      *cb = NULL;
+    uint8_t   *bits = NULL;
+    uint32_t   nr;
+    uint32_t   bnr;
+    uint32_t   i;
+
+    if (yang_cv_get(yid) != NULL) /* Already numbered */
+        goto ok;
+    if (yang_flag_get(yid, YANG_FLAG_TMP)){
+        clixon_err(OE_YANG, EINVAL, "Identity %s: derivation cycle", yang_argument_get(yid));
+        goto done;
+    }
+    yang_flag_set(yid, YANG_FLAG_TMP);
+    while ((yc = yn_each(yid, yc)) != NULL) {
+        if (yang_keyword_get(yc) != Y_BASE)
+            continue;
+        if ((ybaseid = yang_find_identity(yid, yang_argument_get(yc))) == NULL){
+            clixon_err(OE_YANG, ENOENT, "No such identity: %s", yang_argument_get(yc));
+            goto done;
+        }
+        if (yang_identity_number(yx, ybaseid) < 0)
+            goto done;
+    }
+    yang_flag_reset(yid, YANG_FLAG_TMP);
+    nr = yx->yx_len;
+    if (nr == yx->yx_max){
+        yx->yx_max = yx->yx_max ? 2*yx->yx_max : 64;
+        if ((yx->yx_vec = realloc(yx->yx_vec, yx->yx_max*sizeof(yang_stmt*))) == NULL ||
+            (yx->yx_ancestors = realloc(yx->yx_ancestors, yx->yx_max*sizeof(uint8_t*))) == NULL){
+            clixon_err(OE_YANG, errno, "realloc");
+            goto done;
+        }
+    }
+    if ((bits = calloc(nr/8 + 1, 1)) == NULL){
+        clixon_err(OE_YANG, errno, "calloc");
+        goto done;
+    }
+    bits[nr/8] |= 1 << (nr%8);
+    yc = NULL;
+    while ((yc = yn_each(yid, yc)) != NULL) {
+        if (yang_keyword_get(yc) != Y_BASE)
+            continue;
+        ybaseid = yang_find_identity(yid, yang_argument_get(yc));
+        if (yang_identity_nr(ybaseid, &bnr) == 0)
+            continue;
+        for (i=0; i<=bnr/8; i++)
+            bits[i] |= yx->yx_ancestors[bnr][i];
+        /* Cache resolved base */
+        if ((cv = cv_new(CGV_UINT32)) == NULL){
+            clixon_err(OE_YANG, errno, "cv_new");
+            goto done;
+        }
+        cv_uint32_set(cv, bnr);
+        yang_cv_set(yc, cv);
+        cv = NULL;
+    }
+    if (ys_real_module(yid, &ymod) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s:%s", yang_argument_get(ymod), yang_argument_get(yid));
+    if (clicon_hash_add(yx->yx_hash, cbuf_get(cb), &nr, sizeof(nr)) == NULL)
+        goto done;
+    if ((cv = cv_new(CGV_UINT32)) == NULL){
+        clixon_err(OE_YANG, errno, "cv_new");
+        goto done;
+    }
+    cv_uint32_set(cv, nr);
+    yang_cv_set(yid, cv);
+    cv = NULL;
+    yx->yx_vec[nr] = yid;
+    yx->yx_ancestors[nr] = bits;
+    bits = NULL;
+    yx->yx_len++;
+ ok:
+    retval = 0;
+ done:
+    if (bits)
+        free(bits);
+    if (cv)
+        cv_free(cv);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Build or extend identity derivation index of a yang spec
+ *
+ * All identities of all modules in the yang spec are numbered. Identities already numbered
+ * keep their numbers, which means the index can be extended when modules are added.
+ * @param[in] yspec  Yang spec
+ * @retval    0      OK
+ * @retval   -1      Error
+ * @see yang_identity_derived  Use of the index
+ */
+int
+yang_identity_index_build(yang_stmt *yspec)
+{
+    int                         retval = -1;
+    struct yang_identity_index *yx;
+    yang_stmt                  *ym = NULL;
+    yang_stmt                  *yid;
+
+    if ((yx = yspec->ys_identities) == NULL){
+        if ((yx = calloc(1, sizeof(*yx))) == NULL){
+            clixon_err(OE_YANG, errno, "calloc");
+            goto done;
+        }
+        yspec->ys_identities = yx;
+        if ((yx->yx_hash = clicon_hash_init()) == NULL)
+            goto done;
+    }
+    while ((ym = yn_each(yspec, ym)) != NULL) {
+        if (yang_keyword_get(ym) != Y_MODULE && yang_keyword_get(ym) != Y_SUBMODULE)
+            continue;
+        yid = NULL;
+        while ((yid = yn_each(ym, yid)) != NULL) {
+            if (yang_keyword_get(yid) != Y_IDENTITY)
+                continue;
+            if (yang_identity_number(yx, yid) < 0)
+                goto done;
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Find identity given module name and identifier
+ *
+ * @param[in] yspec   Yang spec
+ * @param[in] module  Module name (not prefix), for identities in submodules the belongs-to module
+ * @param[in] id      Identifier without prefix
+ * @retval    yid     Yang identity statement
+ * @retval    NULL    Not found, or no index
+ */
+yang_stmt *
+yang_identity_find(yang_stmt  *yspec,
+                   const char *module,
+                   const char *id)
+{
+    struct yang_identity_index *yx;
+    char                        buf[256];
+    char                       *key = buf;
+    size_t                      len;
+    uint32_t                   *nrp;
+    yang_stmt                  *yid = NULL;
+
+    if ((yx = yspec->ys_identities) == NULL)
+        return NULL;
+    len = strlen(module) + strlen(id) + 2;
+    if (len > sizeof(buf) && (key = malloc(len)) == NULL){
+        clixon_err(OE_YANG, errno, "malloc");
+        return NULL;
+    }
+    snprintf(key, len, "%s:%s", module, id);
+    if ((nrp = clicon_hash_value(yx->yx_hash, key, NULL)) != NULL)
+        yid = yx->yx_vec[*nrp];
+    if (key != buf)
+        free(key);
+    return yid;
+}
+
+/*! Find identity given an identityref value on the form [<prefix>:]<id>
+ *
+ * The prefix is resolved among all modules of the yang spec. If there is no prefix, the
+ * module of the yang statement is used.
+ * @param[in] ys     Yang statement of identityref leaf or leaf-list
+ * @param[in] value  Identityref value
+ * @retval    yid    Yang identity statement
+ * @retval    NULL   Not found
+ */
+yang_stmt *
+yang_identity_value(yang_stmt  *ys,
+                    const char *value)
+{
+    yang_stmt  *yspec;
+    yang_stmt  *ymod = NULL;
+    const char *id;
+    char        buf[64];
+    char       *prefix = buf;
+    size_t      len;
+
+    yspec = ys_spec(ys);
+    if ((id = strchr(value, ':')) == NULL){
+        id = value;
+        if (ys_real_module(ys, &ymod) < 0)
+            return NULL;
+    }
+    else {
+        len = id - value;
+        if (len >= sizeof(buf) && (prefix = malloc(len + 1)) == NULL){
+            clixon_err(OE_YANG, errno, "malloc");
+            return NULL;
+        }
+        memcpy(prefix, value, len);
+        prefix[len] = '\0';
+        ymod = yang_find_module_by_prefix_yspec(yspec, prefix);
+        if (prefix != buf)
+            free(prefix);
+        id++;
+    }
+    if (ymod == NULL)
+        return NULL;
+    return yang_identity_find(yspec, yang_argument_get(ymod), id);
+}
+
+/*! Get base identity of a base statement, cache the result
+ *
+ * @param[in] ybase  Yang base statement, eg of identityref type
+ * @retval    yid    Yang identity statement
+ * @retval    NULL   Not found
+ */
+yang_stmt *
+yang_identity_base(yang_stmt *ybase)
+{
+    struct yang_identity_index *yx;
+    yang_stmt                  *yid;
+    uint32_t                    nr;
+    cg_var                     *cv;
+
+    yx = ys_spec(ybase)->ys_identities;
+    if (yx && yang_identity_nr(ybase, &nr) == 1 && nr < yx->yx_len)
+        return yx->yx_vec[nr];
+    if ((yid = yang_find_identity(ybase, yang_argument_get(ybase))) == NULL)
+        return NULL;
+    if (yx && yang_identity_nr(yid, &nr) == 1 &&
+        (cv = cv_new(CGV_UINT32)) != NULL){
+        cv_uint32_set(cv, nr);
+        yang_cv_set(ybase, cv);
+    }
+    return yid;
+}
+
+/*! Check if identity is derived from a base identity
+ *
+ * @param[in] yid    Yang identity statement
+ * @param[in] ybase  Yang base identity statement
+ * @param[in] self   If set, also return 1 if yid is ybase, ie derived-from-or-self
+ * @retval    1      yid is derived from ybase
+ * @retval    0      yid is not derived from ybase
+ * @see RFC 7950 Sec 10.4.1
+ */
+int
+yang_identity_derived(yang_stmt *yid,
+                      yang_stmt *ybase,
+                      int        self)
+{
+    struct yang_identity_index *yx;
+    uint32_t                    nr;
+    uint32_t                    bnr;
+
+    if (yid == ybase)
+        return self ? 1 : 0;
+    if ((yx = ys_spec(yid)->ys_identities) == NULL ||
+        yang_identity_nr(yid, &nr) == 0 ||
+        yang_identity_nr(ybase, &bnr) == 0 ||
+        nr >= yx->yx_len)
+        return 0;
+    if (bnr > nr) /* Bases have lower numbers */
+        return 0;
+    return (yx->yx_ancestors[nr][bnr/8] & (1 << (bnr%8))) != 0;
+}
+
 /*! Return 1 if feature is enabled, 0 if not using the populated yang tree
  *
  * @param[in] yspec   yang specification
@@ -3071,6 +3403,17 @@ ys_populate2(yang_stmt    *ys,
                 yang_flag_set(yang_parent_get(ys), YANG_FLAG_STATE_LOCAL);
         }
         break;
+#ifdef XML_EXPLICIT_INDEX
+    case Y_UNKNOWN: /* Composite search index: mark leafs after grouping expansion */
+        if (yang_flag_get(ys, YANG_FLAG_INDEX) &&
+            yang_list_index_composite_leafs(ys) < 0)
+            goto done;
+        break;
+    case Y_KEY:     /* Implicit key index of ordered-by user list */
+        if (yang_list_index_key_add(ys) < 0)
+            goto done;
+        break;
+#endif
     default:
         break;
     }
@@ -4008,6 +4351,8 @@ yang_init(clixon_handle h)
 #ifdef XML_EXPLICIT_INDEX
 /*! Mark element as search_index in list
  *
+ * Both the leaf and its list are marked, the list to signal it has explicit indexes
+ * @param[in]  ys  Yang leaf with search_index extension
  * @retval     0   OK
  * @retval    -1   Error
  */
@@ -4023,13 +4368,317 @@ yang_list_index_add(yang_stmt *ys)
         goto ok;
     }
     yang_flag_set(ys, YANG_FLAG_INDEX);
+    yang_flag_set(yp, YANG_FLAG_INDEX);
  ok:
     retval = 0;
    // done:
     return retval;
 }
 
-/*! Callback for yang clixon search_index extension
+/*! Mark list as having a composite search index over leafs given as space-separated argument
+ *
+ * The argument is normalized to leaf names separated by single spaces, which is the name of
+ * the index. The leafs themselves are marked later in ys_populate2 after grouping expansion.
+ * @param[in]  ys  Yang unknown statement of search_index_list extension
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+yang_list_index_composite_add(yang_stmt *ys)
+{
+    int        retval = -1;
+    yang_stmt *yp;
+    cg_var    *cv;
+    char      *arg;
+    cbuf      *cb = NULL;
+    char      *p;
+    size_t     len;
+
+    if ((yp = yang_parent_get(ys)) == NULL ||
+        yang_keyword_get(yp) != Y_LIST){
+        clixon_log(NULL, LOG_WARNING, "search_index_list should be in a list");
+        goto ok;
+    }
+    if ((cv = yang_cv_get(ys)) == NULL ||
+        (arg = cv_string_get(cv)) == NULL){
+        clixon_log(NULL, LOG_WARNING, "search_index_list without leafs");
+        goto ok;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    p = arg;
+    while (*p != '\0'){
+        while (isspace(*p))
+            p++;
+        for (len=0; p[len] != '\0' && !isspace(p[len]); len++);
+        if (len == 0)
+            break;
+        cprintf(cb, "%s%.*s", cbuf_len(cb)?" ":"", (int)len, p);
+        p += len;
+    }
+    if (cbuf_len(cb) == 0){
+        clixon_log(NULL, LOG_WARNING, "search_index_list without leafs");
+        goto ok;
+    }
+    if (cv_string_set(cv, cbuf_get(cb)) == NULL){
+        clixon_err(OE_UNIX, errno, "cv_string_set");
+        goto done;
+    }
+    yang_flag_set(ys, YANG_FLAG_INDEX);
+    yang_flag_set(yp, YANG_FLAG_INDEX);
+ ok:
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Mark leafs of composite search index, after grouping expansion
+ *
+ * @param[in]  ys  Yang unknown statement of search_index_list extension
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see yang_list_index_composite_add
+ */
+static int
+yang_list_index_composite_leafs(yang_stmt *ys)
+{
+    yang_stmt *yp;
+    yang_stmt *yc;
+    char      *name;
+    char      *p;
+    size_t     len;
+    int        i;
+
+    if ((yp = yang_parent_get(ys)) == NULL ||
+        yang_keyword_get(yp) != Y_LIST ||
+        yang_cv_get(ys) == NULL)
+        return 0;
+    name = cv_string_get(yang_cv_get(ys));
+    for (p = name; p && *p != '\0'; p += len){
+        if (*p == ' ')
+            p++;
+        for (len=0; p[len] != '\0' && p[len] != ' '; len++);
+        for (i=0; i<yang_len_get(yp); i++){
+            yc = yang_child_i(yp, i);
+            if (yang_keyword_get(yc) == Y_LEAF &&
+                strncmp(yang_argument_get(yc), p, len) == 0 &&
+                yang_argument_get(yc)[len] == '\0')
+                break;
+        }
+        if (i < yang_len_get(yp))
+            yang_flag_set(yc, YANG_FLAG_INDEX);
+        else
+            clixon_log(NULL, LOG_WARNING, "search_index_list \"%s\": %.*s is not a leaf of list %s",
+                       name, (int)len, p, yang_argument_get(yp));
+    }
+    return 0;
+}
+
+/*! Add implicit search index on the keys of an ordered-by user list, after grouping expansion
+ *
+ * Entries of ordered-by user lists are not sorted by key and cannot be binary searched in the
+ * child vector. Instead the list is given an index named by its keys separated by space, which
+ * is maintained as other explicit indexes and used for key lookups.
+ * The name is stored as cv of the key statement, and the list and key leafs are marked.
+ * State lists are sorted by key unless STATE_ORDERED_BY_SYSTEM is undefined.
+ * @param[in]  ys  Yang key statement
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see yang_list_index_key
+ */
+static int
+yang_list_index_key_add(yang_stmt *ys)
+{
+    int        retval = -1;
+    yang_stmt *yp;
+    yang_stmt *yc;
+    cg_var    *cvi;
+    cg_var    *cv = NULL;
+    cbuf      *cb = NULL;
+    char      *name;
+    int        i = 0;
+
+    if ((yp = yang_parent_get(ys)) == NULL ||
+        yang_keyword_get(yp) != Y_LIST ||
+        yang_cvec_get(yp) == NULL)
+        goto ok;
+    if (
+#ifndef STATE_ORDERED_BY_SYSTEM
+        yang_config_ancestor(yp) != 0 &&
+#endif
+        yang_find(yp, Y_ORDERED_BY, "user") == NULL)
+        goto ok;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cvi = NULL;
+    while ((cvi = cvec_each(yang_cvec_get(yp), cvi)) != NULL)
+        cprintf(cb, "%s%s", cbuf_len(cb)?" ":"", cv_string_get(cvi));
+    /* An explicit index on exactly the keys is used instead */
+    while ((name = yang_list_index_each(yp, &i)) != NULL)
+        if (strcmp(name, cbuf_get(cb)) == 0)
+            goto ok;
+    if ((cv = cv_new(CGV_STRING)) == NULL){
+        clixon_err(OE_UNIX, errno, "cv_new");
+        goto done;
+    }
+    if (cv_string_set(cv, cbuf_get(cb)) == NULL){
+        clixon_err(OE_UNIX, errno, "cv_string_set");
+        goto done;
+    }
+    if (yang_cv_set(ys, cv) < 0)
+        goto done;
+    cv = NULL;
+    cvi = NULL;
+    while ((cvi = cvec_each(yang_cvec_get(yp), cvi)) != NULL)
+        if ((yc = yang_find(yp, Y_LEAF, cv_string_get(cvi))) != NULL)
+            yang_flag_set(yc, YANG_FLAG_INDEX);
+    yang_flag_set(ys, YANG_FLAG_INDEX);
+    yang_flag_set(yp, YANG_FLAG_INDEX);
+ ok:
+    retval = 0;
+ done:
+    if (cv)
+        cv_free(cv);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Get implicit key index of a yang list
+ *
+ * @param[in]  ylist  Yang list
+ * @retval     name   Index name, keys separated by single space, do not free
+ * @retval     NULL   List has no key index, eg it is sorted by key
+ * @see yang_list_index_key_add
+ */
+char *
+yang_list_index_key(yang_stmt *ylist)
+{
+    yang_stmt *ykey;
+
+    if (yang_flag_get(ylist, YANG_FLAG_INDEX) == 0 ||
+        (ykey = yang_find(ylist, Y_KEY, NULL)) == NULL ||
+        yang_flag_get(ykey, YANG_FLAG_INDEX) == 0 ||
+        yang_cv_get(ykey) == NULL)
+        return NULL;
+    return cv_string_get(yang_cv_get(ykey));
+}
+
+/*! Check if leaf name is part of explicit search index name
+ *
+ * @param[in]  name  Index name, leaf names separated by single space
+ * @param[in]  leaf  Leaf name
+ * @retval     1     Yes
+ * @retval     0     No
+ */
+static int
+yang_list_index_leaf(char *name,
+                     char *leaf)
+{
+    size_t len = strlen(leaf);
+    char  *p = name;
+
+    while ((p = strstr(p, leaf)) != NULL){
+        if ((p == name || p[-1] == ' ') &&
+            (p[len] == '\0' || p[len] == ' '))
+            return 1;
+        p += len;
+    }
+    return 0;
+}
+
+/*! Iterate over explicit search indexes of a yang list
+ *
+ * A single index is declared by the search_index extension in a leaf of the list and is named
+ * by the leaf. A composite index is declared by the search_index_list extension in the list and
+ * is named by its leafs separated by space. An ordered-by user list also has an implicit index
+ * on its keys, see yang_list_index_key_add.
+ * @param[in]     ylist  Yang list
+ * @param[in,out] i      Iterator state, initialize to 0
+ * @retval        name   Index name, do not free
+ * @retval        NULL   No more indexes
+ * @code
+ *   int   i = 0;
+ *   char *name;
+ *   while ((name = yang_list_index_each(ylist, &i)) != NULL)
+ *      ...
+ * @endcode
+ * @note Does not use yn_each, can be called within other iterations of the list
+ */
+char *
+yang_list_index_each(yang_stmt *ylist,
+                     int       *i)
+{
+    yang_stmt *yc;
+    yang_stmt *yu;
+    cg_var    *cv;
+    int        j;
+
+    while (*i < yang_len_get(ylist)){
+        yc = yang_child_i(ylist, (*i)++);
+        if (yang_flag_get(yc, YANG_FLAG_INDEX) == 0)
+            continue;
+        switch (yang_keyword_get(yc)){
+        case Y_UNKNOWN: /* Composite search_index_list */
+        case Y_KEY:     /* Implicit key index */
+            if ((cv = yang_cv_get(yc)) != NULL)
+                return cv_string_get(cv);
+            break;
+        case Y_LEAF:    /* Single search_index, the leaf may also be part of composite index */
+            for (j=0; j<yang_len_get(yc); j++){
+                yu = yang_child_i(yc, j);
+                if (yang_keyword_get(yu) == Y_UNKNOWN &&
+                    yang_flag_get(yu, YANG_FLAG_INDEX))
+                    return yang_argument_get(yc);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return NULL;
+}
+
+/*! Find explicit search index of a yang list that consists of exactly a set of leafs
+ *
+ * @param[in]  ylist  Yang list
+ * @param[in]  cvk    Vector of <leafname>=<value> in any order
+ * @retval     name   Index name, do not free
+ * @retval     NULL   No such index
+ */
+char *
+yang_list_index_match(yang_stmt *ylist,
+                      cvec      *cvk)
+{
+    char   *name;
+    char   *p;
+    cg_var *cvi;
+    int     i = 0;
+    int     n;
+
+    if (cvk == NULL || cvec_len(cvk) == 0)
+        return NULL;
+    while ((name = yang_list_index_each(ylist, &i)) != NULL){
+        for (n=1, p=name; (p = strchr(p, ' ')) != NULL; p++, n++);
+        if (n != cvec_len(cvk))
+            continue;
+        cvi = NULL;
+        while ((cvi = cvec_each(cvk, cvi)) != NULL)
+            if (cv_name_get(cvi) == NULL || !yang_list_index_leaf(name, cv_name_get(cvi)))
+                break;
+        if (cvi == NULL)
+            return name;
+    }
+    return NULL;
+}
+
+/*! Callback for yang clixon search_index and search_index_list extensions
  * 
  * @param[in] h    Clixon handle
  * @param[in] yext Yang node of extension 
@@ -4051,12 +4700,20 @@ yang_search_index_extension(clixon_handle h,
     ymod = ys_module(yext);
     modname = yang_argument_get(ymod);
     extname = yang_argument_get(yext);
-    if (strcmp(modname, "clixon-config") != 0 || strcmp(extname, "search_index") != 0)
+    if (strcmp(modname, "clixon-config") != 0)
         goto ok;
-    clixon_debug(CLIXON_DBG_YANG, "Enabled extension:%s:%s", modname, extname);
-    yp = yang_parent_get(ys);
-    if (yang_list_index_add(yp) < 0)
-        goto done;
+    if (strcmp(extname, "search_index") == 0){
+        clixon_debug(CLIXON_DBG_YANG, "Enabled extension:%s:%s", modname, extname);
+        yp = yang_parent_get(ys);
+        if (yang_list_index_add(yp) < 0)
+            goto done;
+        yang_flag_set(ys, YANG_FLAG_INDEX);
+    }
+    else if (strcmp(extname, "search_index_list") == 0){
+        clixon_debug(CLIXON_DBG_YANG, "Enabled extension:%s:%s", modname, extname);
+        if (yang_list_index_composite_add(ys) < 0)
+            goto done;
+    }
  ok:
     retval = 0;
  done:
@@ -60,6 +60,21 @@ struct yang_type_cache{
 };
 typedef struct yang_type_cache yang_type_cache;
 
+/*! Identity derivation index of a yang spec
+ *
+ * Identities are numbered so that base identities have lower numbers than derived ones.
+ * Each identity has a bitset of itself and all its transitive base identities, so that
+ * a derived-from check is a bit test.
+ * @see yang_identity_index_build
+ */
+struct yang_identity_index{
+    clicon_hash_t *yx_hash;      /* <module>:<id> -> identity number */
+    yang_stmt    **yx_vec;       /* Identities by number */
+    uint8_t      **yx_ancestors; /* Per identity: bitset of self and base identities */
+    uint32_t       yx_len;       /* Number of identities */
+    uint32_t       yx_max;       /* Allocated length of vectors */
+};
+
 /*! yang statement 
  *
  * This is an internal type, not exposed in the API
@@ -92,6 +107,8 @@ struct yang_stmt{
                                         unknown-stmt (optional argument)
                                         spec: mount-point xpath
                                         enum: value
+                                        identity: number in identity index (uint32)
+                                        base: number of base identity, cached (uint32)
                                      */
     cvec              *ys_cvec;      /* List of stmt-specific variables 
                                         Y_RANGE: range_min, range_max 
@@ -103,6 +120,7 @@ struct yang_stmt{
                                         Y_UNKNOWN: app-dep: yang-mount-points
                                      */
     int                ys_ref;       /* Reference count for free, only YS_SPEC */
+    struct yang_identity_index *ys_identities; /* Identity derivation index, only YS_SPEC */
     yang_type_cache   *ys_typecache; /* If ys_keyword==Y_TYPE, cache all typedef data except unions */
     char              *ys_when_xpath; /* Special conditional for a "when"-associated augment/uses xpath */
     cvec              *ys_when_nsc;   /* Special conditional for a "when"-associated augment/uses namespace ctx */
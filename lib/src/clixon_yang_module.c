@@ -127,6 +127,91 @@ modstate_diff_free(modstate_diff_t *md)
     return 0;
 }
 
+/*! Compute module-state differences between two module-sets
+ *
+ * Each module in xfrom that is not in xto is marked DEL, each module whose revision
+ * differs is marked CHANGE, and each module in xto that is not in xfrom is marked ADD.
+ * Modules are copied from xfrom, except added modules which are copied from xto.
+ * @param[in]  yspec   Yang spec
+ * @param[in]  xfrom   Module-set before, eg of a datastore file
+ * @param[in]  xto     Module-set after, eg of the running system
+ * @param[out] msdiff  Modules-state differences, md_status and md_diff are set
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @note Other elements than module, such as module-set-id, are ignored
+ */
+int
+yang_modules_state_diff(yang_stmt       *yspec,
+                        cxobj           *xfrom,
+                        cxobj           *xto,
+                        modstate_diff_t *msdiff)
+{
+    int    retval = -1;
+    cxobj *xf;
+    cxobj *xs;
+    cxobj *x2;
+    char  *name;
+    char  *frev;
+    char  *srev;
+
+    msdiff->md_status = 1;  /* There is module state */
+    /* Create modstate diff tree
+     * Note, module-set is not a top-level symbol, so cannot bind using module-set
+     */
+    if (clixon_xml_parse_string("<module-set xmlns=\"urn:ietf:params:xml:ns:yang:ietf-yang-library\"/>",
+                                YB_NONE, yspec, &msdiff->md_diff, NULL) < 0)
+        goto done;
+    if (xml_rootchild(msdiff->md_diff, 0, &msdiff->md_diff) < 0)
+        goto done;
+    /* For each module in from */
+    xf = NULL;
+    while ((xf = xml_child_each(xfrom, xf, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(xf), "module"))
+            continue; /* ignore other tags, such as module-set-id */
+        if ((name = xml_find_body(xf, "name")) == NULL)
+            continue;
+        /* There is no such module in to */
+        if ((xs = xpath_first(xto, NULL, "module[name=\"%s\"]", name)) == NULL){
+            if ((x2 = xml_dup(xf)) == NULL)
+                goto done;
+            if (xml_addsub(msdiff->md_diff, x2) < 0)
+                goto done;
+            xml_flag_set(x2, XML_FLAG_DEL);
+            continue;
+        }
+        /* These two shouldnt happen since revision is key, just ignore */
+        if ((frev = xml_find_body(xf, "revision")) == NULL)
+            continue;
+        if ((srev = xml_find_body(xs, "revision")) == NULL)
+            continue;
+        if (strcmp(frev, srev) != 0){
+            if ((x2 = xml_dup(xf)) == NULL)
+                goto done;
+            if (xml_addsub(msdiff->md_diff, x2) < 0)
+                goto done;
+            xml_flag_set(x2, XML_FLAG_CHANGE);
+        }
+    }
+    /* For each module in to that is not in from */
+    xs = NULL;
+    while ((xs = xml_child_each(xto, xs, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(xs), "module"))
+            continue;
+        if ((name = xml_find_body(xs, "name")) == NULL)
+            continue;
+        if (xpath_first(xfrom, NULL, "module[name=\"%s\"]", name) == NULL){
+            if ((x2 = xml_dup(xs)) == NULL)
+                goto done;
+            if (xml_addsub(msdiff->md_diff, x2) < 0)
+                goto done;
+            xml_flag_set(x2, XML_FLAG_ADD);
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Init the Yang module library
  *
  * Load RFC7895 yang spec, module-set-id, etc.
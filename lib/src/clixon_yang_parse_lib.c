@@ -1538,6 +1538,9 @@ yang_parse_post(clixon_handle h,
     for (i=0; i<ylen; i++)
         if (yang_cardinality(h, ylist[i], yang_argument_get(ylist[i])) < 0)
             goto done;
+    /* 12. Number identities and compute derivation closure for identityref validation */
+    if (yang_identity_index_build(yspec) < 0)
+        goto done;
     retval = 0;
  done:
     if (ylist)
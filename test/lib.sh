@@ -269,6 +269,7 @@ if $SNMPCHECK; then
             echo "  rwcommunity     public  localhost"
             echo "  agentxsocket    unix:/var/run/snmp.sock"
             echo "  agentxperms     777 777"
+            echo "  trap2sink       127.0.0.1:1162 public   (for notification tests)"
             echo ""
             echo "If you don't rely on systemd you can configure the lines above"
             echo "and start snmpd manually with 'snmpd -Lo -p /var/run/snmpd.pid'."
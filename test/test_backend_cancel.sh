@@ -0,0 +1,144 @@
+#!/usr/bin/env bash
+# Per-RPC deadlines and cancellation of backend RPCs
+# See clixon-lib deadline attribute and CLICON_BACKEND_RPC_DEADLINE
+# An expensive xpath over a large list is used as long-running operation
+# 1. RPC with deadline attribute is aborted with error, and invalid deadline is rejected
+# 2. Per-user default deadline
+# 3. RPC of client that disconnects mid-operation is cancelled, later requests are not delayed
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Number of list entries
+: ${perfnr:=5000}
+
+# Number of clients that disconnect mid-operation
+: ${perfreq:=5}
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/cancel.yang
+fconfig=$dir/large.xml
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_BACKEND_RPC_DEADLINE>slow 100</CLICON_BACKEND_RPC_DEADLINE>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module cancel{
+  yang-version 1.1;
+  namespace "urn:example:cancel";
+  prefix ca;
+  container x{
+    list y{
+      key a;
+      leaf a{
+        type int32;
+      }
+      leaf b{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+NS="xmlns=\"urn:example:cancel\""
+CLNS="xmlns:cl=\"http://clicon.org/lib\""
+OK="<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+# Quadratic xpath: count of whole list is evaluated for each entry, matches nothing
+SLOW="<get-config><source><running/></source><filter type=\"xpath\" select=\"/ca:x/ca:y[ca:a=count(/ca:x/ca:y)]\" xmlns:ca=\"urn:example:cancel\"/></get-config>"
+FAST="<get-config><source><running/></source><filter type=\"xpath\" select=\"/ca:x/ca:y[ca:a='1']\" xmlns:ca=\"urn:example:cancel\"/></get-config>"
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "generate $perfnr entries"
+rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><default-operation>replace</default-operation><config><x $NS>"
+for (( i=0; i<$perfnr; i++ )); do
+    rpc+="<y><a>$i</a><b>$i</b></y>"
+done
+rpc+="</x></config></edit-config></rpc>"
+echo -n "$DEFAULTHELLO" > $fconfig
+echo "$(chunked_framing "$rpc")" >> $fconfig
+
+new "load $perfnr entries"
+expecteof_file "$clixon_netconf -qef $cfg" 0 "$fconfig" "^$OK$"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "$OK"
+
+new "slow query without deadline"
+t=$({ time -p echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS>$SLOW</rpc>")" | $clixon_netconf -qef $cfg > /dev/null; } 2>&1 | awk '/real/ {print $2}')
+echo "time: $t"
+
+new "slow query with deadline"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS $CLNS cl:deadline=\"100\">$SLOW</rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>operation-failed</error-tag><error-severity>error</error-severity><error-message>Deadline exceeded</error-message></rpc-error></rpc-reply>"
+
+new "fast query with deadline"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS $CLNS cl:deadline=\"10000\">$FAST</rpc>" "<rpc-reply $DEFAULTNS><data><x $NS><y><a>1</a><b>1</b></y></x></data></rpc-reply>"
+
+new "invalid deadline"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS $CLNS cl:deadline=\"soon\">$FAST</rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>protocol</error-type><error-tag>bad-attribute</error-tag><error-info><bad-attribute>deadline</bad-attribute></error-info>"
+
+new "slow query of user with default deadline"
+expecteof_netconf "$clixon_netconf -qf $cfg -U slow" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$SLOW</rpc>" "<error-message>Deadline exceeded</error-message>"
+
+new "deadline attribute overrides user default"
+expecteof_netconf "$clixon_netconf -qf $cfg -U slow" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS $CLNS cl:deadline=\"0\">$FAST</rpc>" "<rpc-reply $DEFAULTNS><data><x $NS><y><a>1</a><b>1</b></y></x></data></rpc-reply>"
+
+new "$perfreq clients disconnect during slow query"
+for (( i=0; i<$perfreq; i++ )); do
+    echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS>$SLOW</rpc>")" | timeout 0.2 $clixon_netconf -qef $cfg > /dev/null
+done
+
+new "fast query after disconnects"
+t1=$({ time -p echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS>$FAST</rpc>")" | $clixon_netconf -qef $cfg > /dev/null; } 2>&1 | awk '/real/ {print $2}')
+echo "time: $t1"
+if ! awk -v t1=$t1 -v t=$t 'BEGIN {exit !(t1 < t)}'; then
+    err "less than $t s" "$t1 s"
+fi
+
+new "stats: cancelled requests are counted"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><stats $LIBNS/></rpc>")" | $clixon_netconf -qef $cfg)
+expectpart "$ret" 0 "<rpc-cancel $LIBNS><deadline>2</deadline><disconnect>[1-9][0-9]*</disconnect><memory>0</memory></rpc-cancel>"
+
+new "backend is alive"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$FAST</rpc>" "<rpc-reply $DEFAULTNS><data><x $NS><y><a>1</a><b>1</b></y></x></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
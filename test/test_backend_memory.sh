@@ -0,0 +1,123 @@
+#!/usr/bin/env bash
+# Per-request memory budgets of backend RPCs, see CLICON_BACKEND_RPC_MEMORY
+# 1. Oversized get and xpath queries of a user with a budget are rejected with too-big
+# 2. Small queries of same user, and queries of users without budget, succeed
+# 3. Rejected requests are counted and backend stays healthy
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Number of list entries
+: ${perfnr:=20000}
+
+# Memory budget of guest in bytes
+: ${budget:=1000000}
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/memory.yang
+fconfig=$dir/large.xml
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_BACKEND_RPC_MEMORY>admin 0</CLICON_BACKEND_RPC_MEMORY>
+  <CLICON_BACKEND_RPC_MEMORY>* $budget</CLICON_BACKEND_RPC_MEMORY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module memory{
+  yang-version 1.1;
+  namespace "urn:example:memory";
+  prefix me;
+  container x{
+    list y{
+      key a;
+      leaf a{
+        type int32;
+      }
+      leaf b{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+NS="xmlns=\"urn:example:memory\""
+OK="<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+TOOBIG="<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>too-big</error-tag><error-severity>error</error-severity><error-message>Memory budget exceeded</error-message></rpc-error></rpc-reply>"
+ONE="<rpc-reply $DEFAULTNS><data><x $NS><y><a>1</a><b>1</b></y></x></data></rpc-reply>"
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "generate $perfnr entries"
+rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><default-operation>replace</default-operation><config><x $NS>"
+for (( i=0; i<$perfnr; i++ )); do
+    rpc+="<y><a>$i</a><b>$i</b></y>"
+done
+rpc+="</x></config></edit-config></rpc>"
+echo -n "$DEFAULTHELLO" > $fconfig
+echo "$(chunked_framing "$rpc")" >> $fconfig
+
+new "load $perfnr entries as admin"
+expecteof_file "$clixon_netconf -qef $cfg -U admin" 0 "$fconfig" "^$OK$"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg -U admin" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "$OK"
+
+new "get all entries as guest is too big"
+expecteof_netconf "$clixon_netconf -qf $cfg -U guest" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "$TOOBIG"
+
+new "get //* as guest is too big"
+expecteof_netconf "$clixon_netconf -qf $cfg -U guest" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"//*\"/></get></rpc>" "$TOOBIG"
+
+new "get one entry as guest"
+expecteof_netconf "$clixon_netconf -qf $cfg -U guest" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/me:x/me:y[me:a='1']\" xmlns:me=\"urn:example:memory\"/></get-config></rpc>" "$ONE"
+
+new "get all entries as admin"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>")" | $clixon_netconf -qef $cfg -U admin)
+expectpart "$ret" 0 "<y><a>$(( $perfnr - 1 ))</a><b>$(( $perfnr - 1 ))</b></y></x></data></rpc-reply>"
+
+new "stats: rejected requests are counted"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><stats $LIBNS/></rpc>")" | $clixon_netconf -qef $cfg -U admin)
+expectpart "$ret" 0 "<rpc-cancel $LIBNS><deadline>0</deadline><disconnect>0</disconnect><memory>2</memory></rpc-cancel>"
+
+new "backend is alive"
+expecteof_netconf "$clixon_netconf -qf $cfg -U guest" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/me:x/me:y[me:a='1']\" xmlns:me=\"urn:example:memory\"/></get-config></rpc>" "$ONE"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
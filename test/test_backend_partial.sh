@@ -0,0 +1,155 @@
+#!/usr/bin/env bash
+# Non-blocking assembly of incoming messages in the backend
+# See CLICON_BACKEND_MSG_MAX and CLICON_BACKEND_MSG_TIMEOUT
+# 1. A message split in several writes is assembled
+# 2. Several messages in one write are all handled
+# 3. A stalled sender does not block other clients
+# 4. A stalled sender is disconnected after timeout
+# 5. A too large message disconnects the sender
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Skip it if no netcat
+if [ -z "$netcat" ]; then
+    echo "...netcat not installed"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi # skip
+fi
+
+# Number of requests made by other clients while sender is stalled
+: ${perfreq:=20}
+
+# Max age of incomplete message in ms
+: ${timeout:=3000}
+
+# Max message size
+: ${msgmax:=100000}
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/partial.yang
+sock=$dir/partial.sock
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>$sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_BACKEND_MSG_MAX>$msgmax</CLICON_BACKEND_MSG_MAX>
+  <CLICON_BACKEND_MSG_TIMEOUT>$timeout</CLICON_BACKEND_MSG_TIMEOUT>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module partial{
+  yang-version 1.1;
+  namespace "urn:example:partial";
+  prefix p;
+  container c{
+    leaf x{
+      type string;
+    }
+  }
+}
+EOF
+
+RPC="<rpc $DEFAULTNS message-id=\"42\"><get-config><source><running/></source></get-config></rpc>"
+LEN=${#RPC}
+
+# Count sessions in backend
+function sessions(){
+    ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/ncm:netconf-state/ncm:sessions\" xmlns:ncm=\"urn:ietf:params:xml:ns:yang:ietf-netconf-monitoring\"/></get></rpc>")" | $clixon_netconf -qef $cfg)
+    echo "$ret" | grep -o "<session-id>" | wc -l
+}
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "message split in two writes"
+ret=$( (printf "\n#$LEN\n${RPC:0:20}"; sleep 0.5; printf "${RPC:20}\n##\n") | sudo netcat -w 2 -U $sock)
+expectpart "$ret" 0 "<rpc-reply $DEFAULTNS message-id=\"42\"><data/></rpc-reply>"
+
+new "two messages in one write"
+ret=$(printf "\n#$LEN\n$RPC\n##\n\n#$LEN\n$RPC\n##\n" | sudo netcat -w 2 -U $sock)
+match=$(echo "$ret" | grep -o "<rpc-reply" | wc -l)
+if [ $match -ne 2 ]; then
+    err "2 replies" "$ret"
+fi
+
+new "start stalled sender"
+(printf "\n#$LEN\n${RPC:0:20}"; sleep 30) | sudo netcat -U $sock > /dev/null &
+sleep 1
+
+new "stalled session is open"
+nr=$(sessions)
+if [ $nr -ne 2 ]; then
+    err "2 sessions" "$nr"
+fi
+
+new "$perfreq requests while sender is stalled"
+rpc=""
+for (( i=0; i<$perfreq; i++ )); do
+    rpc+=$(chunked_framing "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>")
+done
+t=$({ time -p echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg > /dev/null; } 2>&1 | awk '/real/ {print $2}')
+echo "time: $t"
+if ! awk -v t=$t -v m=$timeout 'BEGIN {exit !(t * 1000 < m)}'; then
+    err "less than $timeout ms" "$t s"
+fi
+
+new "wait for timeout"
+sleep $(( $timeout / 1000 + 1 ))
+
+new "stalled session is closed"
+nr=$(sessions)
+if [ $nr -ne 1 ]; then
+    err "1 session" "$nr"
+fi
+
+new "too large message"
+(printf "\n#$(( $msgmax * 2 ))\n"; head -c $(( $msgmax + $msgmax / 2 )) /dev/zero | tr '\0' 'x'; sleep 30) | sudo netcat -U $sock > /dev/null &
+sleep 1
+
+new "too large message session is closed"
+nr=$(sessions)
+if [ $nr -ne 1 ]; then
+    err "1 session" "$nr"
+fi
+
+new "backend is alive"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+# Kill stalled senders
+sudo pkill -f "netcat -U $sock"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,197 @@
+#!/usr/bin/env bash
+# Weighted fair scheduling of backend requests, see CLICON_BACKEND_SCHED_CLASS
+# Pollers in a low-weight class flood the backend with large gets, while edits and commits
+# are made by a user in a high-weight class.
+# 1. Sessions are assigned to classes by user and transport, see stats
+# 2. Edits of high-weight class are served while pollers are active, with a bounded max
+#    queue wait
+# 3. Backend is alive and no requests are queued after pollers are stopped
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Number of list entries
+: ${perfnr:=5000}
+
+# Number of requests made in timing tests
+: ${perfreq:=20}
+
+# Number of poller sessions
+: ${pollers:=4}
+
+# Bound of max queue wait of high-weight class with pollers, in us
+: ${waitbound:=500000}
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/sched.yang
+fconfig=$dir/large.xml
+fpoll=$dir/poll.xml
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_BACKEND_SCHED_CLASS>ops 10 user:andy</CLICON_BACKEND_SCHED_CLASS>
+  <CLICON_BACKEND_SCHED_CLASS>poll 1 user:wilma transport:netconf</CLICON_BACKEND_SCHED_CLASS>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module sched{
+  yang-version 1.1;
+  namespace "urn:example:sched";
+  prefix sc;
+  container x{
+    list y{
+      key a;
+      leaf a{
+        type int32;
+      }
+      leaf b{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+NS="xmlns=\"urn:example:sched\""
+OK="<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+# Get a counter of a scheduler class from stats rpc, made by andy in ops class
+# 1: class name
+# 2: leaf name, eg requests or wait-max
+function sched_stat()
+{
+    echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><stats $LIBNS/></rpc>")" | $clixon_netconf -qef $cfg -U andy | sed 's/<class>/\n&/g' | grep "^<class><name>$1</name>" | sed -e 's/<\/class>.*//' -n -e "s/.*<$2>\([0-9]*\)<\/$2>.*/\1/p"
+}
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "generate $perfnr entries"
+rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><default-operation>replace</default-operation><config><x $NS>"
+for (( i=0; i<$perfnr; i++ )); do
+    rpc+="<y><a>$i</a><b>$i</b></y>"
+done
+rpc+="</x></config></edit-config></rpc>"
+echo -n "$DEFAULTHELLO" > $fconfig
+echo "$(chunked_framing "$rpc")" >> $fconfig
+
+new "load $perfnr entries"
+expecteof_file "$clixon_netconf -qef $cfg -U andy" 0 "$fconfig" "^$OK$"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg -U andy" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "$OK"
+
+new "default class requests before unclassified user"
+req0=$(sched_stat default requests)
+if [ -z "$req0" ]; then
+    err "default class requests" "not found"
+fi
+
+new "unclassified user is in default class"
+expecteof_netconf "$clixon_netconf -qf $cfg -U guest" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/sc:x/sc:y[sc:a='1']\" xmlns:sc=\"urn:example:sched\"/></get-config></rpc>" "<rpc-reply $DEFAULTNS><data><x $NS><y><a>1</a><b>1</b></y></x></data></rpc-reply>"
+
+new "default class counted request of unclassified user"
+req1=$(sched_stat default requests)
+if [ -z "$req1" ] || [ $req1 -le $req0 ]; then
+    err "default class requests > $req0" "$req1"
+fi
+
+new "$perfreq edits and commits without pollers"
+rpc=""
+for (( i=0; i<$perfreq; i++ )); do
+    rpc+=$(chunked_framing "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x $NS><y><a>$i</a><b>idle$i</b></y></x></config></edit-config></rpc>")
+    rpc+=$(chunked_framing "<rpc $DEFAULTNS><commit/></rpc>")
+done
+{ time -p echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg -U andy > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+new "ops class max wait without pollers"
+idlemax=$(sched_stat ops wait-max)
+if [ -z "$idlemax" ]; then
+    err "ops class wait-max" "not found"
+fi
+echo "wait-max: $idlemax us"
+
+# Each poller sends many gets of the whole list in one session
+echo -n "$DEFAULTHELLO" > $fpoll
+for (( i=0; i<$perfreq * 5; i++ )); do
+    echo -n "$(chunked_framing "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>")" >> $fpoll
+done
+
+new "start $pollers pollers"
+for (( p=0; p<$pollers; p++ )); do
+    (while true; do $clixon_netconf -qef $cfg -U wilma < $fpoll > /dev/null; done) &
+done
+sleep 1
+
+new "$perfreq edits and commits with $pollers pollers"
+rpc=""
+for (( i=0; i<$perfreq; i++ )); do
+    rpc+=$(chunked_framing "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x $NS><y><a>$i</a><b>busy$i</b></y></x></config></edit-config></rpc>")
+    rpc+=$(chunked_framing "<rpc $DEFAULTNS><commit/></rpc>")
+done
+{ time -p echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg -U andy > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+new "ops class max wait with $pollers pollers below $waitbound us"
+busymax=$(sched_stat ops wait-max)
+echo "wait-max: $busymax us"
+if [ -z "$busymax" ] || [ $busymax -ge $waitbound ]; then
+    err "ops class wait-max < $waitbound" "$busymax"
+fi
+
+new "edits were made"
+expecteof_netconf "$clixon_netconf -qf $cfg -U andy" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/sc:x/sc:y[sc:a='$(( $perfreq - 1 ))']\" xmlns:sc=\"urn:example:sched\"/></get-config></rpc>" "<rpc-reply $DEFAULTNS><data><x $NS><y><a>$(( $perfreq - 1 ))</a><b>busy$(( $perfreq - 1 ))</b></y></x></data></rpc-reply>"
+
+new "stop pollers"
+kill $(jobs -p) 2> /dev/null
+wait 2> /dev/null
+sleep 1
+
+new "stats: scheduler classes"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><stats $LIBNS/></rpc>")" | $clixon_netconf -qef $cfg)
+expectpart "$ret" 0 "<scheduler $LIBNS><class><name>ops</name><weight>10</weight><requests>[1-9][0-9]*</requests><queued>0</queued>" "<class><name>poll</name><weight>1</weight><requests>[1-9][0-9]*</requests><queued>0</queued>" "<class><name>default</name><weight>1</weight><requests>[1-9][0-9]*</requests><queued>0</queued>"
+
+new "backend is alive"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/sc:x/sc:y[sc:a='1']\" xmlns:sc=\"urn:example:sched\"/></get-config></rpc>" "<rpc-reply $DEFAULTNS><data><x $NS><y><a>1</a><b>busy1</b></y></x></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+# unset conditional parameters
+unset perfnr
+unset perfreq
+unset pollers
+unset waitbound
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -1,6 +1,7 @@
 #!/usr/bin/env bash
 # CLI compare for all formats
 # Create a diff by committing one set, then add/remove some parts in candidate and show diff in all formats
+# Last, time the compare of a large config
 
 # Magic line must be first in script (see README.md)
 s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
@@ -8,6 +9,9 @@ s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
 APPNAME=example
 # include err() and new() functions and creates $dir
 
+# Number of list entries in large compare
+: ${perfnr:=20000}
+
 cfg=$dir/conf_yang.xml
 clidir=$dir/cli
 fyang=$dir/clixon-example.yang
@@ -94,6 +98,8 @@ show("Show a particular state of the system"){
       json("Show comparison in xml"), compare_dbs("running", "candidate", "json");
       text("Show comparison in text"), compare_dbs("running", "candidate", "text");
       cli("Show comparison in text"), compare_dbs("running", "candidate", "cli", "set ");
+      tree("Show structural comparison"), compare_dbs_diff("running", "candidate", "tree");
+      unified("Show comparison as unified diff"), compare_dbs_diff("running", "candidate", "unified");
    }
    configuration("Show configuration") {
       candidate, cli_show_auto_mode("candidate", "xml", false, false); {
@@ -172,6 +178,15 @@ expectpart "$($clixon_cli -1 -f $cfg show compare xml)" 0 "<table xmlns=\"urn:ex
 new "check compare text"
 expectpart "$($clixon_cli -1 -f $cfg show compare text)" 0 "^\ *table {" "^\-\ *parameter a {" "^+\ *parameter c {" "^\-\ *value \"98\";" "^+\ *value \"99\";"
 
+new "check compare json"
+expectpart "$($clixon_cli -1 -f $cfg show compare json)" 0 "^\-\ *\"name\": \"a\"" "^+\ *\"name\": \"c\"" "^\-\ *\"value\": \"98\"" "^+\ *\"value\": \"99\"" --not-- "^+\ *\"name\": \"a\"" "^\-\ *\"name\": \"c\""
+
+new "check compare tree"
+expectpart "$($clixon_cli -1 -f $cfg show compare tree)" 0 "^- /top/section\[name='x'\]/table/parameter\[name='a'\]$" "^+ /top/section\[name='x'\]/table/parameter\[name='c'\]$" "^~ /top/section\[name='x'\]/table/parameter\[name='d'\]/value: 98 -> 99$" --not-- "parameter\[name='b'\]"
+
+new "check compare unified"
+expectpart "$($clixon_cli -1 -f $cfg show compare unified)" 0 "^@@ -[0-9]\+,[0-9]\+ +[0-9]\+,[0-9]\+ @@$" "^\-\ *<name>a</name>" "^+\ *<name>c</name>" "^\-\ *<value>98</value>" "^+\ *<value>99</value>"
+
 new "delete section x"
 expectpart "$($clixon_cli -1 -f $cfg delete top section x)" 0 "^$"
 
@@ -219,7 +234,37 @@ new "check compare multi text"
 expectpart "$($clixon_cli -1 -f $cfg show compare text)" 0 "^\-\ *parameter a1 a2 {" "^\-\ *17" "^\-\ *18" "^+\ *parameter c1 c2 {" "^+\ *72" "^+\ *73" "^+\ *97" "^\-\ *99" "parameter d1 d2 {"  --not-- "parameter b1 b2 {"
 # XXX --not-- "^+\ *value \["
 
-# NYI: json, cli
+new "check compare multi tree"
+expectpart "$($clixon_cli -1 -f $cfg show compare tree)" 0 "^- /top/section\[name='y'\]/multi/parameter\[first='a1'\]\[second='a2'\]$" "^+ /top/section\[name='y'\]/multi/parameter\[first='c1'\]\[second='c2'\]$" "^- /top/section\[name='y'\]/multi/parameter\[first='d1'\]\[second='d2'\]/value\[.='99'\]$" "^+ /top/section\[name='y'\]/multi/parameter\[first='d1'\]\[second='d2'\]/value\[.='97'\]$" --not-- "first='b1'" "value\[.='98'\]"
+
+# NYI: cli
+
+new "generate $perfnr entries"
+rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><top xmlns=\"urn:example:clixon\"><section><name>z</name><table>"
+for (( i=0; i<$perfnr; i++ )); do
+    rpc+="<parameter><name>$i</name><value>$i</value></parameter>"
+done
+rpc+="</table></section></top></config></edit-config></rpc>"
+echo -n "$DEFAULTHELLO" > $dir/perf.xml
+echo "$(chunked_framing "$rpc")" >> $dir/perf.xml
+
+new "load $perfnr entries"
+expecteof_file "$clixon_netconf -qef $cfg" 0 "$dir/perf.xml" "^<rpc-reply $DEFAULTNS><ok/></rpc-reply>$"
+
+new "commit"
+expectpart "$($clixon_cli -1 -f $cfg commit)" 0 "^$"
+
+new "change first and last entries"
+expectpart "$($clixon_cli -1 -f $cfg set top section z table parameter 0 value new0)" 0 "^$"
+expectpart "$($clixon_cli -1 -f $cfg set top section z table parameter $(( $perfnr - 1 )) value new)" 0 "^$"
+
+new "check large compare json"
+expectpart "$($clixon_cli -1 -f $cfg show compare json)" 0 "^+\ *\"value\": \"new0\"" "^+\ *\"value\": \"new\""
+
+for f in xml json text; do
+    new "compare $f time with $perfnr entries"
+    { time -p $clixon_cli -1 -f $cfg show compare $f > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+done
 
 if [ $BE -ne 0 ]; then
     new "Kill backend"
@@ -0,0 +1,165 @@
+#!/usr/bin/env bash
+# CLI command server: clixon_cli -S <sock> serves commands of thin clients clixon_cli -x <sock>
+# 1. Commands are run with output and exit status of each request
+# 2. Mode is per request and restored after
+# 3. Server survives quit and errors
+# 4. Time of one-shot commands with and without server
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Number of one-shot commands in timing tests
+: ${perfreq:=20}
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+clidir=$dir/clidir
+sock=$dir/cli.sock
+
+if [ ! -d $clidir ]; then
+    mkdir $clidir
+fi
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_CLISPEC_DIR>$clidir</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  container table{
+     list parameter{
+        key name;
+        leaf name{
+           type string;
+        }
+        leaf value{
+           type string;
+        }
+     }
+  }
+}
+EOF
+
+cat <<EOF > $clidir/example.cli
+CLICON_MODE="example";
+CLICON_PROMPT="%U@%H %W> ";
+
+set @datamodel, cli_auto_set();
+delete("Delete a configuration item") {
+      @datamodel, cli_auto_del();
+      all("Delete whole candidate configuration"), delete_all("candidate");
+}
+show("Show"){
+      xml("Show configuration as XML"), cli_show_config("candidate", "xml", "/", NULL, false);
+      cli("Show configuration as indented CLI"), cli_show_config("candidate", "cli", "/", NULL, true, false, NULL, "   set ");
+}
+quit("Quit"), cli_quit();
+EOF
+
+cat <<EOF > $clidir/other.cli
+CLICON_MODE="other";
+CLICON_PROMPT="%U@%H %W> ";
+
+show("Show"){
+      other("Show other"), cli_show_config("candidate", "xml", "/table/parameter[name='a']/value", "urn:example:clixon", false);
+}
+EOF
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -z -f $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "start cli server on $sock"
+$clixon_cli -1 -f $cfg -S $sock &
+pid=$!
+for (( i=0; i<50; i++ )); do
+    if [ -S $sock ]; then
+        break
+    fi
+    sleep 0.1
+done
+if [ ! -S $sock ]; then
+    err "cli server socket $sock" "not found"
+fi
+
+new "set parameter"
+expectpart "$($clixon_cli -x $sock set table parameter a value 42)" 0 "^$"
+
+new "show parameter"
+expectpart "$($clixon_cli -x $sock show xml)" 0 "<table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>42</value></parameter></table>"
+
+new "leading whitespace of output is kept"
+expectpart "$($clixon_cli -x $sock show cli)" 0 "^   set table parameter a value 42"
+
+new "two commands in one request"
+expectpart "$($clixon_cli -x $sock set table parameter b value 7\; show xml)" 0 "<parameter><name>b</name><value>7</value></parameter>"
+
+new "syntax error has exit status"
+expectpart "$($clixon_cli -x $sock show nonexistent 2>&1)" 1 "CLI syntax error"
+
+new "other mode"
+expectpart "$($clixon_cli -x $sock -m other show other)" 0 "<value>42</value>" --not-- "<name>b</name>"
+
+new "mode is restored"
+expectpart "$($clixon_cli -x $sock show xml)" 0 "<name>b</name>"
+
+new "no such mode"
+expectpart "$($clixon_cli -x $sock -m nonexistent show xml 2>&1)" 1 "No such cli mode"
+
+new "quit does not stop server"
+expectpart "$($clixon_cli -x $sock quit)" 0 "^$"
+
+new "server is alive"
+expectpart "$($clixon_cli -x $sock show xml)" 0 "<name>a</name>"
+
+new "$perfreq one-shot commands without server"
+{ time -p for (( i=0; i<$perfreq; i++ )); do $clixon_cli -1 -f $cfg show xml > /dev/null; done; } 2>&1 | awk '/real/ {print $2}'
+
+new "$perfreq one-shot commands with server"
+{ time -p for (( i=0; i<$perfreq; i++ )); do $clixon_cli -x $sock show xml > /dev/null; done; } 2>&1 | awk '/real/ {print $2}'
+
+new "stop cli server"
+kill $pid
+wait $pid 2> /dev/null
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,149 @@
+#!/usr/bin/env bash
+# Event loop statistics and watchdog, see CLICON_EVENT_WATCHDOG
+# Callbacks are timed per handler and timer lag is measured, shown by the stats rpc
+# A quadratic xpath over a large list holds the backend loop longer than the watchdog
+# 1. Backend event-loop statistics via netconf
+# 2. Watchdog log of handler holding the loop
+# 3. Backend and restconf event-loop statistics via restconf
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Number of list entries
+: ${perfnr:=5000}
+
+# Watchdog threshold in ms
+: ${watchdog:=50}
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/event.yang
+fconfig=$dir/large.xml
+flog=$dir/backend.log
+
+# Define default restconfig config: RESTCONFIG
+RESTCONFIG=$(restconf_config none false)
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_EVENT_WATCHDOG>$watchdog</CLICON_EVENT_WATCHDOG>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module event{
+  yang-version 1.1;
+  namespace "urn:example:event";
+  prefix ev;
+  container x{
+    list y{
+      key a;
+      leaf a{
+        type int32;
+      }
+      leaf b{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+NS="xmlns=\"urn:example:event\""
+OK="<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+# Quadratic xpath: count of whole list is evaluated for each entry, matches nothing
+SLOW="<get-config><source><running/></source><filter type=\"xpath\" select=\"/ev:x/ev:y[ev:a=count(/ev:x/ev:y)]\" xmlns:ev=\"urn:example:event\"/></get-config>"
+BUCKETS="<bucket><le>1ms</le><count>[0-9]\+</count></bucket><bucket><le>10ms</le><count>[0-9]\+</count></bucket><bucket><le>100ms</le><count>[0-9]\+</count></bucket><bucket><le>1s</le><count>[0-9]\+</count></bucket><bucket><le>inf</le><count>[0-9]\+</count></bucket>"
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    # -n: example stream timer every 5s, for timer lag
+    new "start backend -s init -f $cfg -l f$flog -- -n"
+    start_backend -s init -f $cfg -l f$flog -- -n
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+fi
+
+new "wait restconf"
+wait_restconf
+
+new "generate $perfnr entries"
+rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><default-operation>replace</default-operation><config><x $NS>"
+for (( i=0; i<$perfnr; i++ )); do
+    rpc+="<y><a>$i</a><b>$i</b></y>"
+done
+rpc+="</x></config></edit-config></rpc>"
+echo -n "$DEFAULTHELLO" > $fconfig
+echo "$(chunked_framing "$rpc")" >> $fconfig
+
+new "load $perfnr entries"
+expecteof_file "$clixon_netconf -qef $cfg" 0 "$fconfig" "^$OK$"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "$OK"
+
+new "slow query"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$SLOW</rpc>" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "wait for example stream timer"
+sleep 6
+
+new "stats: backend event loop"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><stats $LIBNS/></rpc>")" | $clixon_netconf -qef $cfg)
+expectpart "$ret" 0 "<event-loop $LIBNS><process>backend</process><lag><calls>[1-9][0-9]*</calls><time-total>[0-9]\+</time-total><time-max>[0-9]\+</time-max>$BUCKETS</lag>" "<handler><name>server socket</name><calls>[1-9][0-9]*</calls>" "<handler><name>example stream timer</name><calls>[1-9][0-9]*</calls>"
+
+new "stats: max time of client handler is at least 10ms"
+expectpart "$ret" 0 "<handler><name>local netconf client socket</name><calls>[1-9][0-9]*</calls><time-total>[0-9]\+</time-total><time-max>[0-9]\{5,\}</time-max>"
+
+new "watchdog logs handler holding the loop"
+ret=$(sudo cat $flog)
+expectpart "$ret" 0 "Event watchdog: local netconf client socket held event loop [0-9]\+ ms" --not-- "Event watchdog: server socket"
+
+new "restconf stats: backend and restconf event loop"
+expectpart "$(curl $CURLOPTS -X POST -H "Accept: application/yang-data+json" $RCPROTO://localhost/restconf/operations/clixon-lib:stats)" 0 "HTTP/$HVER 200" '"event-loop":\[{"process":"backend"' '{"process":"restconf","lag":{"calls":"[0-9]\+"'
+
+if [ $RC -ne 0 ]; then
+    new "Kill restconf daemon"
+    stop_restconf
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
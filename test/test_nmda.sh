@@ -0,0 +1,256 @@
+#!/usr/bin/env bash
+# NMDA get-data and edit-data, RFC 8526, see CLICON_NETCONF_NMDA
+# Config and state in an interface list, where state is given by example backend plugin
+# 1. get-data of conventional and operational datastores
+# 2. config-filter, origin-filter, max-depth and with-origin
+# 3. xpath and subtree filters
+# 4. edit-data, and subtree filters with quotes
+# 5. Time of get-data with filters compared to get with client-side filtering
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Number of list entries in timing tests
+: ${perfnr:=20000}
+
+# Number of requests made in timing tests
+: ${perfreq:=10}
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/nmda.yang
+fstate=$dir/state.xml
+fconfig=$dir/large.xml
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_REGEXP>example_backend.so$</CLICON_BACKEND_REGEXP>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_NETCONF_NMDA>true</CLICON_NETCONF_NMDA>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module nmda{
+  yang-version 1.1;
+  namespace "urn:example:nmda";
+  prefix ex;
+  container interfaces{
+    list interface{
+      key name;
+      leaf name{
+        type string;
+      }
+      leaf type{
+        type string;
+      }
+      leaf enabled{
+        type boolean;
+        default true;
+      }
+      leaf status{
+        type string;
+        config false;
+      }
+    }
+  }
+}
+EOF
+
+NS="xmlns=\"urn:example:nmda\""
+NMDANS="xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-nmda\""
+DSNS="xmlns:ds=\"urn:ietf:params:xml:ns:yang:ietf-datastores\""
+ORNS="xmlns:or=\"urn:ietf:params:xml:ns:yang:ietf-origin\""
+OK="<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+# get-data rpc of datastore $1 with other input parameters $2
+function getdata(){
+    echo "<rpc $DEFAULTNS><get-data $NMDANS $DSNS><datastore>ds:$1</datastore>$2</get-data></rpc>"
+}
+
+new "generate state file"
+echo "<interfaces $NS><interface><name>e0</name><status>up</status></interface><interface><name>e1</name><status>down</status></interface></interfaces>" > $fstate
+
+new "test params: -f $cfg -- -sS $fstate"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg -- -sS $fstate"
+    start_backend -s init -f $cfg -- -sS $fstate
+fi
+
+new "wait backend"
+wait_backend
+
+new "edit-data running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-data $NMDANS $DSNS><datastore>ds:running</datastore><config><interfaces $NS><interface><name>e0</name><type>eth</type></interface><interface><name>e1</name><type>eth</type></interface></interfaces></config></edit-data></rpc>" "$OK"
+
+new "edit-data operational is not writable"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-data $NMDANS $DSNS><datastore>ds:operational</datastore><config><interfaces $NS><interface><name>e2</name></interface></interfaces></config></edit-data></rpc>" "<error-tag>invalid-value</error-tag>"
+
+new "get-data running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(getdata running)" "<rpc-reply $DEFAULTNS><data $NMDANS><interfaces $NS><interface><name>e0</name><type>eth</type></interface><interface><name>e1</name><type>eth</type></interface></interfaces></data></rpc-reply>"
+
+new "get-data intended"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(getdata intended)" "<rpc-reply $DEFAULTNS><data $NMDANS><interfaces $NS><interface><name>e0</name><type>eth</type></interface><interface><name>e1</name><type>eth</type></interface></interfaces></data></rpc-reply>"
+
+new "get-data operational"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(getdata operational)" "<rpc-reply $DEFAULTNS><data $NMDANS><interfaces $NS><interface><name>e0</name><type>eth</type><status>up</status></interface><interface><name>e1</name><type>eth</type><status>down</status></interface></interfaces></data></rpc-reply>"
+
+new "get-data unsupported datastore"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(getdata dynamic)" "<error-tag>invalid-value</error-tag>"
+
+new "get-data operational config-filter true"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(getdata operational "<config-filter>true</config-filter>")" "<rpc-reply $DEFAULTNS><data $NMDANS><interfaces $NS><interface><name>e0</name><type>eth</type></interface><interface><name>e1</name><type>eth</type></interface></interfaces></data></rpc-reply>"
+
+new "get-data operational config-filter false"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(getdata operational "<config-filter>false</config-filter>")" "<rpc-reply $DEFAULTNS><data $NMDANS><interfaces $NS><interface><name>e0</name><status>up</status></interface><interface><name>e1</name><status>down</status></interface></interfaces></data></rpc-reply>"
+
+new "get-data running config-filter false is empty"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(getdata running "<config-filter>false</config-filter>")" "<rpc-reply $DEFAULTNS><data $NMDANS/></rpc-reply>"
+
+new "get-data operational xpath-filter"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(getdata operational "<xpath-filter xmlns:ex=\"urn:example:nmda\">/ex:interfaces/ex:interface[ex:name='e1']</xpath-filter>")" "<rpc-reply $DEFAULTNS><data $NMDANS><interfaces $NS><interface><name>e1</name><type>eth</type><status>down</status></interface></interfaces></data></rpc-reply>"
+
+new "get-data operational subtree-filter"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(getdata operational "<subtree-filter><interfaces $NS><interface><name>e0</name></interface></interfaces></subtree-filter>")" "<rpc-reply $DEFAULTNS><data $NMDANS><interfaces $NS><interface><name>e0</name><type>eth</type><status>up</status></interface></interfaces></data></rpc-reply>"
+
+new "get-data max-depth"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(getdata operational "<max-depth>1</max-depth>")" "<rpc-reply $DEFAULTNS><data $NMDANS><interfaces $NS/></data></rpc-reply>"
+
+new "get-data with-origin"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "$(getdata operational "<with-origin/>")")" | $clixon_netconf -qef $cfg)
+expectpart "$ret" 0 "$ORNS" "<interfaces $NS or:origin=\"or:intended\"><interface><name>e0</name><type>eth</type><status>up</status></interface>"
+
+new "get-data with-origin and defaults"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "$(getdata operational "<with-origin/><with-defaults>report-all</with-defaults>")")" | $clixon_netconf -qef $cfg)
+expectpart "$ret" 0 "<interface><name>e0</name><type>eth</type><enabled or:origin=\"or:default\">true</enabled><status>up</status></interface>"
+
+new "get-data origin-filter default"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "$(getdata operational "<origin-filter $ORNS>or:default</origin-filter><with-defaults>report-all</with-defaults>")")" | $clixon_netconf -qef $cfg)
+expectpart "$ret" 0 "<interface><name>e0</name><enabled>true</enabled><status>up</status></interface>"
+
+new "get-data negated-origin-filter intended and config-filter true"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "$(getdata operational "<config-filter>true</config-filter><negated-origin-filter $ORNS>or:intended</negated-origin-filter><with-defaults>report-all</with-defaults>")")" | $clixon_netconf -qef $cfg)
+expectpart "$ret" 0 "<interface><name>e0</name><enabled>true</enabled></interface>"
+
+new "get-data with-origin of running is invalid"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(getdata running "<with-origin/>")" "<error-tag>invalid-value</error-tag>"
+
+new "edit-data candidate replace"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-data $NMDANS $DSNS><datastore>ds:candidate</datastore><default-operation>replace</default-operation><config><interfaces $NS><interface><name>e2</name><type>lo</type></interface></interfaces></config></edit-data></rpc>" "$OK"
+
+new "get-data candidate"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(getdata candidate)" "<rpc-reply $DEFAULTNS><data $NMDANS><interfaces $NS><interface><name>e2</name><type>lo</type></interface></interfaces></data></rpc-reply>"
+
+new "edit-data candidate with prefix declared on config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-data $NMDANS $DSNS><datastore>ds:candidate</datastore><config xmlns:ex=\"urn:example:nmda\"><ex:interfaces><ex:interface><ex:name>e'3</ex:name><ex:type>q1</ex:type></ex:interface><ex:interface><ex:name>e\"4</ex:name><ex:type>q2</ex:type></ex:interface></ex:interfaces></config></edit-data></rpc>" "$OK"
+
+new "get-data subtree-filter value with '"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(getdata candidate "<subtree-filter><interfaces $NS><interface><name>e'3</name></interface></interfaces></subtree-filter>")" "<type>q1</type></interface></interfaces></data></rpc-reply>"
+
+new "get-data subtree-filter value with \""
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(getdata candidate "<subtree-filter><interfaces $NS><interface><name>e&quot;4</name></interface></interfaces></subtree-filter>")" "<type>q2</type></interface></interfaces></data></rpc-reply>"
+
+new "get-data subtree-filter value with ' and \" is invalid"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(getdata candidate "<subtree-filter><interfaces $NS><interface><name>e'&quot;</name></interface></interfaces></subtree-filter>")" "<error-tag>invalid-value</error-tag>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+new "generate state file with $perfnr entries"
+echo -n "<interfaces $NS>" > $fstate
+for (( i=0; i<$perfnr; i++ )); do
+    echo -n "<interface><name>e$i</name><status>up</status></interface>" >> $fstate
+done
+echo "</interfaces>" >> $fstate
+
+if [ $BE -ne 0 ]; then
+    new "start backend -s init -f $cfg -- -sS $fstate"
+    start_backend -s init -f $cfg -- -sS $fstate
+fi
+
+new "wait backend"
+wait_backend
+
+new "generate $perfnr entries"
+rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><default-operation>replace</default-operation><config><interfaces $NS>"
+for (( i=0; i<$perfnr; i++ )); do
+    rpc+="<interface><name>e$i</name><type>eth</type></interface>"
+done
+rpc+="</interfaces></config></edit-config></rpc>"
+echo -n "$DEFAULTHELLO" > $fconfig
+echo "$(chunked_framing "$rpc")" >> $fconfig
+
+new "load $perfnr entries"
+expecteof_file "$clixon_netconf -qef $cfg" 0 "$fconfig" "^$OK$"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "$OK"
+
+new "$perfreq get with client-side config filtering"
+rpc=""
+for (( i=0; i<$perfreq; i++ )); do
+    rpc+=$(chunked_framing "<rpc $DEFAULTNS><get/></rpc>")
+done
+{ time -p echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg | sed -e 's/<status>[^<]*<\/status>//g' > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+new "$perfreq get-data with config-filter true"
+rpc=""
+for (( i=0; i<$perfreq; i++ )); do
+    rpc+=$(chunked_framing "$(getdata operational "<config-filter>true</config-filter>")")
+done
+{ time -p echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+new "$perfreq get with client-side state filtering"
+rpc=""
+for (( i=0; i<$perfreq; i++ )); do
+    rpc+=$(chunked_framing "<rpc $DEFAULTNS><get/></rpc>")
+done
+{ time -p echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg | sed -e 's/<type>[^<]*<\/type>//g' > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+new "$perfreq get-data with config-filter false"
+rpc=""
+for (( i=0; i<$perfreq; i++ )); do
+    rpc+=$(chunked_framing "$(getdata operational "<config-filter>false</config-filter>")")
+done
+{ time -p echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+new "get-data with config-filter true of $perfnr entries"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "$(getdata operational "<config-filter>true</config-filter>")")" | $clixon_netconf -qef $cfg)
+expectpart "$ret" 0 "<interface><name>e$(( $perfnr - 1 ))</name><type>eth</type></interface>" --not-- "<status>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,181 @@
+#!/usr/bin/env bash
+# Identityref validation and derived-from() using the identity derivation index
+# An identity hierarchy with several levels and multiple bases is generated, and a list
+# with an identityref leaf in each entry.
+# 1. Derived identities validate, base and unrelated identities fail
+# 2. derived-from() and derived-from-or-self() in must expressions
+# 3. Validation time of a large list of identityrefs
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Number of list entries
+: ${perfnr:=20000}
+
+# Number of generated identities per level
+: ${idnr:=100}
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/ident.yang
+fbase=$dir/ident-base.yang
+fperf=$dir/perf.xml
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+</clixon-config>
+EOF
+
+# Base module: if-type <- eth-type <- ethN, and if-type <- virt-type
+cat <<EOF > $fbase
+module ident-base{
+  yang-version 1.1;
+  namespace "urn:example:ident-base";
+  prefix ib;
+  identity if-type;
+  identity eth-type{
+    base if-type;
+  }
+  identity virt-type{
+    base if-type;
+  }
+  identity other;
+EOF
+for (( i=0; i<$idnr; i++ )); do
+    echo "  identity eth$i{ base eth-type; }" >> $fbase
+done
+echo "}" >> $fbase
+
+# Main module: vethN derived from both eth-type (via ethN) and virt-type
+cat <<EOF > $fyang
+module ident{
+  yang-version 1.1;
+  namespace "urn:example:ident";
+  prefix id;
+  import ident-base{
+    prefix ib;
+  }
+EOF
+for (( i=0; i<$idnr; i++ )); do
+    echo "  identity veth$i{ base ib:eth$i; base ib:virt-type; }" >> $fyang
+done
+cat <<EOF >> $fyang
+  container interfaces{
+    list interface{
+      key name;
+      leaf name{
+        type int32;
+      }
+      leaf type{
+        type identityref{
+          base ib:if-type;
+        }
+      }
+      leaf eth{
+        type identityref{
+          base ib:eth-type;
+        }
+        must "derived-from(., 'ib:eth-type')";
+      }
+      leaf virt{
+        type identityref{
+          base ib:if-type;
+        }
+        must "derived-from-or-self(., 'ib:virt-type')";
+      }
+    }
+  }
+}
+EOF
+
+NS="xmlns=\"urn:example:ident\""
+NSB="xmlns:ib=\"urn:example:ident-base\""
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+# Edit entry 1 and validate
+# 1: leaf name
+# 2: value
+# 3: expected validate reply
+function check(){
+    new "set $1 $2"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><default-operation>replace</default-operation><config><interfaces $NS><interface><name>1</name><$1 $NSB>$2</$1></interface></interfaces></config></edit-config></rpc>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+    new "validate $1 $2"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "$3"
+}
+
+OK="<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+check type ib:eth-type "$OK"
+check type ib:eth7 "$OK"
+check type id:veth7 "$OK"
+check type veth$(( $idnr - 1 )) "$OK"
+check type ib:if-type "Identityref validation failed, ib:if-type not derived from if-type"
+check type ib:other "Identityref validation failed, ib:other not derived from if-type"
+check type ib:foo "Identityref validation failed, ib:foo not derived from if-type"
+check type xx:eth7 "Identityref validation failed, xx:eth7 not derived from if-type"
+check eth id:veth3 "$OK"
+check eth ib:virt-type "Identityref validation failed, ib:virt-type not derived from eth-type"
+check virt id:veth3 "$OK"
+check virt ib:virt-type "$OK"
+check virt ib:eth3 "Failed MUST xpath"
+
+new "discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "$OK"
+
+new "generate $perfnr entries"
+rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><default-operation>replace</default-operation><config><interfaces $NS $NSB>"
+for (( i=0; i<$perfnr; i++ )); do
+    j=$(( $i % $idnr ))
+    rpc+="<interface><name>$i</name><type>id:veth$j</type><eth>ib:eth$j</eth><virt>id:veth$j</virt></interface>"
+done
+rpc+="</interfaces></config></edit-config></rpc>"
+echo -n "$DEFAULTHELLO" > $fperf
+echo "$(chunked_framing "$rpc")" >> $fperf
+
+new "load $perfnr entries"
+expecteof_file "$clixon_netconf -qef $cfg" 0 "$fperf" "^$OK$"
+
+new "validate $perfnr entries"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "$OK"
+
+new "validate time with $perfnr entries"
+rpc=$(chunked_framing "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>")
+{ time -p echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,199 @@
+#!/usr/bin/env bash
+# Multi-client load using clixon_loadgen
+# Run a mix of get, edit, commit and subscribe from concurrent sessions over the internal
+# socket, NETCONF and RESTCONF HTTP/1 and HTTP/2, and check there are no errors.
+# Throughput and latency percentiles are printed as JSON.
+# To catch regressions, save results as baselines on a given host with save=true, and
+# compare later runs on the same host by setting baselinedir:
+#   baselinedir=/var/tmp/loadgen save=true ./test_perf_loadgen.sh
+#   baselinedir=/var/tmp/loadgen ./test_perf_loadgen.sh
+# Baselines are labelled with host and test parameters in loadgen-env.txt, and are only
+# compared if the label matches. No reference baselines are included in the source tree.
+
+# Use plain http for native restconf
+RCPROTO=http
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Number of concurrent sessions
+: ${sessions:=8}
+
+# Number of requests per session
+: ${perfreq:=200}
+
+# Number of list entries edited
+: ${perfnr:=1000}
+
+# Directory of baseline results, no regression check if not set
+: ${baselinedir:=}
+
+# Save results as new baselines
+: ${save:=false}
+
+# Regression tolerance in percent
+: ${tolerance:=20}
+
+: ${clixon_loadgen:=clixon_loadgen}
+
+APPNAME=example
+
+cfg=$dir/loadgen-conf.xml
+fyang=$dir/scaling.yang
+
+cat <<EOF > $fyang
+module scaling{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container x {
+    list y {
+      key "a";
+      leaf a {
+        type int32;
+      }
+      leaf b {
+        type int32;
+      }
+    }
+  }
+}
+EOF
+
+# Define default restconfig config: RESTCONFIG
+RESTCONFIG=$(restconf_config none false)
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_RESTCONF_HTTP2_PLAIN>true</CLICON_RESTCONF_HTTP2_PLAIN>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+NS="urn:example:clixon"
+
+# Label of host and test parameters that baselines were produced with
+function loadgen_env(){
+    echo "host: $(uname -n) $(uname -s) $(uname -r) $(uname -m)"
+    echo "cpus: $(getconf _NPROCESSORS_ONLN)"
+    echo "clixon: $($clixon_loadgen -V 2>/dev/null | head -1)"
+    echo "params: sessions=$sessions perfreq=$perfreq perfnr=$perfnr"
+}
+
+loadgen_env > $dir/loadgen-env.txt
+if [ -n "$baselinedir" -a $save = true ]; then
+    mkdir -p $baselinedir
+    cp $dir/loadgen-env.txt $baselinedir/
+elif [ -n "$baselinedir" ]; then
+    if ! cmp -s $dir/loadgen-env.txt $baselinedir/loadgen-env.txt; then
+        echo "Baselines in $baselinedir are from another host or parameters, not compared:"
+        diff $baselinedir/loadgen-env.txt $dir/loadgen-env.txt
+        baselinedir=
+    fi
+fi
+
+# Run load generator, check result and compare with baseline
+# 1: protocol
+# 2-: extra load generator options
+function loadgen(){
+    proto=$1
+    shift
+    res=$dir/loadgen-$proto.json
+    base=
+    if [ -n "$baselinedir" -a $save = false -a -f $baselinedir/loadgen-$proto.json ]; then
+        base="-b $baselinedir/loadgen-$proto.json -T $tolerance"
+    fi
+    new "loadgen $proto: $sessions sessions x $perfreq requests"
+    echo "$clixon_loadgen -l e -f $cfg -P $proto -c $sessions -n $perfreq -r $perfnr $base $@"
+    $clixon_loadgen -l e -f $cfg -P $proto -c $sessions -n $perfreq -r $perfnr $base "$@" > $res
+    r=$?
+    cat $res
+    if [ $r -eq 1 ]; then
+        err "No regression compared to $baselinedir/loadgen-$proto.json" "$(cat $res)"
+    elif [ $r -ne 0 ]; then
+        err "loadgen retval 0" "$r"
+    fi
+    match=$(grep -c "\"requests\":$(( $sessions * $perfreq )),\"errors\":0," $res)
+    if [ $match -eq 0 ]; then
+        err "$(( $sessions * $perfreq )) requests without errors" "$(cat $res)"
+    fi
+    if [ -n "$baselinedir" -a $save = true ]; then
+        mkdir -p $baselinedir
+        cp $res $baselinedir/
+    fi
+}
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+fi
+
+new "wait restconf"
+wait_restconf
+
+new "Add entry read by get"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"$NS\"><y><a>1</a><b>1</b></y></x></config></edit-config></rpc>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "Commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+edit="<x xmlns=\"$NS\"><y><a>%u</a><b>%u</b></y></x>"
+
+loadgen internal -m get=60,edit=30,commit=9,subscribe=1 -g "/ex:x/ex:y[ex:a='1']" -N ex:$NS -e "$edit"
+
+loadgen netconf -m get=60,edit=30,commit=10 -g "/ex:x/ex:y[ex:a='1']" -N ex:$NS -e "$edit"
+
+if [ ${HAVE_HTTP1} = true ]; then
+    loadgen http1 -m get=70,edit=30 -g /restconf/data/scaling:x/y=1 -p /restconf/data/scaling:x/y=%u -e "<y xmlns=\"$NS\"><a>%u</a><b>%u</b></y>"
+fi
+
+if [ ${HAVE_LIBNGHTTP2} = true ]; then
+    loadgen http2 -m get=70,edit=30 -g /restconf/data/scaling:x/y=1 -p /restconf/data/scaling:x/y=%u -e "<y xmlns=\"$NS\"><a>%u</a><b>%u</b></y>"
+fi
+
+if [ $RC -ne 0 ]; then
+    new "Kill restconf daemon"
+    stop_restconf
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
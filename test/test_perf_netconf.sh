@@ -137,6 +137,25 @@ if [ $? -ne 0 ]; then
     err1 "Matching running-db with $fconfigonly"
 fi      
 
+new "Check running-db contents with forwarded reply"
+rpc=$(chunked_framing "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>")
+echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg -o CLICON_NETCONF_FORWARD=true > $foutput
+
+ret=$(diff $ftest $foutput)
+if [ $? -ne 0 ]; then
+    err1 "Matching forwarded running-db with $fconfigonly"
+fi      
+
+# Compare time and max RSS of netconf client for large get-config, parsed and forwarded reply
+for forward in false true; do
+    new "netconf get large config forward=$forward"
+    if [ -x /usr/bin/time ]; then
+        echo "$DEFAULTHELLO$rpc" | /usr/bin/time -f "%e s %M kB" $clixon_netconf -qef $cfg -o CLICON_NETCONF_FORWARD=$forward 2>&1 > /dev/null | tail -1
+    else
+        { time -p echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg -o CLICON_NETCONF_FORWARD=$forward > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+    fi
+done
+
 # Now commit it again from candidate (validation takes time when
 # comparing to existing)
 
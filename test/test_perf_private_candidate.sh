@@ -0,0 +1,169 @@
+#!/usr/bin/env bash
+# Concurrent edits: private candidates vs shared candidate with locks
+# See CLICON_XMLDB_PRIVATE_CANDIDATE
+# N sessions each make a number of edit and commit cycles on separate list entries
+# 1. With private candidates: edit-config, commit
+# 2. With shared candidate: lock, edit-config, commit, unlock, retried until the lock is taken
+# Total time of each workflow is printed, and running is checked to contain all entries
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Number of concurrent sessions
+: ${sessions:=10}
+
+# Number of edit and commit cycles per session
+: ${perfreq:=10}
+
+# time function (this is a mess to get right on freebsd/linux)
+: ${TIMEFN:=time -p} # portability: 2>&1 | awk '/real/ {print $2}'
+if ! $TIMEFN true; then err "A working time function" "'$TIMEFN' does not work"; fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/private.yang
+
+cat <<EOF > $fyang
+module private{
+  yang-version 1.1;
+  namespace "urn:example:private";
+  prefix p;
+  container c{
+    list a{
+      key k;
+      leaf k{
+        type string;
+      }
+      leaf v{
+        type int32;
+      }
+    }
+  }
+}
+EOF
+
+NS="xmlns=\"urn:example:private\""
+
+# Write backend config
+# Args:
+# 1: true: private candidates, false: shared candidate
+function mkconfig(){
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_XMLDB_PRIVATE_CANDIDATE>$1</CLICON_XMLDB_PRIVATE_CANDIDATE>
+</clixon-config>
+EOF
+}
+
+# Edit-config of entry with key $1 and value $2
+function edit(){
+    echo "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c $NS><a><k>$1</k><v>$2</v></a></c></config></edit-config></rpc>"
+}
+
+# One session of private candidate workflow
+# Args:
+# 1: session number
+function session_private(){
+    n=$1
+    for (( j=0; j<$perfreq; j++ )); do
+        rpc="$DEFAULTHELLO$(chunked_framing "$(edit s$n $j)")$(chunked_framing "<rpc $DEFAULTNS><commit/></rpc>")"
+        ret=$(echo "$rpc" | $clixon_netconf -qef $cfg)
+        if [ $(echo "$ret" | grep -c "rpc-error") -ne 0 ]; then
+            echo "session $n: $ret" >> $dir/errors
+        fi
+    done
+}
+
+# One session of shared candidate workflow, each cycle is retried until the lock is taken
+# Args:
+# 1: session number
+function session_shared(){
+    n=$1
+    for (( j=0; j<$perfreq; j++ )); do
+        rpc="$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><lock><target><candidate/></target></lock></rpc>")$(chunked_framing "$(edit s$n $j)")$(chunked_framing "<rpc $DEFAULTNS><commit/></rpc>")$(chunked_framing "<rpc $DEFAULTNS><unlock><target><candidate/></target></unlock></rpc>")"
+        while true; do
+            ret=$(echo "$rpc" | $clixon_netconf -qef $cfg)
+            if [ $(echo "$ret" | grep -c "rpc-error") -eq 0 ]; then
+                break
+            fi
+            if [ $(echo "$ret" | grep -c "lock-denied\|in-use") -eq 0 ]; then
+                echo "session $n: $ret" >> $dir/errors
+                break
+            fi
+        done
+    done
+}
+
+# Run concurrent sessions and check result
+# Args:
+# 1: true: private candidates, false: shared candidate
+function testrun(){
+    private=$1
+    if $private; then
+        fn=session_private
+    else
+        fn=session_shared
+    fi
+    mkconfig $private
+    rm -f $dir/errors
+
+    new "test params: -f $cfg"
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s init -f $cfg"
+        start_backend -s init -f $cfg
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "$sessions sessions x $perfreq edit and commit, private candidate: $private"
+    { $TIMEFN bash -c "for (( i=0; i<$sessions; i++ )); do $fn \$i & done; wait"; } 2>&1 | awk '/real/ {print $2}'
+
+    new "No errors"
+    if [ -f $dir/errors ]; then
+        err "no errors" "$(head -5 $dir/errors)"
+    fi
+
+    new "Running contains entries of all sessions"
+    ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>")" | $clixon_netconf -qef $cfg)
+    match=$(echo "$ret" | grep -o "<v>$(( $perfreq - 1 ))</v>" | wc -l)
+    if [ $match -ne $sessions ]; then
+        err "$sessions entries" "$match"
+    fi
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+# Functions and variables used by sessions in sub-shells
+export -f edit session_private session_shared chunked_framing
+export DEFAULTHELLO DEFAULTNS NS cfg dir clixon_netconf perfreq
+
+testrun true
+testrun false
+
+rm -rf $dir
+
+new "endtest"
+endtest
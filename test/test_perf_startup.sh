@@ -159,6 +159,13 @@ for variant in prefix plain pretty; do
     { time -p sudo $clixon_backend -F1 -D $DBG -s $mode -f $cfg -y $fyang -o CLICON_XMLDB_FORMAT=$format 2> /dev/null; } 2>&1 | awk '/real/ {print $2}'
 done
 
+# Trusted startup: first run saves digest, second skips validation
+cp $sx $sdb
+sudo rm -f $dir/validated.digest
+sudo $clixon_backend -F1 -D $DBG -s $mode -f $cfg -y $fyang -o CLICON_XMLDB_FORMAT=$format -o CLICON_STARTUP_DIGEST=true 2> /dev/null
+new "Startup $format plain trusted digest"
+{ time -p sudo $clixon_backend -F1 -D $DBG -s $mode -f $cfg -y $fyang -o CLICON_XMLDB_FORMAT=$format -o CLICON_STARTUP_DIGEST=true 2> /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
 rm -rf $dir
 
 new "endtest"
@@ -0,0 +1,156 @@
+#!/usr/bin/env bash
+# Key lookup in large ordered-by user lists using the implicit key index
+# The list is loaded in reverse key order, which is kept since the list is ordered-by user
+# 1. Get, merge and delete of single entries by key
+# 2. Insert before/after an entry given by key
+# 3. Order is preserved after edits
+# 4. Time of edits and inserts in a large list
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Number of list entries
+: ${perfnr:=20000}
+
+# Number of requests made in timing tests
+: ${perfreq:=20}
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/userorder.yang
+fconfig=$dir/large.xml
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module userorder{
+  yang-version 1.1;
+  namespace "urn:example:userorder";
+  prefix uo;
+  container acl{
+    list rule{
+      ordered-by user;
+      key "name seq";
+      leaf name{
+        type string;
+      }
+      leaf seq{
+        type int32;
+      }
+      leaf action{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+NS="xmlns=\"urn:example:userorder\""
+YNS="xmlns:yang=\"urn:ietf:params:xml:ns:yang:1\""
+OK="<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "generate $perfnr entries in reverse order"
+rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><default-operation>replace</default-operation><config><acl $NS>"
+for (( i=$perfnr-1; i>=0; i-- )); do
+    rpc+="<rule><name>r$i</name><seq>$i</seq><action>permit</action></rule>"
+done
+rpc+="</acl></config></edit-config></rpc>"
+echo -n "$DEFAULTHELLO" > $fconfig
+echo "$(chunked_framing "$rpc")" >> $fconfig
+
+new "load $perfnr entries"
+expecteof_file "$clixon_netconf -qef $cfg" 0 "$fconfig" "^$OK$"
+
+mid=$(( $perfnr / 2 ))
+
+new "get entry $mid"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/uo:acl/uo:rule[uo:name='r$mid'][uo:seq='$mid']\" xmlns:uo=\"urn:example:userorder\"/></get-config></rpc>" "<rpc-reply $DEFAULTNS><data><acl $NS><rule><name>r$mid</name><seq>$mid</seq><action>permit</action></rule></acl></data></rpc-reply>"
+
+new "get non-existing entry"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/uo:acl/uo:rule[uo:name='r$mid'][uo:seq='$perfnr']\" xmlns:uo=\"urn:example:userorder\"/></get-config></rpc>" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "merge entry $mid"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><acl $NS><rule><name>r$mid</name><seq>$mid</seq><action>deny</action></rule></acl></config></edit-config></rpc>" "$OK"
+
+new "insert entry after $mid"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><acl $NS><rule $YNS yang:insert=\"after\" yang:key=\"[name='r$mid'][seq='$mid']\"><name>after</name><seq>0</seq></rule></acl></config></edit-config></rpc>" "$OK"
+
+new "insert entry before $mid"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><acl $NS><rule $YNS yang:insert=\"before\" yang:key=\"[name='r$mid'][seq='$mid']\"><name>before</name><seq>0</seq></rule></acl></config></edit-config></rpc>" "$OK"
+
+new "insert after non-existing entry"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><acl $NS><rule $YNS yang:insert=\"after\" yang:key=\"[name='r$mid'][seq='$perfnr']\"><name>none</name><seq>0</seq></rule></acl></config></edit-config></rpc>" "<rpc-error><error-type>protocol</error-type><error-tag>operation-failed</error-tag><error-severity>error</error-severity><error-message>bad-attribute: key, missing-instance"
+
+new "delete entry $(( $mid - 1 ))"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><acl $NS><rule nc:operation=\"delete\" xmlns:nc=\"${BASENS}\"><name>r$(( $mid - 1 ))</name><seq>$(( $mid - 1 ))</seq></rule></acl></config></edit-config></rpc>" "$OK"
+
+new "get deleted entry"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/uo:acl/uo:rule[uo:name='r$(( $mid - 1 ))'][uo:seq='$(( $mid - 1 ))']\" xmlns:uo=\"urn:example:userorder\"/></get-config></rpc>" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "order is preserved"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>")" | $clixon_netconf -qef $cfg)
+expectpart "$ret" 0 "<rule><name>r$(( $mid + 1 ))</name><seq>$(( $mid + 1 ))</seq><action>permit</action></rule><rule><name>before</name><seq>0</seq></rule><rule><name>r$mid</name><seq>$mid</seq><action>deny</action></rule><rule><name>after</name><seq>0</seq></rule><rule><name>r$(( $mid - 2 ))</name>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "$OK"
+
+new "$perfreq merge edits in $perfnr entries"
+rpc=""
+for (( i=0; i<$perfreq; i++ )); do
+    rnd=$(( ( $RANDOM * 32768 + $RANDOM ) % $perfnr ))
+    rpc+=$(chunked_framing "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><acl $NS><rule><name>r$rnd</name><seq>$rnd</seq><action>deny</action></rule></acl></config></edit-config></rpc>")
+done
+{ time -p echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+new "$perfreq inserts after key in $perfnr entries"
+rpc=""
+for (( i=0; i<$perfreq; i++ )); do
+    rnd=$(( ( $RANDOM * 32768 + $RANDOM ) % $perfnr ))
+    rpc+=$(chunked_framing "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><acl $NS><rule $YNS yang:insert=\"after\" yang:key=\"[name='r$rnd'][seq='$rnd']\"><name>new$i</name><seq>$i</seq></rule></acl></config></edit-config></rpc>")
+done
+{ time -p echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+new "validate $perfnr entries"
+rpc=$(chunked_framing "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>")
+{ time -p echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,162 @@
+#!/usr/bin/env bash
+# Private candidate datastores, see CLICON_XMLDB_PRIVATE_CANDIDATE
+# 1. Edits of one session are not visible to other sessions until committed
+# 2. Two sessions editing different nodes concurrently can both commit
+# 3. Two sessions editing the same node: the second commit fails with a conflict
+# 4. discard-changes drops the private candidate
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/private.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRIVATE_CANDIDATE>true</CLICON_XMLDB_PRIVATE_CANDIDATE>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module private{
+  yang-version 1.1;
+  namespace "urn:example:private";
+  prefix p;
+  container c{
+    list a{
+      key k;
+      leaf k{
+        type string;
+      }
+      leaf v{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+NS="xmlns=\"urn:example:private\""
+
+# Edit-config of entry with key $1 and value $2
+function edit(){
+    echo "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c $NS><a><k>$1</k><v>$2</v></a></c></config></edit-config></rpc>"
+}
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "Initial commit of x"
+rpc="$DEFAULTHELLO$(chunked_framing "$(edit x 1)")$(chunked_framing "<rpc $DEFAULTNS><commit/></rpc>")"
+ret=$(echo "$rpc" | $clixon_netconf -qef $cfg)
+match=$(echo "$ret" | grep -c "rpc-error")
+if [ $match -ne 0 ]; then
+    err "<ok/>" "$ret"
+fi
+
+new "Uncommitted edit in one session is visible in that session"
+rpc="$DEFAULTHELLO$(chunked_framing "$(edit y 2)")$(chunked_framing "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/p:c\" xmlns:p=\"urn:example:private\"/></get-config></rpc>")"
+ret=$(echo "$rpc" | $clixon_netconf -qef $cfg)
+match=$(echo "$ret" | grep -c "<k>y</k>")
+if [ $match -eq 0 ]; then
+    err "<k>y</k>" "$ret"
+fi
+
+new "Uncommitted edit is not visible in other session candidate"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "<rpc-reply $DEFAULTNS><data><c $NS><a><k>x</k><v>1</v></a></c></data></rpc-reply>"
+
+new "Concurrent non-conflicting edits: session A edits y, waits, and commits"
+rpc1="$DEFAULTHELLO$(chunked_framing "$(edit y 2)")"
+rpc2=$(chunked_framing "<rpc $DEFAULTNS><commit/></rpc>")
+(echo "$rpc1"; sleep 2; echo "$rpc2"; sleep 1) | $clixon_netconf -qef $cfg > $dir/a.out &
+sleep 1
+
+new "Concurrent non-conflicting edits: session B edits z and commits"
+rpc="$DEFAULTHELLO$(chunked_framing "$(edit z 3)")$(chunked_framing "<rpc $DEFAULTNS><commit/></rpc>")"
+ret=$(echo "$rpc" | $clixon_netconf -qef $cfg)
+match=$(echo "$ret" | grep -c "rpc-error")
+if [ $match -ne 0 ]; then
+    err "<ok/>" "$ret"
+fi
+wait
+
+new "Session A commit succeeded"
+match=$(grep -c "rpc-error" $dir/a.out)
+if [ $match -ne 0 ]; then
+    err "<ok/>" "$(cat $dir/a.out)"
+fi
+
+new "Running contains both x, y and z"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "<rpc-reply $DEFAULTNS><data><c $NS><a><k>x</k><v>1</v></a><a><k>y</k><v>2</v></a><a><k>z</k><v>3</v></a></c></data></rpc-reply>"
+
+new "Concurrent conflicting edits: session A changes x, waits, and commits"
+rpc1="$DEFAULTHELLO$(chunked_framing "$(edit x 10)")"
+(echo "$rpc1"; sleep 2; echo "$rpc2"; sleep 1) | $clixon_netconf -qef $cfg > $dir/a.out &
+sleep 1
+
+new "Concurrent conflicting edits: session B changes x and commits"
+rpc="$DEFAULTHELLO$(chunked_framing "$(edit x 20)")$(chunked_framing "<rpc $DEFAULTNS><commit/></rpc>")"
+ret=$(echo "$rpc" | $clixon_netconf -qef $cfg)
+match=$(echo "$ret" | grep -c "rpc-error")
+if [ $match -ne 0 ]; then
+    err "<ok/>" "$ret"
+fi
+wait
+
+new "Session A commit failed with conflict"
+match=$(grep -c "<error-tag>in-use</error-tag>" $dir/a.out)
+if [ $match -eq 0 ]; then
+    err "in-use" "$(cat $dir/a.out)"
+fi
+
+new "Running has value of session B"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/p:c/p:a[p:k='x']\" xmlns:p=\"urn:example:private\"/></get-config></rpc>" "<rpc-reply $DEFAULTNS><data><c $NS><a><k>x</k><v>20</v></a></c></data></rpc-reply>"
+
+new "Edit and discard-changes"
+rpc="$DEFAULTHELLO$(chunked_framing "$(edit w 4)")$(chunked_framing "<rpc $DEFAULTNS><discard-changes/></rpc>")$(chunked_framing "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/p:c/p:a[p:k='w']\" xmlns:p=\"urn:example:private\"/></get-config></rpc>")"
+ret=$(echo "$rpc" | $clixon_netconf -qef $cfg)
+match=$(echo "$ret" | grep -c "<k>w</k>")
+if [ $match -ne 0 ]; then
+    err "no w" "$ret"
+fi
+
+new "No private candidate files left"
+if ls $dir/candidate-*_db > /dev/null 2>&1; then
+    err "no candidate-*_db" "$(ls $dir)"
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
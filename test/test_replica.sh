@@ -0,0 +1,244 @@
+#!/usr/bin/env bash
+# Shared-memory replica of running for local frontends, see CLICON_XMLDB_REPLICA
+# 1. Backend publishes replica of running, CLI reads running from replica
+# 2. Replica follows commits
+# 3. NACM read rules are applied by CLI reading replica
+# 4. Replica is removed when backend is killed
+# 5. Time for concurrent CLI readers with and without replica
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+. ./nacm.sh
+
+# Number of list entries in timing test
+: ${perfnr:=2000}
+
+# Number of concurrent CLI readers in timing test
+: ${readers:=8}
+
+# Number of reads per reader in timing test
+: ${perfreq:=20}
+
+cfg=$dir/conf_yang.xml
+cfgnr=$dir/conf_norep.xml
+fyang=$dir/replica.yang
+clidir=$dir/cli
+replica=$dir/running.replica
+
+test -d ${clidir} || mkdir $clidir
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLISPEC_DIR>$clidir</CLICON_CLISPEC_DIR>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_NACM_MODE>internal</CLICON_NACM_MODE>
+  <CLICON_NACM_CREDENTIALS>none</CLICON_NACM_CREDENTIALS>
+  <CLICON_XMLDB_REPLICA>$replica</CLICON_XMLDB_REPLICA>
+</clixon-config>
+EOF
+
+# Same config but frontends do not read the replica
+sed -e "/CLICON_XMLDB_REPLICA/d" -e "s#<CLICON_CONFIGFILE>$cfg#<CLICON_CONFIGFILE>$cfgnr#" $cfg > $cfgnr
+
+cat <<EOF > $fyang
+module replica{
+  yang-version 1.1;
+  namespace "urn:example:replica";
+  prefix ex;
+  import ietf-netconf-acm {
+    prefix nacm;
+  }
+  container x{
+    list y{
+      key a;
+      leaf a{
+        type int32;
+      }
+      leaf b{
+        type int32;
+      }
+      leaf c{
+        type int32;
+        default 42;
+      }
+    }
+  }
+  container secret{
+    leaf s{
+      type string;
+    }
+  }
+}
+EOF
+
+cat <<EOF > $clidir/ex.cli
+CLICON_MODE="example";
+CLICON_PROMPT="%U@%H %W> ";
+
+show("Show a particular state of the system"){
+    running("Show running"), cli_show_config("running", "xml", "/", NULL, false, false);
+    entry("Show entry 1"), cli_show_config("running", "xml", "/x/y[a='1']", "urn:example:replica", false, false);
+    defaults("Show running with defaults"), cli_show_config("running", "xml", "/x", "urn:example:replica", false, false, "report-all");
+    trim("Show running with defaults trimmed"), cli_show_config("running", "xml", "/x", "urn:example:replica", false, false, "trim");
+}
+EOF
+
+RULES=$(cat <<EOF
+   <nacm xmlns="urn:ietf:params:xml:ns:yang:ietf-netconf-acm">
+     <enable-nacm>true</enable-nacm>
+     <read-default>permit</read-default>
+     <write-default>permit</write-default>
+     <exec-default>permit</exec-default>
+     $NGROUPS
+     <rule-list>
+       <name>limited-acl</name>
+       <group>limited</group>
+       <rule>
+         <name>secret</name>
+         <module-name>*</module-name>
+         <access-operations>read</access-operations>
+         <path xmlns:ex="urn:example:replica">/ex:secret</path>
+         <action>deny</action>
+       </rule>
+     </rule-list>
+     $NADMIN
+   </nacm>
+EOF
+)
+
+NS="xmlns=\"urn:example:replica\""
+XCONF="<x $NS><y><a>1</a><b>1</b></y><y><a>2</a><b>2</b></y></x>"
+SCONF="<secret $NS><s>sesame</s></secret>"
+
+# Start backend from startup
+function start(){
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s startup -f $cfg"
+        start_backend -s startup -f $cfg
+    fi
+    new "wait backend"
+    wait_backend
+}
+
+function stop(){
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+echo "<${DATASTORE_TOP}>$RULES$XCONF$SCONF</${DATASTORE_TOP}>" > $dir/startup_db
+
+new "test params: -f $cfg"
+start
+
+new "replica published"
+if [ ! -f $replica ]; then
+    err "$replica" "not found"
+fi
+
+new "netconf get-config running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x\" xmlns:ex=\"urn:example:replica\"/></get-config></rpc>" "<rpc-reply $DEFAULTNS><data>$XCONF</data></rpc-reply>"
+
+new "cli show running from replica"
+expectpart "$($clixon_cli -1 -f $cfg show running)" 0 "$XCONF" "$SCONF"
+
+new "cli show running from backend"
+expectpart "$($clixon_cli -1 -f $cfgnr show running)" 0 "$XCONF" "$SCONF"
+
+new "cli show entry from replica"
+expectpart "$($clixon_cli -1 -f $cfg show entry)" 0 "^<x $NS><y><a>1</a><b>1</b></y></x>$"
+
+new "cli show with defaults from replica"
+expectpart "$($clixon_cli -1 -f $cfg show defaults)" 0 "<y><a>1</a><b>1</b><c>42</c></y>"
+
+new "cli show with defaults trimmed from replica"
+expectpart "$($clixon_cli -1 -f $cfg show trim)" 0 "^$XCONF$"
+
+new "Change entry 1"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x $NS><y><a>1</a><b>11</b></y></x></config></edit-config></rpc>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "cli show entry before commit"
+expectpart "$($clixon_cli -1 -f $cfg show entry)" 0 "^<x $NS><y><a>1</a><b>1</b></y></x>$"
+
+new "Commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "cli show entry after commit"
+expectpart "$($clixon_cli -1 -f $cfg show entry)" 0 "^<x $NS><y><a>1</a><b>11</b></y></x>$"
+
+new "cli show running as limited user from replica"
+expectpart "$($clixon_cli -1 -f $cfg -U wilma show running)" 0 "<y><a>1</a><b>11</b></y>" --not-- "sesame"
+
+new "cli show running as limited user from backend"
+expectpart "$($clixon_cli -1 -f $cfgnr -U wilma show running)" 0 "<y><a>1</a><b>11</b></y>" --not-- "sesame"
+
+new "cli show running as admin user from replica"
+expectpart "$($clixon_cli -1 -f $cfg -U andy show running)" 0 "sesame"
+
+stop
+
+if [ $BE -ne 0 ]; then
+    new "replica removed"
+    if [ -f $replica ]; then
+        err "$replica removed" "$(ls -l $replica)"
+    fi
+fi
+
+# Timing: concurrent CLI readers of a large running
+new "generate startup with $perfnr entries"
+echo -n "<${DATASTORE_TOP}>$RULES<x $NS>" > $dir/startup_db
+for (( i=0; i<$perfnr; i++ )); do
+    echo -n "<y><a>$i</a><b>$i</b></y>" >> $dir/startup_db
+done
+echo "</x></${DATASTORE_TOP}>" >> $dir/startup_db
+
+start
+
+# Run concurrent CLI readers of running
+# 1: config file
+function readers(){
+    for (( r=0; r<$readers; r++ )); do
+        (
+            for (( j=0; j<$perfreq; j++ )); do
+                $clixon_cli -1 -f $1 show running > /dev/null
+            done
+        ) &
+    done
+    wait
+}
+
+new "$readers readers x $perfreq reads with replica"
+{ time -p readers $cfg; } 2>&1 | awk '/real/ {print $2}'
+
+new "$readers readers x $perfreq reads without replica"
+{ time -p readers $cfgnr; } 2>&1 | awk '/real/ {print $2}'
+
+stop
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -10,6 +10,9 @@
 #  3. andy      - a well-known user
 #  3. unknown   - unknown user
 # Use NACM to return XML for different returns for anonymous and andy
+# Then repeat auth-type=user with authentication cache, see CLICON_RESTCONF_AUTH_CACHE_TTL
+# The cache is flushed by authenticated NACM writes and, using CLICON_XMLDB_REPLICA, by
+# any change of running, but not by unauthenticated writes
 
 # Magic line must be first in script (see README.md)
 s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
@@ -37,6 +40,12 @@ fyang=$dir/myexample.yang
 RCPROTO=http 
 HVER=1.1
 
+# Authentication cache time-to-live, 0 disables cache
+: ${CACHETTL:=0}
+
+# Number of keep-alive requests in cache timing
+: ${perfreq:=100}
+
 # Start with common config, then append fcgi/native specific config
 # NOTE this is replaced in testrun()
 cat <<EOF > $cfg
@@ -57,6 +66,7 @@ cat <<EOF > $cfg
   <CLICON_XMLDB_UPGRADE_CHECKOLD>true</CLICON_XMLDB_UPGRADE_CHECKOLD>
   <CLICON_NACM_MODE>internal</CLICON_NACM_MODE>
   <CLICON_ANONYMOUS_USER>$anonymous</CLICON_ANONYMOUS_USER>
+  <CLICON_XMLDB_REPLICA>$dir/running.replica</CLICON_XMLDB_REPLICA>
 </clixon-config>
 EOF
 
@@ -132,6 +142,13 @@ cat <<EOF > $dir/startup_db
          <access-operations>exec</access-operations>
          <action>permit</action>
        </rule>
+       <rule>
+         <name>allow-stats</name>
+         <module-name>clixon-lib</module-name>
+         <rpc-name>stats</rpc-name>
+         <access-operations>exec</access-operations>
+         <action>permit</action>
+       </rule>
        <rule>
          <name>allow-wilma</name>
          <module-name>myexample</module-name>
@@ -199,6 +216,8 @@ function testrun()
   <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
   <CLICON_NACM_MODE>internal</CLICON_NACM_MODE>
   <CLICON_ANONYMOUS_USER>$anonymous</CLICON_ANONYMOUS_USER>
+  <CLICON_RESTCONF_AUTH_CACHE_TTL>$CACHETTL</CLICON_RESTCONF_AUTH_CACHE_TTL>
+  <CLICON_XMLDB_REPLICA>$dir/running.replica</CLICON_XMLDB_REPLICA>
   $RESTCONFIG
 </clixon-config>
 EOF
@@ -217,6 +236,45 @@ EOF
     new "curl $CURLOPTS $user -X GET $RCPROTO://localhost/restconf/data/myexample:top"
     expectpart "$(curl $CURLOPTS $user -X GET $RCPROTO://localhost/restconf/data/myexample:top)" 0 $expectcode "$expectmsg"
 
+    if [ -n "$user" -a "$auth" = user ]; then
+        new "keep-alive: same credentials twice, then wrong password on same connection"
+        expectpart "$(curl $CURLOPTS $user -X GET $RCPROTO://localhost/restconf/data/myexample:top --next $CURLOPTS $user -X GET $RCPROTO://localhost/restconf/data/myexample:top --next $CURLOPTS -u wilma:wrong -X GET $RCPROTO://localhost/restconf/data/myexample:top)" 0 $expectcode "$expectmsg" "HTTP/$HVER 401"
+    fi
+
+    if [ "$user" = "-u wilma:bar" -a "$auth" = user ]; then
+        new "time $perfreq keep-alive GET with cache ttl $CACHETTL"
+        urls=""
+        for (( i=0; i<$perfreq; i++ )); do
+            urls="$urls $RCPROTO://localhost/restconf/data/myexample:top"
+        done
+        { time -p curl $CURLOPTS $user -X GET $urls > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+    fi
+
+    if [ "$user" = "-u wilma:bar" -a "$auth" = user -a "$CACHETTL" -gt 0 ]; then
+        STATS="$RCPROTO://localhost/restconf/operations/clixon-lib:stats"
+        NACMURL="$RCPROTO://localhost/restconf/data/ietf-netconf-acm:nacm/enable-nacm"
+        new "auth cache stats: hits of keep-alive requests"
+        expectpart "$(curl $CURLOPTS $user -X GET $RCPROTO://localhost/restconf/data/myexample:top --next $CURLOPTS $user -X POST -H "Accept: application/yang-data+json" $STATS)" 0 "HTTP/$HVER 200" '"restconf-auth-cache":{"hits":"[1-9][0-9]*","misses":"[0-9]\+","entries":[1-9][0-9]*}'
+
+        new "auth cache: unauthenticated write to NACM"
+        expectpart "$(curl $CURLOPTS -u wilma:wrong -X PUT -H "Content-Type: application/yang-data+json" $NACMURL -d '{"ietf-netconf-acm:enable-nacm":false}')" 0 "HTTP/$HVER 401"
+
+        new "auth cache: unauthenticated write to NACM does not flush cache"
+        expectpart "$(curl $CURLOPTS $user -X POST -H "Accept: application/yang-data+json" $STATS)" 0 "HTTP/$HVER 200" '"entries":\([2-9]\|[1-9][0-9]\+\)}'
+
+        new "auth cache: authenticated write to NACM flushes cache"
+        expectpart "$(curl $CURLOPTS $user -X PUT -H "Content-Type: application/yang-data+json" $NACMURL -d '{"ietf-netconf-acm:enable-nacm":false}' --next $CURLOPTS $user -X POST -H "Accept: application/yang-data+json" $STATS)" 0 "HTTP/$HVER 403" '"entries":1}'
+
+        new "auth cache: change of running"
+        expectpart "$(curl $CURLOPTS $user -X PUT -H "Content-Type: application/yang-data+json" $RCPROTO://localhost/restconf/data/myexample:top/wilma -d '{"myexample:wilma":"72"}')" 0 "HTTP/$HVER 204"
+
+        new "auth cache: change of running flushes cache"
+        expectpart "$(curl $CURLOPTS $user -X POST -H "Accept: application/yang-data+json" $STATS)" 0 "HTTP/$HVER 200" '"entries":1}'
+
+        new "restore wilma"
+        expectpart "$(curl $CURLOPTS $user -X PUT -H "Content-Type: application/yang-data+json" $RCPROTO://localhost/restconf/data/myexample:top/wilma -d '{"myexample:wilma":"71"}')" 0 "HTTP/$HVER 204"
+    fi
+
     if [ $RC -ne 0 ]; then
         new "Kill restconf daemon"
         stop_restconf
@@ -276,6 +334,19 @@ testrun $AUTH "-u wilma:wrong" "HTTP/$HVER 401" "$MSGERR1"      # denied
 new "auth-type=$AUTH unknown"
 testrun $AUTH "-u unknown:any"  "HTTP/$HVER 401" "$MSGERR1"     # denied
 
+CACHETTL=60
+
+new "auth-type=$AUTH cache wilma"
+testrun $AUTH "-u wilma:bar" "HTTP/$HVER 200" "$MSGWILMA"                 # OK - wilma
+
+new "auth-type=$AUTH cache wilma wrong passwd"
+testrun $AUTH "-u wilma:wrong" "HTTP/$HVER 401" "$MSGERR1"      # denied
+
+new "auth-type=$AUTH cache unknown"
+testrun $AUTH "-u unknown:any"  "HTTP/$HVER 401" "$MSGERR1"     # denied
+
+CACHETTL=0
+
 if [ $BE -ne 0 ]; then
     new "Kill backend"
     # Check if premature kill
@@ -289,6 +360,9 @@ fi
 
 # unset conditional parameters
 unset RESTCONFIG1
+unset CACHETTL
+unset STATS
+unset NACMURL
 unset MSGANON
 unset MSGWILMA
 unset MSGERR1
@@ -0,0 +1,322 @@
+#!/usr/bin/env bash
+# Restconf YANG-CBOR encoding (RFC 9254) with names as keys, media type application/yang-data+cbor
+# 1. Round-trip: GET as CBOR, DELETE, PUT same CBOR back and compare with XML
+# 2. Fixed CBOR vectors of list entries and leafs, encoded per RFC 8949/RFC 9254
+# 3. RPC input and output as CBOR, and malformed CBOR errors
+# 4. Datastore format cbor, see CLICON_XMLDB_FORMAT
+# 5. Time and size of GET of a large list as XML, JSON and CBOR
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Number of list entries in timing tests
+: ${perfnr:=5000}
+
+cfg=$dir/conf.xml
+cfgdb=$dir/conf_db.xml
+fyang=$dir/clixon-example.yang
+fcbor=$dir/types.cbor
+fin=$dir/input.cbor
+fconfig=$dir/large.json
+
+# Curl without response headers in output for binary bodies
+CURLNOHDR=${CURLOPTS/-Ssik/-Ssk}
+
+# Define default restconfig config: RESTCONFIG
+RESTCONFIG=$(restconf_config none false)
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $cfgdb
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfgdb</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_FORMAT>cbor</CLICON_XMLDB_FORMAT>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   identity base;
+   identity eth {
+      base base;
+   }
+   container types{
+      leaf tint {
+         type int32;
+      }
+      leaf tneg {
+         type int64;
+      }
+      leaf tdec64 {
+         type decimal64{
+            fraction-digits 3;
+         }
+      }
+      leaf tbool {
+         type boolean;
+      }
+      leaf tstr {
+         type string;
+      }
+      leaf tbin {
+         type binary;
+      }
+      leaf tid {
+         type identityref{
+            base base;
+         }
+      }
+      leaf tempty {
+         type empty;
+      }
+      leaf-list tll {
+         type string;
+      }
+      list tlist {
+         key name;
+         leaf name{
+            type string;
+         }
+         leaf value{
+            type uint32;
+         }
+      }
+   }
+   rpc example {
+      input {
+         leaf x {
+            type string;
+            mandatory true;
+         }
+         leaf y {
+            type string;
+            default "42";
+         }
+      }
+      output {
+         leaf x {
+            type string;
+         }
+         leaf y {
+            type string;
+         }
+      }
+   }
+}
+EOF
+
+# Write CBOR given as hex to file
+# 1: hex
+# 2: file
+function hex2file(){
+    printf "$(echo -n $1 | sed 's/../\\x&/g')" > $2
+}
+
+# Get CBOR response as hex
+# 1: restconf path
+function gethex(){
+    curl $CURLNOHDR -X GET -H "Accept: application/yang-data+cbor" $RCPROTO://localhost/restconf/data/$1 | od -An -tx1 | tr -d ' \n'
+}
+
+TYPES='{"clixon-example:types":{"tint":0,"tneg":-4711,"tdec64":"42.120","tbool":true,"tstr":"str","tbin":"AAECAw==","tid":"clixon-example:eth","tempty":[null],"tll":["a","b"],"tlist":[{"name":"x","value":1},{"name":"y","value":2}]}}'
+XTYPES='<types xmlns="urn:example:clixon"><tint>0</tint><tneg>-4711</tneg><tdec64>42.120</tdec64><tbool>true</tbool><tstr>str</tstr><tbin>AAECAw==</tbin><tid>eth</tid><tempty/><tll>a</tll><tll>b</tll><tlist><name>x</name><value>1</value></tlist><tlist><name>y</name><value>2</value></tlist></types>'
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    sudo pkill -f clixon_backend # to be sure
+
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+fi
+
+new "wait restconf"
+wait_restconf
+
+new "restconf POST types as JSON"
+expectpart "$(curl $CURLOPTS -X POST -H "Content-Type: application/yang-data+json" -d "$TYPES" $RCPROTO://localhost/restconf/data)" 0 "HTTP/$HVER 201"
+
+new "restconf GET types as XML"
+expectpart "$(curl $CURLOPTS -X GET -H "Accept: application/yang-data+xml" $RCPROTO://localhost/restconf/data/clixon-example:types)" 0 "HTTP/$HVER 200" "$XTYPES"
+
+new "restconf GET types as CBOR"
+ret=$(curl $CURLNOHDR -D - -o $fcbor -X GET -H "Accept: application/yang-data+cbor" $RCPROTO://localhost/restconf/data/clixon-example:types)
+expectpart "$ret" 0 "HTTP/$HVER 200" "Content-Type: application/yang-data+cbor"
+
+new "CBOR is a map of one member"
+expectpart "$(od -An -tx1 -N2 $fcbor)" 0 "a1 74"
+
+new "CBOR member name is module-qualified"
+expectpart "$(grep -ac "clixon-example:types" $fcbor)" 0 "1"
+
+new "restconf DELETE types"
+expectpart "$(curl $CURLOPTS -X DELETE $RCPROTO://localhost/restconf/data/clixon-example:types)" 0 "HTTP/$HVER 204"
+
+new "restconf PUT types as CBOR"
+expectpart "$(curl $CURLOPTS -X PUT -H "Content-Type: application/yang-data+cbor" --data-binary @$fcbor $RCPROTO://localhost/restconf/data/clixon-example:types)" 0 "HTTP/$HVER 201"
+
+new "restconf GET types as XML after round-trip"
+expectpart "$(curl $CURLOPTS -X GET -H "Accept: application/yang-data+xml" $RCPROTO://localhost/restconf/data/clixon-example:types)" 0 "HTTP/$HVER 200" "$XTYPES"
+
+new "restconf POST types as CBOR exists"
+expectpart "$(curl $CURLOPTS -X POST -H "Content-Type: application/yang-data+cbor" --data-binary @$fcbor $RCPROTO://localhost/restconf/data)" 0 "HTTP/$HVER 409" "data-exists"
+
+# {"clixon-example:tlist":[{"name":"y","value":2}]}
+new "restconf GET list entry as CBOR is fixed vector"
+expectpart "$(gethex clixon-example:types/tlist=y)" 0 "^a174636c69786f6e2d6578616d706c653a746c69737481a2646e616d6561796576616c756502$"
+
+# {"clixon-example:tneg":-4711}
+new "restconf GET negative integer as CBOR is fixed vector"
+expectpart "$(gethex clixon-example:types/tneg)" 0 "^a173636c69786f6e2d6578616d706c653a746e6567391266$"
+
+# {"clixon-example:tbin":h'00010203'}
+new "restconf GET binary as CBOR byte string is fixed vector"
+expectpart "$(gethex clixon-example:types/tbin)" 0 "^a173636c69786f6e2d6578616d706c653a7462696e4400010203$"
+
+# {"clixon-example:tlist":[{"name":"z","value":300}]}
+hex2file a174636c69786f6e2d6578616d706c653a746c69737481a2646e616d65617a6576616c756519012c $fin
+
+new "restconf PUT list entry as fixed CBOR vector"
+expectpart "$(curl $CURLOPTS -X PUT -H "Content-Type: application/yang-data+cbor" --data-binary @$fin $RCPROTO://localhost/restconf/data/clixon-example:types/tlist=z)" 0 "HTTP/$HVER 201"
+
+new "restconf GET list entry as XML"
+expectpart "$(curl $CURLOPTS -X GET -H "Accept: application/yang-data+xml" $RCPROTO://localhost/restconf/data/clixon-example:types/tlist=z)" 0 "HTTP/$HVER 200" "<tlist xmlns=\"urn:example:clixon\"><name>z</name><value>300</value></tlist>"
+
+new "restconf DELETE list entry"
+expectpart "$(curl $CURLOPTS -X DELETE $RCPROTO://localhost/restconf/data/clixon-example:types/tlist=z)" 0 "HTTP/$HVER 204"
+
+# {"clixon-example:input":{"x":"a"}}
+printf '\xa1\x74clixon-example:input\xa1\x61x\x61a' > $fin
+
+new "restconf RPC with CBOR input and JSON output"
+expectpart "$(curl $CURLOPTS -X POST -H "Content-Type: application/yang-data+cbor" --data-binary @$fin $RCPROTO://localhost/restconf/operations/clixon-example:example)" 0 "HTTP/$HVER 200" '{"clixon-example:output":{"x":"a","y":"42"}}'
+
+# {"clixon-example:output":{"x":"a","y":"42"}}
+new "restconf RPC with CBOR input and output"
+ret=$(curl $CURLNOHDR -X POST -H "Content-Type: application/yang-data+cbor" -H "Accept: application/yang-data+cbor" --data-binary @$fin $RCPROTO://localhost/restconf/operations/clixon-example:example | od -An -tx1 | tr -d ' \n')
+expectpart "$ret" 0 "^a175636c69786f6e2d6578616d706c653a6f7574707574a2617861616179623432"
+
+# Truncated: {"clixon-example:input":
+printf '\xa1\x74clixon-example:input' > $fin
+
+new "restconf RPC with truncated CBOR"
+expectpart "$(curl $CURLOPTS -X POST -H "Content-Type: application/yang-data+cbor" --data-binary @$fin $RCPROTO://localhost/restconf/operations/clixon-example:example)" 0 "HTTP/$HVER 400" "malformed-message" "Premature end of CBOR data"
+
+# {"clixon-example:input":{"a":{"a":...{}}}}, nested deeper than decoder limit
+printf '\xa1\x74clixon-example:input' > $fin
+for (( i=0; i<1000; i++ )); do
+    printf '\xa1\x61a' >> $fin
+done
+printf '\xa0' >> $fin
+
+new "restconf RPC with too deeply nested CBOR"
+expectpart "$(curl $CURLOPTS -X POST -H "Content-Type: application/yang-data+cbor" --data-binary @$fin $RCPROTO://localhost/restconf/operations/clixon-example:example)" 0 "HTTP/$HVER 400" "malformed-message" "CBOR maps nested deeper than"
+
+new "restconf GET operations as CBOR"
+expectpart "$(curl $CURLNOHDR -X GET -H "Accept: application/yang-data+cbor" $RCPROTO://localhost/restconf/operations | grep -ac "clixon-example:example")" 0 "1"
+
+new "generate $perfnr entries"
+echo -n '{"clixon-example:types":{"tlist":[' > $fconfig
+for (( i=0; i<$perfnr; i++ )); do
+    if [ $i -ne 0 ]; then
+        echo -n "," >> $fconfig
+    fi
+    echo -n "{\"name\":\"n$i\",\"value\":$i}" >> $fconfig
+done
+echo -n ']}}' >> $fconfig
+
+new "restconf PUT $perfnr entries"
+expectpart "$(curl $CURLOPTS -X PUT -H "Content-Type: application/yang-data+json" -d @$fconfig $RCPROTO://localhost/restconf/data/clixon-example:types)" 0 "HTTP/$HVER 204"
+
+for media in xml json cbor; do
+    new "restconf GET $perfnr entries as $media: time and size"
+    { time -p curl $CURLNOHDR -o /dev/null -w "size: %{size_download}\n" -X GET -H "Accept: application/yang-data+$media" $RCPROTO://localhost/restconf/data/clixon-example:types; } 2>&1 | awk '/real|size/ {print $0}'
+done
+
+if [ $RC -ne 0 ]; then
+    new "Kill restconf daemon"
+    stop_restconf
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+
+    new "start backend -s init -f $cfgdb with cbor datastore"
+    start_backend -s init -f $cfgdb
+
+    new "wait backend"
+    wait_backend
+
+    new "netconf edit-config types"
+    expecteof_netconf "$clixon_netconf -qf $cfgdb" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$XTYPES</config></edit-config></rpc>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "netconf commit"
+    expecteof_netconf "$clixon_netconf -qf $cfgdb" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "running datastore is CBOR"
+    expectpart "$(od -An -tx1 -N8 $dir/running_db)" 0 "a1 66 63 6f 6e 66 69 67"
+
+    new "Kill backend"
+    stop_backend -f $cfgdb
+
+    new "start backend -s running -f $cfgdb"
+    start_backend -s running -f $cfgdb
+
+    new "wait backend"
+    wait_backend
+
+    new "netconf get-config after restart"
+    expecteof_netconf "$clixon_netconf -qf $cfgdb" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "<rpc-reply $DEFAULTNS><data>$XTYPES</data></rpc-reply>"
+
+    new "Kill backend"
+    stop_backend -f $cfgdb
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,178 @@
+#!/usr/bin/env bash
+# Restconf :startup with coalesced copy of running to startup, see CLICON_STARTUP_FLUSH_DELAY
+# 1. Many edits are coalesced into few copies to startup, see stats
+# 2. After the delay, startup is same as running
+# 3. Edits are copied to startup on backend termination
+# 4. Crash: edits acknowledged more than the delay before a kill -9 are in startup
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Number of restconf edits
+: ${perfnr:=50}
+
+# Flush delay in ms
+: ${delay:=1000}
+
+cfg=$dir/conf.xml
+fyang=$dir/example.yang
+
+cat <<EOF > $fyang
+module example{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ip;
+   container x {
+    list y {
+      key "a";
+      leaf a {
+        type string;
+      }
+      leaf b {
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+# Define default restconfig config: RESTCONFIG
+RESTCONFIG=$(restconf_config none false)
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_FEATURE>ietf-netconf:startup</CLICON_FEATURE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_STARTUP_FLUSH_DELAY>$delay</CLICON_STARTUP_FLUSH_DELAY>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+function start(){
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        sudo rm -f $dir/startup_db
+        new "start backend -s init -f $cfg"
+        start_backend -s init -f $cfg
+    fi
+    new "wait backend"
+    wait_backend
+
+    if [ $RC -ne 0 ]; then
+        new "kill old restconf daemon"
+        stop_restconf_pre
+
+        new "start restconf daemon"
+        start_restconf -f $cfg
+    fi
+    new "wait restconf"
+    wait_restconf
+}
+
+function stop(){
+    if [ $RC -ne 0 ]; then
+        new "Kill restconf daemon"
+        stop_restconf
+    fi
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+# Make restconf edits
+# 1: first entry
+# 2: last entry
+function edits(){
+    for (( i=$1; i<=$2; i++ )); do
+        expectpart "$(curl $CURLOPTS -X PUT -H "Content-Type: application/yang-data+json" $RCPROTO://localhost/restconf/data/example:x/y=$i -d "{\"example:y\":{\"a\":\"$i\",\"b\":\"$i\"}}")" 0 "HTTP/$HVER 201"
+    done
+}
+
+new "test params: -f $cfg"
+start
+
+new "$perfnr restconf edits"
+edits 1 $perfnr
+
+new "wait for flush"
+sleep $(( $delay / 1000 + 1 ))
+
+new "Check running and startup are same"
+d=$(sudo diff $dir/startup_db $dir/running_db)
+if [ -n "$d" ]; then
+    err "running and startup should be equal" "$d"
+fi
+
+new "stats: edits coalesced"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><stats $LIBNS/></rpc>")" | $clixon_netconf -qef $cfg)
+expectpart "$ret" 0 "<startup-flush $LIBNS><edits>$perfnr</edits><flushes>[0-9]*</flushes><pending>0</pending>"
+flushes=$(echo "$ret" | sed -n 's/.*<flushes>\([0-9]*\)<\/flushes>.*/\1/p')
+echo "edits-per-flush: $(( $perfnr / $flushes ))"
+if [ $flushes -ge $perfnr ]; then
+    err "less than $perfnr flushes" "$flushes"
+fi
+
+new "restconf delete 1"
+expectpart "$(curl $CURLOPTS -X DELETE $RCPROTO://localhost/restconf/data/example:x/y=1)" 0 "HTTP/$HVER 204"
+
+stop
+
+new "Edits are copied to startup on termination"
+d=$(sudo diff $dir/startup_db $dir/running_db)
+if [ -n "$d" ]; then
+    err "running and startup should be equal" "$d"
+fi
+
+if [ $BE -ne 0 ]; then
+    start
+
+    new "edits before crash"
+    edits 1 $perfnr
+
+    new "wait longer than delay"
+    sleep $(( $delay / 1000 + 1 ))
+
+    new "edit within delay before crash"
+    edits $(( $perfnr + 1 )) $(( $perfnr + 1 ))
+
+    new "crash backend"
+    sudo pkill -9 -u root -f clixon_backend
+    sudo rm -f /usr/local/var/run/$APPNAME.pidfile
+
+    new "All edits acknowledged before the window are in startup"
+    for (( i=1; i<=$perfnr; i++ )); do
+        if ! sudo grep -q "<y><a>$i</a><b>$i</b></y>" $dir/startup_db; then
+            err "entry $i in startup" "$(sudo cat $dir/startup_db)"
+        fi
+    done
+
+    if [ $RC -ne 0 ]; then
+        new "Kill restconf daemon"
+        stop_restconf
+    fi
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -6,29 +6,45 @@
 #   - not a key int
 #   - key in an ordered-by user
 #   - key in state data
+#   - composite non-unique index using search_index_list
+#   - index maintained on edits in the backend, used by xpath
 # Use instance-id for tests, since api-path can only handle keys, and xpath is too complex.
 
 # Magic line must be first in script (see README.md)
 s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
 
+APPNAME=example
+
 : ${clixon_util_path:=clixon_util_path -D $DBG -Y /usr/local/share/clixon}
 
 # Number of list/leaf-list entries
 : ${nr:=10000}
 
 # Number of tests to generate XML for +1
-max=2
+max=4
 
 # XML file (alt provide it in stdin after xpath)
-for (( i=1; i<$max; i++ )); do  
+for (( i=1; i<$max; i++ )); do
     eval xml$i=$dir/xml$i.xml
 done
 ydir=$dir/yang
+cfg=$dir/conf_yang.xml
 
 if [ ! -d $ydir ]; then
     mkdir $ydir
 fi
 
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_DIR>$ydir</CLICON_YANG_MAIN_DIR>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
 cat <<EOF > $ydir/moda.yang
 module moda{
   namespace "urn:example:a";
@@ -58,6 +74,40 @@ module moda{
       }
     }
   }
+  container x2{
+    description "composite non-unique index in list";
+    list y{
+      key k1;
+      cc:search_index_list "a b";
+      leaf k1{
+        type string;
+      }
+      leaf a{
+        type int32;
+      }
+      leaf b{
+        type string;
+      }
+    }
+  }
+  container x3{
+    description "same as x1 but without index, for memory comparison";
+    list y{
+      key k1;
+      leaf k1{
+        type string;
+      }
+      leaf z{
+        type string;
+      }
+      leaf i{
+        type int32;
+      }
+      leaf j{
+        type int32;
+      }
+    }
+  }
 }
 EOF
 
@@ -65,12 +115,25 @@ EOF
 # Assign index i in reverse order
 new "generate list with $nr single string key to $xml1"
 echo -n '<x1 xmlns="urn:example:a">' > $xml1
-for (( i=0; i<$nr; i++ )); do  
+for (( i=0; i<$nr; i++ )); do
     let ii=$nr-$i-1
     echo -n "<y><k1>a$i</k1><z>foo$i</z><i>$ii</i><j>$ii</j></y>" >> $xml1
 done
 echo -n '</x1>' >> $xml1
 
+# Composite index: every (a,b) pair occurs nr/100 times
+new "generate list with $nr composite index entries to $xml2"
+echo -n '<x2 xmlns="urn:example:a">' > $xml2
+for (( i=0; i<$nr; i++ )); do
+    let a=$i%10
+    let b=$i/10%10
+    echo -n "<y><k1>a$i</k1><a>$a</a><b>b$b</b></y>" >> $xml2
+done
+echo -n '</x2>' >> $xml2
+
+new "generate list with $nr entries without index to $xml3"
+sed -e 's/<x1 /<x3 /' -e 's/<\/x1>/<\/x3>/' $xml1 > $xml3
+
 # First check correctness
 for (( ii=0; ii<10; ii++ )); do
     # key random
@@ -81,6 +144,16 @@ for (( ii=0; ii<10; ii++ )); do
     expectpart "$($clixon_util_path -f $xml1 -y $ydir -p /a:x1/a:y[a:i=\"$rndi\"])" 0 "^0: <y><k1>a$rnd</k1><z>foo$rnd</z><i>$rndi</i><j>$rndi</j></y>$"
 done
 
+new "instance-id composite index a=3 b=b5 returns all duplicates"
+ret=$($clixon_util_path -f $xml2 -y $ydir -p /a:x2/a:y[a:a=\"3\"][a:b=\"b5\"])
+match=$(echo "$ret" | grep -c "<a>3</a><b>b5</b>")
+if [ $match -ne $(( $nr / 100 )) ]; then
+    err "$(( $nr / 100 )) entries" "$ret"
+fi
+
+new "instance-id composite index no match"
+expectpart "$($clixon_util_path -f $xml2 -y $ydir -p /a:x2/a:y[a:a=\"3\"][a:b=\"b99\"])" 0 "^$"
+
 # Then measure time for index and non-index, assume correct
 # For small nr, the time to parse is so much larger than searching (and also parsing involves
 # searching) which makes it hard to make a  test comparing accessing the index variable "i" and the
@@ -91,6 +164,68 @@ new "index search latency i=$rndi"
 new "non-index search latency j=$rndi"
 { time -p $clixon_util_path -f $xml1 -y $ydir -p /a:x1/a:y[a:j=\"$rndi\"] > /dev/null; }  2>&1 | awk '/real/ {print $2}'
 
+new "composite index search latency a=3 b=b5"
+{ time -p $clixon_util_path -f $xml2 -y $ydir -p /a:x2/a:y[a:a=\"3\"][a:b=\"b5\"] -n 10 > /dev/null; }  2>&1 | awk '/real/ {print $2}'
+
+# Memory overhead of the index: compare max RSS of same data with and without index
+if [ -x /usr/bin/time ]; then
+    new "max RSS (kB) with index"
+    /usr/bin/time -f "%M" $clixon_util_path -f $xml1 -y $ydir -p /a:x1/a:y[a:i=\"$rndi\"] 2>&1 > /dev/null | tail -1
+
+    new "max RSS (kB) without index"
+    /usr/bin/time -f "%M" $clixon_util_path -f $xml3 -y $ydir -p /a:x3/a:y[a:i=\"$rndi\"] 2>&1 > /dev/null | tail -1
+fi
+
+# Index maintenance when entries are added, changed and deleted in the backend
+NS="xmlns=\"urn:example:a\""
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "Add entries"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x1 $NS><y><k1>a</k1><i>1</i></y><y><k1>b</k1><i>2</i></y><y><k1>c</k1><i>3</i></y></x1><x2 $NS><y><k1>a</k1><a>1</a><b>x</b></y><y><k1>b</k1><a>1</a><b>x</b></y></x2></config></edit-config></rpc>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "Change index value of b"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x1 $NS><y><k1>b</k1><i>42</i></y></x1><x2 $NS><y><k1>b</k1><b>y</b></y></x2></config></edit-config></rpc>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "Delete entry c"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x1 $NS><y nc:operation=\"delete\" xmlns:nc=\"${BASENS}\"><k1>c</k1></y></x1></config></edit-config></rpc>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "xpath new index value"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/a:x1/a:y[a:i='42']\" xmlns:a=\"urn:example:a\"/></get-config></rpc>" "<rpc-reply $DEFAULTNS><data><x1 $NS><y><k1>b</k1><i>42</i></y></x1></data></rpc-reply>"
+
+new "xpath old index value"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/a:x1/a:y[a:i='2']\" xmlns:a=\"urn:example:a\"/></get-config></rpc>" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "xpath deleted index value"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/a:x1/a:y[a:i='3']\" xmlns:a=\"urn:example:a\"/></get-config></rpc>" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "xpath composite index after change"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/a:x2/a:y[a:a='1'][a:b='x']\" xmlns:a=\"urn:example:a\"/></get-config></rpc>" "<rpc-reply $DEFAULTNS><data><x2 $NS><y><k1>a</k1><a>1</a><b>x</b></y></x2></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
 rm -rf $dir
 
 new "endtest"
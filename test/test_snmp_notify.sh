@@ -0,0 +1,207 @@
+#!/usr/bin/env bash
+# SNMP notifications generated from YANG notifications, see CLICON_SNMP_NOTIFY_STREAM
+# A notification with smiv2:oid refers to a scalar and a columnar object of CLIXON-TYPES-MIB
+# The example backend sends it periodically on the EXAMPLE stream, and clixon_snmp sends it
+# to snmpd which forwards it to a trap receiver on loopback.
+# snmpd must be configured with: trap2sink 127.0.0.1:1162 public
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Re-use main example backend stream
+APPNAME=example
+
+if [ ${ENABLE_NETSNMP} != "yes" ]; then
+    echo "Skipping test, Net-SNMP support not enabled."
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+snmptrapd=$(type -p snmptrapd)
+if [ -z "$snmptrapd" ]; then
+    echo "Skipping test, snmptrapd not found."
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+# Trap receiver port, see trap2sink in snmpd.conf
+: ${trapport:=1162}
+
+cfg=$dir/conf_startup.xml
+fyang=$dir/clixon-example.yang
+fnotify=$dir/notify.xml
+ftrapconf=$dir/snmptrapd.conf
+ftraplog=$dir/traps.log
+
+# AgentX unix socket
+SOCK=/var/run/snmp.sock
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_STANDARD_DIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${MIB_GENERATED_YANG_DIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_SNMP_AGENT_SOCK>unix:$SOCK</CLICON_SNMP_AGENT_SOCK>
+  <CLICON_SNMP_MIB>CLIXON-TYPES-MIB</CLICON_SNMP_MIB>
+  <CLICON_SNMP_NOTIFY_STREAM>EXAMPLE</CLICON_SNMP_NOTIFY_STREAM>
+</clixon-config>
+EOF
+
+# Notification as translated from a NOTIFICATION-TYPE with OBJECTS clause:
+# { clixonExampleInteger, clixonExampleString, clixonHostStorage }
+cat <<EOF > $fyang
+module clixon-example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  import CLIXON-TYPES-MIB {
+      prefix "clixon-types";
+  }
+  import ietf-yang-smiv2 {
+      prefix "smiv2";
+  }
+  notification clixonExampleNotification {
+     smiv2:oid "1.3.6.1.4.1.8072.200.3.0.1";
+     container clixonExampleScalars {
+        leaf clixonExampleInteger {
+           type leafref {
+              path "/clixon-types:CLIXON-TYPES-MIB/clixon-types:clixonExampleScalars/clixon-types:clixonExampleInteger";
+           }
+        }
+        leaf clixonExampleString {
+           type leafref {
+              path "/clixon-types:CLIXON-TYPES-MIB/clixon-types:clixonExampleScalars/clixon-types:clixonExampleString";
+           }
+        }
+     }
+     container clixonHostsEntry {
+        leaf clixonHostName {
+           type leafref {
+              path "/clixon-types:CLIXON-TYPES-MIB/clixon-types:clixonHostsTable/clixon-types:clixonHostsEntry/clixon-types:clixonHostName";
+           }
+        }
+        leaf clixonHostStorage {
+           type leafref {
+              path "/clixon-types:CLIXON-TYPES-MIB/clixon-types:clixonHostsTable/clixon-types:clixonHostsEntry/clixon-types:clixonHostStorage";
+           }
+        }
+     }
+  }
+}
+EOF
+
+cat <<EOF > $fnotify
+<clixonExampleNotification xmlns="urn:example:clixon">
+  <clixonExampleScalars>
+    <clixonExampleInteger>42</clixonExampleInteger>
+    <clixonExampleString>notify</clixonExampleString>
+  </clixonExampleScalars>
+  <clixonHostsEntry>
+    <clixonHostName>test</clixonHostName>
+    <clixonHostStorage>permanent</clixonHostStorage>
+  </clixonHostsEntry>
+</clixonExampleNotification>
+EOF
+
+cat <<EOF > $ftrapconf
+disableAuthorization yes
+EOF
+
+function testinit(){
+    new "test params: -s init -f $cfg -- -n -e $fnotify"
+    if [ $BE -ne 0 ]; then
+        # Kill old backend and start a new one
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err "Failed to start backend"
+        fi
+
+        sudo pkill -f clixon_backend
+
+        new "Starting backend"
+        start_backend -s init -f $cfg -- -n -e $fnotify
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "Starting snmptrapd on 127.0.0.1:$trapport"
+    $snmptrapd -f -One -Lf $ftraplog -C -c $ftrapconf udp:127.0.0.1:$trapport &
+    trappid=$!
+
+    if [ $SN -ne 0 ]; then
+        # Kill old clixon_snmp, if any
+        new "Terminating any old clixon_snmp processes"
+        sudo killall -q clixon_snmp
+
+        new "Starting clixon_snmp"
+        start_snmp $cfg
+    fi
+
+    new "wait snmp"
+    wait_snmp
+}
+
+function testexit(){
+    stop_snmp
+    kill $trappid
+    wait $trappid 2> /dev/null
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+NOTIFYOID=".1.3.6.1.4.1.8072.200.3.0.1"
+
+testinit
+
+# Example stream timer is 5s
+new "wait for notification"
+for (( i=0; i<15; i++ )); do
+    if grep -q "$NOTIFYOID" $ftraplog 2> /dev/null; then
+        break
+    fi
+    sleep 1
+done
+
+ret=$(cat $ftraplog 2> /dev/null)
+
+new "snmpTrapOID is notification OID"
+expectpart "$ret" 0 "\.1\.3\.6\.1\.6\.3\.1\.1\.4\.1\.0 = OID: $NOTIFYOID"
+
+new "sysUpTime is added"
+expectpart "$ret" 0 "\.1\.3\.6\.1\.2\.1\.1\.3\.0 = Timeticks:"
+
+new "scalar integer instance .0"
+expectpart "$ret" 0 "\.1\.3\.6\.1\.4\.1\.8072\.200\.1\.1\.0 = INTEGER: 42"
+
+new "scalar string instance .0"
+expectpart "$ret" 0 "\.1\.3\.6\.1\.4\.1\.8072\.200\.1\.3\.0 = STRING: \"notify\""
+
+new "columnar enum with index instance"
+expectpart "$ret" 0 "\.1\.3\.6\.1\.4\.1\.8072\.200\.2\.2\.1\.4\.4\.116\.101\.115\.116 = INTEGER: 4"
+
+new "not-accessible index is not a varbind"
+expectpart "$ret" 0 "" --not-- "\.1\.3\.6\.1\.4\.1\.8072\.200\.2\.2\.1\.1\.4\.116"
+
+new "Cleaning up"
+testexit
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,115 @@
+#!/usr/bin/env bash
+# Trusted startup using digest of last validated config, see CLICON_STARTUP_DIGEST
+# 1. Start from valid startup, digest is saved
+# 2. Restart from same startup, digest matches: validation is skipped
+# 3. Change startup to invalid config, digest differs: validation fails
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/digest.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>ietf-netconf:startup</CLICON_FEATURE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_STARTUP_DIGEST>true</CLICON_STARTUP_DIGEST>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module digest{
+  yang-version 1.1;
+  namespace "urn:example:digest";
+  prefix d;
+  container c{
+    list a{
+      key k;
+      leaf k{
+        type string;
+      }
+    }
+    leaf ref{
+      type leafref{
+        path "../a/k";
+      }
+    }
+  }
+}
+EOF
+
+NS="xmlns=\"urn:example:digest\""
+validvar="<c $NS><a><k>x</k></a><ref>x</ref></c>"
+invalidvar="<c $NS><a><k>x</k></a><ref>y</ref></c>"
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    sudo rm -f $dir/validated.digest
+    echo "<${DATASTORE_TOP}>$validvar</${DATASTORE_TOP}>" > $dir/startup_db
+
+    new "start backend -s startup -f $cfg"
+    start_backend -s startup -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "Check running"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "<rpc-reply $DEFAULTNS><data>$validvar</data></rpc-reply>"
+
+    new "Digest saved"
+    if [ ! -f $dir/validated.digest ]; then
+        err "$dir/validated.digest" "not found"
+    fi
+
+    new "Digest is SHA-256 of config and YANG"
+    if ! grep -Eq "^[0-9a-f]{64} [0-9a-f]{64}$" $dir/validated.digest; then
+        err "<sha256> <sha256>" "$(cat $dir/validated.digest)"
+    fi
+
+    new "No temporary digest file left"
+    if [ -f $dir/validated.digest.tmp ]; then
+        err "no $dir/validated.digest.tmp" "found"
+    fi
+
+    new "Kill backend"
+    stop_backend -f $cfg
+
+    new "restart backend with unchanged startup"
+    start_backend -s startup -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "Check running"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "<rpc-reply $DEFAULTNS><data>$validvar</data></rpc-reply>"
+
+    new "Kill backend"
+    stop_backend -f $cfg
+
+    new "Changed startup is validated and fails"
+    echo "<${DATASTORE_TOP}>$invalidvar</${DATASTORE_TOP}>" > $dir/startup_db
+    ret=$(start_backend -1 -s startup -f $cfg 2> /dev/null)
+    r=$?
+    if [ $r -ne 255 ]; then
+        err "Unexpected retval" $r
+    fi
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,156 @@
+#!/usr/bin/env bash
+# Compiled configuration templates, see clixon-lib template-apply RPC
+# 1. Template with variables, cl:if and cl:foreach is defined and applied to candidate
+# 2. Template is re-used by name, and errors of undefined and invalid templates
+# 3. Time of applying many instances compared to edit-config of the same expanded config
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Number of template instances in timing tests
+: ${perfnr:=10000}
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/template.yang
+ftmpl=$dir/template.xml
+fconfig=$dir/config.xml
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module template{
+  yang-version 1.1;
+  namespace "urn:example:template";
+  prefix tm;
+  container services{
+    list service{
+      key name;
+      leaf name{
+        type string;
+      }
+      leaf vlan{
+        type uint16;
+      }
+      leaf descr{
+        type string;
+      }
+      leaf-list port{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+NS="xmlns=\"urn:example:template\""
+CLNS="xmlns:cl=\"http://clicon.org/lib\""
+OK="<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+TEMPLATE="<template><services $NS><service><name>\${name}</name><vlan>\${vlan}</vlan><descr cl:if=\"descr\">\${descr}</descr><port cl:foreach=\"port\">\${port}</port></service></services></template>"
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "define and apply template with two instances"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><template-apply $LIBNS $CLNS><name>svc</name>$TEMPLATE<instance><id>1</id><variable><name>name</name><value>y</value></variable><variable><name>vlan</name><value>20</value></variable><variable><name>port</name><value>p2</value><value>p1</value></variable></instance><instance><id>2</id><variable><name>name</name><value>x</value></variable><variable><name>vlan</name><value>10</value></variable><variable><name>descr</name><value>first</value></variable></instance></template-apply></rpc>" "<rpc-reply $DEFAULTNS><instances $LIBNS>2</instances></rpc-reply>"
+
+new "get-config: sorted, conditional and loop"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "<rpc-reply $DEFAULTNS><data><services $NS><service><name>x</name><vlan>10</vlan><descr>first</descr></service><service><name>y</name><vlan>20</vlan><port>p1</port><port>p2</port></service></services></data></rpc-reply>"
+
+new "apply template by name, merged with existing"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><template-apply $LIBNS><name>svc</name><instance><id>1</id><variable><name>name</name><value>a</value></variable><variable><name>vlan</name><value>30</value></variable><variable><name>descr</name><value>false</value></variable></instance></template-apply></rpc>" "<rpc-reply $DEFAULTNS><instances $LIBNS>1</instances></rpc-reply>"
+
+new "get-config: new entry first"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "<rpc-reply $DEFAULTNS><data><services $NS><service><name>a</name><vlan>30</vlan></service><service><name>x</name><vlan>10</vlan><descr>first</descr></service><service><name>y</name>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "$OK"
+
+new "undefined template"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><template-apply $LIBNS><name>none</name></template-apply></rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>bad-element</error-tag><error-info><bad-element>name</bad-element></error-info><error-severity>error</error-severity><error-message>Template not defined</error-message></rpc-error></rpc-reply>"
+
+new "template with unknown element"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><template-apply $LIBNS><name>bad</name><template><services $NS><xxx/></services></template></template-apply></rpc>" "<error-tag>unknown-element</error-tag>"
+
+new "template with unterminated variable"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><template-apply $LIBNS><name>bad</name><template><services $NS><service><name>\${name</name></service></services></template></template-apply></rpc>" "<error-tag>operation-failed</error-tag><error-severity>error</error-severity><error-message>Unterminated template variable"
+
+new "invalid template does not replace existing"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><template-apply $LIBNS><name>svc</name><template><services $NS><xxx/></services></template></template-apply></rpc>" "<error-tag>unknown-element</error-tag>"
+
+new "existing template still works"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><template-apply $LIBNS><name>svc</name><instance><id>1</id><variable><name>name</name><value>b</value></variable></instance></template-apply></rpc>" "<rpc-reply $DEFAULTNS><instances $LIBNS>1</instances></rpc-reply>"
+
+new "discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "$OK"
+
+new "generate $perfnr instances"
+rpc="<rpc $DEFAULTNS><template-apply $LIBNS><name>svc</name>"
+for (( i=0; i<$perfnr; i++ )); do
+    rpc+="<instance><id>$i</id><variable><name>name</name><value>s$i</value></variable><variable><name>vlan</name><value>$(( $i % 4096 ))</value></variable></instance>"
+done
+rpc+="</template-apply></rpc>"
+echo -n "$DEFAULTHELLO" > $ftmpl
+echo "$(chunked_framing "$rpc")" >> $ftmpl
+
+new "generate $perfnr expanded entries"
+rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><services $NS>"
+for (( i=0; i<$perfnr; i++ )); do
+    rpc+="<service><name>s$i</name><vlan>$(( $i % 4096 ))</vlan></service>"
+done
+rpc+="</services></config></edit-config></rpc>"
+echo -n "$DEFAULTHELLO" > $fconfig
+echo "$(chunked_framing "$rpc")" >> $fconfig
+
+new "apply template $perfnr instances"
+{ time -p $clixon_netconf -qef $cfg < $ftmpl > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+new "get-config one of $perfnr instances"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/tm:services/tm:service[tm:name='s4711']\" xmlns:tm=\"urn:example:template\"/></get-config></rpc>" "<rpc-reply $DEFAULTNS><data><services $NS><service><name>s4711</name><vlan>615</vlan></service></services></data></rpc-reply>"
+
+new "discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "$OK"
+
+new "edit-config $perfnr expanded entries"
+{ time -p $clixon_netconf -qef $cfg < $fconfig > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+new "discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "$OK"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
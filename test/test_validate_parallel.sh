@@ -0,0 +1,195 @@
+#!/usr/bin/env bash
+# Parallel validation, see CLICON_VALIDATE_WORKERS
+# 1. Valid config validates with several workers
+# 2. Config with errors early and late in a large list gives the same error as sequential
+# 3. Error only at end of list, handled by last worker, gives the same error as sequential
+# 4. Validation time for different number of workers
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Number of list entries
+: ${perfnr:=20000}
+
+# Number of workers in parallel tests
+: ${workers:=4}
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/parallel.yang
+fvalid=$dir/valid.xml
+finvalid=$dir/invalid.xml
+flast=$dir/last.xml
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module parallel{
+  yang-version 1.1;
+  namespace "urn:example:parallel";
+  prefix p;
+  container c{
+    list a{
+      key k;
+      unique v;
+      leaf k{
+        type int32;
+      }
+      leaf v{
+        type int32;
+        must ". < 1000000" {
+          error-message "v too large";
+        }
+      }
+      leaf ref{
+        type leafref{
+          path "../../a/k";
+        }
+      }
+    }
+    container d{
+      leaf-list l{
+        type string;
+        min-elements 1;
+      }
+    }
+  }
+}
+EOF
+
+NS="xmlns=\"urn:example:parallel\""
+
+# Generate edit-config of list with perfnr entries
+# 1: file
+# 2: entry with invalid leafref, or -1
+# 3: entry with failed must, or -1
+function genconfig(){
+    f=$1
+    rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><default-operation>replace</default-operation><config><c $NS>"
+    for (( i=0; i<$perfnr; i++ )); do
+        ref=$(( ( $i + 1 ) % $perfnr ))
+        v=$i
+        if [ $i -eq $2 ]; then
+            ref=-1
+        fi
+        if [ $i -eq $3 ]; then
+            v=2000000
+        fi
+        rpc+="<a><k>$i</k><v>$v</v><ref>$ref</ref></a>"
+    done
+    rpc+="<d><l>x</l></d></c></config></edit-config></rpc>"
+    echo -n "$DEFAULTHELLO" > $f
+    echo "$(chunked_framing "$rpc")" >> $f
+}
+
+new "generate valid config with $perfnr entries"
+genconfig $fvalid -1 -1
+
+new "generate config with invalid leafref early and failed must late"
+genconfig $finvalid 10 $(( $perfnr - 10 ))
+
+new "generate config with failed must in last entry"
+genconfig $flast -1 $(( $perfnr - 1 ))
+
+# Start backend with number of validation workers
+# 1: workers
+function start(){
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s init -f $cfg -o CLICON_VALIDATE_WORKERS=$1"
+        start_backend -s init -f $cfg -o CLICON_VALIDATE_WORKERS=$1
+    fi
+    new "wait backend"
+    wait_backend
+}
+
+function stop(){
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+# Load config and validate candidate, save reply
+# 1: config file
+# 2: reply file
+function validate(){
+    new "load $1"
+    expecteof_file "$clixon_netconf -qef $cfg" 0 "$1" "^<rpc-reply $DEFAULTNS><ok/></rpc-reply>$"
+    new "validate $1"
+    rpc=$(chunked_framing "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>")
+    echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg > $2
+}
+
+for w in 1 $workers; do
+    start $w
+    validate $fvalid $dir/valid$w.out
+    new "valid config with $w workers"
+    match=$(grep -c "<ok/>" $dir/valid$w.out)
+    if [ $match -eq 0 ]; then
+        err "<ok/>" "$(cat $dir/valid$w.out)"
+    fi
+    validate $finvalid $dir/invalid$w.out
+    validate $flast $dir/last$w.out
+    stop
+done
+
+new "invalid leafref is reported"
+match=$(grep -c "Leafref validation failed: No leaf -1" $dir/invalid1.out)
+if [ $match -eq 0 ]; then
+    err "Leafref validation failed" "$(cat $dir/invalid1.out)"
+fi
+
+new "same error with $workers workers as sequential"
+if ! cmp -s $dir/invalid1.out $dir/invalid$workers.out; then
+    err "$(cat $dir/invalid1.out)" "$(cat $dir/invalid$workers.out)"
+fi
+
+new "failed must in last entry is reported"
+match=$(grep -c "v too large" $dir/last1.out)
+if [ $match -eq 0 ]; then
+    err "v too large" "$(cat $dir/last1.out)"
+fi
+
+new "same error in last entry with $workers workers as sequential"
+if ! cmp -s $dir/last1.out $dir/last$workers.out; then
+    err "$(cat $dir/last1.out)" "$(cat $dir/last$workers.out)"
+fi
+
+# Scaling: validation time of valid config
+nproc=$(nproc 2> /dev/null || echo 1)
+for w in 1 2 4 $nproc; do
+    start $w
+    new "load $fvalid"
+    expecteof_file "$clixon_netconf -qef $cfg" 0 "$fvalid" "^<rpc-reply $DEFAULTNS><ok/></rpc-reply>$"
+    new "validate time with $w workers"
+    rpc=$(chunked_framing "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>")
+    { time -p echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+    stop
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest
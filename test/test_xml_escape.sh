@@ -0,0 +1,129 @@
+#!/usr/bin/env bash
+# XML character data escaping and URI percent encoding/decoding
+# Random strings of varying length, so that special characters occur at all positions
+# relative to the block scans, are:
+# 1. Escaped, parsed and printed with clixon_util_xml and compared with a reference escape
+# 2. Percent-encoded as api-path keys, decoded and looked up with clixon_util_path
+# Last, the time to parse and print a large file of mostly plain text is shown
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_xml:="clixon_util_xml"}
+: ${clixon_util_path:=clixon_util_path -a -D $DBG}
+
+# Number of random strings
+: ${nr:=100}
+
+# Number of entries in throughput file
+: ${perfnr:=20000}
+
+ydir=$dir/yang
+xml=$dir/keys.xml
+perfxml=$dir/perf.xml
+
+if [ ! -d $ydir ]; then
+    mkdir $ydir
+fi
+
+cat <<EOF > $ydir/esc.yang
+module esc{
+  namespace "urn:example:esc";
+  prefix e;
+  container x{
+    list y{
+      key k;
+      leaf k{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+# Characters in random strings, including XML and URI special characters and UTF-8
+chars=(a b c X Y 0 9 - _ . '~' ' ' '&' '<' '>' "'" '"' '%' '/' '=' ',' '?' '#' '[' ']' 'å' 'ö' '€')
+
+# Random string of length $1
+function rndstr(){
+    local s=""
+    for (( j=0; j<$1; j++ )); do
+        s="$s${chars[$(( RANDOM % ${#chars[@]} ))]}"
+    done
+    echo -n "$s"
+}
+
+# Reference XML escape of $1: & < >
+function xmlesc(){
+    echo -n "$1" | sed -e 's/&/\&amp;/g' -e 's/</\&lt;/g' -e 's/>/\&gt;/g'
+}
+
+# Reference RFC 3986 percent encoding of $1: all but unreserved characters
+function uriesc(){
+    local LC_ALL=C
+    local s="$1"
+    local c
+    for (( j=0; j<${#s}; j++ )); do
+        c="${s:$j:1}"
+        case "$c" in
+            [a-zA-Z0-9._~-]) echo -n "$c" ;;
+            *) printf '%%%02X' "'$c" ;;
+        esac
+    done
+}
+
+new "xml escape of $nr random strings"
+for (( i=0; i<$nr; i++ )); do
+    # Lengths cross 8 and 16 byte block boundaries
+    str=$(rndstr $(( i % 70 )))
+    esc=$(xmlesc "$str")
+    ret=$(echo -n "<a>x${esc}x</a>" | $clixon_util_xml -o)
+    if [ "$ret" != "<a>x${esc}x</a>" ]; then
+        err "<a>x${esc}x</a>" "$ret"
+    fi
+done
+
+new "xml escape special characters last in block"
+esc="0123456789abcde&amp;0123456789abcd&lt;&gt;"
+expecteofx "$clixon_util_xml -o" 0 "<a>$esc</a>" "<a>$esc</a>"
+
+new "xml CDATA is not escaped"
+expecteofx "$clixon_util_xml -o" 0 "<a>0123456789abcdef&amp;<![CDATA[a<b&c>d 0123456789abcdef]]>&lt;</a>" "<a>0123456789abcdef&amp;<![CDATA[a<b&c>d 0123456789abcdef]]>&lt;</a>"
+
+new "generate $nr random keys to $xml"
+echo -n '<x xmlns="urn:example:esc">' > $xml
+keys=()
+for (( i=0; i<$nr; i++ )); do
+    # Make keys unique by suffix
+    keys[$i]="$(rndstr $(( i % 40 )))$i"
+    echo -n "<y><k>$(xmlesc "${keys[$i]}")</k></y>" >> $xml
+done
+echo -n '</x>' >> $xml
+
+new "api-path percent-encoded keys"
+for (( i=0; i<$nr; i++ )); do
+    enc=$(uriesc "${keys[$i]}")
+    ret=$($clixon_util_path -f $xml -y $ydir -p "/esc:x/y=$enc")
+    if [ "$ret" != "0: <y><k>$(xmlesc "${keys[$i]}")</k></y>" ]; then
+        err "0: <y><k>$(xmlesc "${keys[$i]}")</k></y>" "$ret"
+    fi
+done
+
+new "api-path lowercase hex and literal percent"
+echo -n '<x xmlns="urn:example:esc"><y><k>a/b%z</k></y></x>' > $xml
+expectpart "$($clixon_util_path -f $xml -y $ydir -p /esc:x/y=a%2fb%z)" 0 "^0: <y><k>a/b%z</k></y>$"
+
+new "generate $perfnr entries of text to $perfxml"
+echo -n '<x xmlns="urn:example:esc">' > $perfxml
+for (( i=0; i<$perfnr; i++ )); do
+    echo -n "<y><k>Interface $i description connected to uplink port number $i &amp; backup</k></y>" >> $perfxml
+done
+echo -n '</x>' >> $perfxml
+
+new "parse and print $perfnr entries"
+{ time -p $clixon_util_xml -o -f $perfxml > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,176 @@
+#!/usr/bin/env bash
+# XPath profiling and slow-query log, see CLICON_XPATH_PROFILE and CLICON_XPATH_SLOW_THRESHOLD
+# 1. Per-expression statistics are dumped, limited and reset with clixon-lib:xpath-profile
+# 2. Slow xpath evaluations are logged, fast are not
+# 3. Time of queries with and without profiling
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Number of list entries
+: ${perfnr:=5000}
+
+# Number of queries in timing tests
+: ${perfreq:=100}
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/profile.yang
+fconfig=$dir/large.xml
+flog=$dir/backend.log
+fquery=$dir/query.xml
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_XPATH_PROFILE>true</CLICON_XPATH_PROFILE>
+  <CLICON_XPATH_SLOW_THRESHOLD>50</CLICON_XPATH_SLOW_THRESHOLD>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module profile{
+  yang-version 1.1;
+  namespace "urn:example:profile";
+  prefix pr;
+  container x{
+    list y{
+      key a;
+      leaf a{
+        type int32;
+      }
+      leaf b{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+NS="xmlns=\"urn:example:profile\""
+OK="<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+# Quadratic xpath: count of whole list is evaluated for each entry, matches nothing
+SLOW="<get-config><source><running/></source><filter type=\"xpath\" select=\"/pr:x/pr:y[pr:a=count(/pr:x/pr:y)]\" xmlns:pr=\"urn:example:profile\"/></get-config>"
+# Non-key predicate, no list optimization
+FAST="<get-config><source><running/></source><filter type=\"xpath\" select=\"/pr:x/pr:y[pr:b='1']\" xmlns:pr=\"urn:example:profile\"/></get-config>"
+ONE="<rpc-reply $DEFAULTNS><data><x $NS><y><a>1</a><b>1</b></y></x></data></rpc-reply>"
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg -l f$flog"
+    start_backend -s init -f $cfg -l f$flog
+fi
+
+new "wait backend"
+wait_backend
+
+new "generate $perfnr entries"
+rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><default-operation>replace</default-operation><config><x $NS>"
+for (( i=0; i<$perfnr; i++ )); do
+    rpc+="<y><a>$i</a><b>$i</b></y>"
+done
+rpc+="</x></config></edit-config></rpc>"
+echo -n "$DEFAULTHELLO" > $fconfig
+echo "$(chunked_framing "$rpc")" >> $fconfig
+
+new "load $perfnr entries"
+expecteof_file "$clixon_netconf -qef $cfg" 0 "$fconfig" "^$OK$"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "$OK"
+
+new "reset statistics"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><xpath-profile $LIBNS><reset>true</reset></xpath-profile></rpc>")" | $clixon_netconf -qef $cfg)
+expectpart "$ret" 0 "<rpc-reply $DEFAULTNS>"
+
+new "fast query"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$FAST</rpc>" "$ONE"
+
+new "fast query again"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$FAST</rpc>" "$ONE"
+
+new "slow query"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$SLOW</rpc>" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "xpath-profile: fast query is counted twice with nodes and results"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><xpath-profile $LIBNS/></rpc>")" | $clixon_netconf -qef $cfg)
+expectpart "$ret" 0 "<xpath $LIBNS><expression>/pr:x/pr:y\[pr:b='1'\]</expression><call-site>[^<]\+</call-site><calls>2</calls><time-total>[0-9]\+</time-total><time-max>[0-9]\+</time-max><nodes>[1-9][0-9]*</nodes><results>2</results></xpath>"
+
+new "xpath-profile: slow query is first"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><xpath-profile $LIBNS><max>1</max></xpath-profile></rpc>")" | $clixon_netconf -qef $cfg)
+expectpart "$ret" 0 "<rpc-reply $DEFAULTNS><xpath $LIBNS><expression>/pr:x/pr:y\[pr:a=count(/pr:x/pr:y)\]</expression><call-site>[^<]\+</call-site><calls>1</calls>" --not-- "pr:b='1'"
+
+new "xpath-profile: invalid max"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><xpath-profile $LIBNS><max>many</max></xpath-profile></rpc>" "<rpc-error><error-type>application</error-type><error-tag>bad-element</error-tag>"
+
+new "xpath-profile with reset"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><xpath-profile $LIBNS><reset>true</reset></xpath-profile></rpc>")" | $clixon_netconf -qef $cfg)
+expectpart "$ret" 0 "pr:b='1'"
+
+new "xpath-profile after reset"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><xpath-profile $LIBNS/></rpc>")" | $clixon_netconf -qef $cfg)
+expectpart "$ret" 0 "<rpc-reply $DEFAULTNS>" --not-- "pr:b='1'" "count("
+
+new "slow query is logged, fast is not"
+ret=$(sudo cat $flog)
+expectpart "$ret" 0 "Slow xpath: [0-9]\+ ms /pr:x/pr:y\[pr:a=count(/pr:x/pr:y)\] caller:[^ ]\+ nodes:[1-9][0-9]* results:0" --not-- "Slow xpath: [0-9]\+ ms /pr:x/pr:y\[pr:b='1'\]"
+
+echo -n "$DEFAULTHELLO" > $fquery
+for (( i=0; i<$perfreq; i++ )); do
+    echo "$(chunked_framing "<rpc $DEFAULTNS>$FAST</rpc>")" >> $fquery
+done
+
+new "$perfreq queries with profiling"
+{ time -p $clixon_netconf -qef $cfg < $fquery > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+
+    new "start backend without profiling"
+    start_backend -s running -f $cfg -o CLICON_XPATH_PROFILE=false -o CLICON_XPATH_SLOW_THRESHOLD=0
+fi
+
+new "wait backend"
+wait_backend
+
+new "$perfreq queries without profiling"
+{ time -p $clixon_netconf -qef $cfg < $fquery > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+new "xpath-profile is empty without profiling"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><xpath-profile $LIBNS/></rpc>")" | $clixon_netconf -qef $cfg)
+expectpart "$ret" 0 "<rpc-reply $DEFAULTNS" --not-- "<xpath"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
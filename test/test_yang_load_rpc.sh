@@ -0,0 +1,277 @@
+#!/usr/bin/env bash
+# Runtime YANG module load, upgrade and removal with the yang-load RPC
+# 1. Load a new module and edit data of it
+# 2. Upgrade module, new default is added to datastore
+# 3. Upgrade where running is invalid is rejected and old revision remains
+# 4. Remove module
+# 5. yang-library-update notification is sent on upgrade
+# 6. Time of upgrade and client latency during upgrade under client load
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Number of list entries in main module
+: ${perfnr:=10000}
+
+# Number of concurrent clients during upgrade
+: ${clients:=4}
+
+# Number of requests per client during upgrade
+: ${perfreq:=20}
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/main.yang
+ydir=$dir/yang
+
+test -d $ydir || mkdir $ydir
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$ydir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_XMLDB_MODSTATE>true</CLICON_XMLDB_MODSTATE>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module main{
+  yang-version 1.1;
+  namespace "urn:example:main";
+  prefix m;
+  container x{
+    list y{
+      key a;
+      leaf a{
+        type int32;
+      }
+      leaf b{
+        type int32;
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $ydir/load@2024-01-01.yang
+module load{
+  yang-version 1.1;
+  namespace "urn:example:load";
+  prefix l;
+  revision 2024-01-01;
+  container c{
+    leaf v{
+      type int32;
+    }
+  }
+}
+EOF
+
+# Added leaf with default
+cat <<EOF > $ydir/load@2024-06-01.yang
+module load{
+  yang-version 1.1;
+  namespace "urn:example:load";
+  prefix l;
+  revision 2024-06-01;
+  revision 2024-01-01;
+  container c{
+    leaf v{
+      type int32;
+    }
+    leaf w{
+      type string;
+      default "new";
+    }
+  }
+}
+EOF
+
+# Restricted range
+cat <<EOF > $ydir/load@2024-09-01.yang
+module load{
+  yang-version 1.1;
+  namespace "urn:example:load";
+  prefix l;
+  revision 2024-09-01;
+  revision 2024-06-01;
+  revision 2024-01-01;
+  container c{
+    leaf v{
+      type int32{
+        range "0..100";
+      }
+    }
+    leaf w{
+      type string;
+      default "new";
+    }
+  }
+}
+EOF
+
+NS="xmlns=\"urn:example:load\""
+OK="<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+# yang-load of a module revision
+# 1: revision
+function yangload(){
+    echo "<rpc $DEFAULTNS><yang-load $LIBNS><module><name>load</name><revision>$1</revision></module></yang-load></rpc>"
+}
+
+# Edit and commit
+# 1: value of v
+function editv(){
+    new "edit v=$1"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c $NS><v>$1</v></c></config></edit-config></rpc>" "$OK"
+    new "commit v=$1"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "$OK"
+}
+
+new "generate startup with $perfnr entries"
+echo -n "<${DATASTORE_TOP}><x xmlns=\"urn:example:main\">" > $dir/startup_db
+for (( i=0; i<$perfnr; i++ )); do
+    echo -n "<y><a>$i</a><b>$i</b></y>" >> $dir/startup_db
+done
+echo "</x></${DATASTORE_TOP}>" >> $dir/startup_db
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s startup -f $cfg"
+    start_backend -s startup -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "edit data of module not loaded"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c $NS><v>50</v></c></config></edit-config></rpc>" "<rpc-reply $DEFAULTNS><rpc-error>"
+
+new "load module"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(yangload 2024-01-01)" "<rpc-reply $DEFAULTNS><content-id $LIBNS>1</content-id></rpc-reply>"
+
+editv 50
+
+new "running has new module-state"
+if ! sudo grep -q "<name>load</name><revision>2024-01-01</revision>" $dir/running_db; then
+    err "load@2024-01-01 in running_db" "$(sudo cat $dir/running_db)"
+fi
+
+new "main data is kept"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/m:x/m:y[m:a='7']\" xmlns:m=\"urn:example:main\"/></get-config></rpc>" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:main\"><y><a>7</a><b>7</b></y></x></data></rpc-reply>"
+
+new "upgrade module"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(yangload 2024-06-01)" "<rpc-reply $DEFAULTNS><content-id $LIBNS>2</content-id></rpc-reply>"
+
+new "new default after upgrade"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/l:c\" xmlns:l=\"urn:example:load\"/><with-defaults xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-with-defaults\">report-all</with-defaults></get-config></rpc>" "<rpc-reply $DEFAULTNS><data><c $NS><v>50</v><w>new</w></c></data></rpc-reply>"
+
+editv 1000
+
+new "upgrade with invalid running fails"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(yangload 2024-09-01)" "<rpc-reply $DEFAULTNS><rpc-error>" "1000"
+
+new "old revision remains"
+if ! sudo grep -q "<name>load</name><revision>2024-06-01</revision>" $dir/running_db; then
+    err "load@2024-06-01 in running_db" "$(sudo cat $dir/running_db)"
+fi
+
+editv 100
+
+new "load non-existing revision"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(yangload 2000-01-01)" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>operation-failed</error-tag>"
+
+new "subscribe to NETCONF stream and upgrade"
+rpc=$(chunked_framing "<rpc $DEFAULTNS><create-subscription xmlns=\"urn:ietf:params:xml:ns:netmod:notification\"><stream>NETCONF</stream></create-subscription></rpc>")
+(echo "$DEFAULTHELLO$rpc"; sleep 3) | timeout 5 $clixon_netconf -qef $cfg > $dir/notify.out &
+sleep 1
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(yangload 2024-09-01)" "<rpc-reply $DEFAULTNS><content-id $LIBNS>3</content-id></rpc-reply>"
+wait
+
+new "yang-library-update notification"
+if ! grep -q "<yang-library-update xmlns=\"urn:ietf:params:xml:ns:yang:ietf-yang-library\"><content-id>3</content-id></yang-library-update>" $dir/notify.out; then
+    err "yang-library-update" "$(cat $dir/notify.out)"
+fi
+
+new "remove module with data fails"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><yang-load $LIBNS><remove>load</remove></yang-load></rpc>" "<rpc-reply $DEFAULTNS><rpc-error>"
+
+new "remove non-existing module"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><yang-load $LIBNS><remove>foo</remove></yang-load></rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>bad-element</error-tag><error-info><bad-element>remove</bad-element></error-info><error-severity>error</error-severity><error-message>No such module</error-message></rpc-error></rpc-reply>"
+
+new "delete data of module"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c $NS xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\" nc:operation=\"delete\"/></config></edit-config></rpc>" "$OK"
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "$OK"
+
+new "remove module"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><yang-load $LIBNS><remove>load</remove></yang-load></rpc>" "<rpc-reply $DEFAULTNS><content-id $LIBNS>4</content-id></rpc-reply>"
+
+new "module removed from module-state"
+if sudo grep -q "<name>load</name>" $dir/running_db; then
+    err "no load in running_db" "$(sudo cat $dir/running_db)"
+fi
+
+new "edit data of removed module"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c $NS><v>50</v></c></config></edit-config></rpc>" "<rpc-reply $DEFAULTNS><rpc-error>"
+
+# Clients reading running, each writes latency of requests in ms to a file
+function clients(){
+    rpc=$(chunked_framing "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/m:x/m:y[m:a='7']\" xmlns:m=\"urn:example:main\"/></get-config></rpc>")
+    for (( r=0; r<$clients; r++ )); do
+        (
+            for (( j=0; j<$perfreq; j++ )); do
+                t0=$(date +%s%N)
+                echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg > /dev/null
+                t1=$(date +%s%N)
+                echo $(( ($t1 - $t0) / 1000000 )) >> $dir/latency
+            done
+        ) &
+    done
+}
+
+rm -f $dir/latency
+new "$clients clients with $perfreq requests"
+clients
+wait
+echo "max client latency without upgrade (ms): $(sort -n $dir/latency | tail -1)"
+
+rm -f $dir/latency
+new "$clients clients with $perfreq requests during upgrade"
+clients
+rpc=$(chunked_framing "$(yangload 2024-06-01)")
+new "upgrade time with $perfnr entries"
+{ time -p echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+wait
+echo "max client latency during upgrade (ms): $(sort -n $dir/latency | tail -1)"
+
+new "main data is kept after upgrade under load"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/m:x/m:y[m:a='$(( $perfnr - 1 ))']\" xmlns:m=\"urn:example:main\"/></get-config></rpc>" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:main\"><y><a>$(( $perfnr - 1 ))</a><b>$(( $perfnr - 1 ))</b></y></x></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest